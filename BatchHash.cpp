@@ -0,0 +1,464 @@
+#include "BatchHash.h"
+#include "CgroupLimits.h"
+#include "Logger.h"
+#include "MiningCommon.h"
+#include "RandomXAlgorithm.h"
+#include "RandomXHasher.h"
+#include "RandomXManager.h"
+#include "ThreadAffinity.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <fmt/core.h>
+
+namespace {
+
+constexpr size_t NONCE_OFFSET = 39; // Jak w RandomXHasher::hash()
+constexpr size_t HASH_CHUNK = 16;   // Rekordów pobieranych naraz przez wątek
+
+using HashBytes = std::array<uint8_t, RANDOMX_HASH_SIZE>;
+
+struct BatchOptions {
+    std::string input = "-";
+    std::string output = "-";
+    unsigned threads = 0; // 0 = liczba dozwolonych CPU
+    std::vector<unsigned> affinity;
+    RandomXMode mode = RandomXMode::Fast;
+    const RandomXAlgorithm* algorithm = &default_randomx_algorithm();
+    size_t batch = 65536;
+    bool echo = false;
+};
+
+struct Record {
+    std::vector<uint8_t> blob; // Z wstrzykniętym nonce
+    std::string line;          // Tylko przy --echo
+};
+
+/**
+ * @brief Rekordy partii z tym samym seedem i wariantem.
+ */
+struct Group {
+    const RandomXAlgorithm* algorithm = nullptr;
+    std::string seed;
+    std::vector<size_t> records; // Indeksy w partii
+};
+
+uint64_t parse_number(const std::string& option, std::string_view text, uint64_t max) {
+    int base = 10;
+    if (text.starts_with("0x") || text.starts_with("0X")) {
+        text.remove_prefix(2);
+        base = 16;
+    }
+    uint64_t value = 0;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value, base);
+    if (text.empty() || ec != std::errc() || ptr != text.data() + text.size() || value > max) {
+        throw std::invalid_argument(fmt::format("Nieprawidłowa wartość dla {}: '{}'", option, text));
+    }
+    return value;
+}
+
+bool is_hex(std::string_view text) {
+    return text.size() % 2 == 0 &&
+           std::all_of(text.begin(), text.end(), [](char c) { return std::isxdigit(static_cast<unsigned char>(c)); });
+}
+
+BatchOptions parse_options(const std::vector<std::string>& args) {
+    BatchOptions options;
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        auto value = [&]() -> const std::string& {
+            if (i + 1 >= args.size()) {
+                throw std::invalid_argument(fmt::format("Brak wartości dla {}", arg));
+            }
+            return args[++i];
+        };
+        if (arg == "--input") {
+            options.input = value();
+        } else if (arg == "--output") {
+            options.output = value();
+        } else if (arg == "--threads") {
+            options.threads = static_cast<unsigned>(parse_number(arg, value(), 4096));
+        } else if (arg == "--affinity") {
+            options.affinity = parse_kernel_cpu_list(value());
+            if (options.affinity.empty()) {
+                throw std::invalid_argument(fmt::format("Nieprawidłowa lista CPU dla {}: '{}'", arg, args[i]));
+            }
+        } else if (arg == "--mode") {
+            const std::string& mode = value();
+            if (mode == "fast") {
+                options.mode = RandomXMode::Fast;
+            } else if (mode == "light") {
+                options.mode = RandomXMode::Light;
+            } else {
+                throw std::invalid_argument(fmt::format("Oczekiwano fast lub light dla --mode, otrzymano '{}'", mode));
+            }
+        } else if (arg == "--algo") {
+            options.algorithm = find_randomx_algorithm(value());
+            if (!options.algorithm) {
+                throw std::invalid_argument(fmt::format("Nieobsługiwany algorytm: '{}'", args[i]));
+            }
+        } else if (arg == "--batch") {
+            options.batch = parse_number(arg, value(), 1u << 24);
+            if (options.batch == 0) {
+                throw std::invalid_argument("--batch musi być większe od zera");
+            }
+        } else if (arg == "--echo") {
+            options.echo = true;
+        } else {
+            throw std::invalid_argument(fmt::format("Nieznana opcja hash: '{}'", arg));
+        }
+    }
+    return options;
+}
+
+/**
+ * @brief Parsuje linię "SEED BLOB NONCE [ALGO]" do rekordu.
+ * @return false dla linii pustej lub komentarza.
+ */
+bool parse_record(const std::string& line, uint64_t line_no, const BatchOptions& options,
+                  Record& record, std::string& seed, const RandomXAlgorithm*& algorithm) {
+    std::vector<std::string_view> fields;
+    std::string_view rest = line;
+    while (true) {
+        auto begin = rest.find_first_not_of(" \t\r");
+        if (begin == std::string_view::npos) {
+            break;
+        }
+        rest.remove_prefix(begin);
+        if (fields.empty() && rest.front() == '#') {
+            return false;
+        }
+        auto end = std::min(rest.find_first_of(" \t\r"), rest.size());
+        fields.push_back(rest.substr(0, end));
+        rest.remove_prefix(end);
+    }
+    if (fields.empty()) {
+        return false;
+    }
+
+    auto fail = [&](const std::string& reason) {
+        return std::invalid_argument(fmt::format("Linia {}: {}", line_no, reason));
+    };
+    if (fields.size() < 3 || fields.size() > 4) {
+        throw fail(fmt::format("oczekiwano 'SEED BLOB NONCE [ALGO]', otrzymano {} pól", fields.size()));
+    }
+    if (fields[0].size() != 64 || !is_hex(fields[0])) {
+        throw fail("seed musi mieć 64 znaki hex");
+    }
+    if (!is_hex(fields[1]) || fields[1].size() < 2 * (NONCE_OFFSET + sizeof(uint32_t))) {
+        throw fail(fmt::format("blob musi być hex i mieć co najmniej {} bajtów", NONCE_OFFSET + sizeof(uint32_t)));
+    }
+
+    seed.assign(fields[0]);
+    std::transform(seed.begin(), seed.end(), seed.begin(), [](unsigned char c) { return std::tolower(c); });
+    record.blob = hex_to_bytes(std::string(fields[1]));
+    if (fields[2] != "-") {
+        uint32_t nonce = 0;
+        try {
+            nonce = static_cast<uint32_t>(parse_number("nonce", fields[2], UINT32_MAX));
+        } catch (const std::invalid_argument& e) {
+            throw fail(e.what());
+        }
+        std::memcpy(record.blob.data() + NONCE_OFFSET, &nonce, sizeof(uint32_t));
+    }
+    algorithm = options.algorithm;
+    if (fields.size() == 4) {
+        algorithm = find_randomx_algorithm(fields[3]);
+        if (!algorithm) {
+            throw fail(fmt::format("nieobsługiwany algorytm '{}'", fields[3]));
+        }
+    }
+    if (options.echo) {
+        record.line.assign(fields.front().data(), fields.back().data() + fields.back().size());
+    }
+    return true;
+}
+
+/**
+ * @class HashPool
+ * @brief Stałe, przypięte wątki z własnymi VM. VM są podpinane do zasobów
+ * managera tylko przy zmianie ich generacji, więc kolejne partie tego
+ * samego seeda nie tworzą VM od nowa.
+ */
+class HashPool {
+public:
+    HashPool(unsigned threads, const std::vector<unsigned>& cpus) {
+        m_threads.reserve(threads);
+        for (unsigned i = 0; i < threads; ++i) {
+            std::vector<unsigned> pin;
+            if (!cpus.empty()) {
+                pin.push_back(cpus[i % cpus.size()]);
+            }
+            m_threads.emplace_back([this, pin](std::stop_token st) { thread_loop(st, pin); });
+        }
+    }
+
+    /**
+     * @brief Liczy hashe rekordów records[indices[i]] do out[indices[i]].
+     * Wymaga blokady managera (binding ważny do końca).
+     */
+    void run(const RandomXBinding& binding, const std::vector<Record>& records,
+             const std::vector<size_t>& indices, std::vector<HashBytes>& out) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_binding = binding;
+        m_records = &records;
+        m_indices = &indices;
+        m_out = &out;
+        m_next.store(0, std::memory_order_relaxed);
+        m_running = static_cast<unsigned>(m_threads.size());
+        m_error = nullptr;
+        ++m_round;
+        m_cv.notify_all();
+        m_done_cv.wait(lock, [this] { return m_running == 0; });
+        if (m_error) {
+            std::rethrow_exception(m_error);
+        }
+    }
+
+private:
+    void thread_loop(std::stop_token st, std::vector<unsigned> pin) {
+        if (!pin.empty() && !set_current_thread_affinity(pin)) {
+            LOG_WARN(LogCategory::Hasher, "[Hash] Nie udało się przypiąć wątku do CPU {}.", pin.front());
+        }
+        RandomXHasher hasher;
+        std::optional<uint64_t> bound_generation;
+        uint64_t seen_round = 0;
+        while (true) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!m_cv.wait(lock, st, [&] { return m_round != seen_round; })) {
+                return;
+            }
+            seen_round = m_round;
+            RandomXBinding binding = m_binding;
+            const std::vector<Record>& records = *m_records;
+            const std::vector<size_t>& indices = *m_indices;
+            std::vector<HashBytes>& out = *m_out;
+            lock.unlock();
+
+            try {
+                if (bound_generation != binding.generation) {
+                    hasher.bind(*binding.algorithm, binding.cache, binding.dataset);
+                    bound_generation = binding.generation;
+                }
+                size_t begin;
+                while ((begin = m_next.fetch_add(HASH_CHUNK, std::memory_order_relaxed)) < indices.size()) {
+                    size_t end = std::min(begin + HASH_CHUNK, indices.size());
+                    for (size_t i = begin; i < end; ++i) {
+                        const Record& record = records[indices[i]];
+                        hasher.hash_bytes(record.blob.data(), record.blob.size(), out[indices[i]].data());
+                    }
+                }
+            } catch (...) {
+                bound_generation.reset();
+                lock.lock();
+                m_error = std::current_exception();
+                lock.unlock();
+            }
+
+            lock.lock();
+            if (--m_running == 0) {
+                m_done_cv.notify_one();
+            }
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable_any m_cv;
+    std::condition_variable m_done_cv;
+    uint64_t m_round = 0;
+    unsigned m_running = 0;
+    std::exception_ptr m_error;
+    RandomXBinding m_binding;
+    const std::vector<Record>* m_records = nullptr;
+    const std::vector<size_t>* m_indices = nullptr;
+    std::vector<HashBytes>* m_out = nullptr;
+    std::atomic<size_t> m_next{0};
+    std::vector<std::jthread> m_threads; // Ostatnie: zatrzymywane przed zniszczeniem reszty
+};
+
+struct BatchStats {
+    uint64_t records = 0;
+    uint64_t groups = 0;
+    uint64_t builds = 0;
+    double build_seconds = 0.0;
+    double hash_seconds = 0.0;
+};
+
+/**
+ * @brief Liczy jedną partię: grupy po (seed, wariant), dataset budowany raz na grupę.
+ */
+void hash_batch(RandomXManager& manager, HashPool& pool, const std::vector<Record>& records,
+                std::vector<Group>& groups, std::vector<HashBytes>& out, BatchStats& stats) {
+    // Najpierw grupa z seedem, który manager już ma - bez zbędnej przebudowy
+    std::string current = manager.get_current_seed();
+    auto ready = std::find_if(groups.begin(), groups.end(), [&](const Group& group) {
+        return group.seed == current && group.algorithm == &manager.get_algorithm();
+    });
+    if (ready != groups.end()) {
+        std::rotate(groups.begin(), ready, ready + 1);
+    }
+
+    for (const Group& group : groups) {
+        auto build_start = std::chrono::steady_clock::now();
+        if (manager.updateSeed(group.seed, *group.algorithm)) {
+            stats.builds++;
+            stats.build_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - build_start).count();
+        }
+
+        auto lock = manager.try_acquire();
+        RandomXBinding binding = manager.binding();
+        if (!lock.owns_lock() || binding.seed_hex != group.seed || binding.algorithm != group.algorithm) {
+            throw std::runtime_error(fmt::format("Nie udało się przygotować RandomX {} dla seeda {}",
+                                                 group.algorithm->name, group.seed));
+        }
+        auto hash_start = std::chrono::steady_clock::now();
+        pool.run(binding, records, group.records, out);
+        stats.hash_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - hash_start).count();
+        stats.groups++;
+    }
+    stats.records += records.size();
+}
+
+int run(const BatchOptions& options) {
+    std::ifstream input_file;
+    if (options.input != "-") {
+        input_file.open(options.input);
+        if (!input_file) {
+            std::cerr << fmt::format("BŁĄD: Nie udało się otworzyć {}\n", options.input);
+            return 1;
+        }
+    }
+    std::ofstream output_file;
+    if (options.output != "-") {
+        output_file.open(options.output, std::ios::binary);
+        if (!output_file) {
+            std::cerr << fmt::format("BŁĄD: Nie udało się utworzyć {}\n", options.output);
+            return 1;
+        }
+    }
+    std::istream& in = options.input != "-" ? static_cast<std::istream&>(input_file) : std::cin;
+    std::ostream& out = options.output != "-" ? static_cast<std::ostream&>(output_file) : std::cout;
+    std::ios::sync_with_stdio(false);
+
+    // Domyślnie jeden wątek na dozwolony CPU (cpuset cgroup), przypięty
+    std::vector<unsigned> cpus = options.affinity;
+    if (cpus.empty()) {
+        cpus = read_cgroup_limits().cpuset;
+    }
+    unsigned threads = options.threads ? options.threads
+                                       : !cpus.empty() ? static_cast<unsigned>(cpus.size())
+                                                       : std::max(1u, std::thread::hardware_concurrency());
+
+    RandomXManager manager(options.mode, *options.algorithm);
+    DatasetInitConfig init;
+    init.threads = threads;
+    init.cpus = cpus;
+    init.worker_help = false;
+    manager.set_init_config(init);
+    HashPool pool(threads, cpus);
+
+    std::cerr << fmt::format("[Hash] {} wątków, tryb {}, partie po {} rekordów.\n",
+                             threads, randomx_mode_name(options.mode), options.batch);
+
+    BatchStats stats;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Record> records;
+    std::vector<Group> groups;
+    std::map<std::pair<const RandomXAlgorithm*, std::string>, size_t> group_index;
+    std::vector<HashBytes> hashes;
+    std::string line;
+    std::string output;
+    uint64_t line_no = 0;
+    bool eof = false;
+    while (!eof) {
+        records.clear();
+        groups.clear();
+        group_index.clear();
+        while (records.size() < options.batch) {
+            if (!std::getline(in, line)) {
+                eof = true;
+                break;
+            }
+            ++line_no;
+            Record record;
+            std::string seed;
+            const RandomXAlgorithm* algorithm = nullptr;
+            if (!parse_record(line, line_no, options, record, seed, algorithm)) {
+                continue;
+            }
+            auto [it, inserted] = group_index.try_emplace({algorithm, seed}, groups.size());
+            if (inserted) {
+                groups.push_back({algorithm, seed, {}});
+            }
+            groups[it->second].records.push_back(records.size());
+            records.push_back(std::move(record));
+        }
+        if (records.empty()) {
+            continue;
+        }
+
+        hashes.resize(records.size());
+        hash_batch(manager, pool, records, groups, hashes, stats);
+
+        output.clear();
+        for (size_t i = 0; i < records.size(); ++i) {
+            if (options.echo) {
+                output += records[i].line;
+                output += ' ';
+            }
+            output += bytes_to_hex(hashes[i].data(), hashes[i].size());
+            output += '\n';
+        }
+        out.write(output.data(), static_cast<std::streamsize>(output.size()));
+        if (!out) {
+            std::cerr << "BŁĄD: Nie udało się zapisać wyników.\n";
+            return 1;
+        }
+    }
+    out.flush();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << fmt::format("[Hash] {} rekordów, {} grup seed, {} budów datasetu ({:.2f} s) w {:.2f} s: "
+                             "{:.1f} H/s całościowo, {:.1f} H/s haszowania.\n",
+                             stats.records, stats.groups, stats.builds, stats.build_seconds, seconds,
+                             seconds > 0 ? stats.records / seconds : 0.0,
+                             stats.hash_seconds > 0 ? stats.records / stats.hash_seconds : 0.0);
+    return 0;
+}
+
+} // namespace
+
+int run_batch_hash(const std::vector<std::string>& args) {
+    BatchOptions options;
+    try {
+        options = parse_options(args);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << fmt::format("BŁĄD: {}\n", e.what());
+        return 1;
+    }
+
+    // stdout należy do wyników - logi tylko od ostrzeżeń (stderr)
+    LoggerConfig log_config;
+    log_config.min_level = LogLevel::Warn;
+    g_logger.start(log_config);
+
+    int code = 1;
+    try {
+        code = run(options);
+    } catch (const std::exception& e) {
+        std::cerr << fmt::format("BŁĄD: {}\n", e.what());
+    }
+    g_logger.stop();
+    return code;
+}
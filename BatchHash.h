@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Haszowanie wsadowe rekordów: `pjurominer hash [opcje]`.
+ *
+ * Czyta rekordy "SEED BLOB NONCE [ALGO]" (hex, hex, liczba dziesiętna lub
+ * 0x..., "-" = nonce już w blobie; linie puste i od '#' są pomijane) z pliku
+ * lub stdin i wypisuje po jednym hashu hex na rekord, w kolejności wejścia.
+ * Rekordy są czytane partiami i grupowane po (seed, wariant); dataset
+ * RandomXManager jest budowany raz na grupę, a grupa liczona równolegle przez
+ * przypięte wątki z własnymi VM (utrzymywanymi między partiami).
+ * Opcje: --input PLIK, --output PLIK ("-" = stdin/stdout), --threads N,
+ * --affinity LISTA, --mode fast|light, --algo WARIANT (domyślny dla rekordów
+ * bez ALGO), --batch N (rekordów na partię), --echo (rekord przed hashem).
+ * Podsumowanie (rekordy, seedy, H/s) trafia na stderr.
+ * @param args Argumenty po "hash".
+ * @return Kod wyjścia procesu.
+ */
+int run_batch_hash(const std::vector<std::string>& args);
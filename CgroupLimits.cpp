@@ -0,0 +1,321 @@
+#include "CgroupLimits.h"
+#include "SystemUtils.h"
+#include "ThreadAffinity.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <fmt/core.h>
+
+namespace {
+
+// Zapotrzebowanie pamięci RandomX (wartości z konfiguracji referencyjnej)
+constexpr uint64_t RANDOMX_DATASET_BYTES = 2181038016ULL;   // ~2080 MiB
+constexpr uint64_t RANDOMX_CACHE_BYTES = 256ULL << 20;
+constexpr uint64_t RANDOMX_SCRATCHPAD_BYTES = 2ULL << 20;   // Na każdą VM
+constexpr uint64_t PROCESS_HEADROOM_BYTES = 128ULL << 20;   // Sterta, stosy, bufory sieci
+constexpr uint64_t FAST_UPGRADE_MARGIN_BYTES = 256ULL << 20; // Histereza light -> fast
+constexpr double LIGHT_RELATIVE_RATE = 0.125;               // Hashrate wątku light względem fast
+
+// cgroup v1 zapisuje "brak limitu" jako ogromną liczbę (LONG_MAX wyrównane do strony)
+constexpr uint64_t CGROUP_V1_UNLIMITED = 1ULL << 62;
+
+struct CgroupMount {
+    std::string root;        // Korzeń hierarchii widoczny w tym punkcie montowania
+    std::string mount_point;
+};
+
+std::vector<std::string> split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::stringstream ss(text);
+    std::string part;
+    while (std::getline(ss, part, separator)) {
+        parts.push_back(part);
+    }
+    return parts;
+}
+
+/**
+ * @brief Katalog cgroup procesu pod danym punktem montowania.
+ * W kontenerze z własną przestrzenią nazw cgroup ścieżka z /proc/self/cgroup
+ * może nie zaczynać się od korzenia montowania lub nie istnieć w widocznym
+ * drzewie - wtedy używamy samego punktu montowania.
+ */
+std::string cgroup_dir(const std::string& root, const CgroupMount& mount, const std::string& path) {
+    std::string relative;
+    if (mount.root == "/") {
+        relative = path;
+    } else if (path.starts_with(mount.root)) {
+        relative = path.substr(mount.root.size());
+    }
+    if (relative == "/") {
+        relative.clear();
+    }
+    std::string dir = root + mount.mount_point + relative;
+    std::error_code ec;
+    if (!relative.empty() && !std::filesystem::is_directory(dir, ec)) {
+        return root + mount.mount_point;
+    }
+    return dir;
+}
+
+void read_v1(const std::string& root,
+             const std::map<std::string, CgroupMount>& mounts,
+             const std::map<std::string, std::string>& paths,
+             CgroupLimits& limits) {
+    auto dir_for = [&](const std::string& controller) -> std::optional<std::string> {
+        auto m = mounts.find(controller);
+        auto p = paths.find(controller);
+        if (m == mounts.end() || p == paths.end()) {
+            return std::nullopt;
+        }
+        return cgroup_dir(root, m->second, p->second);
+    };
+
+    if (auto dir = dir_for("cpu")) {
+        auto quota = read_first_line(*dir + "/cpu.cfs_quota_us");
+        auto period = read_u64(*dir + "/cpu.cfs_period_us");
+        if (quota && period && *period > 0 && *quota != "-1") {
+            if (auto q = parse_u64(*quota)) {
+                limits.cpu_quota = static_cast<double>(*q) / static_cast<double>(*period);
+            }
+        }
+    }
+
+    if (auto dir = dir_for("cpuset")) {
+        if (auto cpus = read_first_line(*dir + "/cpuset.effective_cpus")) {
+            limits.cpuset = parse_kernel_cpu_list(*cpus);
+        } else if (auto cpus_fallback = read_first_line(*dir + "/cpuset.cpus")) {
+            limits.cpuset = parse_kernel_cpu_list(*cpus_fallback);
+        }
+    }
+
+    if (auto dir = dir_for("memory")) {
+        auto limit = read_u64(*dir + "/memory.limit_in_bytes");
+        if (limit && *limit < CGROUP_V1_UNLIMITED) {
+            limits.memory_limit = *limit;
+        }
+    }
+}
+
+void read_v2(const std::string& root, const CgroupMount& mount, const std::string& path, CgroupLimits& limits) {
+    std::string leaf = cgroup_dir(root, mount, path);
+    std::string top = root + mount.mount_point;
+
+    if (auto cpus = read_first_line(leaf + "/cpuset.cpus.effective")) {
+        limits.cpuset = parse_kernel_cpu_list(*cpus);
+    }
+
+    // Limity dziedziczone: obowiązuje najciaśniejszy na ścieżce do korzenia
+    for (std::string dir = leaf; dir.size() >= top.size(); ) {
+        if (auto cpu_max = read_first_line(dir + "/cpu.max")) {
+            auto fields = split(*cpu_max, ' ');
+            if (fields.size() == 2 && fields[0] != "max") {
+                auto quota = parse_u64(fields[0]);
+                auto period = parse_u64(fields[1]);
+                if (quota && period && *period > 0) {
+                    double cpus = static_cast<double>(*quota) / static_cast<double>(*period);
+                    limits.cpu_quota = limits.cpu_quota ? std::min(*limits.cpu_quota, cpus) : cpus;
+                }
+            }
+        }
+        if (auto memory_max = read_first_line(dir + "/memory.max"); memory_max && *memory_max != "max") {
+            if (auto bytes = parse_u64(*memory_max)) {
+                limits.memory_limit = limits.memory_limit ? std::min(*limits.memory_limit, *bytes) : *bytes;
+            }
+        }
+
+        if (dir.size() == top.size()) {
+            break;
+        }
+        auto slash = dir.rfind('/');
+        if (slash == std::string::npos || slash < top.size()) {
+            dir = top;
+        } else {
+            dir.resize(slash);
+        }
+    }
+}
+
+} // namespace
+
+unsigned CgroupLimits::usable_cpus(unsigned hardware_threads) const {
+    unsigned cpus = std::max(1u, hardware_threads);
+    if (!cpuset.empty()) {
+        cpus = std::min(cpus, static_cast<unsigned>(cpuset.size()));
+    }
+    if (cpu_quota) {
+        // W dół: wątek ponad limit CFS tylko zwiększa dławienie i przełączenia kontekstu
+        cpus = std::min(cpus, static_cast<unsigned>(std::max(1.0, std::floor(*cpu_quota + 1e-6))));
+    }
+    return cpus;
+}
+
+CgroupLimits read_cgroup_limits(const std::string& root) {
+    CgroupLimits limits;
+
+    // Przynależność: "hierarchia:kontrolery:ścieżka"; v2 to "0::/ścieżka"
+    std::map<std::string, std::string> v1_paths;
+    std::optional<std::string> v2_path;
+    {
+        std::ifstream in(root + "/proc/self/cgroup");
+        std::string line;
+        while (std::getline(in, line)) {
+            auto first = line.find(':');
+            auto second = line.find(':', first + 1);
+            if (first == std::string::npos || second == std::string::npos) {
+                continue;
+            }
+            std::string controllers = line.substr(first + 1, second - first - 1);
+            std::string path = line.substr(second + 1);
+            if (line.substr(0, first) == "0" && controllers.empty()) {
+                v2_path = path;
+                continue;
+            }
+            for (const auto& controller : split(controllers, ',')) {
+                v1_paths[controller] = path;
+            }
+        }
+    }
+
+    // Punkty montowania: "... root mount_point ... - fstype source opcje"
+    std::map<std::string, CgroupMount> v1_mounts;
+    std::optional<CgroupMount> v2_mount;
+    {
+        std::ifstream in(root + "/proc/self/mountinfo");
+        std::string line;
+        while (std::getline(in, line)) {
+            auto separator = line.find(" - ");
+            if (separator == std::string::npos) {
+                continue;
+            }
+            auto before = split(line.substr(0, separator), ' ');
+            auto after = split(line.substr(separator + 3), ' ');
+            if (before.size() < 5 || after.size() < 3) {
+                continue;
+            }
+            CgroupMount mount{before[3], before[4]};
+            if (after[0] == "cgroup2") {
+                v2_mount = mount;
+            } else if (after[0] == "cgroup") {
+                for (const auto& option : split(after[2], ',')) {
+                    if (option == "cpu" || option == "cpuset" || option == "memory") {
+                        v1_mounts[option] = mount;
+                    }
+                }
+            }
+        }
+    }
+
+    // Hybryda (v1 + v2 bez kontrolerów): limity trzymają kontrolery v1
+    if (!v1_mounts.empty()) {
+        limits.version = 1;
+        read_v1(root, v1_mounts, v1_paths, limits);
+    } else if (v2_mount && v2_path) {
+        limits.version = 2;
+        read_v2(root, *v2_mount, *v2_path, limits);
+    }
+    return limits;
+}
+
+WorkerPlan plan_workers(const CgroupLimits& limits,
+                        unsigned hardware_threads,
+                        unsigned requested_threads,
+                        std::optional<RandomXMode> requested_mode,
+                        const MemoryBudget& memory) {
+    WorkerPlan plan;
+
+    unsigned usable = limits.usable_cpus(hardware_threads);
+    if (requested_threads > 0) {
+        plan.threads = requested_threads;
+        plan.reason = fmt::format("{} wątków z konfiguracji", requested_threads);
+    } else {
+        plan.threads = usable;
+        plan.reason = fmt::format("{} wątków (CPU: {}", usable, std::max(1u, hardware_threads));
+        if (!limits.cpuset.empty()) {
+            plan.reason += fmt::format(", cpuset: {}", limits.cpuset.size());
+        }
+        if (limits.cpu_quota) {
+            plan.reason += fmt::format(", quota: {:.2f}", *limits.cpu_quota);
+        }
+        plan.reason += ")";
+    }
+
+    // Budżet: limit cgroup i pamięć hosta, którą możemy jeszcze zająć
+    std::optional<uint64_t> budget = limits.memory_limit;
+    std::string budget_source = budget ? fmt::format("limit cgroup {} MiB", *budget >> 20) : std::string();
+    if (memory.available_bytes) {
+        uint64_t hugepages = memory.hugepages_free_bytes.value_or(0);
+        uint64_t host = *memory.available_bytes + hugepages + memory.resident_bytes;
+        if (!budget || host < *budget) {
+            budget = host;
+            budget_source = fmt::format("dostępne {} MiB", *memory.available_bytes >> 20);
+            if (hugepages) {
+                budget_source += fmt::format(" + huge pages {} MiB", hugepages >> 20);
+            }
+            if (memory.resident_bytes) {
+                budget_source += fmt::format(" + RandomX {} MiB", memory.resident_bytes >> 20);
+            }
+        }
+    }
+
+    auto fast_bytes = [](uint64_t threads) {
+        return RANDOMX_DATASET_BYTES + RANDOMX_CACHE_BYTES + threads * RANDOMX_SCRATCHPAD_BYTES + PROCESS_HEADROOM_BYTES;
+    };
+    auto light_bytes = [](uint64_t threads) {
+        return RANDOMX_CACHE_BYTES + threads * RANDOMX_SCRATCHPAD_BYTES + PROCESS_HEADROOM_BYTES;
+    };
+    // Ile wątków mieści budżet po odjęciu części wspólnej
+    auto threads_within = [&](uint64_t shared_bytes) -> unsigned {
+        if (*budget < shared_bytes + RANDOMX_SCRATCHPAD_BYTES) {
+            return 0;
+        }
+        return static_cast<unsigned>(std::min<uint64_t>(plan.threads, (*budget - shared_bytes) / RANDOMX_SCRATCHPAD_BYTES));
+    };
+
+    if (requested_mode) {
+        plan.mode = *requested_mode;
+        plan.reason += fmt::format(", tryb {} z konfiguracji", randomx_mode_name(plan.mode));
+        if (budget && *budget < (plan.mode == RandomXMode::Fast ? fast_bytes(plan.threads) : light_bytes(plan.threads))) {
+            plan.reason += fmt::format(" (uwaga: {} - za mało pamięci)", budget_source);
+        }
+        return plan;
+    }
+    if (!budget) {
+        plan.mode = RandomXMode::Fast;
+        plan.reason += ", tryb fast";
+        return plan;
+    }
+
+    uint64_t required = fast_bytes(plan.threads);
+    if (memory.current_mode == RandomXMode::Light) {
+        required += FAST_UPGRADE_MARGIN_BYTES;
+    }
+    if (*budget >= required) {
+        plan.mode = RandomXMode::Fast;
+        plan.reason += fmt::format(", tryb fast ({} >= {} MiB)", budget_source, fast_bytes(plan.threads) >> 20);
+        return plan;
+    }
+
+    // Fast na części wątków kontra light na wszystkich: wybieramy wyższy szacowany hashrate
+    unsigned fast_threads = threads_within(RANDOMX_DATASET_BYTES + RANDOMX_CACHE_BYTES + PROCESS_HEADROOM_BYTES +
+                                           (memory.current_mode == RandomXMode::Light ? FAST_UPGRADE_MARGIN_BYTES : 0));
+    unsigned light_threads = std::max(1u, threads_within(RANDOMX_CACHE_BYTES + PROCESS_HEADROOM_BYTES));
+    if (fast_threads > 0 && fast_threads >= light_threads * LIGHT_RELATIVE_RATE) {
+        plan.reason += fmt::format(", tryb fast na {} z {} wątków ({} < {} MiB dla wszystkich)", fast_threads,
+                                   plan.threads, budget_source, fast_bytes(plan.threads) >> 20);
+        plan.mode = RandomXMode::Fast;
+        plan.threads = fast_threads;
+    } else {
+        plan.reason += fmt::format(", tryb light ({} < {} MiB dla fast", budget_source, fast_bytes(1) >> 20);
+        if (light_threads < plan.threads) {
+            plan.reason += fmt::format(", {} z {} wątków", light_threads, plan.threads);
+        }
+        plan.reason += ")";
+        plan.mode = RandomXMode::Light;
+        plan.threads = light_threads;
+    }
+    return plan;
+}
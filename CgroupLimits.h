@@ -0,0 +1,80 @@
+#pragma once
+
+#include "MiningCommon.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @struct CgroupLimits
+ * @brief Limity zasobów procesu odczytane z cgroup v1 lub v2.
+ * Brak limitu = std::nullopt (lub pusta lista CPU).
+ */
+struct CgroupLimits {
+    int version = 0;                        // 0 = brak cgroup (np. Windows), 1 lub 2
+    std::optional<double> cpu_quota;        // Liczba CPU z quota / period (np. 2.5)
+    std::vector<unsigned> cpuset;           // Dozwolone CPU
+    std::optional<uint64_t> memory_limit;   // Bajty
+
+    /**
+     * @brief Liczba CPU, z których proces może realnie korzystać.
+     * @param hardware_threads Wynik std::thread::hardware_concurrency().
+     */
+    unsigned usable_cpus(unsigned hardware_threads) const;
+
+    bool operator==(const CgroupLimits&) const = default;
+};
+
+/**
+ * @brief Odczytuje limity cgroup bieżącego procesu.
+ * @param root Katalog traktowany jako "/" (np. sztuczne drzewo w testach);
+ * pusty = prawdziwy system plików. Czyta <root>/proc/self/cgroup,
+ * <root>/proc/self/mountinfo i pliki kontrolerów pod punktami montowania.
+ */
+CgroupLimits read_cgroup_limits(const std::string& root = "");
+
+/**
+ * @struct MemoryBudget
+ * @brief Pamięć hosta dostępna dla RandomX (poza limitem cgroup).
+ * Brak odczytu = std::nullopt (planowanie tylko wg cgroup).
+ */
+struct MemoryBudget {
+    std::optional<uint64_t> available_bytes;      // MemAvailable (bez zarezerwowanych huge pages)
+    std::optional<uint64_t> hugepages_free_bytes; // Wolne strony z puli huge pages (dataset może z nich skorzystać)
+    uint64_t resident_bytes = 0;                  // Cache i dataset, które już trzymamy (nie ma ich w polach wyżej)
+    std::optional<RandomXMode> current_mode;      // Tryb działającego minera (histereza powrotu do fast)
+};
+
+/**
+ * @struct WorkerPlan
+ * @brief Liczba wątków i tryb RandomX dopasowane do limitów.
+ */
+struct WorkerPlan {
+    unsigned threads = 1;
+    RandomXMode mode = RandomXMode::Fast;
+    std::string reason; // Opis do logów (skąd taka decyzja)
+};
+
+/**
+ * @brief Dobiera liczbę wątków i tryb do limitów CPU i pamięci.
+ *
+ * Budżet pamięci to mniejsza z wartości: limit cgroup i pamięć hosta
+ * (MemAvailable + wolne huge pages + to, co już zajmuje RandomX). W trybie
+ * auto planista wybiera najszybszy wariant, który się mieści: fast na
+ * wszystkich wątkach, fast na mniejszej liczbie wątków (mniej scratchpadów)
+ * albo light, w którym wszystkie wątki dzielą cache 256 MB - porównując
+ * szacowany hashrate (wątek light to ok. 1/8 wątku fast). Powrót z light do
+ * fast wymaga zapasu ponad próg, żeby plan nie przełączał się co odczyt.
+ *
+ * @param limits Limity cgroup.
+ * @param hardware_threads Liczba CPU widziana przez system.
+ * @param requested_threads Liczba wątków z konfiguracji (0 = auto).
+ * @param requested_mode Tryb z konfiguracji (std::nullopt = auto).
+ * @param memory Pamięć hosta (domyślnie nieznana).
+ */
+WorkerPlan plan_workers(const CgroupLimits& limits,
+                        unsigned hardware_threads,
+                        unsigned requested_threads,
+                        std::optional<RandomXMode> requested_mode,
+                        const MemoryBudget& memory = {});
@@ -0,0 +1,272 @@
+#include "ControlServer.h"
+#include "Logger.h"
+#include <algorithm>
+#include <charconv>
+#include <sstream>
+#include <stdexcept>
+#include <fmt/core.h>
+
+using asio::ip::tcp;
+using json = nlohmann::json;
+
+namespace {
+
+// Limity żądania sterującego (nagłówki + ciało JSON)
+constexpr std::size_t MAX_REQUEST_SIZE = 16384;
+constexpr std::size_t MAX_BODY_SIZE = 8192;
+constexpr auto REQUEST_TIMEOUT = std::chrono::seconds(5);
+
+// Jedyny endpoint tylko do odczytu (GET); pozostałe zmieniają stan (POST)
+constexpr const char* STATUS_ENDPOINT = "/status";
+constexpr const char* ENDPOINTS[] = {"/status", "/pause", "/resume", "/threads", "/affinity", "/pool", "/reload", "/limit"};
+
+std::string http_response(int status, const char* reason, const json& body) {
+    std::string payload = body.dump() + "\n";
+    std::string response = fmt::format("HTTP/1.1 {} {}\r\n", status, reason);
+    response += "Content-Type: application/json\r\n";
+    response += fmt::format("Content-Length: {}\r\n", payload.size());
+    response += "Connection: close\r\n\r\n";
+    response += payload;
+    return response;
+}
+
+std::string error_response(int status, const char* reason, const std::string& message) {
+    return http_response(status, reason, {{"ok", false}, {"error", message}});
+}
+
+/**
+ * @brief Zwraca wartość nagłówka Content-Length (0, jeśli brak).
+ */
+std::size_t content_length(std::istream& headers) {
+    std::string line;
+    while (std::getline(headers, line) && line != "\r" && !line.empty()) {
+        auto colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        std::string name = line.substr(0, colon);
+        for (auto& c : name) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        if (name != "content-length") {
+            continue;
+        }
+        auto first = line.find_first_not_of(' ', colon + 1);
+        std::size_t value = 0;
+        if (first != std::string::npos) {
+            std::from_chars(line.data() + first, line.data() + line.size(), value);
+        }
+        return value;
+    }
+    return 0;
+}
+
+} // namespace
+
+ControlServer::ControlServer(asio::io_context& io_context,
+                             const std::string& bind_address,
+                             uint16_t port,
+                             ControlHandlers handlers)
+        : m_io_context(io_context),
+          m_acceptor(io_context),
+          m_bind_address(bind_address),
+          m_port(port),
+          m_handlers(std::move(handlers)),
+          m_request_timeout(REQUEST_TIMEOUT) {}
+
+void ControlServer::start() {
+    tcp::endpoint endpoint(asio::ip::make_address(m_bind_address), m_port);
+    m_acceptor.open(endpoint.protocol());
+    m_acceptor.set_option(tcp::acceptor::reuse_address(true));
+    m_acceptor.bind(endpoint);
+    m_acceptor.listen();
+
+    LOG_INFO(LogCategory::Control, "[Control] Nasłuchuję na http://{}:{}/status", m_bind_address, port());
+
+    do_accept();
+}
+
+void ControlServer::stop() {
+    asio::error_code ignored;
+    m_acceptor.close(ignored);
+}
+
+uint16_t ControlServer::port() const {
+    asio::error_code ec;
+    auto endpoint = m_acceptor.local_endpoint(ec);
+    return ec ? m_port : endpoint.port();
+}
+
+void ControlServer::do_accept() {
+    auto self = shared_from_this();
+    auto socket = std::make_shared<tcp::socket>(m_io_context);
+    m_acceptor.async_accept(*socket, [this, self, socket](const asio::error_code& ec) {
+        if (ec) {
+            if (ec != asio::error::operation_aborted) {
+                LOG_WARN(LogCategory::Control, "[Control] Błąd akceptacji połączenia: {}", ec.message());
+            }
+            if (!m_acceptor.is_open()) {
+                return;
+            }
+        } else {
+            handle_connection(socket);
+        }
+        do_accept();
+    });
+}
+
+void ControlServer::handle_connection(std::shared_ptr<tcp::socket> socket) {
+    auto self = shared_from_this();
+    auto buffer = std::make_shared<asio::streambuf>(MAX_REQUEST_SIZE);
+    auto deadline = std::make_shared<asio::steady_timer>(m_io_context, m_request_timeout);
+    deadline->async_wait([socket](const asio::error_code& ec) {
+        if (!ec) {
+            // Zamknięcie przerywa oczekujący odczyt lub zapis (kończą się błędem)
+            asio::error_code ignored;
+            socket->close(ignored);
+        }
+    });
+
+    asio::async_read_until(*socket, *buffer, "\r\n\r\n",
+                           [this, self, socket, buffer, deadline](const asio::error_code& ec, std::size_t header_length) {
+        if (ec) {
+            // Klient rozłączył się, przysłał za duże żądanie albo minął czas
+            deadline->cancel();
+            asio::error_code ignored;
+            socket->close(ignored);
+            return;
+        }
+
+        // Nagłówki zdejmujemy z bufora; reszta to początek ciała
+        std::string headers(asio::buffers_begin(buffer->data()),
+                            asio::buffers_begin(buffer->data()) + static_cast<std::ptrdiff_t>(header_length));
+        buffer->consume(header_length);
+
+        std::istringstream is(headers);
+        std::string request_line;
+        std::getline(is, request_line);
+        if (!request_line.empty() && request_line.back() == '\r') {
+            request_line.pop_back();
+        }
+
+        auto first_space = request_line.find(' ');
+        auto second_space = request_line.find(' ', first_space + 1);
+        if (first_space == std::string::npos || second_space == std::string::npos) {
+            send_response(socket, deadline, error_response(400, "Bad Request", "bad request"));
+            return;
+        }
+        std::string method = request_line.substr(0, first_space);
+        std::string target = request_line.substr(first_space + 1, second_space - first_space - 1);
+
+        std::size_t body_length = content_length(is);
+        if (body_length > MAX_BODY_SIZE) {
+            send_response(socket, deadline, error_response(413, "Payload Too Large", "body too large"));
+            return;
+        }
+
+        std::size_t missing = body_length > buffer->size() ? body_length - buffer->size() : 0;
+
+        auto finish = [this, self, socket, buffer, deadline, method, target, body_length]() {
+            std::string body(body_length, '\0');
+            buffer->sgetn(body.data(), static_cast<std::streamsize>(body_length));
+            send_response(socket, deadline, build_response(method, target, body));
+        };
+
+        if (missing == 0) {
+            finish();
+            return;
+        }
+        asio::async_read(*socket, *buffer, asio::transfer_exactly(missing),
+                         [socket, deadline, finish](const asio::error_code& ec, std::size_t /*length*/) {
+                             if (ec) {
+                                 deadline->cancel();
+                                 asio::error_code ignored;
+                                 socket->close(ignored);
+                                 return;
+                             }
+                             finish();
+                         });
+    });
+}
+
+void ControlServer::send_response(std::shared_ptr<tcp::socket> socket, std::shared_ptr<asio::steady_timer> deadline,
+                                  std::string response) {
+    auto payload = std::make_shared<std::string>(std::move(response));
+    asio::async_write(*socket, asio::buffer(*payload),
+                      [socket, payload, deadline](const asio::error_code& /*ec*/, std::size_t /*length*/) {
+                          deadline->cancel();
+                          asio::error_code ignored;
+                          socket->shutdown(tcp::socket::shutdown_both, ignored);
+                          socket->close(ignored);
+                      });
+}
+
+std::string ControlServer::build_response(const std::string& method, const std::string& target, const std::string& body) {
+    if (std::find(std::begin(ENDPOINTS), std::end(ENDPOINTS), target) == std::end(ENDPOINTS)) {
+        return error_response(404, "Not Found", "unknown endpoint");
+    }
+    if (method != (target == STATUS_ENDPOINT ? "GET" : "POST")) {
+        return error_response(405, "Method Not Allowed", target == STATUS_ENDPOINT ? "use GET" : "use POST");
+    }
+
+    json request = json::object();
+    if (!body.empty()) {
+        request = json::parse(body, nullptr, false);
+        if (request.is_discarded() || !request.is_object()) {
+            return error_response(400, "Bad Request", "body must be a JSON object");
+        }
+    }
+
+    try {
+        return http_response(200, "OK", dispatch(method, target, request));
+    } catch (const std::invalid_argument& e) {
+        return error_response(400, "Bad Request", e.what());
+    } catch (const json::exception& e) {
+        return error_response(400, "Bad Request", e.what());
+    } catch (const std::exception& e) {
+        LOG_ERROR(LogCategory::Control, "[Control] Błąd operacji {} {}: {}", method, target, e.what());
+        return error_response(500, "Internal Server Error", e.what());
+    }
+}
+
+json ControlServer::dispatch(const std::string& method, const std::string& target, const json& body) {
+    if (target == STATUS_ENDPOINT) {
+        return m_handlers.status();
+    }
+
+    if (target == "/pause") {
+        m_handlers.pause();
+    } else if (target == "/resume") {
+        m_handlers.resume();
+    } else if (target == "/threads") {
+        unsigned count = body.at("count").get<unsigned>();
+        if (count == 0 || count > 4096) {
+            throw std::invalid_argument("count must be in 1..4096");
+        }
+        m_handlers.set_threads(count);
+    } else if (target == "/affinity") {
+        m_handlers.set_affinity(body.at("cpus").get<std::vector<unsigned>>());
+    } else if (target == "/pool") {
+        std::string pool = body.at("pool").get<std::string>();
+        auto colon = pool.rfind(':');
+        if (colon == std::string::npos || colon == 0 || colon + 1 == pool.size()) {
+            throw std::invalid_argument("pool must be HOST:PORT");
+        }
+        std::optional<std::string> user;
+        if (body.contains("user")) {
+            user = body["user"].get<std::string>();
+        }
+        m_handlers.switch_pool(pool.substr(0, colon), pool.substr(colon + 1), user);
+    } else if (target == "/limit") {
+        // Liczba = H/s; tekst jak w --limit ("50%", "2.5cores", "120W", "none")
+        const json& limit = body.at("limit");
+        m_handlers.set_limit(limit.is_number() ? limit.dump() : limit.get<std::string>());
+    } else if (target == "/reload") {
+        m_handlers.reload_config(body.value("path", std::string()));
+    }
+
+    LOG_INFO(LogCategory::Control, "[Control] Wykonano {} {}", method, target);
+    json status = m_handlers.status();
+    status["ok"] = true;
+    return status;
+}
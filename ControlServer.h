@@ -0,0 +1,97 @@
+#pragma once
+
+#include <asio.hpp>
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @struct ControlHandlers
+ * @brief Operacje udostępniane przez interfejs sterowania.
+ * Wywoływane w wątku io_context; błędne argumenty zgłaszają std::invalid_argument.
+ */
+struct ControlHandlers {
+    std::function<nlohmann::json()> status;
+    std::function<void()> pause;
+    std::function<void()> resume;
+    std::function<void(unsigned)> set_threads;
+    std::function<void(std::vector<unsigned>)> set_affinity;
+    // host, port, portfel (std::nullopt = bez zmian)
+    std::function<void(const std::string&, const std::string&, const std::optional<std::string>&)> switch_pool;
+    // Ścieżka pliku (pusta = plik podany przy starcie przez --config)
+    std::function<void(const std::string&)> reload_config;
+    // Limit w formacie --limit, np. "500H/s", "50%", "none"
+    std::function<void(const std::string&)> set_limit;
+};
+
+/**
+ * @class ControlServer
+ * @brief Lokalny interfejs sterowania HTTP/JSON na istniejącym io_context.
+ *
+ * GET  /status                 - stan minera
+ * POST /pause, /resume         - wstrzymanie i wznowienie haszowania
+ * POST /threads  {"count": N}  - zmiana liczby wątków roboczych
+ * POST /affinity {"cpus": [..]}- przypięcie wątków (pusta lista zdejmuje)
+ * POST /pool     {"pool": "host:port", "user": "..."} - zmiana puli
+ * POST /reload   {"path": "..."} - ponowne wczytanie pliku konfiguracyjnego
+ * POST /limit    {"limit": "500H/s" | "50%" | "2cores" | "none"} - limit hashrate lub CPU
+ *
+ * Dataset i VM pozostają nietknięte, dopóki nie zmieni się seed.
+ * Każde połączenie obsługuje jedno żądanie i jest zamykane po odpowiedzi
+ * albo po czasie na żądanie (klient, który nic nie wysyła, nie trzyma gniazda).
+ */
+class ControlServer : public std::enable_shared_from_this<ControlServer> {
+public:
+    /**
+     * @brief Konstruktor.
+     * @param io_context Główna pętla zdarzeń Asio.
+     * @param bind_address Adres nasłuchu (domyślnie tylko lokalny).
+     * @param port Port TCP.
+     * @param handlers Operacje minera.
+     */
+    ControlServer(asio::io_context& io_context,
+                  const std::string& bind_address,
+                  uint16_t port,
+                  ControlHandlers handlers);
+
+    /**
+     * @brief Otwiera gniazdo i zaczyna przyjmować połączenia.
+     * @throws std::system_error jeśli nie można powiązać portu.
+     */
+    void start();
+
+    /**
+     * @brief Zamyka gniazdo nasłuchujące.
+     */
+    void stop();
+
+    /**
+     * @brief Czas na przesłanie żądania i odebranie odpowiedzi (od przyjęcia połączenia).
+     */
+    void set_request_timeout(std::chrono::milliseconds timeout) { m_request_timeout = timeout; }
+
+    /**
+     * @brief Port, na którym nasłuchuje serwer (po start(); przydatne przy porcie 0).
+     */
+    uint16_t port() const;
+
+private:
+    void do_accept();
+    void handle_connection(std::shared_ptr<asio::ip::tcp::socket> socket);
+    void send_response(std::shared_ptr<asio::ip::tcp::socket> socket, std::shared_ptr<asio::steady_timer> deadline,
+                       std::string response);
+    std::string build_response(const std::string& method, const std::string& target, const std::string& body);
+    nlohmann::json dispatch(const std::string& method, const std::string& target, const nlohmann::json& body);
+
+    asio::io_context& m_io_context;
+    asio::ip::tcp::acceptor m_acceptor;
+    std::string m_bind_address;
+    uint16_t m_port;
+    ControlHandlers m_handlers;
+    std::chrono::milliseconds m_request_timeout;
+};
@@ -0,0 +1,143 @@
+#include "CotenantMonitor.h"
+#include "Logger.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+std::optional<PressureSample> read_pressure(const std::string& path) {
+    // Format: "some avg10=1.23 avg60=0.50 avg300=0.10 total=123456"
+    std::ifstream in(path);
+    std::string line;
+    while (in && std::getline(in, line)) {
+        if (!line.starts_with("some ")) {
+            continue;
+        }
+        PressureSample sample;
+        std::istringstream fields(line.substr(5));
+        std::string field;
+        while (fields >> field) {
+            auto eq = field.find('=');
+            if (eq == std::string::npos) {
+                continue;
+            }
+            std::string key = field.substr(0, eq);
+            std::string value = field.substr(eq + 1);
+            try {
+                if (key == "avg10") {
+                    sample.some_avg10 = std::stod(value);
+                } else if (key == "total") {
+                    sample.some_total_us = std::stoull(value);
+                }
+            } catch (const std::exception&) {
+                return std::nullopt;
+            }
+        }
+        return sample;
+    }
+    return std::nullopt;
+}
+
+std::optional<unsigned> read_procs_running(const std::string& proc_root) {
+    std::ifstream in(proc_root + "/proc/stat");
+    std::string key;
+    while (in >> key) {
+        if (key == "procs_running") {
+            unsigned value = 0;
+            if (in >> value) {
+                return value;
+            }
+            return std::nullopt;
+        }
+        in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    return std::nullopt;
+}
+
+std::optional<unsigned> read_own_runnable(const std::string& proc_root) {
+    std::error_code ec;
+    std::filesystem::directory_iterator it(proc_root + "/proc/self/task", ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    unsigned running = 0;
+    for (const auto& entry : it) {
+        // "pid (comm) S ..." - comm może zawierać spacje i nawiasy, stan jest po ostatnim ')'
+        std::ifstream in(entry.path().string() + "/stat");
+        std::string line;
+        if (!std::getline(in, line)) {
+            continue; // Wątek zakończył się w trakcie odczytu
+        }
+        auto paren = line.rfind(')');
+        if (paren != std::string::npos && paren + 2 < line.size() && line[paren + 2] == 'R') {
+            running++;
+        }
+    }
+    return running;
+}
+
+CotenantMonitor::CotenantMonitor(CotenantConfig config)
+        : m_config(std::move(config)),
+          m_last_update(std::chrono::steady_clock::now()) {}
+
+unsigned CotenantMonitor::update(unsigned total_workers, unsigned usable_cpus, double per_worker_rate) {
+    auto now = std::chrono::steady_clock::now();
+    double dt = std::chrono::duration<double>(now - m_last_update).count();
+    m_last_update = now;
+
+    // Skutki poprzedniej decyzji (obowiązującej przez ostatnie dt sekund)
+    unsigned previous_active = std::min(m_active, total_workers);
+    unsigned previous_parked = total_workers - previous_active;
+    m_stats.cpu_seconds_yielded += previous_parked * dt;
+    m_stats.hashes_forgone_total += previous_parked * per_worker_rate * dt;
+
+    m_stats.cpu = read_pressure(m_config.proc_root + "/proc/pressure/cpu");
+    m_stats.memory = read_pressure(m_config.proc_root + "/proc/pressure/memory");
+
+    // procs_running obejmuje też nasze wątki: aktywne workery, wątek, który właśnie czyta,
+    // oraz budowę datasetu, scrubber czy logger, jeśli akurat pracują. Odejmujemy faktycznie
+    // gotowe wątki procesu; bez /proc/self/task - szacunek (workery + bieżący wątek).
+    // W kontenerze procs_running liczy zadania całego hosta, więc "obce" obejmują też
+    // sąsiednie kontenery, a usable_cpus to tylko limit naszej cgroup - miner ustępuje
+    // wtedy ostrożniej, niż wynikałoby z samego kontenera.
+    unsigned foreign = 0;
+    if (auto running = read_procs_running(m_config.proc_root)) {
+        unsigned own = read_own_runnable(m_config.proc_root).value_or(previous_active + 1);
+        foreign = *running > own ? *running - own : 0;
+    }
+    m_stats.foreign_runnable = foreign;
+
+    bool pressure_high = (m_stats.cpu && m_stats.cpu->some_avg10 > m_config.cpu_pressure_high) ||
+                         (m_stats.memory && m_stats.memory->some_avg10 > m_config.memory_pressure_high);
+    bool pressure_low = (!m_stats.cpu || m_stats.cpu->some_avg10 < m_config.cpu_pressure_low) &&
+                        (!m_stats.memory || m_stats.memory->some_avg10 < m_config.memory_pressure_low);
+
+    // Miejsce na CPU po odjęciu zadań innych procesów
+    unsigned room = usable_cpus > foreign ? usable_cpus - foreign : 0;
+    unsigned active = previous_active;
+    if (active > room) {
+        active = room; // Inne procesy czekają na CPU - ustępujemy od razu
+    } else if (pressure_high && active > 0) {
+        active -= 1;   // Nasycenie widoczne w PSI mimo wolnych CPU (np. pamięć, SMT)
+    } else if (pressure_low && active < std::min(room, total_workers)) {
+        active += 1;   // Wznawiamy ostrożnie, po jednym workerze na okres
+    }
+    active = std::min(active, total_workers);
+
+    if (active < previous_active) {
+        m_stats.park_events += 1;
+        LOG_INFO(LogCategory::Manager, "[Co-tenant] Parkuję workery: aktywne {} -> {} (obce zadania: {}, PSI cpu {:.1f}%, mem {:.1f}%)",
+                 previous_active, active, foreign,
+                 m_stats.cpu ? m_stats.cpu->some_avg10 : 0.0,
+                 m_stats.memory ? m_stats.memory->some_avg10 : 0.0);
+    } else if (active > previous_active) {
+        LOG_DEBUG(LogCategory::Manager, "[Co-tenant] Wznawiam worker: aktywne {} -> {}", previous_active, active);
+    }
+
+    m_active = active;
+    m_stats.active_workers = active;
+    m_stats.parked_workers = total_workers - active;
+    m_stats.hashrate_forgone = m_stats.parked_workers * per_worker_rate;
+    return active;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "ThreadPriority.h"
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+/**
+ * @struct CotenantConfig
+ * @brief Parametry trybu co-tenant (miner ustępuje innym usługom na hoście).
+ */
+struct CotenantConfig {
+    bool enabled = false;
+    ThreadPriority priority{ThreadPriority::Class::Idle, 19};
+
+    // Progi PSI "some avg10" w procentach: powyżej high parkujemy, poniżej low wznawiamy
+    double cpu_pressure_high = 10.0;
+    double cpu_pressure_low = 2.0;
+    double memory_pressure_high = 5.0;
+    double memory_pressure_low = 1.0;
+
+    std::chrono::milliseconds poll_interval{2000};
+    std::string proc_root; // Korzeń dla /proc (pusty = "/"; inny np. w testach)
+};
+
+/**
+ * @struct PressureSample
+ * @brief Odczyt jednego pliku PSI (/proc/pressure/cpu lub memory).
+ */
+struct PressureSample {
+    double some_avg10 = 0.0;     // % czasu, w którym co najmniej jedno zadanie czekało (10 s)
+    uint64_t some_total_us = 0;  // Skumulowany czas oczekiwania
+};
+
+/**
+ * @brief Parsuje plik PSI. std::nullopt, gdy plik nie istnieje (jądro bez PSI).
+ */
+std::optional<PressureSample> read_pressure(const std::string& path);
+
+/**
+ * @brief Liczba zadań gotowych do uruchomienia ("procs_running" z /proc/stat).
+ *
+ * Licznik nie jest objęty przestrzeniami nazw: w kontenerze obejmuje zadania
+ * całego hosta (także innych kontenerów), a nie tylko widoczne procesy.
+ */
+std::optional<unsigned> read_procs_running(const std::string& proc_root);
+
+/**
+ * @brief Liczba wątków tego procesu w stanie R (/proc/self/task/<tid>/stat) - workery,
+ * wątek io_context, budowa datasetu, scrubber, logger itd.
+ */
+std::optional<unsigned> read_own_runnable(const std::string& proc_root);
+
+/**
+ * @class CotenantMonitor
+ * @brief Obserwuje PSI i kolejkę uruchomień, decyduje, ilu workerów parkować.
+ *
+ * Parkowanie jest natychmiastowe (gdy inne procesy potrzebują CPU lub PSI
+ * przekracza próg wysoki), wznawianie - po jednym workerze na okres, tylko
+ * gdy PSI spadło poniżej progu niskiego. Używany w jednym wątku (io_context).
+ */
+class CotenantMonitor {
+public:
+    /**
+     * @struct Stats
+     * @brief Skutki trybu co-tenant dla metryk.
+     */
+    struct Stats {
+        unsigned active_workers = 0;
+        unsigned parked_workers = 0;
+        unsigned foreign_runnable = 0;       // Gotowe zadania innych procesów (w kontenerze - całego hosta)
+        std::optional<PressureSample> cpu;
+        std::optional<PressureSample> memory;
+        double hashrate_forgone = 0.0;       // H/s, które dałyby zaparkowane workery
+        double hashes_forgone_total = 0.0;
+        double cpu_seconds_yielded = 0.0;    // Czas CPU oddany innym procesom
+        uint64_t park_events = 0;            // Ile razy zmniejszono liczbę aktywnych workerów
+    };
+
+    explicit CotenantMonitor(CotenantConfig config);
+
+    /**
+     * @brief Odczytuje PSI i obciążenie, zwraca liczbę workerów, które mogą haszować.
+     * @param total_workers Rozmiar puli.
+     * @param usable_cpus CPU dostępne dla procesu (limity cgroup).
+     * @param per_worker_rate Średni hashrate jednego aktywnego workera (do szacunku straty).
+     */
+    unsigned update(unsigned total_workers, unsigned usable_cpus, double per_worker_rate);
+
+    const Stats& stats() const { return m_stats; }
+    const CotenantConfig& config() const { return m_config; }
+
+private:
+    CotenantConfig m_config;
+    Stats m_stats;
+    unsigned m_active = ~0u; // ~0u = jeszcze nie ustalono (start: wszystkie)
+    std::chrono::steady_clock::time_point m_last_update;
+};
@@ -0,0 +1,192 @@
+#include "DatasetInit.h"
+#include <algorithm>
+#include <optional>
+#include <thread>
+
+namespace {
+
+// 16384 elementów = 1 MiB: kilkadziesiąt ms na fragment, więc przerwanie i postęp są płynne
+constexpr uint64_t CHUNK_ITEMS = 16384;
+
+/**
+ * @brief Kolejność przypinania wątków puli: na przemian z każdego węzła,
+ * aby nawet mała pula korzystała z pasma pamięci wszystkich węzłów.
+ */
+std::vector<unsigned> interleave_cpus(const NumaTopology& topology, const std::vector<unsigned>& allowed) {
+    std::vector<unsigned> order;
+    std::size_t longest = 0;
+    for (const auto& node : topology.nodes) {
+        longest = std::max(longest, node.size());
+    }
+    for (std::size_t i = 0; i < longest; ++i) {
+        for (const auto& node : topology.nodes) {
+            if (i < node.size() &&
+                (allowed.empty() || std::find(allowed.begin(), allowed.end(), node[i]) != allowed.end())) {
+                order.push_back(node[i]);
+            }
+        }
+    }
+    // CPU spoza znanej topologii (np. --affinity bez sysfs) - w podanej kolejności
+    for (unsigned cpu : allowed) {
+        if (std::find(order.begin(), order.end(), cpu) == order.end()) {
+            order.push_back(cpu);
+        }
+    }
+    return order;
+}
+
+} // namespace
+
+DatasetInitSession::DatasetInitSession(const RandomXAlgorithm& algorithm, randomx_dataset* dataset, randomx_cache* cache,
+                                       uint64_t item_count, const NumaTopology& topology, unsigned max_participants,
+                                       DatasetKernel kernel)
+        : m_api(*algorithm.api),
+          m_dataset(dataset),
+          m_cache(cache),
+          m_item_count(item_count),
+          m_max_participants(std::max(1u, max_participants)),
+          m_kernel(kernel == DatasetKernel::Auto ? DatasetKernel::Library : kernel),
+          m_start(std::chrono::steady_clock::now()) {
+    // Wycinki proporcjonalne do liczby CPU węzła, wyrównane do fragmentu
+    uint64_t total_cpus = 0;
+    for (const auto& node : topology.nodes) {
+        total_cpus += std::max<std::size_t>(1, node.size());
+    }
+    uint64_t begin = 0;
+    for (std::size_t n = 0; n < topology.nodes.size(); ++n) {
+        uint64_t share = item_count * std::max<std::size_t>(1, topology.nodes[n].size()) / total_cpus;
+        uint64_t end = n + 1 == topology.nodes.size()
+                       ? item_count
+                       : std::min(item_count, (begin + share + CHUNK_ITEMS - 1) / CHUNK_ITEMS * CHUNK_ITEMS);
+        auto slice = std::make_unique<Slice>();
+        slice->next.store(begin, std::memory_order_relaxed);
+        slice->end = end;
+        m_slices.push_back(std::move(slice));
+        begin = end;
+    }
+}
+
+bool DatasetInitSession::take_chunk(unsigned home_node, uint64_t& start, uint64_t& count) {
+    std::size_t slices = m_slices.size();
+    for (std::size_t i = 0; i < slices; ++i) {
+        Slice& slice = *m_slices[(home_node + i) % slices];
+        if (slice.next.load(std::memory_order_relaxed) >= slice.end) {
+            continue;
+        }
+        uint64_t s = slice.next.fetch_add(CHUNK_ITEMS, std::memory_order_relaxed);
+        if (s < slice.end) {
+            start = s;
+            count = std::min(CHUNK_ITEMS, slice.end - s);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DatasetInitSession::exhausted() const {
+    return std::all_of(m_slices.begin(), m_slices.end(), [](const std::unique_ptr<Slice>& slice) {
+        return slice->next.load(std::memory_order_relaxed) >= slice->end;
+    });
+}
+
+bool DatasetInitSession::participate(unsigned home_node, const std::stop_token& stop) {
+    unsigned current = m_participants.load(std::memory_order_relaxed);
+    do {
+        if (current >= m_max_participants) {
+            return false;
+        }
+    } while (!m_participants.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel));
+
+    bool worked = false;
+    uint64_t start = 0;
+    uint64_t count = 0;
+    while (!cancelled() && !stop.stop_requested() && take_chunk(home_node, start, count)) {
+        if (m_kernel == DatasetKernel::Library ||
+            !m_api.init_dataset_kernel(m_dataset, m_cache, static_cast<unsigned long>(start),
+                                       static_cast<unsigned long>(count), m_kernel)) {
+            m_api.init_dataset(m_dataset, m_cache, static_cast<unsigned long>(start), static_cast<unsigned long>(count));
+        }
+        m_items_done.fetch_add(count, std::memory_order_relaxed);
+        worked = true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_idle_mutex);
+        m_participants.fetch_sub(1, std::memory_order_acq_rel);
+    }
+    m_idle_cv.notify_all();
+    return worked;
+}
+
+void DatasetInitSession::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(m_idle_mutex);
+        m_cancelled.store(true, std::memory_order_relaxed);
+    }
+    m_idle_cv.notify_all();
+}
+
+bool DatasetInitSession::wait(const std::function<void(const DatasetInitProgress&)>& report,
+                              std::chrono::milliseconds report_interval) {
+    std::unique_lock<std::mutex> lock(m_idle_mutex);
+    auto finished = [this] {
+        // Fragment wzięty z wycinka może się jeszcze liczyć - czekamy też na uczestników
+        return (exhausted() || cancelled()) && m_participants.load(std::memory_order_acquire) == 0;
+    };
+    while (!m_idle_cv.wait_for(lock, report_interval, finished)) {
+        if (report) {
+            lock.unlock();
+            report(progress());
+            lock.lock();
+        }
+    }
+    return !cancelled() && m_items_done.load(std::memory_order_relaxed) == m_item_count;
+}
+
+DatasetInitProgress DatasetInitSession::progress() const {
+    DatasetInitProgress p;
+    p.items_done = m_items_done.load(std::memory_order_relaxed);
+    p.items_total = m_item_count;
+    p.active = p.items_done < p.items_total && !cancelled();
+    p.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    if (p.items_done > 0) {
+        p.eta_seconds = p.elapsed_seconds * static_cast<double>(p.items_total - p.items_done) / p.items_done;
+    }
+    p.participants = m_participants.load(std::memory_order_relaxed);
+    p.kernel = m_kernel;
+    return p;
+}
+
+bool run_dataset_init(DatasetInitSession& session,
+                      const DatasetInitConfig& config,
+                      const NumaTopology& topology,
+                      const std::function<void(const DatasetInitProgress&)>& report) {
+    unsigned max_threads = config.threads ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+
+    // Najpierw dajemy szansę czekającym workerom (są już przypięte i nie kosztują nowego wątku)
+    if (config.worker_help && config.helper_grace.count() > 0) {
+        std::this_thread::sleep_for(config.helper_grace);
+    }
+    unsigned helpers = session.progress().participants;
+    unsigned pool_size = max_threads > helpers ? max_threads - helpers : 0;
+
+    std::vector<unsigned> cpus = interleave_cpus(topology, config.cpus);
+    std::vector<std::jthread> pool;
+    pool.reserve(pool_size);
+    for (unsigned i = 0; i < pool_size; ++i) {
+        std::optional<unsigned> cpu;
+        if (!cpus.empty()) {
+            cpu = cpus[(helpers + i) % cpus.size()];
+        }
+        pool.emplace_back([&session, &topology, cpu] {
+            if (cpu) {
+                set_current_thread_affinity({*cpu});
+            }
+            session.participate(topology.node_of(cpu ? static_cast<int>(*cpu) : current_cpu()));
+        });
+    }
+
+    bool complete = session.wait(report, std::chrono::seconds(1));
+    pool.clear(); // Join - wątki puli skończyły, gdy zabrakło fragmentów
+    return complete;
+}
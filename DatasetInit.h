@@ -0,0 +1,125 @@
+#pragma once
+
+#include "DatasetKernel.h"
+#include "RandomXAlgorithm.h"
+#include "ThreadAffinity.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <vector>
+
+/**
+ * @struct DatasetInitConfig
+ * @brief Parametry równoległej inicjalizacji datasetu.
+ */
+struct DatasetInitConfig {
+    unsigned threads = 0;          // Maks. liczba wątków liczących naraz (0 = hardware_concurrency)
+    std::vector<unsigned> cpus;    // CPU do przypięcia wątków puli (pusta = wszystkie z topologii)
+    bool numa = true;              // Dzielenie zakresu między węzły NUMA (first-touch lokalny)
+    bool worker_help = true;       // Czekające workery liczą fragmenty zamiast spać
+    std::chrono::milliseconds helper_grace{30}; // Czas na dołączenie workerów przed startem puli
+    DatasetKernel kernel = DatasetKernel::Auto; // Liczenie elementów (zobacz select_dataset_kernel)
+};
+
+/**
+ * @struct DatasetInitProgress
+ * @brief Postęp bieżącej (lub ostatniej) inicjalizacji.
+ */
+struct DatasetInitProgress {
+    bool active = false;
+    uint64_t items_done = 0;
+    uint64_t items_total = 0;
+    double elapsed_seconds = 0.0;
+    double eta_seconds = -1.0;     // -1 = jeszcze nieznane
+    unsigned participants = 0;     // Wątki liczące teraz (pula + workery)
+    DatasetKernel kernel = DatasetKernel::Library;
+
+    double fraction() const { return items_total ? static_cast<double>(items_done) / items_total : 0.0; }
+};
+
+/**
+ * @class DatasetInitSession
+ * @brief Jedna inicjalizacja datasetu podzielona na fragmenty.
+ *
+ * Zakres elementów jest dzielony na wycinki węzłów NUMA (proporcjonalnie do
+ * liczby CPU), a każdy uczestnik pobiera fragmenty najpierw ze swojego węzła,
+ * potem z pozostałych. Uczestnikami są wątki puli i czekające workery;
+ * liczba liczących naraz nie przekracza limitu z konfiguracji.
+ */
+class DatasetInitSession {
+public:
+    /**
+     * @param kernel Kernel fragmentów (Library = randomx_init_dataset); Auto jest
+     * rozstrzygany wcześniej przez select_dataset_kernel.
+     */
+    DatasetInitSession(const RandomXAlgorithm& algorithm, randomx_dataset* dataset, randomx_cache* cache,
+                       uint64_t item_count, const NumaTopology& topology, unsigned max_participants,
+                       DatasetKernel kernel = DatasetKernel::Library);
+
+    /**
+     * @brief Liczy fragmenty, dopóki są. Zwraca false od razu, jeśli brak wolnego miejsca
+     * (limit uczestników) albo nic już nie zostało.
+     * @param home_node Węzeł NUMA wywołującego wątku.
+     * @param stop Zatrzymanie wywołującego wątku (worker kończy po bieżącym fragmencie).
+     */
+    bool participate(unsigned home_node, const std::stop_token& stop = {});
+
+    /**
+     * @brief Przerywa inicjalizację (nowszy seed). Fragmenty w toku są kończone.
+     */
+    void cancel();
+
+    /**
+     * @brief Czeka, aż wszystkie fragmenty zostaną policzone (lub sesja przerwana)
+     * i żaden uczestnik nie pisze już do datasetu.
+     * @param report Wywoływana co report_interval z postępem (wątek wywołujący).
+     * @return true, jeśli dataset jest kompletny.
+     */
+    bool wait(const std::function<void(const DatasetInitProgress&)>& report,
+              std::chrono::milliseconds report_interval);
+
+    DatasetInitProgress progress() const;
+    bool cancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+    bool exhausted() const; // Wszystkie fragmenty rozdane
+
+private:
+    struct Slice {
+        std::atomic<uint64_t> next{0};
+        uint64_t end = 0;
+    };
+
+    bool take_chunk(unsigned home_node, uint64_t& start, uint64_t& count);
+
+    const RandomXApi& m_api;
+    randomx_dataset* m_dataset;
+    randomx_cache* m_cache;
+    uint64_t m_item_count;
+    unsigned m_max_participants;
+    DatasetKernel m_kernel;
+    std::vector<std::unique_ptr<Slice>> m_slices; // Jeden na węzeł NUMA
+
+    std::atomic<unsigned> m_participants{0};
+    std::atomic<uint64_t> m_items_done{0};
+    std::atomic<bool> m_cancelled{false};
+    std::chrono::steady_clock::time_point m_start;
+
+    std::mutex m_idle_mutex;
+    std::condition_variable m_idle_cv;
+};
+
+/**
+ * @brief Inicjalizuje dataset równolegle: dołączone workery + przypięta pula
+ * na pozostałe miejsca. Blokuje do końca (lub przerwania) sesji.
+ * @param session Sesja (publikowana wcześniej, aby workery mogły dołączyć).
+ * @param report Raport postępu (co sekundę).
+ * @return true, jeśli dataset jest kompletny.
+ */
+bool run_dataset_init(DatasetInitSession& session,
+                      const DatasetInitConfig& config,
+                      const NumaTopology& topology,
+                      const std::function<void(const DatasetInitProgress&)>& report);
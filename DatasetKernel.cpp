@@ -0,0 +1,158 @@
+#include "DatasetKernel.h"
+#include "Logger.h"
+#include "RandomXAlgorithm.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+namespace {
+
+// Próbka: kilka ms biblioteki na jednym wątku - pomijalne wobec budowy datasetu
+constexpr unsigned long SELECT_ITEMS = 2048;
+// Auto wybiera kernel dopiero przy wyraźnej przewadze (szum pomiaru na małej próbce)
+constexpr double AUTO_MIN_GAIN = 1.05;
+
+constexpr DatasetKernel VECTOR_KERNELS[] = {DatasetKernel::Avx512, DatasetKernel::Avx2, DatasetKernel::Scalar};
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+const char* dataset_kernel_name(DatasetKernel kernel) {
+    switch (kernel) {
+        case DatasetKernel::Auto: return "auto";
+        case DatasetKernel::Library: return "library";
+        case DatasetKernel::Scalar: return "scalar";
+        case DatasetKernel::Avx2: return "avx2";
+        case DatasetKernel::Avx512: return "avx512";
+    }
+    return "unknown";
+}
+
+std::optional<DatasetKernel> parse_dataset_kernel(std::string_view name) {
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    for (DatasetKernel kernel : {DatasetKernel::Auto, DatasetKernel::Library, DatasetKernel::Scalar,
+                                 DatasetKernel::Avx2, DatasetKernel::Avx512}) {
+        if (lower == dataset_kernel_name(kernel)) {
+            return kernel;
+        }
+    }
+    return std::nullopt;
+}
+
+unsigned dataset_kernel_lanes(DatasetKernel kernel) {
+    switch (kernel) {
+        case DatasetKernel::Scalar: return 1;
+        case DatasetKernel::Avx2: return 4;
+        case DatasetKernel::Avx512: return 8;
+        default: return 0;
+    }
+}
+
+std::vector<DatasetKernel> supported_dataset_kernels(const RandomXAlgorithm& algorithm) {
+    std::vector<DatasetKernel> kernels;
+    for (DatasetKernel kernel : VECTOR_KERNELS) {
+        // Pusty zakres nie dotyka datasetu ani cache'a - tylko sprawdza obsługę
+        if (algorithm.api->init_dataset_kernel(nullptr, nullptr, 0, 0, kernel)) {
+            kernels.push_back(kernel);
+        }
+    }
+    return kernels;
+}
+
+DatasetKernelCheck check_dataset_kernel(const RandomXAlgorithm& algorithm, randomx_dataset* dataset,
+                                        randomx_cache* cache, DatasetKernel kernel, unsigned long items) {
+    const RandomXApi& api = *algorithm.api;
+    DatasetKernelCheck check;
+    check.kernel = kernel;
+    unsigned long total = api.dataset_item_count();
+    items = std::max(1ul, std::min(items, total / 2));
+    uint64_t item_size = RANDOMX_DATASET_ITEM_SIZE;
+    auto* memory = static_cast<uint8_t*>(api.get_dataset_memory(dataset));
+    std::vector<uint8_t> reference(items * item_size);
+
+    // Próbka 1: biblioteka (mierzona), potem kernel na wyzerowanej pamięci
+    unsigned long first = 0;
+    uint8_t* sample = memory + first * item_size;
+    auto start = std::chrono::steady_clock::now();
+    api.init_dataset(dataset, cache, first, items);
+    check.library_items_per_second = items / std::max(1e-9, seconds_since(start));
+    if (kernel == DatasetKernel::Library) {
+        check.supported = true;
+        check.exact = true;
+        check.items_per_second = check.library_items_per_second;
+        return check;
+    }
+    std::memcpy(reference.data(), sample, reference.size());
+    std::memset(sample, 0, reference.size());
+    if (!api.init_dataset_kernel(dataset, cache, first, items, kernel)) {
+        return check;
+    }
+    check.supported = true;
+    check.exact = std::memcmp(reference.data(), sample, reference.size()) == 0;
+
+    // Próbka 2 (koniec, z elementami dodatkowymi): kernel (mierzony), potem biblioteka
+    first = total - items;
+    sample = memory + first * item_size;
+    std::memset(sample, 0, reference.size());
+    start = std::chrono::steady_clock::now();
+    api.init_dataset_kernel(dataset, cache, first, items, kernel);
+    check.items_per_second = items / std::max(1e-9, seconds_since(start));
+    std::memcpy(reference.data(), sample, reference.size());
+    api.init_dataset(dataset, cache, first, items);
+    check.exact = check.exact && std::memcmp(reference.data(), sample, reference.size()) == 0;
+    return check;
+}
+
+DatasetKernel select_dataset_kernel(const RandomXAlgorithm& algorithm, randomx_dataset* dataset, randomx_cache* cache,
+                                    DatasetKernel requested) {
+    if (requested == DatasetKernel::Library) {
+        return DatasetKernel::Library;
+    }
+
+    std::vector<DatasetKernel> candidates;
+    if (requested == DatasetKernel::Auto) {
+        candidates = supported_dataset_kernels(algorithm);
+    } else {
+        candidates.push_back(requested);
+    }
+
+    DatasetKernelCheck best;
+    best.kernel = DatasetKernel::Library;
+    double library_rate = 0.0;
+    for (DatasetKernel kernel : candidates) {
+        DatasetKernelCheck check = check_dataset_kernel(algorithm, dataset, cache, kernel, SELECT_ITEMS);
+        library_rate = std::max(library_rate, check.library_items_per_second);
+        if (!check.supported) {
+            LOG_WARN(LogCategory::RandomX, "[RandomXManager] Kernel datasetu {} nieobsługiwany przez CPU lub kompilację {} - "
+                                           "używam randomx_init_dataset.", dataset_kernel_name(kernel), algorithm.name);
+            continue;
+        }
+        if (!check.exact) {
+            LOG_ERROR(LogCategory::RandomX, "[RandomXManager] Kernel datasetu {} daje inne elementy niż randomx_init_dataset ({}) - "
+                                            "pomijam go.", dataset_kernel_name(kernel), algorithm.name);
+            continue;
+        }
+        if (best.kernel == DatasetKernel::Library || check.items_per_second > best.items_per_second) {
+            best = check;
+        }
+    }
+
+    if (best.kernel == DatasetKernel::Library) {
+        return DatasetKernel::Library;
+    }
+    if (requested == DatasetKernel::Auto && best.items_per_second < AUTO_MIN_GAIN * library_rate) {
+        LOG_DEBUG(LogCategory::RandomX, "[RandomXManager] Kernel datasetu: library ({:.0f} el./s na wątek; {} {:.0f} el./s).",
+                  library_rate, dataset_kernel_name(best.kernel), best.items_per_second);
+        return DatasetKernel::Library;
+    }
+    LOG_DEBUG(LogCategory::RandomX, "[RandomXManager] Kernel datasetu: {} ({:.0f} el./s na wątek; biblioteka {:.0f} el./s).",
+              dataset_kernel_name(best.kernel), best.items_per_second, library_rate);
+    return best.kernel;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+struct RandomXAlgorithm;
+struct randomx_cache;
+struct randomx_dataset;
+
+/**
+ * @enum DatasetKernel
+ * @brief Sposób liczenia elementów datasetu.
+ *
+ * Library to randomx_init_dataset (JIT SuperscalarHash, jeden element naraz).
+ * Pozostałe liczą ten sam SuperscalarHash z programów cache'a, ale kilka
+ * elementów naraz - każdy element w innej linii wektora, bo wszystkie
+ * wykonują te same programy i różnią się tylko rejestrami i adresami
+ * odczytów z cache'a; kilka wektorów wykonuje razem każdą instrukcję, żeby
+ * koszt jej dekodowania rozłożyć na więcej elementów. Scalar jest wersją
+ * jednoliniową (reszta zakresu i CPU bez AVX2).
+ */
+enum class DatasetKernel { Auto, Library, Scalar, Avx2, Avx512 };
+
+/**
+ * @brief Nazwa do logów, statusu i opcji ("auto", "library", "scalar", "avx2", "avx512").
+ */
+const char* dataset_kernel_name(DatasetKernel kernel);
+
+/**
+ * @brief Parsuje nazwę z dataset_kernel_name (wielkość liter bez znaczenia).
+ */
+std::optional<DatasetKernel> parse_dataset_kernel(std::string_view name);
+
+/**
+ * @brief Elementy liczone naraz (0 dla Auto i Library).
+ */
+unsigned dataset_kernel_lanes(DatasetKernel kernel);
+
+/**
+ * @brief Kernele wektorowe obsługiwane przez ten CPU i tę kompilację
+ * wariantu, od najszerszego (bez Auto i Library).
+ */
+std::vector<DatasetKernel> supported_dataset_kernels(const RandomXAlgorithm& algorithm);
+
+/**
+ * @struct DatasetKernelCheck
+ * @brief Wynik porównania kernela z randomx_init_dataset na próbce elementów.
+ */
+struct DatasetKernelCheck {
+    DatasetKernel kernel = DatasetKernel::Library;
+    bool supported = false;
+    bool exact = false;             // Bit w bit zgodny z biblioteką na całej próbce
+    double items_per_second = 0.0;  // Jeden wątek
+    double library_items_per_second = 0.0;
+};
+
+/**
+ * @brief Sprawdza kernel na dwóch próbkach (początek i koniec datasetu, w tym
+ * elementy dodatkowe) i mierzy jego tempo oraz tempo biblioteki - każde na
+ * innej próbce, żeby żadne nie korzystało z linii cache'a rozgrzanych przez
+ * drugie. Nadpisuje te elementy datasetu - wywoływać tylko przed jego
+ * inicjalizacją.
+ * @param items Elementy w próbce (na początku i na końcu).
+ */
+DatasetKernelCheck check_dataset_kernel(const RandomXAlgorithm& algorithm, randomx_dataset* dataset,
+                                        randomx_cache* cache, DatasetKernel kernel, unsigned long items);
+
+/**
+ * @brief Wybiera kernel dla budowy datasetu z bieżącego cache'a.
+ *
+ * Każdy kernel poza Library jest najpierw porównany z biblioteką; niezgodny
+ * lub nieobsługiwany jest pomijany (z logiem). Przy Auto wygrywa najszybszy
+ * zgodny kernel, o ile jest wyraźnie szybszy od biblioteki - JIT biblioteki
+ * bywa szybszy od wersji wektorowej na CPU z wolnymi gather i mnożeniami
+ * 64-bitowymi. Nadpisuje próbkowane elementy datasetu (jak check_dataset_kernel).
+ */
+DatasetKernel select_dataset_kernel(const RandomXAlgorithm& algorithm, randomx_dataset* dataset, randomx_cache* cache,
+                                    DatasetKernel requested);
@@ -0,0 +1,155 @@
+#include "DatasetScrubber.h"
+#include "DatasetKernel.h"
+#include "RandomXManager.h"
+#include "ThreadPriority.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+constexpr unsigned BATCHES_PER_SECOND = 10;   // Krótkie paczki - blokada współdzielona trzymana kilka ms
+constexpr uint64_t MIN_BATCH = 16;
+constexpr uint64_t MAX_BATCH = 4096;
+constexpr std::chrono::seconds UNAVAILABLE_RETRY{1};
+}
+
+DatasetScrubber::DatasetScrubber(RandomXManager& manager) : m_manager(manager) {}
+
+DatasetScrubber::~DatasetScrubber() {
+    // Jawny join przed zniszczeniem pól, których używa run()
+    m_thread.request_stop();
+    m_cv.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void DatasetScrubber::set_config(const DatasetScrubConfig& config) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_config = config;
+        if (config.rate > 0 && !m_thread.joinable()) {
+            m_thread = std::jthread([this](std::stop_token st) { run(st); });
+        }
+    }
+    m_cv.notify_all();
+}
+
+DatasetScrubStats DatasetScrubber::stats() const {
+    DatasetScrubStats s;
+    s.active = m_active.load(std::memory_order_relaxed);
+    s.items_checked = m_items_checked.load(std::memory_order_relaxed);
+    s.corrupt_items = m_corrupt_items.load(std::memory_order_relaxed);
+    s.corrupt_ranges = m_corrupt_ranges.load(std::memory_order_relaxed);
+    s.rebuilds = m_rebuilds.load(std::memory_order_relaxed);
+    s.passes = m_passes.load(std::memory_order_relaxed);
+    uint64_t total = m_item_count.load(std::memory_order_relaxed);
+    s.pass_progress = total ? static_cast<double>(m_position.load(std::memory_order_relaxed)) / total : 0.0;
+    return s;
+}
+
+int64_t DatasetScrubber::scrub_range(uint64_t first, uint64_t count, uint64_t& generation) {
+    std::vector<uint64_t> mismatched;
+    {
+        auto lock = m_manager.try_acquire();
+        if (!lock.owns_lock()) {
+            return -1;
+        }
+        RandomXBinding binding = m_manager.binding();
+        if (!binding.algorithm || !binding.dataset || !binding.cache) {
+            return -1;
+        }
+        generation = binding.generation;
+
+        const RandomXApi& api = *binding.algorithm->api;
+        uint64_t total = api.dataset_item_count();
+        m_item_count.store(total, std::memory_order_relaxed);
+        auto* memory = static_cast<const uint8_t*>(api.get_dataset_memory(binding.dataset));
+        uint64_t last = std::min(first + count, total);
+        if (last <= first) {
+            return 0;
+        }
+
+        // Pod blokadą odczytu dataset tylko czytamy - workery haszują z niego równolegle
+        std::vector<uint8_t> expected((last - first) * RANDOMX_DATASET_ITEM_SIZE);
+        if (!api.compute_dataset_items(binding.cache, expected.data(), first, last - first, DatasetKernel::Scalar)) {
+            return -1;
+        }
+        for (uint64_t item = first; item < last; ++item) {
+            if (std::memcmp(memory + item * RANDOMX_DATASET_ITEM_SIZE,
+                            expected.data() + (item - first) * RANDOMX_DATASET_ITEM_SIZE, RANDOMX_DATASET_ITEM_SIZE) != 0) {
+                mismatched.push_back(item);
+            }
+        }
+        m_items_checked.fetch_add(last - first, std::memory_order_relaxed);
+    }
+    if (mismatched.empty()) {
+        return 0;
+    }
+    // Zapis tylko na wyłączność; liczą się elementy różne od wyniku biblioteki
+    return m_manager.repair_dataset_items(generation, mismatched);
+}
+
+void DatasetScrubber::run(std::stop_token stop) {
+    // Skanowanie ustępuje workerom i innym procesom
+    ThreadPriority idle;
+    idle.cls = ThreadPriority::Class::Idle;
+    set_current_thread_priority(idle);
+
+    uint64_t position = 0;
+    uint64_t generation = 0;
+    uint64_t pass_corrupt = 0;
+    while (!stop.stop_requested()) {
+        DatasetScrubConfig config;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!m_cv.wait(lock, stop, [this] { return m_config.rate > 0; })) {
+                break;
+            }
+            config = m_config;
+        }
+
+        uint64_t batch = std::clamp<uint64_t>(config.rate / BATCHES_PER_SECOND, MIN_BATCH, MAX_BATCH);
+        uint64_t previous_generation = generation;
+        int64_t corrupt = scrub_range(position, batch, generation);
+        m_active.store(corrupt >= 0, std::memory_order_relaxed);
+
+        std::chrono::microseconds pause = UNAVAILABLE_RETRY;
+        if (corrupt >= 0) {
+            if (generation != previous_generation) {
+                pass_corrupt = 0; // Nowy seed lub tryb - nowy dataset
+            }
+            if (corrupt > 0) {
+                m_corrupt_items.fetch_add(static_cast<uint64_t>(corrupt), std::memory_order_relaxed);
+                m_corrupt_ranges.fetch_add(1, std::memory_order_relaxed);
+                pass_corrupt += static_cast<uint64_t>(corrupt);
+                LOG_WARN(LogCategory::RandomX,
+                         "[Scrub] Uszkodzony dataset: {} elementów w zakresie {}-{} (naprawione). "
+                         "Możliwy wadliwy RAM lub niestabilne podkręcenie.",
+                         corrupt, position, std::min(position + batch, m_item_count.load(std::memory_order_relaxed)) - 1);
+            }
+
+            position += batch;
+            if (config.rebuild_after > 0 && pass_corrupt >= config.rebuild_after) {
+                LOG_ERROR(LogCategory::RandomX, "[Scrub] {} uszkodzonych elementów w jednym przebiegu - przebudowuję dataset.",
+                          pass_corrupt);
+                m_rebuilds.fetch_add(1, std::memory_order_relaxed);
+                m_manager.request_rebuild();
+                position = 0; // Nowy przebieg po przebudowie
+                pass_corrupt = 0;
+            } else if (position >= m_item_count.load(std::memory_order_relaxed)) {
+                LOG_DEBUG(LogCategory::RandomX, "[Scrub] Przebieg zakończony ({} uszkodzeń).", pass_corrupt);
+                m_passes.fetch_add(1, std::memory_order_relaxed);
+                position = 0;
+                pass_corrupt = 0;
+            }
+            pause = std::chrono::microseconds(batch * 1000000 / config.rate);
+        }
+        m_position.store(position, std::memory_order_relaxed);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait_for(lock, stop, pause, [this, &config] { return m_config.rate != config.rate; });
+    }
+    m_active.store(false, std::memory_order_relaxed);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+class RandomXManager;
+
+/**
+ * @struct DatasetScrubConfig
+ * @brief Parametry skanowania datasetu w tle.
+ */
+struct DatasetScrubConfig {
+    unsigned rate = 0;            // Elementy (64 B) sprawdzane na sekundę (0 = wyłączony)
+    unsigned rebuild_after = 64;  // Uszkodzone elementy w jednym przebiegu, po których przebudowujemy całość
+};
+
+/**
+ * @struct DatasetScrubStats
+ * @brief Liczniki skanowania (od startu, sumowane po seedach).
+ */
+struct DatasetScrubStats {
+    bool active = false;          // Skanowanie włączone i dataset dostępny
+    uint64_t items_checked = 0;
+    uint64_t corrupt_items = 0;   // Elementy różne od policzonych z cache'a (naprawione w miejscu)
+    uint64_t corrupt_ranges = 0;  // Paczki z co najmniej jednym uszkodzeniem
+    uint64_t rebuilds = 0;        // Przebudowy zlecone po masowym uszkodzeniu
+    uint64_t passes = 0;          // Pełne przejścia przez dataset
+    double pass_progress = 0.0;   // Bieżące przejście (0-1)
+};
+
+/**
+ * @class DatasetScrubber
+ * @brief Wątek w tle, który wykrywa przekłamania datasetu (wadliwy RAM, podkręcony host).
+ *
+ * Przechodzi dataset po kolei paczkami elementów: liczy paczkę ponownie
+ * z cache'a do własnego bufora (kernel skalarny, SuperscalarKernel.h)
+ * i porównuje z datasetem, który pod blokadą współdzieloną tylko czyta.
+ * Różne elementy manager przelicza biblioteką pod blokadą zapisu
+ * (repair_dataset_items) - za uszkodzone uznajemy te, które się przy tym
+ * faktycznie zmieniły. Powyżej rebuild_after uszkodzeń w jednym przebiegu
+ * (wadliwy moduł RAM psuje zwykle wiele miejsc naraz) manager przebudowuje
+ * cały dataset.
+ *
+ * Koszt jest ograniczony tempem (elementy na sekundę): element to kilka
+ * mikrosekund CPU i 64 B odczytu, więc domyślne tempo zajmuje ułamek procenta
+ * jednego rdzenia. Wątek ma priorytet idle, a paczkę liczy pod blokadą
+ * współdzieloną - przebudowa ma pierwszeństwo i skanowanie wtedy czeka.
+ * Bez cache'a (--release-cache) nie ma z czym porównać i skanowanie stoi.
+ */
+class DatasetScrubber {
+public:
+    explicit DatasetScrubber(RandomXManager& manager);
+    ~DatasetScrubber();
+
+    DatasetScrubber(const DatasetScrubber&) = delete;
+    DatasetScrubber& operator=(const DatasetScrubber&) = delete;
+
+    /**
+     * @brief Zmienia tempo; rate = 0 zatrzymuje wątek, rate > 0 go uruchamia.
+     */
+    void set_config(const DatasetScrubConfig& config);
+
+    DatasetScrubStats stats() const;
+
+private:
+    void run(std::stop_token stop);
+
+    /**
+     * @brief Sprawdza elementy [first, first + count) bieżącego datasetu i naprawia różniące się.
+     * @return Liczba uszkodzonych elementów; -1, gdy dataset jest niedostępny (przebudowa, brak cache'a).
+     */
+    int64_t scrub_range(uint64_t first, uint64_t count, uint64_t& generation);
+
+    RandomXManager& m_manager;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable_any m_cv;
+    DatasetScrubConfig m_config;
+    std::jthread m_thread;
+
+    std::atomic<bool> m_active{false};
+    std::atomic<uint64_t> m_items_checked{0};
+    std::atomic<uint64_t> m_corrupt_items{0};
+    std::atomic<uint64_t> m_corrupt_ranges{0};
+    std::atomic<uint64_t> m_rebuilds{0};
+    std::atomic<uint64_t> m_passes{0};
+    std::atomic<uint64_t> m_position{0};
+    std::atomic<uint64_t> m_item_count{0};
+};
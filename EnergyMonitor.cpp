@@ -0,0 +1,125 @@
+#include "EnergyMonitor.h"
+#include "Logger.h"
+#include "SystemUtils.h"
+#include <algorithm>
+#include <filesystem>
+
+std::vector<RaplZone> discover_rapl_zones(const std::string& root) {
+    std::vector<RaplZone> zones;
+    std::error_code ec;
+    std::filesystem::directory_iterator it(root + "/sys/class/powercap", ec);
+    if (ec) {
+        return zones;
+    }
+    for (const auto& entry : it) {
+        // "intel-rapl:N" - pakiet, "intel-rapl:N:M" - jego podstrefa (core, uncore, dram);
+        // AMD korzysta z tego samego sterownika i nazw
+        std::string dir = entry.path().filename().string();
+        if (!dir.starts_with("intel-rapl:")) {
+            continue;
+        }
+        auto name = read_first_line(entry.path().string() + "/name");
+        if (!name) {
+            continue;
+        }
+        bool package = name->starts_with("package");
+        bool dram = *name == "dram";
+        if (!package && !dram) {
+            continue;
+        }
+        RaplZone zone;
+        zone.path = entry.path().string();
+        zone.name = *name;
+        zone.dram = dram;
+        zone.max_energy_range_uj = read_u64(zone.path + "/max_energy_range_uj").value_or(0);
+        zones.push_back(std::move(zone));
+    }
+    std::sort(zones.begin(), zones.end(), [](const RaplZone& a, const RaplZone& b) { return a.path < b.path; });
+    return zones;
+}
+
+uint64_t energy_delta_uj(uint64_t previous, uint64_t current, uint64_t max_energy_range_uj) {
+    if (current >= previous) {
+        return current - previous;
+    }
+    if (max_energy_range_uj < previous) {
+        return 0; // Nieznany zakres - nie zgadujemy
+    }
+    return max_energy_range_uj - previous + current;
+}
+
+EnergyMonitor::EnergyMonitor(EnergyConfig config) : m_config(std::move(config)) {
+    for (auto& zone : discover_rapl_zones(m_config.sysfs_root)) {
+        (zone.dram ? m_stats.dram_zones : m_stats.package_zones) += 1;
+        m_zones.push_back({std::move(zone), std::nullopt});
+    }
+    if (m_stats.package_zones == 0) {
+        LOG_WARN(LogCategory::Manager, "[Energia] Brak stref RAPL w {}/sys/class/powercap - pomiar energii niedostępny.",
+                 m_config.sysfs_root);
+    } else {
+        LOG_INFO(LogCategory::Manager, "[Energia] Strefy RAPL - pakiety: {}, DRAM: {}.",
+                 m_stats.package_zones, m_stats.dram_zones);
+    }
+}
+
+void EnergyMonitor::update(uint64_t total_hashes, uint64_t accepted_shares) {
+    auto now = std::chrono::steady_clock::now();
+    double dt = std::chrono::duration<double>(now - m_last_update).count();
+
+    double package_joules = 0.0;
+    double dram_joules = 0.0;
+    bool readable = false;
+    uint64_t wraps = 0;
+    for (auto& zone : m_zones) {
+        auto current = read_u64(zone.zone.path + "/energy_uj");
+        if (!current) {
+            zone.last_uj.reset();
+            continue;
+        }
+        readable = readable || !zone.zone.dram;
+        if (zone.last_uj) {
+            if (*current < *zone.last_uj) {
+                wraps += 1;
+            }
+            double joules = energy_delta_uj(*zone.last_uj, *current, zone.zone.max_energy_range_uj) / 1e6;
+            (zone.zone.dram ? dram_joules : package_joules) += joules;
+        }
+        zone.last_uj = current;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!readable && m_stats.package_zones > 0 && !m_have_sample) {
+        LOG_WARN(LogCategory::Manager, "[Energia] Nie można odczytać energy_uj (od jądra 5.10 wymaga roota).");
+    }
+    m_stats.available = readable;
+    m_stats.counter_wraps += wraps;
+
+    if (m_have_sample && readable && dt > 0.0) {
+        m_stats.package_joules_total += package_joules;
+        m_stats.dram_joules_total += dram_joules;
+        m_stats.package_watts = package_joules / dt;
+        m_stats.dram_watts = dram_joules / dt;
+        double joules = package_joules + dram_joules;
+        m_stats.hashes_per_joule = joules > 0.0 ? (total_hashes - m_last_hashes) / joules : 0.0;
+        uint64_t shares = accepted_shares - m_first_shares;
+        m_stats.joules_per_share = shares > 0 ? m_stats.joules_total() / shares : 0.0;
+    } else if (!m_have_sample) {
+        m_first_shares = accepted_shares;
+    }
+    m_have_sample = true;
+    m_last_update = now;
+    m_last_hashes = total_hashes;
+}
+
+EnergyMonitor::Stats EnergyMonitor::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+std::optional<double> EnergyMonitor::watts() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_stats.available || m_stats.package_joules_total <= 0.0) {
+        return std::nullopt;
+    }
+    return m_stats.watts();
+}
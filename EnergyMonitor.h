@@ -0,0 +1,108 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @struct EnergyConfig
+ * @brief Parametry pomiaru energii (Linux powercap / RAPL).
+ */
+struct EnergyConfig {
+    bool enabled = false;
+    std::string sysfs_root; // Korzeń dla /sys/class/powercap (pusty = "/"; inny np. w testach)
+
+    bool operator==(const EnergyConfig&) const = default;
+};
+
+/**
+ * @struct RaplZone
+ * @brief Licznik energii jednej strefy RAPL (pakiet CPU lub DRAM).
+ */
+struct RaplZone {
+    std::string path;              // Katalog strefy, np. <root>/sys/class/powercap/intel-rapl:0
+    std::string name;              // "package-0", "dram"
+    bool dram = false;
+    uint64_t max_energy_range_uj = 0; // Zakres licznika - po nim wraca do zera
+};
+
+/**
+ * @brief Wyszukuje strefy pakietów i DRAM w <root>/sys/class/powercap.
+ * Pomija strefy "core"/"uncore" (zawarte w pakiecie), "psys" (cała platforma)
+ * i duplikaty intel-rapl-mmio, żeby energia nie była liczona podwójnie.
+ */
+std::vector<RaplZone> discover_rapl_zones(const std::string& root);
+
+/**
+ * @brief Przyrost licznika energy_uj z uwzględnieniem przepełnienia.
+ * Przy current < previous licznik przekroczył max_energy_range_uj i zaczął od zera
+ * (zakłada co najwyżej jedno przepełnienie między odczytami - przy ~260 kJ
+ * zakresu to kilkanaście minut pracy pakietu 300 W).
+ */
+uint64_t energy_delta_uj(uint64_t previous, uint64_t current, uint64_t max_energy_range_uj);
+
+/**
+ * @class EnergyMonitor
+ * @brief Odczytuje liczniki RAPL i przelicza je na waty i efektywność kopania.
+ *
+ * RAPL mierzy cały pakiet (i moduły DRAM), a nie sam proces - przy innych
+ * obciążeniach na hoście hashe na dżul są zaniżone. Od jądra 5.10 energy_uj
+ * czyta tylko root; bez uprawnień strefy są znalezione, ale pomiar jest
+ * niedostępny. update() wywołuje jeden wątek (io_context), stats() - dowolny.
+ */
+class EnergyMonitor {
+public:
+    /**
+     * @struct Stats
+     * @brief Pomiar energii dla metryk, raportu i regulatora limitu.
+     */
+    struct Stats {
+        bool available = false;          // Co najmniej jedna strefa pakietu daje się odczytać
+        unsigned package_zones = 0;
+        unsigned dram_zones = 0;
+        double package_watts = 0.0;      // Średnia moc od poprzedniego odczytu
+        double dram_watts = 0.0;
+        double package_joules_total = 0.0;
+        double dram_joules_total = 0.0;
+        double hashes_per_joule = 0.0;   // Od poprzedniego odczytu (pakiet + DRAM)
+        double joules_per_share = 0.0;   // Od startu pomiaru; 0 = brak przyjętych udziałów
+        uint64_t counter_wraps = 0;      // Przepełnienia liczników energy_uj
+
+        double watts() const { return package_watts + dram_watts; }
+        double joules_total() const { return package_joules_total + dram_joules_total; }
+    };
+
+    explicit EnergyMonitor(EnergyConfig config);
+
+    /**
+     * @brief Odczytuje liczniki i przelicza przyrosty.
+     * @param total_hashes Hashe wszystkich workerów od startu.
+     * @param accepted_shares Udziały przyjęte przez pule od startu.
+     */
+    void update(uint64_t total_hashes, uint64_t accepted_shares);
+
+    Stats stats() const;
+
+    /**
+     * @brief Bieżąca moc (pakiet + DRAM); std::nullopt, gdy pomiar niedostępny.
+     */
+    std::optional<double> watts() const;
+
+private:
+    struct Zone {
+        RaplZone zone;
+        std::optional<uint64_t> last_uj;
+    };
+
+    EnergyConfig m_config;
+    std::vector<Zone> m_zones;
+    mutable std::mutex m_mutex; // Chroni m_stats (update() vs stats())
+    Stats m_stats;
+    bool m_have_sample = false;
+    std::chrono::steady_clock::time_point m_last_update;
+    uint64_t m_last_hashes = 0;
+    uint64_t m_first_shares = 0; // Udziały przyjęte przed pierwszym odczytem
+};
@@ -0,0 +1,395 @@
+#include "FleetAggregator.h"
+#include <algorithm>
+#include <fmt/core.h>
+
+using json = nlohmann::json;
+
+namespace {
+
+// Migawki trzymane na hosta (historia w /fleet/hosts/NAZWA)
+constexpr std::size_t HISTORY_LIMIT = 60;
+// Migawki uśredniane do porównań hashrate (jedna bywa zaszumiona)
+constexpr std::size_t RATE_SAMPLES = 6;
+// Mediana floty ma sens dopiero od kilku hostów
+constexpr std::size_t MIN_PEERS = 3;
+// Udziałów potrzebnych do oceny odrzuceń
+constexpr uint64_t MIN_SHARES = 20;
+// Gdy host nie podał odstępu (0), a próg nie jest ustawiony
+constexpr auto DEFAULT_STALE_AFTER = std::chrono::seconds(60);
+
+double seconds(std::chrono::nanoseconds duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+double median(std::vector<double> values) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    auto middle = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), middle, values.end());
+    if (values.size() % 2) {
+        return *middle;
+    }
+    return (*middle + *std::max_element(values.begin(), middle)) / 2.0;
+}
+
+bool hashing(const FleetSnapshot& s) {
+    return s.dataset_state == FleetDatasetState::Ready || s.dataset_state == FleetDatasetState::Light;
+}
+
+std::string escape_label(const std::string& value) {
+    std::string out;
+    for (char c : value) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"': out += "\\\""; break;
+            case '\n': out += "\\n"; break;
+            default: out += c;
+        }
+    }
+    return out;
+}
+
+void append_metric_header(std::string& out, const char* name, const char* type, const char* help) {
+    out += fmt::format("# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+}
+
+} // namespace
+
+FleetAggregator::FleetAggregator(FleetAggregatorConfig config) : m_config(config) {}
+
+void FleetAggregator::ingest(const FleetBatch& batch, const std::string& source, Clock::time_point now) {
+    auto [it, inserted] = m_hosts.try_emplace(batch.host);
+    Host& host = it->second;
+    if (inserted || host.instance != batch.instance) {
+        if (!inserted) {
+            ++host.restarts;
+            ++m_stats.restarts;
+        } else {
+            host.first_seen = now;
+        }
+        host.instance = batch.instance;
+        host.next_sequence = batch.sequence;
+        host.batch_size = 1;
+        host.history.clear();
+    } else if (batch.sequence < host.next_sequence) {
+        return; // Spóźniony lub powtórzony datagram - nowsze migawki już są
+    }
+
+    ++m_stats.batches;
+    m_stats.snapshots += batch.snapshots.size();
+    uint64_t lost = batch.sequence - host.next_sequence;
+    host.lost_batches += lost;
+    m_stats.lost_batches += lost;
+    host.next_sequence = batch.sequence + 1;
+    host.source = source;
+    host.interval = std::chrono::milliseconds(batch.interval_ms);
+    host.batch_size = std::max(host.batch_size, batch.snapshots.size());
+    host.last_seen = now;
+    ++host.batches;
+    for (const auto& snapshot : batch.snapshots) {
+        host.history.push_back(snapshot);
+    }
+    while (host.history.size() > HISTORY_LIMIT) {
+        host.history.pop_front();
+    }
+}
+
+void FleetAggregator::expire(Clock::time_point now) {
+    std::erase_if(m_hosts, [&](const auto& entry) { return now - entry.second.last_seen > m_config.forget_after; });
+}
+
+std::chrono::nanoseconds FleetAggregator::stale_after(const Host& host) const {
+    if (m_config.stale_after.count() > 0) {
+        return m_config.stale_after;
+    }
+    if (host.interval.count() <= 0) {
+        return DEFAULT_STALE_AFTER;
+    }
+    // Paczka przychodzi co interval * batch; trzy zgubione z rzędu to już brak kontaktu
+    return 3 * host.interval * static_cast<int64_t>(host.batch_size);
+}
+
+bool FleetAggregator::is_stale(const Host& host, Clock::time_point now) const {
+    return now - host.last_seen > stale_after(host);
+}
+
+double FleetAggregator::average_rate(const Host& host) const {
+    std::size_t count = std::min(RATE_SAMPLES, host.history.size());
+    double sum = 0.0;
+    for (std::size_t i = host.history.size() - count; i < host.history.size(); ++i) {
+        sum += host.history[i].hashrate;
+    }
+    return count ? sum / count : 0.0;
+}
+
+json FleetAggregator::host_json(const std::string& name, const Host& host, Clock::time_point now) const {
+    json j = {{"host", name},
+              {"source", host.source},
+              {"instance", fmt::format("{:016x}", host.instance)},
+              {"live", !is_stale(host, now)},
+              {"age_seconds", seconds(now - host.last_seen)},
+              {"batches", host.batches},
+              {"lost_batches", host.lost_batches},
+              {"restarts", host.restarts}};
+    if (host.history.empty()) {
+        return j;
+    }
+    const FleetSnapshot& s = host.history.back();
+    j["uptime_seconds"] = s.uptime_seconds;
+    j["hashrate"] = s.hashrate;
+    j["hashrate_avg"] = average_rate(host);
+    j["hashrate_ewma"] = s.hashrate_ewma;
+    j["threads"] = s.thread_rates;
+    j["shares"] = {{"accepted", s.shares_accepted}, {"rejected", s.shares_rejected}, {"stale", s.shares_stale}};
+    j["pools"] = {{"connected", s.pools_connected}, {"total", s.pools_total}};
+    j["dataset"] = {{"state", fleet_dataset_state_name(s.dataset_state)},
+                    {"progress", s.dataset_progress},
+                    {"build_seconds", s.dataset_build_seconds}};
+    j["seed"] = {{"hash", s.seed_hash}, {"epoch", s.seed_epoch}};
+    j["algorithm"] = s.algorithm;
+    j["errors"] = {{"log_warnings", s.log_warnings},
+                   {"log_errors", s.log_errors},
+                   {"pool_reconnects", s.pool_reconnects},
+                   {"watchdog_repairs", s.watchdog_repairs},
+                   {"dataset_corrupt_items", s.dataset_corrupt_items}};
+    return j;
+}
+
+json FleetAggregator::totals(Clock::time_point now) const {
+    uint64_t live = 0;
+    uint64_t threads = 0;
+    double hashrate = 0.0;
+    double hashrate_ewma = 0.0;
+    uint64_t accepted = 0, rejected = 0, stale_shares = 0;
+    uint64_t log_errors = 0, reconnects = 0, repairs = 0, corrupt = 0;
+    std::map<std::string, uint64_t> datasets = {{"none", 0}, {"building", 0}, {"ready", 0}, {"light", 0}};
+    std::map<std::string, std::pair<uint64_t, double>> algorithms; // Hosty i H/s
+    std::map<std::string, uint64_t> seeds;
+
+    for (const auto& [name, host] : m_hosts) {
+        if (host.history.empty()) {
+            continue;
+        }
+        const FleetSnapshot& s = host.history.back();
+        // Liczniki od startu minerów - także hostów bez kontaktu (ostatni znany stan)
+        accepted += s.shares_accepted;
+        rejected += s.shares_rejected;
+        stale_shares += s.shares_stale;
+        log_errors += s.log_errors;
+        reconnects += s.pool_reconnects;
+        repairs += s.watchdog_repairs;
+        corrupt += s.dataset_corrupt_items;
+        if (is_stale(host, now)) {
+            continue;
+        }
+        ++live;
+        threads += s.thread_rates.size();
+        hashrate += s.hashrate;
+        hashrate_ewma += s.hashrate_ewma;
+        ++datasets[fleet_dataset_state_name(s.dataset_state)];
+        auto& algorithm = algorithms[s.algorithm.empty() ? "unknown" : s.algorithm];
+        ++algorithm.first;
+        algorithm.second += s.hashrate;
+        if (!s.seed_hash.empty()) {
+            ++seeds[s.seed_hash];
+        }
+    }
+    json by_algorithm = json::object();
+    for (const auto& [name, entry] : algorithms) {
+        by_algorithm[name] = {{"hosts", entry.first}, {"hashrate", entry.second}};
+    }
+
+    return {{"hosts", {{"total", m_hosts.size()}, {"live", live}, {"stale", m_hosts.size() - live}}},
+            {"threads", threads},
+            {"hashrate", hashrate},
+            {"hashrate_ewma", hashrate_ewma},
+            {"shares", {{"accepted", accepted}, {"rejected", rejected}, {"stale", stale_shares}}},
+            {"datasets", datasets},
+            {"algorithms", by_algorithm},
+            {"seeds", seeds},
+            {"errors", {{"log_errors", log_errors},
+                        {"pool_reconnects", reconnects},
+                        {"watchdog_repairs", repairs},
+                        {"dataset_corrupt_items", corrupt}}},
+            {"outliers", outliers(now)["hosts"].size()},
+            {"ingest", {{"batches", m_stats.batches},
+                        {"snapshots", m_stats.snapshots},
+                        {"malformed", m_stats.malformed},
+                        {"lost_batches", m_stats.lost_batches},
+                        {"restarts", m_stats.restarts}}}};
+}
+
+json FleetAggregator::hosts(Clock::time_point now) const {
+    json list = json::array();
+    for (const auto& [name, host] : m_hosts) {
+        list.push_back(host_json(name, host, now));
+    }
+    return {{"hosts", list}};
+}
+
+json FleetAggregator::host(const std::string& name, Clock::time_point now) const {
+    auto it = m_hosts.find(name);
+    if (it == m_hosts.end()) {
+        return json::object();
+    }
+    json j = host_json(name, it->second, now);
+    json history = json::array();
+    for (const auto& s : it->second.history) {
+        history.push_back({{"time_ms", s.time_ms}, {"hashrate", s.hashrate}, {"threads", s.thread_rates},
+                           {"dataset", fleet_dataset_state_name(s.dataset_state)}});
+    }
+    j["history"] = history;
+    return j;
+}
+
+json FleetAggregator::outliers(Clock::time_point now) const {
+    // Mediany floty: H/s na wątek hostów, które haszują, i najczęstszy seed każdego algorytmu
+    std::vector<double> per_thread;
+    std::map<std::string, std::map<std::string, std::size_t>> seed_votes;
+    for (const auto& [name, host] : m_hosts) {
+        if (host.history.empty() || is_stale(host, now)) {
+            continue;
+        }
+        const FleetSnapshot& s = host.history.back();
+        if (hashing(s) && !s.thread_rates.empty()) {
+            per_thread.push_back(average_rate(host) / s.thread_rates.size());
+        }
+        if (!s.seed_hash.empty()) {
+            ++seed_votes[s.algorithm][s.seed_hash];
+        }
+    }
+    double fleet_median = per_thread.size() >= MIN_PEERS ? median(per_thread) : 0.0;
+    std::map<std::string, std::string> majority_seed;
+    for (const auto& [algorithm, votes] : seed_votes) {
+        majority_seed[algorithm] = std::max_element(votes.begin(), votes.end(), [](const auto& a, const auto& b) {
+            return a.second < b.second;
+        })->first;
+    }
+
+    json list = json::array();
+    for (const auto& [name, host] : m_hosts) {
+        if (host.history.empty() || is_stale(host, now)) {
+            continue;
+        }
+        const FleetSnapshot& s = host.history.back();
+        const FleetSnapshot& oldest = host.history.front();
+        json reasons = json::array();
+        json entry = {{"host", name}, {"source", host.source}};
+
+        if (hashing(s) && !s.thread_rates.empty()) {
+            double rate = average_rate(host) / s.thread_rates.size();
+            entry["thread_rate"] = rate;
+            if (fleet_median > 0.0) {
+                double deviation = (rate - fleet_median) / fleet_median;
+                entry["deviation"] = deviation;
+                if (deviation < -m_config.outlier_deviation) {
+                    reasons.push_back("hashrate_low");
+                } else if (deviation > m_config.outlier_deviation) {
+                    reasons.push_back("hashrate_high");
+                }
+            }
+            // Wątki wyraźnie wolniejsze od pozostałych wątków tego hosta
+            std::vector<double> rates(s.thread_rates.begin(), s.thread_rates.end());
+            double host_median = median(rates);
+            json slow = json::array();
+            for (std::size_t i = 0; i < s.thread_rates.size() && rates.size() >= MIN_PEERS; ++i) {
+                if (s.thread_rates[i] < (1.0 - m_config.outlier_deviation) * host_median) {
+                    slow.push_back(i);
+                }
+            }
+            if (!slow.empty()) {
+                reasons.push_back("slow_threads");
+                entry["slow_threads"] = slow;
+            }
+        }
+        uint64_t shares = s.shares_accepted + s.shares_rejected;
+        if (shares >= MIN_SHARES) {
+            double ratio = static_cast<double>(s.shares_rejected) / shares;
+            if (ratio > m_config.reject_ratio) {
+                reasons.push_back("rejects");
+                entry["reject_ratio"] = ratio;
+            }
+        }
+        auto majority = majority_seed.find(s.algorithm);
+        if (!s.seed_hash.empty() && majority != majority_seed.end() && majority->second != s.seed_hash) {
+            reasons.push_back("seed");
+            entry["seed"] = s.seed_hash;
+            entry["fleet_seed"] = majority->second;
+        }
+        if (s.pools_connected < s.pools_total) {
+            reasons.push_back("pool_disconnected");
+        }
+        if (s.log_errors > oldest.log_errors) {
+            reasons.push_back("errors");
+            entry["new_errors"] = s.log_errors - oldest.log_errors;
+        }
+        if (s.dataset_corrupt_items > oldest.dataset_corrupt_items) {
+            reasons.push_back("dataset_corrupt");
+        }
+        if (!reasons.empty()) {
+            entry["reasons"] = reasons;
+            list.push_back(entry);
+        }
+    }
+    return {{"median_thread_rate", fleet_median}, {"hosts", list}};
+}
+
+json FleetAggregator::stale(Clock::time_point now) const {
+    std::vector<std::pair<double, json>> found;
+    for (const auto& [name, host] : m_hosts) {
+        if (!is_stale(host, now)) {
+            continue;
+        }
+        json entry = {{"host", name},
+                      {"source", host.source},
+                      {"age_seconds", seconds(now - host.last_seen)},
+                      {"stale_after_seconds", seconds(stale_after(host))}};
+        if (!host.history.empty()) {
+            entry["last_hashrate"] = host.history.back().hashrate;
+            entry["threads"] = host.history.back().thread_rates.size();
+        }
+        found.emplace_back(seconds(now - host.last_seen), std::move(entry));
+    }
+    // Najdłużej milczące pierwsze
+    std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    json list = json::array();
+    for (auto& [age, entry] : found) {
+        list.push_back(std::move(entry));
+    }
+    return {{"hosts", list}};
+}
+
+std::string FleetAggregator::render_metrics(Clock::time_point now) const {
+    json t = totals(now);
+    std::string out;
+    append_metric_header(out, "pjurominer_fleet_hosts", "gauge", "Hosts known to the aggregator by state.");
+    out += fmt::format("pjurominer_fleet_hosts{{state=\"live\"}} {}\n", t["hosts"]["live"].get<uint64_t>());
+    out += fmt::format("pjurominer_fleet_hosts{{state=\"stale\"}} {}\n", t["hosts"]["stale"].get<uint64_t>());
+    append_metric_header(out, "pjurominer_fleet_hashrate", "gauge", "Sum of live host hashrates in H/s.");
+    out += fmt::format("pjurominer_fleet_hashrate {:.3f}\n", t["hashrate"].get<double>());
+    append_metric_header(out, "pjurominer_fleet_threads", "gauge", "Worker threads on live hosts.");
+    out += fmt::format("pjurominer_fleet_threads {}\n", t["threads"].get<uint64_t>());
+    append_metric_header(out, "pjurominer_fleet_outliers", "gauge", "Live hosts flagged as outliers.");
+    out += fmt::format("pjurominer_fleet_outliers {}\n", t["outliers"].get<uint64_t>());
+
+    append_metric_header(out, "pjurominer_fleet_host_up", "gauge", "Whether the host reported within its stale threshold.");
+    for (const auto& [name, host] : m_hosts) {
+        out += fmt::format("pjurominer_fleet_host_up{{host=\"{}\"}} {}\n", escape_label(name), is_stale(host, now) ? 0 : 1);
+    }
+    append_metric_header(out, "pjurominer_fleet_host_hashrate", "gauge", "Latest reported hashrate per host in H/s.");
+    for (const auto& [name, host] : m_hosts) {
+        if (!host.history.empty()) {
+            out += fmt::format("pjurominer_fleet_host_hashrate{{host=\"{}\"}} {:.3f}\n", escape_label(name),
+                               host.history.back().hashrate);
+        }
+    }
+
+    append_metric_header(out, "pjurominer_fleet_batches_total", "counter", "Snapshot batches received.");
+    out += fmt::format("pjurominer_fleet_batches_total {}\n", m_stats.batches);
+    append_metric_header(out, "pjurominer_fleet_lost_batches_total", "counter", "Batches missing from host sequence numbers.");
+    out += fmt::format("pjurominer_fleet_lost_batches_total {}\n", m_stats.lost_batches);
+    append_metric_header(out, "pjurominer_fleet_malformed_total", "counter", "Datagrams or frames that failed to decode.");
+    out += fmt::format("pjurominer_fleet_malformed_total {}\n", m_stats.malformed);
+    return out;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include "FleetProtocol.h"
+
+/**
+ * @struct FleetAggregatorConfig
+ * @brief Progi widoków agregatora floty.
+ */
+struct FleetAggregatorConfig {
+    // Host bez paczki dłużej niż to jest "stale" (0 = 3 odstępy między jego paczkami)
+    std::chrono::seconds stale_after{0};
+    // Host "stale" dłużej niż to znika z widoków
+    std::chrono::seconds forget_after{std::chrono::hours(24)};
+    // Odchylenie H/s na wątek od mediany floty, powyżej którego host jest odstający
+    double outlier_deviation = 0.3;
+    // Udział odrzuconych udziałów, powyżej którego host jest odstający
+    double reject_ratio = 0.05;
+};
+
+/**
+ * @class FleetAggregator
+ * @brief Scala paczki migawek z wielu minerów w stan floty i buduje z niego widoki:
+ * sumy, hosty, hosty odstające i hosty bez kontaktu (stale).
+ *
+ * Dla każdego hosta trzyma ostatnie migawki: hashrate odstających liczony
+ * jest ze średniej z kilku, a nowe błędy - z przyrostu liczników w tej
+ * historii. Restart minera (nowa instancja) czyści historię hosta. Nie jest
+ * bezpieczny wątkowo - wywoływać z jednego wątku (io_context agregatora).
+ */
+class FleetAggregator {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        uint64_t batches = 0;
+        uint64_t snapshots = 0;
+        uint64_t malformed = 0;   // Odrzucone datagramy i ramki
+        uint64_t lost_batches = 0; // Luki w numerach paczek (UDP)
+        uint64_t restarts = 0;
+    };
+
+    explicit FleetAggregator(FleetAggregatorConfig config = {});
+
+    /**
+     * @brief Dodaje paczkę od hosta.
+     * @param source Adres nadawcy ("ip:port") do widoków.
+     */
+    void ingest(const FleetBatch& batch, const std::string& source, Clock::time_point now = Clock::now());
+
+    /**
+     * @brief Liczy datagram/ramkę, której nie udało się zdekodować.
+     */
+    void record_malformed() { ++m_stats.malformed; }
+
+    /**
+     * @brief Usuwa hosty bez kontaktu dłużej niż forget_after.
+     */
+    void expire(Clock::time_point now = Clock::now());
+
+    nlohmann::json totals(Clock::time_point now = Clock::now()) const;
+    nlohmann::json hosts(Clock::time_point now = Clock::now()) const;
+    /**
+     * @brief Pojedynczy host z historią migawek; pusty obiekt, gdy brak hosta.
+     */
+    nlohmann::json host(const std::string& name, Clock::time_point now = Clock::now()) const;
+    nlohmann::json outliers(Clock::time_point now = Clock::now()) const;
+    nlohmann::json stale(Clock::time_point now = Clock::now()) const;
+
+    /**
+     * @brief Sumy i hashrate hostów w formacie tekstowym Prometheusa.
+     */
+    std::string render_metrics(Clock::time_point now = Clock::now()) const;
+
+    const Stats& stats() const { return m_stats; }
+    std::size_t host_count() const { return m_hosts.size(); }
+
+private:
+    struct Host {
+        std::string source;
+        uint64_t instance = 0;
+        uint32_t next_sequence = 0;
+        std::chrono::milliseconds interval{0};
+        std::size_t batch_size = 1;
+        Clock::time_point first_seen;
+        Clock::time_point last_seen;
+        uint64_t batches = 0;
+        uint64_t lost_batches = 0;
+        uint64_t restarts = 0;
+        std::deque<FleetSnapshot> history; // Najnowsza na końcu
+    };
+
+    std::chrono::nanoseconds stale_after(const Host& host) const;
+    bool is_stale(const Host& host, Clock::time_point now) const;
+    double average_rate(const Host& host) const;
+    nlohmann::json host_json(const std::string& name, const Host& host, Clock::time_point now) const;
+
+    FleetAggregatorConfig m_config;
+    std::map<std::string, Host> m_hosts; // Klucz: nazwa hosta (posortowane widoki)
+    Stats m_stats;
+};
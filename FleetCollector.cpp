@@ -0,0 +1,263 @@
+#include "FleetCollector.h"
+#include "Logger.h"
+#include <charconv>
+#include <vector>
+#include <fmt/core.h>
+
+using asio::ip::tcp;
+using asio::ip::udp;
+
+namespace {
+
+// Maksymalny rozmiar nagłówków żądania HTTP (jak w MetricsServer)
+constexpr std::size_t MAX_REQUEST_SIZE = 8192;
+// Co ile usuwać hosty zapomniane (forget_after)
+constexpr auto EXPIRE_INTERVAL = std::chrono::minutes(1);
+
+std::string http_response(int status, const char* reason, const char* content_type, const std::string& body) {
+    std::string response = fmt::format("HTTP/1.1 {} {}\r\n", status, reason);
+    response += fmt::format("Content-Type: {}\r\n", content_type);
+    response += fmt::format("Content-Length: {}\r\n", body.size());
+    response += "Connection: close\r\n\r\n";
+    response += body;
+    return response;
+}
+
+std::string format_endpoint(const asio::ip::address& address, uint16_t port) {
+    return address.is_v6() ? fmt::format("[{}]:{}", address.to_string(), port)
+                           : fmt::format("{}:{}", address.to_string(), port);
+}
+
+/**
+ * @brief Dekoduje "%XX" w ścieżce (nazwy hostów w /fleet/hosts/NAZWA).
+ */
+std::string percent_decode(const std::string& text) {
+    std::string out;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        unsigned value = 0;
+        if (text[i] == '%' && i + 2 < text.size()) {
+            auto [ptr, ec] = std::from_chars(text.data() + i + 1, text.data() + i + 3, value, 16);
+            if (ec == std::errc() && ptr == text.data() + i + 3) {
+                out += static_cast<char>(value);
+                i += 2;
+                continue;
+            }
+        }
+        out += text[i];
+    }
+    return out;
+}
+
+} // namespace
+
+FleetCollector::FleetCollector(asio::io_context& io_context, FleetAggregator& aggregator,
+                               const std::string& listen_address, uint16_t listen_port,
+                               const std::string& http_address, uint16_t http_port)
+        : m_io_context(io_context),
+          m_aggregator(aggregator),
+          m_udp(io_context),
+          m_ingest_acceptor(io_context),
+          m_http_acceptor(io_context),
+          m_expire_timer(io_context),
+          m_listen_address(listen_address),
+          m_listen_port(listen_port),
+          m_http_address(http_address),
+          m_http_port(http_port) {}
+
+void FleetCollector::start() {
+    auto listen = asio::ip::make_address(m_listen_address);
+    udp::endpoint udp_endpoint(listen, m_listen_port);
+    m_udp.open(udp_endpoint.protocol());
+    m_udp.bind(udp_endpoint);
+
+    tcp::endpoint ingest_endpoint(listen, m_listen_port);
+    m_ingest_acceptor.open(ingest_endpoint.protocol());
+    m_ingest_acceptor.set_option(tcp::acceptor::reuse_address(true));
+    m_ingest_acceptor.bind(ingest_endpoint);
+    m_ingest_acceptor.listen();
+
+    tcp::endpoint http_endpoint(asio::ip::make_address(m_http_address), m_http_port);
+    m_http_acceptor.open(http_endpoint.protocol());
+    m_http_acceptor.set_option(tcp::acceptor::reuse_address(true));
+    m_http_acceptor.bind(http_endpoint);
+    m_http_acceptor.listen();
+
+    LOG_INFO(LogCategory::Metrics, "[Fleet] Odbieram migawki na udp://{0} i tcp://{0}; widoki na http://{1}/fleet",
+             format_endpoint(listen, m_listen_port), format_endpoint(http_endpoint.address(), m_http_port));
+
+    do_receive();
+    do_accept_ingest();
+    do_accept_http();
+    schedule_expire();
+}
+
+void FleetCollector::stop() {
+    asio::error_code ignored;
+    m_udp.close(ignored);
+    m_ingest_acceptor.close(ignored);
+    m_http_acceptor.close(ignored);
+    m_expire_timer.cancel();
+}
+
+void FleetCollector::do_receive() {
+    auto self = shared_from_this();
+    m_udp.async_receive_from(asio::buffer(m_datagram), m_sender,
+                             [this, self](const asio::error_code& ec, std::size_t length) {
+                                 if (ec) {
+                                     if (!m_udp.is_open()) {
+                                         return;
+                                     }
+                                 } else if (auto batch = decode_fleet_batch(m_datagram.data(), length)) {
+                                     m_aggregator.ingest(*batch, format_endpoint(m_sender.address(), m_sender.port()));
+                                 } else {
+                                     m_aggregator.record_malformed();
+                                 }
+                                 do_receive();
+                             });
+}
+
+void FleetCollector::do_accept_ingest() {
+    auto self = shared_from_this();
+    auto socket = std::make_shared<tcp::socket>(m_io_context);
+    m_ingest_acceptor.async_accept(*socket, [this, self, socket](const asio::error_code& ec) {
+        if (ec) {
+            if (!m_ingest_acceptor.is_open()) {
+                return;
+            }
+        } else {
+            asio::error_code remote_ec;
+            auto remote = socket->remote_endpoint(remote_ec);
+            read_frame(socket, remote_ec ? std::string("?") : format_endpoint(remote.address(), remote.port()));
+        }
+        do_accept_ingest();
+    });
+}
+
+void FleetCollector::read_frame(std::shared_ptr<tcp::socket> socket, std::string source) {
+    auto self = shared_from_this();
+    auto header = std::make_shared<std::array<uint8_t, 4>>();
+    asio::async_read(*socket, asio::buffer(*header), [this, self, socket, source, header](const asio::error_code& ec,
+                                                                                         std::size_t) {
+        if (ec) {
+            return; // Miner zamknął połączenie
+        }
+        uint32_t length = 0;
+        for (int i = 0; i < 4; ++i) {
+            length |= static_cast<uint32_t>((*header)[i]) << (8 * i);
+        }
+        if (length == 0 || length > FLEET_MAX_FRAME) {
+            m_aggregator.record_malformed();
+            asio::error_code ignored;
+            socket->close(ignored);
+            return;
+        }
+        auto body = std::make_shared<std::vector<uint8_t>>(length);
+        asio::async_read(*socket, asio::buffer(*body), [this, self, socket, source, body](const asio::error_code& body_ec,
+                                                                                         std::size_t) {
+            if (body_ec) {
+                return;
+            }
+            auto batch = decode_fleet_batch(body->data(), body->size());
+            if (!batch) {
+                // Po błędnej ramce strumień jest nie do odczytania - miner połączy się ponownie
+                m_aggregator.record_malformed();
+                asio::error_code ignored;
+                socket->close(ignored);
+                return;
+            }
+            m_aggregator.ingest(*batch, source);
+            read_frame(socket, source);
+        });
+    });
+}
+
+void FleetCollector::do_accept_http() {
+    auto self = shared_from_this();
+    auto socket = std::make_shared<tcp::socket>(m_io_context);
+    m_http_acceptor.async_accept(*socket, [this, self, socket](const asio::error_code& ec) {
+        if (ec) {
+            if (!m_http_acceptor.is_open()) {
+                return;
+            }
+        } else {
+            handle_http(socket);
+        }
+        do_accept_http();
+    });
+}
+
+void FleetCollector::handle_http(std::shared_ptr<tcp::socket> socket) {
+    auto self = shared_from_this();
+    auto buffer = std::make_shared<asio::streambuf>(MAX_REQUEST_SIZE);
+    asio::async_read_until(*socket, *buffer, "\r\n\r\n",
+                           [this, self, socket, buffer](const asio::error_code& ec, std::size_t) {
+                               if (ec) {
+                                   asio::error_code ignored;
+                                   socket->close(ignored);
+                                   return;
+                               }
+                               std::istream is(buffer.get());
+                               std::string request_line;
+                               std::getline(is, request_line);
+                               if (!request_line.empty() && request_line.back() == '\r') {
+                                   request_line.pop_back();
+                               }
+                               auto response = std::make_shared<std::string>(build_response(request_line));
+                               asio::async_write(*socket, asio::buffer(*response),
+                                                 [socket, response](const asio::error_code&, std::size_t) {
+                                                     asio::error_code ignored;
+                                                     socket->shutdown(tcp::socket::shutdown_both, ignored);
+                                                     socket->close(ignored);
+                                                 });
+                           });
+}
+
+std::string FleetCollector::build_response(const std::string& request_line) {
+    auto first_space = request_line.find(' ');
+    auto second_space = request_line.find(' ', first_space + 1);
+    if (first_space == std::string::npos || second_space == std::string::npos) {
+        return http_response(400, "Bad Request", "text/plain", "bad request\n");
+    }
+    std::string method = request_line.substr(0, first_space);
+    std::string target = request_line.substr(first_space + 1, second_space - first_space - 1);
+    if (method != "GET") {
+        return http_response(405, "Method Not Allowed", "text/plain", "method not allowed\n");
+    }
+    target = target.substr(0, target.find('?'));
+
+    if (target == "/fleet" || target == "/fleet/") {
+        return http_response(200, "OK", "application/json", m_aggregator.totals().dump());
+    }
+    if (target == "/fleet/hosts") {
+        return http_response(200, "OK", "application/json", m_aggregator.hosts().dump());
+    }
+    if (target.starts_with("/fleet/hosts/")) {
+        auto host = m_aggregator.host(percent_decode(target.substr(13)));
+        if (host.empty()) {
+            return http_response(404, "Not Found", "text/plain", "unknown host\n");
+        }
+        return http_response(200, "OK", "application/json", host.dump());
+    }
+    if (target == "/fleet/outliers") {
+        return http_response(200, "OK", "application/json", m_aggregator.outliers().dump());
+    }
+    if (target == "/fleet/stale") {
+        return http_response(200, "OK", "application/json", m_aggregator.stale().dump());
+    }
+    if (target == "/metrics") {
+        return http_response(200, "OK", "text/plain; version=0.0.4; charset=utf-8", m_aggregator.render_metrics());
+    }
+    return http_response(404, "Not Found", "text/plain", "not found\n");
+}
+
+void FleetCollector::schedule_expire() {
+    auto self = shared_from_this();
+    m_expire_timer.expires_after(EXPIRE_INTERVAL);
+    m_expire_timer.async_wait([this, self](const asio::error_code& ec) {
+        if (ec) {
+            return;
+        }
+        m_aggregator.expire();
+        schedule_expire();
+    });
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <asio.hpp>
+
+#include "FleetAggregator.h"
+
+/**
+ * @class FleetCollector
+ * @brief Gniazda agregatora floty na jednym io_context: odbiór paczek
+ * (UDP i TCP na tym samym porcie) i HTTP z widokami FleetAggregator.
+ *
+ * HTTP (JSON, jedno żądanie GET na połączenie):
+ * /fleet (sumy), /fleet/hosts, /fleet/hosts/NAZWA (z historią),
+ * /fleet/outliers, /fleet/stale oraz /metrics (Prometheus).
+ */
+class FleetCollector : public std::enable_shared_from_this<FleetCollector> {
+public:
+    FleetCollector(asio::io_context& io_context, FleetAggregator& aggregator,
+                   const std::string& listen_address, uint16_t listen_port,
+                   const std::string& http_address, uint16_t http_port);
+
+    /**
+     * @brief Otwiera gniazda i zaczyna odbiór.
+     * @throws std::system_error jeśli nie można powiązać portu.
+     */
+    void start();
+
+    void stop();
+
+private:
+    void do_receive();
+    void do_accept_ingest();
+    void read_frame(std::shared_ptr<asio::ip::tcp::socket> socket, std::string source);
+    void do_accept_http();
+    void handle_http(std::shared_ptr<asio::ip::tcp::socket> socket);
+    std::string build_response(const std::string& request_line);
+    void schedule_expire();
+
+    asio::io_context& m_io_context;
+    FleetAggregator& m_aggregator;
+    asio::ip::udp::socket m_udp;
+    asio::ip::tcp::acceptor m_ingest_acceptor;
+    asio::ip::tcp::acceptor m_http_acceptor;
+    asio::steady_timer m_expire_timer;
+    asio::ip::udp::endpoint m_sender;
+    std::array<uint8_t, 65536> m_datagram{};
+    std::string m_listen_address;
+    uint16_t m_listen_port;
+    std::string m_http_address;
+    uint16_t m_http_port;
+};
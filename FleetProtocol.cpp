@@ -0,0 +1,285 @@
+#include "FleetProtocol.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+constexpr uint8_t MAGIC[4] = {'P', 'J', 'F', 'T'};
+// Wątków w migawce nie więcej niż dopuszcza --threads
+constexpr std::size_t MAX_THREADS = 4096;
+
+class Writer {
+public:
+    void byte(uint8_t value) { m_out.push_back(static_cast<char>(value)); }
+
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            byte(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        byte(static_cast<uint8_t>(value));
+    }
+
+    void f32(float value) {
+        uint32_t bits = std::bit_cast<uint32_t>(value);
+        for (int i = 0; i < 4; ++i) {
+            byte(static_cast<uint8_t>(bits >> (8 * i)));
+        }
+    }
+
+    void bytes(const std::string& value) {
+        varint(value.size());
+        m_out += value;
+    }
+
+    std::string& out() { return m_out; }
+
+private:
+    std::string m_out;
+};
+
+class Reader {
+public:
+    Reader(const uint8_t* data, std::size_t size) : m_data(data), m_size(size) {}
+
+    bool byte(uint8_t& value) {
+        if (m_pos >= m_size) {
+            return false;
+        }
+        value = m_data[m_pos++];
+        return true;
+    }
+
+    bool varint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = 0;
+            if (!byte(b)) {
+                return false;
+            }
+            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename T>
+    bool varint_as(T& value) {
+        uint64_t raw = 0;
+        if (!varint(raw) || raw > static_cast<uint64_t>(std::numeric_limits<T>::max())) {
+            return false;
+        }
+        value = static_cast<T>(raw);
+        return true;
+    }
+
+    bool f32(float& value) {
+        if (m_size - m_pos < 4) {
+            return false;
+        }
+        uint32_t bits = 0;
+        for (int i = 0; i < 4; ++i) {
+            bits |= static_cast<uint32_t>(m_data[m_pos + i]) << (8 * i);
+        }
+        m_pos += 4;
+        value = std::bit_cast<float>(bits);
+        return true;
+    }
+
+    bool bytes(std::string& value, std::size_t length) {
+        if (m_size - m_pos < length) {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char*>(m_data + m_pos), length);
+        m_pos += length;
+        return true;
+    }
+
+    bool string(std::string& value) {
+        uint64_t length = 0;
+        return varint(length) && length <= m_size - m_pos && bytes(value, static_cast<std::size_t>(length));
+    }
+
+    std::size_t remaining() const { return m_size - m_pos; }
+    const uint8_t* cursor() const { return m_data + m_pos; }
+    void skip(std::size_t count) { m_pos += std::min(count, remaining()); }
+
+private:
+    const uint8_t* m_data;
+    std::size_t m_size;
+    std::size_t m_pos = 0;
+};
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * @brief Seed zwykle jest 64-znakowym hexem - wysyłany jako 32 bajty.
+ * Długość niesie flagę: (len << 1) | 1 = bajty z hexa, (len << 1) = tekst.
+ */
+void write_seed(Writer& w, const std::string& seed) {
+    bool hex = seed.size() % 2 == 0 &&
+               std::all_of(seed.begin(), seed.end(), [](char c) { return hex_value(c) >= 0; });
+    if (!hex) {
+        w.varint(static_cast<uint64_t>(seed.size()) << 1);
+        w.out() += seed;
+        return;
+    }
+    w.varint((static_cast<uint64_t>(seed.size() / 2) << 1) | 1);
+    for (std::size_t i = 0; i < seed.size(); i += 2) {
+        w.byte(static_cast<uint8_t>(hex_value(seed[i]) << 4 | hex_value(seed[i + 1])));
+    }
+}
+
+bool read_seed(Reader& r, std::string& seed) {
+    uint64_t tagged = 0;
+    if (!r.varint(tagged) || (tagged >> 1) > r.remaining()) {
+        return false;
+    }
+    std::string raw;
+    if (!r.bytes(raw, static_cast<std::size_t>(tagged >> 1))) {
+        return false;
+    }
+    if (!(tagged & 1)) {
+        seed = std::move(raw);
+        return true;
+    }
+    static constexpr char DIGITS[] = "0123456789abcdef";
+    seed.clear();
+    for (unsigned char c : raw) {
+        seed += DIGITS[c >> 4];
+        seed += DIGITS[c & 0x0F];
+    }
+    return true;
+}
+
+void write_snapshot(Writer& w, const FleetSnapshot& s) {
+    w.varint(static_cast<uint64_t>(std::max<int64_t>(0, s.time_ms)));
+    w.varint(s.uptime_seconds);
+    w.f32(s.hashrate);
+    w.f32(s.hashrate_ewma);
+    w.varint(s.thread_rates.size());
+    for (float rate : s.thread_rates) {
+        w.f32(rate);
+    }
+    w.varint(s.shares_accepted);
+    w.varint(s.shares_rejected);
+    w.varint(s.shares_stale);
+    w.varint(s.pools_connected);
+    w.varint(s.pools_total);
+    w.byte(static_cast<uint8_t>(s.dataset_state));
+    w.f32(s.dataset_progress);
+    w.f32(s.dataset_build_seconds);
+    w.varint(s.seed_epoch);
+    write_seed(w, s.seed_hash);
+    w.bytes(s.algorithm);
+    w.varint(s.log_warnings);
+    w.varint(s.log_errors);
+    w.varint(s.pool_reconnects);
+    w.varint(s.watchdog_repairs);
+    w.varint(s.dataset_corrupt_items);
+}
+
+bool read_snapshot(Reader& r, FleetSnapshot& s) {
+    uint64_t time_ms = 0;
+    uint64_t threads = 0;
+    uint8_t state = 0;
+    if (!r.varint(time_ms) || !r.varint(s.uptime_seconds) || !r.f32(s.hashrate) || !r.f32(s.hashrate_ewma) ||
+        !r.varint(threads) || threads > MAX_THREADS) {
+        return false;
+    }
+    s.time_ms = static_cast<int64_t>(time_ms);
+    s.thread_rates.resize(static_cast<std::size_t>(threads));
+    for (float& rate : s.thread_rates) {
+        if (!r.f32(rate)) {
+            return false;
+        }
+    }
+    if (!r.varint(s.shares_accepted) || !r.varint(s.shares_rejected) || !r.varint(s.shares_stale) ||
+        !r.varint_as(s.pools_connected) || !r.varint_as(s.pools_total) || !r.byte(state) ||
+        state > static_cast<uint8_t>(FleetDatasetState::Light) || !r.f32(s.dataset_progress) ||
+        !r.f32(s.dataset_build_seconds) || !r.varint(s.seed_epoch) || !read_seed(r, s.seed_hash) ||
+        !r.string(s.algorithm)) {
+        return false;
+    }
+    s.dataset_state = static_cast<FleetDatasetState>(state);
+    return r.varint(s.log_warnings) && r.varint(s.log_errors) && r.varint(s.pool_reconnects) &&
+           r.varint(s.watchdog_repairs) && r.varint(s.dataset_corrupt_items);
+}
+
+} // namespace
+
+const char* fleet_dataset_state_name(FleetDatasetState state) {
+    switch (state) {
+        case FleetDatasetState::None: return "none";
+        case FleetDatasetState::Building: return "building";
+        case FleetDatasetState::Ready: return "ready";
+        case FleetDatasetState::Light: return "light";
+    }
+    return "unknown";
+}
+
+std::string encode_fleet_batch(const FleetBatch& batch) {
+    Writer w;
+    for (uint8_t b : MAGIC) {
+        w.byte(b);
+    }
+    w.byte(FLEET_PROTOCOL_VERSION);
+    w.bytes(batch.host.substr(0, 255));
+    w.varint(batch.instance);
+    w.varint(batch.sequence);
+    w.varint(batch.interval_ms);
+    w.varint(batch.snapshots.size());
+    for (const auto& snapshot : batch.snapshots) {
+        Writer body;
+        write_snapshot(body, snapshot);
+        w.bytes(body.out());
+    }
+    return std::move(w.out());
+}
+
+std::optional<FleetBatch> decode_fleet_batch(const uint8_t* data, std::size_t size) {
+    if (size < sizeof(MAGIC) + 1 || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 ||
+        data[sizeof(MAGIC)] != FLEET_PROTOCOL_VERSION) {
+        return std::nullopt;
+    }
+    Reader r(data + sizeof(MAGIC) + 1, size - sizeof(MAGIC) - 1);
+    FleetBatch batch;
+    uint64_t count = 0;
+    if (!r.string(batch.host) || batch.host.empty() || batch.host.size() > 255 || !r.varint(batch.instance) ||
+        !r.varint_as(batch.sequence) || !r.varint_as(batch.interval_ms) || !r.varint(count) ||
+        count > r.remaining()) {
+        return std::nullopt;
+    }
+    batch.snapshots.resize(static_cast<std::size_t>(count));
+    for (auto& snapshot : batch.snapshots) {
+        uint64_t length = 0;
+        if (!r.varint(length) || length > r.remaining()) {
+            return std::nullopt;
+        }
+        Reader body(r.cursor(), static_cast<std::size_t>(length));
+        if (!read_snapshot(body, snapshot)) {
+            return std::nullopt;
+        }
+        r.skip(static_cast<std::size_t>(length)); // Razem z polami nieznanymi tej wersji
+    }
+    return batch;
+}
+
+std::string encode_fleet_frame(const FleetBatch& batch) {
+    std::string body = encode_fleet_batch(batch);
+    std::string frame(4, '\0');
+    auto length = static_cast<uint32_t>(body.size());
+    for (int i = 0; i < 4; ++i) {
+        frame[i] = static_cast<char>(length >> (8 * i));
+    }
+    return frame + body;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @file FleetProtocol.h
+ * @brief Binarny format migawek wysyłanych przez minery do agregatora floty
+ * (pjurominer_fleet).
+ *
+ * Paczka: nagłówek (magia "PJFT", wersja, host, instancja, numer paczki,
+ * interwał próbkowania), potem migawki, każda poprzedzona swoją długością.
+ * Liczby całkowite jako LEB128, tempa jako float32 little-endian. Dekoder
+ * pomija nieznane pola na końcu migawki, więc nowsze minery mogą dopisywać
+ * pola bez zmiany wersji. Przez UDP paczka to jeden datagram, przez TCP -
+ * ramka poprzedzona długością (uint32 little-endian).
+ */
+
+constexpr uint8_t FLEET_PROTOCOL_VERSION = 1;
+// Cel dla datagramu UDP (poniżej typowego MTU); większa paczka jest dzielona
+constexpr std::size_t FLEET_MAX_DATAGRAM = 1400;
+// Górna granica ramki TCP - chroni agregator przed zalaniem pamięci
+constexpr std::size_t FLEET_MAX_FRAME = 1 << 20;
+
+/**
+ * @enum FleetDatasetState
+ * @brief Stan pamięci RandomX hosta.
+ */
+enum class FleetDatasetState : uint8_t {
+    None,     // Brak seeda (przed pierwszą pracą)
+    Building, // Trwa budowa datasetu lub cache'a
+    Ready,    // Tryb fast, dataset gotowy
+    Light,    // Tryb light (tylko cache)
+};
+
+const char* fleet_dataset_state_name(FleetDatasetState state);
+
+/**
+ * @struct FleetSnapshot
+ * @brief Jedna próbka stanu minera. Liczniki są skumulowane od startu
+ * instancji - agregator liczy przyrosty sam.
+ */
+struct FleetSnapshot {
+    int64_t time_ms = 0;              // system_clock, ms od epoki
+    uint64_t uptime_seconds = 0;
+    float hashrate = 0.0f;            // H/s w najkrótszym oknie telemetrii
+    float hashrate_ewma = 0.0f;
+    std::vector<float> thread_rates;  // H/s per wątek (to samo okno)
+
+    uint64_t shares_accepted = 0;
+    uint64_t shares_rejected = 0;
+    uint64_t shares_stale = 0;
+    uint32_t pools_connected = 0;
+    uint32_t pools_total = 0;
+
+    FleetDatasetState dataset_state = FleetDatasetState::None;
+    float dataset_progress = 0.0f;    // 0-1 przy Building
+    float dataset_build_seconds = 0.0f;
+    uint64_t seed_epoch = 0;
+    std::string seed_hash;            // Hex (jak w Stratum); pusty = brak
+    std::string algorithm;
+
+    uint64_t log_warnings = 0;
+    uint64_t log_errors = 0;
+    uint64_t pool_reconnects = 0;
+    uint64_t watchdog_repairs = 0;    // Przepięcia, nowe VM i restarty workerów
+    uint64_t dataset_corrupt_items = 0;
+};
+
+/**
+ * @struct FleetBatch
+ * @brief Paczka migawek jednego hosta.
+ */
+struct FleetBatch {
+    std::string host;          // Nazwa hosta (--fleet-host), maks. 255 bajtów
+    uint64_t instance = 0;     // Losowa przy starcie procesu - agregator wykrywa restarty
+    uint32_t sequence = 0;     // Numer paczki w instancji - luki to paczki zgubione
+    uint32_t interval_ms = 0;  // Odstęp między migawkami (wykrywanie hostów bez kontaktu)
+    std::vector<FleetSnapshot> snapshots;
+};
+
+/**
+ * @brief Koduje paczkę (bez ramki TCP).
+ */
+std::string encode_fleet_batch(const FleetBatch& batch);
+
+/**
+ * @brief Dekoduje paczkę; std::nullopt przy błędnej magii, wersji lub obciętych danych.
+ */
+std::optional<FleetBatch> decode_fleet_batch(const uint8_t* data, std::size_t size);
+
+/**
+ * @brief Koduje paczkę jako ramkę TCP (długość + treść).
+ */
+std::string encode_fleet_frame(const FleetBatch& batch);
@@ -0,0 +1,280 @@
+#include "FleetReporter.h"
+#include "Logger.h"
+#include <algorithm>
+#include <charconv>
+#include <random>
+#include <stdexcept>
+#include <fmt/core.h>
+
+namespace {
+
+// Paczki czekające na wysyłkę (TCP bez połączenia); przy przepełnieniu giną najstarsze
+constexpr std::size_t MAX_OUTBOX = 64;
+
+uint64_t random_instance() {
+    std::random_device rd;
+    uint64_t high = rd();
+    return (high << 32 | rd()) ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+} // namespace
+
+void parse_fleet_collector(const std::string& value, FleetConfig& config) {
+    std::string rest = value;
+    config.transport = FleetConfig::Transport::Udp;
+    if (rest.starts_with("udp://")) {
+        rest.erase(0, 6);
+    } else if (rest.starts_with("tcp://")) {
+        config.transport = FleetConfig::Transport::Tcp;
+        rest.erase(0, 6);
+    } else if (rest.find("://") != std::string::npos) {
+        throw std::invalid_argument(fmt::format("Nieobsługiwany schemat kolektora floty: '{}' (udp:// lub tcp://)", value));
+    }
+
+    auto colon = rest.rfind(':');
+    unsigned port = 0;
+    if (colon != std::string::npos) {
+        auto [ptr, ec] = std::from_chars(rest.data() + colon + 1, rest.data() + rest.size(), port);
+        if (ec != std::errc() || ptr != rest.data() + rest.size()) {
+            port = 0;
+        }
+    }
+    if (colon == std::string::npos || colon == 0 || port == 0 || port > 65535) {
+        throw std::invalid_argument(fmt::format("Oczekiwano [udp://|tcp://]HOST:PORT dla --fleet-collector, otrzymano '{}'", value));
+    }
+    config.collector_host = rest.substr(0, colon);
+    if (config.collector_host.size() > 2 && config.collector_host.front() == '[' && config.collector_host.back() == ']') {
+        config.collector_host = config.collector_host.substr(1, config.collector_host.size() - 2); // [::1]:9300
+    }
+    config.collector_port = std::to_string(port);
+}
+
+std::string format_fleet_collector(const FleetConfig& config) {
+    bool ipv6 = config.collector_host.find(':') != std::string::npos;
+    return fmt::format("{}://{}{}{}:{}", config.transport == FleetConfig::Transport::Tcp ? "tcp" : "udp",
+                       ipv6 ? "[" : "", config.collector_host, ipv6 ? "]" : "", config.collector_port);
+}
+
+FleetReporter::FleetReporter(asio::io_context& io_context, FleetConfig config, SnapshotProvider provider)
+        : m_config(std::move(config)),
+          m_provider(std::move(provider)),
+          m_timer(io_context),
+          m_udp(io_context),
+          m_tcp(io_context),
+          m_udp_resolver(io_context),
+          m_tcp_resolver(io_context),
+          m_instance(random_instance()) {
+    if (m_config.host.empty()) {
+        asio::error_code ec;
+        m_config.host = asio::ip::host_name(ec);
+        if (ec || m_config.host.empty()) {
+            m_config.host = "pjurominer";
+        }
+    }
+    m_config.batch = std::max(1u, m_config.batch);
+}
+
+void FleetReporter::start() {
+    LOG_INFO(LogCategory::Metrics, "[Fleet] Migawki dla {} co {} s (po {} w paczce) do {}", m_config.host,
+             m_config.interval.count(), m_config.batch, format_fleet_collector(m_config));
+    schedule_sample();
+}
+
+void FleetReporter::stop() {
+    m_stopped = true;
+    asio::error_code ignored;
+    m_timer.cancel();
+    m_udp_resolver.cancel();
+    m_tcp_resolver.cancel();
+    m_udp.close(ignored);
+    m_tcp.close(ignored);
+}
+
+void FleetReporter::schedule_sample() {
+    auto self = shared_from_this();
+    m_timer.expires_after(m_config.interval);
+    m_timer.async_wait([this, self](const asio::error_code& ec) {
+        if (ec || m_stopped) {
+            return;
+        }
+        m_samples.push_back(m_provider());
+        if (m_samples.size() >= m_config.batch) {
+            flush();
+        }
+        schedule_sample();
+    });
+}
+
+void FleetReporter::flush() {
+    std::vector<FleetSnapshot> samples;
+    samples.swap(m_samples);
+    enqueue(std::move(samples));
+    while (m_outbox.size() > MAX_OUTBOX) {
+        m_stats.snapshots_dropped += m_outbox.front().snapshots;
+        m_outbox.pop_front();
+    }
+    send_next();
+}
+
+void FleetReporter::enqueue(std::vector<FleetSnapshot> snapshots) {
+    FleetBatch batch;
+    batch.host = m_config.host;
+    batch.instance = m_instance;
+    batch.sequence = m_sequence;
+    batch.interval_ms = static_cast<uint32_t>(std::chrono::milliseconds(m_config.interval).count());
+    std::size_t count = snapshots.size();
+    batch.snapshots = std::move(snapshots);
+
+    if (m_config.transport == FleetConfig::Transport::Tcp) {
+        ++m_sequence;
+        m_outbox.push_back({encode_fleet_frame(batch), count});
+        return;
+    }
+    std::string datagram = encode_fleet_batch(batch);
+    if (datagram.size() > FLEET_MAX_DATAGRAM && count > 1) {
+        // Wiele wątków na hosta: połówki w osobnych datagramach (każda z własnym numerem)
+        std::vector<FleetSnapshot> second(std::make_move_iterator(batch.snapshots.begin() + count / 2),
+                                          std::make_move_iterator(batch.snapshots.end()));
+        batch.snapshots.resize(count / 2);
+        enqueue(std::move(batch.snapshots));
+        enqueue(std::move(second));
+        return;
+    }
+    ++m_sequence;
+    m_outbox.push_back({std::move(datagram), count});
+}
+
+void FleetReporter::send_next() {
+    if (m_busy || m_stopped || m_outbox.empty()) {
+        return;
+    }
+    auto self = shared_from_this();
+    if (m_config.transport == FleetConfig::Transport::Udp) {
+        if (m_udp_endpoints.empty()) {
+            resolve();
+            return;
+        }
+        m_busy = true;
+        m_udp.async_send_to(asio::buffer(m_outbox.front().payload), m_udp_endpoints.front(),
+                            [this, self](const asio::error_code& ec, std::size_t bytes) {
+                                m_busy = false;
+                                if (m_stopped) {
+                                    return;
+                                }
+                                if (ec) {
+                                    // Datagram nie wraca - agregator zobaczy lukę w numerach
+                                    m_stats.snapshots_dropped += m_outbox.front().snapshots;
+                                    m_outbox.pop_front();
+                                    on_send_error(ec);
+                                    return;
+                                }
+                                ++m_stats.batches_sent;
+                                m_stats.snapshots_sent += m_outbox.front().snapshots;
+                                m_stats.bytes_sent += bytes;
+                                m_outbox.pop_front();
+                                send_next();
+                            });
+        return;
+    }
+
+    if (!m_tcp.is_open()) {
+        connect();
+        return;
+    }
+    m_busy = true;
+    asio::async_write(m_tcp, asio::buffer(m_outbox.front().payload),
+                      [this, self](const asio::error_code& ec, std::size_t bytes) {
+                          m_busy = false;
+                          if (m_stopped) {
+                              return;
+                          }
+                          if (ec) {
+                              // Paczka zostaje w kolejce do następnego połączenia
+                              on_send_error(ec);
+                              return;
+                          }
+                          ++m_stats.batches_sent;
+                          m_stats.snapshots_sent += m_outbox.front().snapshots;
+                          m_stats.bytes_sent += bytes;
+                          m_outbox.pop_front();
+                          send_next();
+                      });
+}
+
+void FleetReporter::resolve() {
+    auto self = shared_from_this();
+    m_busy = true;
+    m_udp_resolver.async_resolve(
+            m_config.collector_host, m_config.collector_port,
+            [this, self](const asio::error_code& ec, asio::ip::udp::resolver::results_type results) {
+                m_busy = false;
+                if (m_stopped) {
+                    return;
+                }
+                if (ec || results.empty()) {
+                    on_send_error(ec ? ec : asio::error::host_not_found);
+                    return;
+                }
+                m_udp_endpoints.assign(results.begin(), results.end());
+                asio::error_code open_ec;
+                m_udp.close(open_ec);
+                m_udp.open(m_udp_endpoints.front().protocol(), open_ec);
+                if (open_ec) {
+                    m_udp_endpoints.clear();
+                    on_send_error(open_ec);
+                    return;
+                }
+                m_stats.connected = true;
+                send_next();
+            });
+}
+
+void FleetReporter::connect() {
+    auto self = shared_from_this();
+    m_busy = true;
+    m_tcp_resolver.async_resolve(
+            m_config.collector_host, m_config.collector_port,
+            [this, self](const asio::error_code& ec, asio::ip::tcp::resolver::results_type results) {
+                if (m_stopped) {
+                    m_busy = false;
+                    return;
+                }
+                if (ec) {
+                    m_busy = false;
+                    on_send_error(ec);
+                    return;
+                }
+                asio::async_connect(m_tcp, results, [this, self](const asio::error_code& connect_ec,
+                                                                 const asio::ip::tcp::endpoint&) {
+                    m_busy = false;
+                    if (m_stopped) {
+                        return;
+                    }
+                    if (connect_ec) {
+                        on_send_error(connect_ec);
+                        return;
+                    }
+                    asio::error_code ignored;
+                    m_tcp.set_option(asio::ip::tcp::no_delay(true), ignored);
+                    m_stats.connected = true;
+                    LOG_INFO(LogCategory::Metrics, "[Fleet] Połączono z kolektorem {}", format_fleet_collector(m_config));
+                    send_next();
+                });
+            });
+}
+
+void FleetReporter::on_send_error(const asio::error_code& ec) {
+    ++m_stats.send_errors;
+    // Jeden komunikat na awarię; kolejne próby przy następnych wysyłkach
+    if (m_stats.connected || m_stats.send_errors == 1) {
+        LOG_WARN(LogCategory::Metrics, "[Fleet] Wysyłka do {} nieudana: {} - ponowię przy następnej paczce.",
+                 format_fleet_collector(m_config), ec.message());
+    }
+    m_stats.connected = false;
+    asio::error_code ignored;
+    if (m_config.transport == FleetConfig::Transport::Tcp) {
+        m_tcp.close(ignored);
+    } else {
+        m_udp_endpoints.clear(); // Rozwiązanie nazwy od nowa (kolektor mógł zmienić adres)
+    }
+}
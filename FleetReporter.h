@@ -0,0 +1,106 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <asio.hpp>
+
+#include "FleetProtocol.h"
+
+/**
+ * @struct FleetConfig
+ * @brief Wysyłka migawek do agregatora floty (--fleet-collector).
+ */
+struct FleetConfig {
+    enum class Transport { Udp, Tcp };
+
+    std::string collector_host; // Pusty = wysyłka wyłączona
+    std::string collector_port;
+    Transport transport = Transport::Udp;
+    std::chrono::seconds interval{10}; // Odstęp między migawkami
+    unsigned batch = 3;                 // Migawki w jednej wysyłce
+    std::string host;                   // Nazwa w agregatorze (pusta = nazwa hosta)
+
+    bool enabled() const { return !collector_host.empty(); }
+    bool operator==(const FleetConfig&) const = default;
+};
+
+/**
+ * @brief Parsuje adres kolektora "udp://HOST:PORT" lub "tcp://HOST:PORT"
+ * (bez schematu = UDP) do pól konfiguracji.
+ * @throws std::invalid_argument przy błędnym adresie.
+ */
+void parse_fleet_collector(const std::string& value, FleetConfig& config);
+
+/**
+ * @brief Adres kolektora w postaci "udp://host:port" (logi, status).
+ */
+std::string format_fleet_collector(const FleetConfig& config);
+
+/**
+ * @class FleetReporter
+ * @brief Co interval zbiera migawkę, a co batch migawek wysyła je paczką
+ * do kolektora (wątek io_context).
+ *
+ * UDP: paczka to datagram (za duża jest dzielona), zgubione nie wracają -
+ * agregator widzi je jako luki w numerach paczek. TCP: jedno trwałe
+ * połączenie; paczki czekają w ograniczonej kolejce na ponowne połączenie
+ * (przy każdej kolejnej wysyłce), a przy przepełnieniu giną najstarsze.
+ */
+class FleetReporter : public std::enable_shared_from_this<FleetReporter> {
+public:
+    using SnapshotProvider = std::function<FleetSnapshot()>;
+
+    struct Stats {
+        uint64_t batches_sent = 0;
+        uint64_t snapshots_sent = 0;
+        uint64_t bytes_sent = 0;
+        uint64_t snapshots_dropped = 0; // Przepełniona kolejka lub nieudana wysyłka UDP
+        uint64_t send_errors = 0;
+        bool connected = false;         // TCP: połączenie otwarte; UDP: adres rozwiązany
+    };
+
+    FleetReporter(asio::io_context& io_context, FleetConfig config, SnapshotProvider provider);
+
+    void start();
+    void stop();
+
+    Stats stats() const { return m_stats; }
+    const FleetConfig& config() const { return m_config; }
+
+private:
+    struct Pending {
+        std::string payload; // Datagram lub ramka TCP
+        std::size_t snapshots = 0;
+    };
+
+    void schedule_sample();
+    void flush();
+    void enqueue(std::vector<FleetSnapshot> snapshots);
+    void resolve();
+    void connect();
+    void send_next();
+    void on_send_error(const asio::error_code& ec);
+
+    FleetConfig m_config;
+    SnapshotProvider m_provider;
+    asio::steady_timer m_timer;
+    asio::ip::udp::socket m_udp;
+    asio::ip::tcp::socket m_tcp;
+    asio::ip::udp::resolver m_udp_resolver;
+    asio::ip::tcp::resolver m_tcp_resolver;
+    std::vector<asio::ip::udp::endpoint> m_udp_endpoints;
+
+    uint64_t m_instance = 0;
+    uint32_t m_sequence = 0;
+    std::vector<FleetSnapshot> m_samples;
+    std::deque<Pending> m_outbox;
+    bool m_busy = false;    // Trwa rozwiązywanie, łączenie lub wysyłka
+    bool m_stopped = false;
+    Stats m_stats;
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "RandomXAlgorithm.h"
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @concept HashBackend
+ * @brief Funkcja skrótu, którą liczy MinerWorker (wybierana przy kompilacji).
+ *
+ * Backend jest polem workera, a nie interfejsem wirtualnym: gorąca pętla
+ * woła hash_bytes() bezpośrednio i kompilator może ją wstawić. Wymagania:
+ *  - bind(algorithm, cache, dataset): wskazuje zasoby managera (true = bez odtwarzania),
+ *  - hash_bytes(input, size, output): 32 bajty wyniku (false = backend niegotowy),
+ *  - release(): zwalnia VM, następny bind() tworzy ją od nowa (naprawa przez watchdog),
+ *  - BACKEND_NAME: nazwa do logów i metryk,
+ *  - HASH_BATCH: hashe liczone pod jedną blokadą datasetu i rozliczane
+ *    w telemetrii razem (1 dla RandomX - hash trwa ~1 ms; więcej dla
+ *    szybkich backendów, u których narzut pętli przeważałby nad hashem).
+ */
+template <typename T>
+concept HashBackend = requires(T backend, const RandomXAlgorithm& algorithm, randomx_cache* cache,
+                               randomx_dataset* dataset, const void* input, size_t size, void* output) {
+    { backend.bind(algorithm, cache, dataset) } -> std::same_as<bool>;
+    { backend.hash_bytes(input, size, output) } -> std::same_as<bool>;
+    { backend.release() } -> std::same_as<void>;
+    { T::BACKEND_NAME } -> std::convertible_to<const char*>;
+    { T::HASH_BATCH } -> std::convertible_to<uint32_t>;
+};
+
+// Backend wybierany opcją CMake PJUROMINER_STUB_BACKEND (domyślnie RandomX)
+#ifdef PJUROMINER_STUB_BACKEND
+#include "StubHasher.h"
+using MinerHashBackend = StubHasher;
+#else
+#include "RandomXHasher.h"
+using MinerHashBackend = RandomXHasher;
+#endif
+
+static_assert(HashBackend<MinerHashBackend>, "MinerHashBackend nie spełnia HashBackend");
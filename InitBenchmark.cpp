@@ -0,0 +1,198 @@
+#include "InitBenchmark.h"
+#include "DatasetInit.h"
+#include "DatasetKernel.h"
+#include "RandomXAlgorithm.h"
+#include "ThreadAffinity.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+namespace {
+
+struct BenchOptions {
+    std::vector<unsigned> threads;
+    uint64_t items = 0; // 0 = cały dataset
+    bool numa = true;
+    const RandomXAlgorithm* algorithm = &default_randomx_algorithm();
+    std::vector<DatasetKernel> kernels; // Pusta = biblioteka i obsługiwane kernele
+    std::string json_file;
+};
+
+unsigned parse_count(const std::string& option, std::string_view text) {
+    unsigned value = 0;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc() || ptr != text.data() + text.size() || value == 0) {
+        throw std::invalid_argument(fmt::format("Nieprawidłowa wartość dla {}: '{}'", option, text));
+    }
+    return value;
+}
+
+BenchOptions parse_options(const std::vector<std::string>& args) {
+    BenchOptions options;
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        auto value = [&]() -> const std::string& {
+            if (i + 1 >= args.size()) {
+                throw std::invalid_argument(fmt::format("Brak wartości dla {}", arg));
+            }
+            return args[++i];
+        };
+        if (arg == "--threads") {
+            std::string_view list = value();
+            while (!list.empty()) {
+                auto comma = list.find(',');
+                options.threads.push_back(parse_count(arg, list.substr(0, comma)));
+                list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+            }
+        } else if (arg == "--items") {
+            options.items = parse_count(arg, value());
+        } else if (arg == "--algo") {
+            options.algorithm = find_randomx_algorithm(value());
+            if (!options.algorithm) {
+                throw std::invalid_argument(fmt::format("Nieobsługiwany algorytm: '{}'", args[i]));
+            }
+        } else if (arg == "--kernel") {
+            std::string_view list = value();
+            while (!list.empty()) {
+                auto comma = list.find(',');
+                auto kernel = parse_dataset_kernel(list.substr(0, comma));
+                if (!kernel || *kernel == DatasetKernel::Auto) {
+                    throw std::invalid_argument(fmt::format("Nieznany kernel: '{}'", list.substr(0, comma)));
+                }
+                options.kernels.push_back(*kernel);
+                list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+            }
+        } else if (arg == "--no-numa") {
+            options.numa = false;
+        } else if (arg == "--json") {
+            options.json_file = value();
+        } else {
+            throw std::invalid_argument(fmt::format("Nieznana opcja bench-init: '{}'", arg));
+        }
+    }
+    if (options.threads.empty()) {
+        unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned t = 1; t < hw; t *= 2) {
+            options.threads.push_back(t);
+        }
+        options.threads.push_back(hw);
+    }
+    return options;
+}
+
+} // namespace
+
+int run_init_benchmark(const std::vector<std::string>& args) {
+    BenchOptions options;
+    try {
+        options = parse_options(args);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << fmt::format("BŁĄD: {}\n", e.what());
+        return 1;
+    }
+
+    const RandomXAlgorithm& algorithm = *options.algorithm;
+    const RandomXApi& api = *algorithm.api;
+    randomx_flags flags = api.get_flags();
+    randomx_cache* cache = api.alloc_cache(flags);
+    randomx_dataset* dataset = api.alloc_dataset(RANDOMX_FLAG_DEFAULT);
+    if (!cache || !dataset) {
+        std::cerr << "BŁĄD: Nie udało się zaalokować cache lub datasetu RandomX.\n";
+        if (cache) api.release_cache(cache);
+        if (dataset) api.release_dataset(dataset);
+        return 1;
+    }
+
+    const char seed[] = "pjurominer bench-init";
+    api.init_cache(cache, seed, sizeof(seed) - 1);
+
+    uint64_t items = options.items ? std::min<uint64_t>(options.items, api.dataset_item_count())
+                                   : api.dataset_item_count();
+    NumaTopology topology = options.numa ? read_numa_topology() : NumaTopology{{{}}};
+    std::cout << fmt::format("Inicjalizacja datasetu {}: {} elementów, węzły NUMA: {}\n\n",
+                             algorithm.name, items, topology.nodes.size());
+
+    // Zgodność z biblioteką przed pomiarem - szybki, ale błędny dataset to odrzucone udziały
+    std::vector<DatasetKernel> kernels = options.kernels;
+    if (kernels.empty()) {
+        kernels.push_back(DatasetKernel::Library);
+        for (DatasetKernel kernel : supported_dataset_kernels(algorithm)) {
+            kernels.push_back(kernel);
+        }
+    }
+    int exit_code = 0;
+    nlohmann::json checks = nlohmann::json::array();
+    std::vector<DatasetKernel> measured;
+    for (DatasetKernel kernel : kernels) {
+        DatasetKernelCheck check = check_dataset_kernel(algorithm, dataset, cache, kernel, 4096);
+        const char* verdict = !check.supported ? "nieobsługiwany" : check.exact ? "zgodny z biblioteką" : "NIEZGODNY";
+        std::cout << fmt::format("Kernel {:<8} {}\n", dataset_kernel_name(kernel), verdict);
+        checks.push_back({{"kernel", dataset_kernel_name(kernel)}, {"supported", check.supported}, {"exact", check.exact}});
+        if (check.supported && !check.exact) {
+            exit_code = 2;
+        } else if (check.supported) {
+            measured.push_back(kernel);
+        }
+    }
+
+    std::cout << fmt::format("\n{:>8} {:>8} {:>10} {:>14} {:>9} {:>9}\n",
+                             "kernel", "wątki", "czas [s]", "elementy/s", "speedup", "vs lib");
+    nlohmann::json results = nlohmann::json::array();
+    double baseline_seconds = 0.0;
+    for (unsigned threads : options.threads) {
+        double library_seconds = 0.0;
+        for (DatasetKernel kernel : measured) {
+            DatasetInitConfig config;
+            config.threads = threads;
+            config.numa = options.numa;
+            config.worker_help = false;
+            config.helper_grace = std::chrono::milliseconds(0);
+
+            DatasetInitSession session(algorithm, dataset, cache, items, topology, threads, kernel);
+            auto start = std::chrono::steady_clock::now();
+            run_dataset_init(session, config, topology, nullptr);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            if (baseline_seconds == 0.0) {
+                baseline_seconds = seconds;
+            }
+            if (kernel == DatasetKernel::Library) {
+                library_seconds = seconds;
+            }
+            double rate = items / seconds;
+            double speedup = baseline_seconds / seconds;
+            nlohmann::json result = {{"kernel", dataset_kernel_name(kernel)}, {"threads", threads}, {"seconds", seconds},
+                                     {"items_per_second", rate}, {"speedup", speedup}};
+            std::string vs_library = "-";
+            if (library_seconds > 0.0) {
+                result["vs_library"] = library_seconds / seconds;
+                vs_library = fmt::format("{:.2f}x", library_seconds / seconds);
+            }
+            std::cout << fmt::format("{:>8} {:>8} {:>10.2f} {:>14.0f} {:>8.2f}x {:>9}\n",
+                                     dataset_kernel_name(kernel), threads, seconds, rate, speedup, vs_library);
+            results.push_back(std::move(result));
+        }
+    }
+
+    api.release_dataset(dataset);
+    api.release_cache(cache);
+
+    nlohmann::json report = {{"algo", algorithm.name}, {"items", items}, {"numa_nodes", topology.nodes.size()},
+                             {"kernels", checks}, {"results", results}};
+    if (!options.json_file.empty()) {
+        std::ofstream out(options.json_file);
+        out << report.dump(2) << "\n";
+        if (!out) {
+            std::cerr << fmt::format("BŁĄD: Nie udało się zapisać {}\n", options.json_file);
+            return 1;
+        }
+    }
+    std::cout << "\n" << report.dump() << "\n";
+    return exit_code;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Benchmark inicjalizacji datasetu: `pjurominer bench-init [opcje]`.
+ *
+ * Mierzy czas inicjalizacji dla kolejnych liczb wątków i kerneli i drukuje
+ * tabelę (czas, elementy/s, przyspieszenie względem pierwszego pomiaru i
+ * względem biblioteki przy tej samej liczbie wątków) oraz wynik JSON. Każdy
+ * kernel jest najpierw porównany bit w bit z randomx_init_dataset; niezgodny
+ * nie jest mierzony, a kod wyjścia to 2. Opcje: --threads LISTA (np. 1,2,4,8;
+ * domyślnie potęgi dwójki do liczby CPU), --items N (fragment datasetu
+ * zamiast całości), --no-numa (jeden węzeł), --algo WARIANT, --kernel LISTA
+ * (np. library,avx2; domyślnie biblioteka i kernele obsługiwane przez CPU),
+ * --json PLIK.
+ * @param args Argumenty po "bench-init".
+ * @return Kod wyjścia procesu.
+ */
+int run_init_benchmark(const std::vector<std::string>& args);
@@ -0,0 +1,60 @@
+#include "LastSeed.h"
+#include <cstdio>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+
+bool is_seed_hex(const std::string& text) {
+    return text.size() == 64 && text.find_first_not_of("0123456789abcdefABCDEF") == std::string::npos;
+}
+
+} // namespace
+
+std::optional<LastSeed> load_last_seed(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        return std::nullopt;
+    }
+    json j = json::parse(in, nullptr, false);
+    if (j.is_discarded() || !j.is_object()) {
+        return std::nullopt;
+    }
+    LastSeed seed;
+    try {
+        seed.seed_hash = j.value("seed_hash", std::string());
+        seed.algo = j.value("algo", std::string());
+        seed.pool = j.value("pool", std::string());
+        seed.saved_at = std::chrono::system_clock::time_point(std::chrono::seconds(j.value("saved_at", int64_t{0})));
+    } catch (const json::exception&) {
+        return std::nullopt;
+    }
+    if (!is_seed_hex(seed.seed_hash) || seed.algo.empty()) {
+        return std::nullopt;
+    }
+    return seed;
+}
+
+bool save_last_seed(const std::string& path, const LastSeed& seed) {
+    json j = {{"seed_hash", seed.seed_hash},
+              {"algo", seed.algo},
+              {"pool", seed.pool},
+              {"saved_at", std::chrono::duration_cast<std::chrono::seconds>(seed.saved_at.time_since_epoch()).count()}};
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out << j.dump(2) << '\n';
+        if (!out.flush()) {
+            return false;
+        }
+    }
+#ifdef _WIN32
+    std::remove(path.c_str()); // rename() na Windows nie nadpisuje istniejącego pliku
+#endif
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <string>
+
+/**
+ * @struct LastSeed
+ * @brief Ostatni seed, na którym kopał miner (zapisywany przy każdej zmianie seeda głównej puli).
+ *
+ * Przy starcie posłuży do spekulacyjnej budowy cache'a i datasetu równolegle
+ * z łączeniem z pulą - seed zmienia się raz na epokę (dla Monero 2048 bloków,
+ * ok. 2,8 dnia), więc po krótkiej przerwie pierwsza praca zwykle ma ten sam.
+ */
+struct LastSeed {
+    std::string seed_hash; // 64 znaki hex
+    std::string algo;      // Nazwa wariantu, np. "rx/0"
+    std::string pool;      // "host:port" (tylko do logów)
+    std::chrono::system_clock::time_point saved_at; // Plik zmienia się tylko z seedem - to też początek kopania na nim
+};
+
+/**
+ * @brief Wczytuje zapisany seed.
+ * @return std::nullopt, gdy pliku nie ma albo jest uszkodzony (bez wyjątku - plik jest tylko podpowiedzią).
+ */
+std::optional<LastSeed> load_last_seed(const std::string& path);
+
+/**
+ * @brief Zapisuje seed (plik tymczasowy + rename, więc przerwany zapis nie psuje poprzedniego).
+ * @return false przy błędzie zapisu.
+ */
+bool save_last_seed(const std::string& path, const LastSeed& seed);
@@ -0,0 +1,311 @@
+#include "Logger.h"
+#include "SystemUtils.h"
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+Logger g_logger;
+
+namespace {
+
+constexpr std::size_t LOG_CACHE_LINE = 64;
+
+const char* level_name(LogLevel level) {
+    switch (level) {
+        case LogLevel::Debug: return "debug";
+        case LogLevel::Info: return "info";
+        case LogLevel::Notice: return "notice";
+        case LogLevel::Warn: return "warn";
+        case LogLevel::Error: return "error";
+    }
+    return "info";
+}
+
+std::size_t round_up_pow2(std::size_t v) {
+    std::size_t p = 1;
+    while (p < v) {
+        p <<= 1;
+    }
+    return p;
+}
+
+std::string format_iso8601(int64_t time_us) {
+    std::time_t seconds = static_cast<std::time_t>(time_us / 1000000);
+    std::tm tm{};
+#ifdef _WIN32
+    gmtime_s(&tm, &seconds);
+#else
+    gmtime_r(&seconds, &tm);
+#endif
+    return fmt::format("{:04}-{:02}-{:02}T{:02}:{:02}:{:02}.{:03}Z",
+                       tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                       tm.tm_hour, tm.tm_min, tm.tm_sec, (time_us / 1000) % 1000);
+}
+
+} // namespace
+
+/**
+ * @brief Bufor SPSC jednego wątku: producent = wątek logujący, konsument = wątek piszący.
+ */
+struct Logger::Ring {
+    Ring(std::size_t capacity, uint32_t id)
+            : slots(round_up_pow2(capacity)), mask(slots.size() - 1), thread_id(id) {}
+
+    bool push(Record&& record) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= slots.size()) {
+            return false; // Pełny - porzucamy zamiast czekać
+        }
+        slots[h & mask] = std::move(record);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(Record& out) {
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        out = std::move(slots[t & mask]);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+    }
+
+    std::vector<Record> slots;
+    const std::size_t mask;
+    const uint32_t thread_id;
+    alignas(LOG_CACHE_LINE) std::atomic<uint64_t> head{0};
+    alignas(LOG_CACHE_LINE) std::atomic<uint64_t> tail{0};
+};
+
+Logger::~Logger() {
+    stop();
+}
+
+void Logger::start(const LoggerConfig& config) {
+    if (m_running.exchange(true)) {
+        return;
+    }
+    m_config = config;
+    m_min_level.store(static_cast<uint8_t>(config.min_level), std::memory_order_relaxed);
+    m_category_mask.store(config.category_mask, std::memory_order_relaxed);
+    m_writer = std::thread([this] { writer_loop(); });
+}
+
+void Logger::stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
+    // Wątek piszący opróżnił bufory przed wyjściem; od teraz tryb synchroniczny
+}
+
+Logger::Ring& Logger::thread_ring() {
+    thread_local std::shared_ptr<Ring> ring;
+    if (!ring) {
+        std::lock_guard<std::mutex> lock(m_registry_mutex);
+        ring = std::make_shared<Ring>(m_config.ring_capacity, m_next_thread_id++);
+        m_rings.push_back(ring);
+    }
+    return *ring;
+}
+
+void Logger::log(LogLevel level, LogCategory category, std::string message) {
+    Record record;
+    record.time_us = now_us();
+    record.level = level;
+    record.category = category;
+    record.text = std::move(message);
+    if (level == LogLevel::Warn) {
+        m_warnings.fetch_add(1, std::memory_order_relaxed);
+    } else if (level == LogLevel::Error) {
+        m_errors.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (!m_running.load(std::memory_order_acquire)) {
+        // Przed startem / po zatrzymaniu: zapis synchroniczny
+        std::lock_guard<std::mutex> lock(m_output_mutex);
+        write_record(record);
+        std::cout.flush();
+        return;
+    }
+
+    Ring& ring = thread_ring();
+    record.thread_id = ring.thread_id;
+    if (!ring.push(std::move(record))) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::size_t Logger::drain(std::vector<Record>& batch) {
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        std::lock_guard<std::mutex> lock(m_registry_mutex);
+        // Bufory zakończonych wątków (tylko rejestr trzyma wskaźnik) usuwamy po opróżnieniu
+        std::erase_if(m_rings, [](const std::shared_ptr<Ring>& r) { return r.use_count() == 1 && r->empty(); });
+        rings = m_rings;
+    }
+
+    std::size_t count = 0;
+    Record record;
+    for (auto& ring : rings) {
+        while (ring->pop(record)) {
+            batch.push_back(std::move(record));
+            ++count;
+        }
+    }
+    return count;
+}
+
+void Logger::writer_loop() {
+    std::vector<Record> batch;
+    batch.reserve(256);
+
+    while (true) {
+        bool running = m_running.load(std::memory_order_acquire);
+        batch.clear();
+        drain(batch);
+
+        uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+        if (dropped != m_dropped_reported) {
+            Record note;
+            note.time_us = now_us();
+            note.level = LogLevel::Warn;
+            note.text = fmt::format("[Logger] Porzucono {} wiadomości (przepełnione bufory).", dropped - m_dropped_reported);
+            batch.push_back(std::move(note));
+            m_dropped_reported = dropped;
+        }
+
+        if (!batch.empty()) {
+            write_records(batch);
+        }
+
+        if (!running) {
+            break; // Ostatnie opróżnienie wykonane po zatrzymaniu
+        }
+        std::this_thread::sleep_for(m_config.flush_interval);
+    }
+}
+
+void Logger::write_records(std::vector<Record>& batch) {
+    // Scalamy bufory wielu wątków w kolejności czasowej
+    std::stable_sort(batch.begin(), batch.end(),
+                     [](const Record& a, const Record& b) { return a.time_us < b.time_us; });
+
+    std::lock_guard<std::mutex> lock(m_output_mutex);
+    for (const auto& record : batch) {
+        write_record(record);
+    }
+    std::cout.flush();
+    std::cerr.flush();
+}
+
+void Logger::write_record(const Record& record) {
+    if (m_config.json_lines) {
+        nlohmann::json j = {
+                {"ts", format_iso8601(record.time_us)},
+                {"level", level_name(record.level)},
+                {"category", log_category_name(record.category)},
+                {"thread", record.thread_id},
+                {"msg", record.text}
+        };
+        std::cout << j.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) << '\n';
+        return;
+    }
+
+    if (record.level >= LogLevel::Warn) {
+        std::cerr << record.text << '\n';
+        return;
+    }
+
+    if (record.level == LogLevel::Notice) {
+#ifdef _WIN32
+        HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+        CONSOLE_SCREEN_BUFFER_INFO consoleInfo;
+        GetConsoleScreenBufferInfo(hConsole, &consoleInfo);
+        WORD saved_attributes = consoleInfo.wAttributes;
+        std::cout.flush();
+        SetConsoleTextAttribute(hConsole, FOREGROUND_GREEN | FOREGROUND_INTENSITY);
+        std::cout << record.text << '\n';
+        std::cout.flush();
+        SetConsoleTextAttribute(hConsole, saved_attributes);
+#else
+        if (isatty(STDOUT_FILENO)) {
+            std::cout << "\033[1;32m" << record.text << "\033[0m\n";
+        } else {
+            std::cout << record.text << '\n';
+        }
+#endif
+        return;
+    }
+
+    std::cout << record.text << '\n';
+}
+
+const char* log_category_name(LogCategory category) {
+    switch (category) {
+        case LogCategory::General: return "general";
+        case LogCategory::Stratum: return "stratum";
+        case LogCategory::Worker: return "worker";
+        case LogCategory::Hasher: return "hasher";
+        case LogCategory::RandomX: return "randomx";
+        case LogCategory::Manager: return "manager";
+        case LogCategory::Stats: return "stats";
+        case LogCategory::Metrics: return "metrics";
+        case LogCategory::Trace: return "trace";
+        case LogCategory::Control: return "control";
+        case LogCategory::Count_: break;
+    }
+    return "general";
+}
+
+LogLevel parse_log_level(const std::string& name) {
+    for (LogLevel level : {LogLevel::Debug, LogLevel::Info, LogLevel::Notice, LogLevel::Warn, LogLevel::Error}) {
+        if (name == level_name(level)) {
+            return level;
+        }
+    }
+    throw std::invalid_argument(fmt::format("Nieznany poziom logowania: '{}'", name));
+}
+
+uint32_t parse_log_categories(const std::string& list) {
+    uint32_t mask = 0;
+    std::size_t start = 0;
+    while (start <= list.size()) {
+        std::size_t comma = list.find(',', start);
+        std::string name = list.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+
+        bool found = false;
+        for (uint8_t c = 0; c < static_cast<uint8_t>(LogCategory::Count_); ++c) {
+            if (name == log_category_name(static_cast<LogCategory>(c))) {
+                mask |= 1u << c;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            throw std::invalid_argument(fmt::format("Nieznana kategoria logowania: '{}'", name));
+        }
+
+        if (comma == std::string::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+    return mask;
+}
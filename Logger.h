@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fmt/core.h>
+
+/**
+ * @enum LogLevel
+ * @brief Poziomy logowania. Notice to komunikat wyróżniony (np. zaakceptowany share).
+ */
+enum class LogLevel : uint8_t {
+    Debug,
+    Info,
+    Notice,
+    Warn,
+    Error,
+};
+
+/**
+ * @enum LogCategory
+ * @brief Podsystem, z którego pochodzi wiadomość (filtrowanie i pole JSON).
+ */
+enum class LogCategory : uint8_t {
+    General,
+    Stratum,
+    Worker,
+    Hasher,
+    RandomX,
+    Manager,
+    Stats,
+    Metrics,
+    Trace,
+    Control,
+    Count_ // Liczba kategorii - musi być ostatnia
+};
+
+/**
+ * @struct LoggerConfig
+ * @brief Parametry loggera.
+ */
+struct LoggerConfig {
+    LogLevel min_level = LogLevel::Info;
+    uint32_t category_mask = ~0u;        // Bit na kategorię (1 << LogCategory)
+    bool json_lines = false;             // Strukturalne wyjście JSON (jedna linia na wiadomość)
+    std::size_t ring_capacity = 4096;    // Wiadomości na wątek; potęga dwójki
+    std::chrono::milliseconds flush_interval{10};
+};
+
+/**
+ * @class Logger
+ * @brief Asynchroniczny logger z buforami per wątek i wątkiem piszącym.
+ *
+ * Każdy wątek zapisuje do własnego bufora SPSC (bez blokad po pierwszej
+ * wiadomości). Gdy bufor jest pełny, wiadomość jest porzucana i liczona -
+ * wątki robocze nigdy nie czekają na terminal. Przed start() i po stop()
+ * wiadomości są wypisywane synchronicznie.
+ */
+class Logger {
+public:
+    Logger() = default;
+    ~Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    /**
+     * @brief Uruchamia wątek piszący.
+     */
+    void start(const LoggerConfig& config);
+
+    /**
+     * @brief Opróżnia bufory i zatrzymuje wątek piszący.
+     */
+    void stop();
+
+    /**
+     * @brief Czy wiadomość o danym poziomie i kategorii zostanie zapisana.
+     * Tani test (odczyty relaxed) - makra LOG_* wołają go przed formatowaniem.
+     */
+    bool should_log(LogLevel level, LogCategory category) const {
+        return static_cast<uint8_t>(level) >= m_min_level.load(std::memory_order_relaxed) &&
+               (m_category_mask.load(std::memory_order_relaxed) & (1u << static_cast<uint8_t>(category))) != 0;
+    }
+
+    /**
+     * @brief Kolejkuje wiadomość (bez znaku nowej linii na końcu).
+     */
+    void log(LogLevel level, LogCategory category, std::string message);
+
+    /**
+     * @brief Liczba wiadomości porzuconych z powodu przepełnienia buforów.
+     */
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Liczba zapisanych wiadomości Warn i Error od startu (telemetria floty).
+     */
+    uint64_t warnings() const { return m_warnings.load(std::memory_order_relaxed); }
+    uint64_t errors() const { return m_errors.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Zmienia minimalny poziom w trakcie działania.
+     */
+    void set_min_level(LogLevel level) { m_min_level.store(static_cast<uint8_t>(level), std::memory_order_relaxed); }
+
+private:
+    struct Record {
+        int64_t time_us = 0; // system_clock
+        LogLevel level = LogLevel::Info;
+        LogCategory category = LogCategory::General;
+        uint32_t thread_id = 0;
+        std::string text;
+    };
+
+    struct Ring;
+
+    Ring& thread_ring();
+    void writer_loop();
+    std::size_t drain(std::vector<Record>& batch);
+    void write_records(std::vector<Record>& batch);
+    void write_record(const Record& record);
+
+    std::atomic<uint8_t> m_min_level{static_cast<uint8_t>(LogLevel::Info)};
+    std::atomic<uint32_t> m_category_mask{~0u};
+    std::atomic<bool> m_running{false};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_warnings{0};
+    std::atomic<uint64_t> m_errors{0};
+    uint64_t m_dropped_reported = 0;
+    LoggerConfig m_config;
+
+    std::mutex m_registry_mutex; // Rejestracja buforów (raz na wątek) i lista dla wątku piszącego
+    std::vector<std::shared_ptr<Ring>> m_rings;
+    uint32_t m_next_thread_id = 1;
+
+    std::mutex m_output_mutex; // Tylko wątek piszący i tryb synchroniczny
+    std::thread m_writer;
+};
+
+// Globalny logger - jedyna droga wypisywania komunikatów na konsolę
+extern Logger g_logger;
+
+/**
+ * @brief Parsuje nazwę poziomu ("debug", "info", "warn", "error").
+ * @throws std::invalid_argument dla nieznanej nazwy.
+ */
+LogLevel parse_log_level(const std::string& name);
+
+/**
+ * @brief Parsuje listę kategorii ("stratum,worker") na maskę bitową.
+ * @throws std::invalid_argument dla nieznanej nazwy.
+ */
+uint32_t parse_log_categories(const std::string& list);
+
+/**
+ * @brief Nazwa kategorii używana w JSON i opcjach.
+ */
+const char* log_category_name(LogCategory category);
+
+#define PJ_LOG(level, category, ...)                                           \
+    do {                                                                      \
+        if (g_logger.should_log(level, category)) {                           \
+            g_logger.log(level, category, fmt::format(__VA_ARGS__));          \
+        }                                                                     \
+    } while (0)
+
+#define LOG_DEBUG(category, ...) PJ_LOG(LogLevel::Debug, category, __VA_ARGS__)
+#define LOG_INFO(category, ...) PJ_LOG(LogLevel::Info, category, __VA_ARGS__)
+#define LOG_NOTICE(category, ...) PJ_LOG(LogLevel::Notice, category, __VA_ARGS__)
+#define LOG_WARN(category, ...) PJ_LOG(LogLevel::Warn, category, __VA_ARGS__)
+#define LOG_ERROR(category, ...) PJ_LOG(LogLevel::Error, category, __VA_ARGS__)
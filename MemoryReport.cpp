@@ -0,0 +1,95 @@
+#include "MemoryReport.h"
+#include <fstream>
+#include <sstream>
+#include <fmt/core.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+namespace {
+
+/**
+ * @brief Wartość pola "Klucz:   123 kB" z plików /proc (w bajtach, jeśli podano jednostkę kB).
+ */
+void read_proc_fields(const std::string& path,
+                      const std::initializer_list<std::pair<const char*, std::optional<uint64_t>*>>& fields) {
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        auto colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        std::string key = line.substr(0, colon);
+        for (const auto& [name, target] : fields) {
+            if (key != name) {
+                continue;
+            }
+            std::istringstream value(line.substr(colon + 1));
+            uint64_t amount = 0;
+            std::string unit;
+            if (value >> amount) {
+                value >> unit;
+                *target = unit == "kB" ? amount * 1024 : amount;
+            }
+        }
+    }
+}
+
+std::string format_mib(const std::optional<uint64_t>& bytes) {
+    return bytes ? fmt::format("{} MiB", *bytes >> 20) : std::string("-");
+}
+
+} // namespace
+
+MemoryUsage read_memory_usage(const std::string& root) {
+    MemoryUsage usage;
+#ifdef _WIN32
+    (void)root;
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        usage.rss_bytes = counters.WorkingSetSize;
+        usage.peak_rss_bytes = counters.PeakWorkingSetSize;
+    }
+    usage.hugepage_size_bytes = GetLargePageMinimum();
+    MEMORYSTATUSEX status{};
+    status.dwLength = sizeof(status);
+    if (GlobalMemoryStatusEx(&status)) {
+        usage.available_bytes = status.ullAvailPhys;
+    }
+#else
+    read_proc_fields(root + "/proc/self/status", {{"VmRSS", &usage.rss_bytes},
+                                                  {"VmHWM", &usage.peak_rss_bytes},
+                                                  {"HugetlbPages", &usage.hugetlb_bytes}});
+    read_proc_fields(root + "/proc/meminfo", {{"MemAvailable", &usage.available_bytes},
+                                              {"AnonHugePages", &usage.anon_huge_bytes},
+                                              {"HugePages_Total", &usage.hugepages_total},
+                                              {"HugePages_Free", &usage.hugepages_free},
+                                              {"Hugepagesize", &usage.hugepage_size_bytes}});
+#endif
+    return usage;
+}
+
+std::string format_memory_report(const MemoryUsage& usage, const RandomXFootprint& footprint) {
+    std::string report = fmt::format("[Pamięć] RSS {} (szczyt {}), huge pages procesu {}",
+                                     format_mib(usage.rss_bytes), format_mib(usage.peak_rss_bytes),
+                                     format_mib(usage.hugetlb_bytes));
+    if (usage.hugepages_total && usage.hugepages_free) {
+        report += fmt::format(", wolne {}/{} stron", *usage.hugepages_free, *usage.hugepages_total);
+        if (usage.hugepage_size_bytes) {
+            report += fmt::format(" po {} kB", *usage.hugepage_size_bytes >> 10);
+        }
+    }
+
+    auto describe = [](uint64_t bytes, bool large_pages) {
+        return bytes == 0 ? std::string("zwolniony")
+                          : fmt::format("{} MiB ({})", bytes >> 20, large_pages ? "huge pages" : "zwykłe strony");
+    };
+    report += fmt::format(" | cache {}, dataset {}",
+                          describe(footprint.cache_bytes, footprint.cache_large_pages),
+                          footprint.dataset_bytes == 0 ? std::string("brak")
+                                                       : describe(footprint.dataset_bytes, footprint.dataset_large_pages));
+    return report;
+}
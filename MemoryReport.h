@@ -0,0 +1,33 @@
+#pragma once
+
+#include "RandomXManager.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+
+/**
+ * @struct MemoryUsage
+ * @brief Zużycie pamięci procesu i stan huge pages na hoście.
+ * Pola std::nullopt - niedostępne na tej platformie.
+ */
+struct MemoryUsage {
+    std::optional<uint64_t> rss_bytes;         // VmRSS
+    std::optional<uint64_t> peak_rss_bytes;    // VmHWM
+    std::optional<uint64_t> hugetlb_bytes;     // HugetlbPages procesu (strony hugetlbfs/MAP_HUGETLB)
+    std::optional<uint64_t> anon_huge_bytes;   // AnonHugePages hosta (THP)
+    std::optional<uint64_t> hugepages_total;   // HugePages_Total
+    std::optional<uint64_t> hugepages_free;    // HugePages_Free
+    std::optional<uint64_t> hugepage_size_bytes;
+    std::optional<uint64_t> available_bytes;   // MemAvailable hosta (planowanie trybu RandomX)
+};
+
+/**
+ * @brief Odczytuje <root>/proc/self/status i <root>/proc/meminfo (Linux)
+ * lub liczniki procesu (Windows).
+ */
+MemoryUsage read_memory_usage(const std::string& root = "");
+
+/**
+ * @brief Raport tekstowy: RSS, huge pages oraz cache/dataset RandomX.
+ */
+std::string format_memory_report(const MemoryUsage& usage, const RandomXFootprint& footprint);
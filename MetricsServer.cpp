@@ -0,0 +1,642 @@
+#include "MetricsServer.h"
+#include "Logger.h"
+#include "Trace.h"
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+using asio::ip::tcp;
+using json = nlohmann::json;
+
+namespace {
+
+// Maksymalny rozmiar nagłówków żądania (chroni przed zalaniem pamięci)
+constexpr std::size_t MAX_REQUEST_SIZE = 8192;
+// Czas na przesłanie żądania i odbiór odpowiedzi; bezczynny klient nie trzyma gniazda
+constexpr auto REQUEST_TIMEOUT = std::chrono::seconds(5);
+
+void append_metric_header(std::string& out, const char* name, const char* type, const char* help) {
+    out += fmt::format("# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+}
+
+std::string http_response(int status, const char* reason, const char* content_type, const std::string& body) {
+    std::string response = fmt::format("HTTP/1.1 {} {}\r\n", status, reason);
+    response += fmt::format("Content-Type: {}\r\n", content_type);
+    response += fmt::format("Content-Length: {}\r\n", body.size());
+    response += "Connection: close\r\n\r\n";
+    response += body;
+    return response;
+}
+
+} // namespace
+
+std::string render_metrics_text(const MetricsSnapshot& s) {
+    std::string out;
+    out.reserve(2048 + s.threads.size() * 128);
+
+    append_metric_header(out, "pjurominer_hashrate", "gauge", "Hashrate per worker thread in H/s over a sliding window.");
+    for (const auto& t : s.threads) {
+        for (size_t w = 0; w < s.windows.size() && w < t.window_rates.size(); ++w) {
+            out += fmt::format("pjurominer_hashrate{{thread=\"{}\",window=\"{}\"}} {:.3f}\n",
+                               t.id, s.windows[w], t.window_rates[w]);
+        }
+    }
+    append_metric_header(out, "pjurominer_hashrate_total", "gauge", "Total hashrate in H/s over a sliding window.");
+    for (size_t w = 0; w < s.windows.size() && w < s.total_window_rates.size(); ++w) {
+        out += fmt::format("pjurominer_hashrate_total{{window=\"{}\"}} {:.3f}\n", s.windows[w], s.total_window_rates[w]);
+    }
+
+    append_metric_header(out, "pjurominer_hashrate_ewma", "gauge", "Exponentially weighted hashrate per worker thread in H/s.");
+    for (const auto& t : s.threads) {
+        out += fmt::format("pjurominer_hashrate_ewma{{thread=\"{}\"}} {:.3f}\n", t.id, t.ewma_rate);
+    }
+    append_metric_header(out, "pjurominer_hashrate_ewma_total", "gauge", "Exponentially weighted total hashrate in H/s.");
+    out += fmt::format("pjurominer_hashrate_ewma_total {:.3f}\n", s.total_ewma_rate);
+
+    append_metric_header(out, "pjurominer_hash_latency_seconds", "summary", "Latency of a single hash per worker thread.");
+    for (const auto& t : s.threads) {
+        out += fmt::format("pjurominer_hash_latency_seconds{{thread=\"{}\",quantile=\"0.5\"}} {:.9f}\n", t.id, t.latency_p50_seconds);
+        out += fmt::format("pjurominer_hash_latency_seconds{{thread=\"{}\",quantile=\"0.9\"}} {:.9f}\n", t.id, t.latency_p90_seconds);
+        out += fmt::format("pjurominer_hash_latency_seconds{{thread=\"{}\",quantile=\"0.99\"}} {:.9f}\n", t.id, t.latency_p99_seconds);
+        out += fmt::format("pjurominer_hash_latency_seconds_count{{thread=\"{}\"}} {}\n", t.id, t.latency_count);
+    }
+
+    // Liczniki wydajności - tylko wątki i zdarzenia, które udało się otworzyć
+    struct PerfMetric {
+        const char* name;
+        const char* help;
+        std::optional<uint64_t> PerfSample::* field;
+    };
+    static const PerfMetric perf_metrics[] = {
+            {"pjurominer_perf_cycles_total", "CPU cycles per worker thread.", &PerfSample::cycles},
+            {"pjurominer_perf_instructions_total", "Retired instructions per worker thread.", &PerfSample::instructions},
+            {"pjurominer_perf_llc_misses_total", "Last level cache read misses per worker thread.", &PerfSample::llc_misses},
+            {"pjurominer_perf_dtlb_misses_total", "dTLB read misses per worker thread.", &PerfSample::dtlb_misses},
+            {"pjurominer_perf_context_switches_total", "Context switches per worker thread.", &PerfSample::context_switches},
+            {"pjurominer_perf_cpu_migrations_total", "CPU migrations per worker thread.", &PerfSample::cpu_migrations},
+            {"pjurominer_perf_task_clock_seconds_total", "Task clock per worker thread.", &PerfSample::task_clock_ns},
+    };
+    for (const auto& metric : perf_metrics) {
+        bool header_written = false;
+        for (const auto& t : s.threads) {
+            if (!t.perf || !((*t.perf).*metric.field)) {
+                continue;
+            }
+            if (!header_written) {
+                append_metric_header(out, metric.name, "counter", metric.help);
+                header_written = true;
+            }
+            uint64_t value = *((*t.perf).*metric.field);
+            if (metric.field == &PerfSample::task_clock_ns) {
+                out += fmt::format("{}{{thread=\"{}\"}} {:.6f}\n", metric.name, t.id, value / 1e9);
+            } else {
+                out += fmt::format("{}{{thread=\"{}\"}} {}\n", metric.name, t.id, value);
+            }
+        }
+    }
+    bool perf_header_written = false;
+    for (const auto& t : s.threads) {
+        if (!t.perf) {
+            continue;
+        }
+        if (!perf_header_written) {
+            append_metric_header(out, "pjurominer_perf_hardware", "gauge", "1 if hardware PMU counters are used, 0 for software fallback.");
+            perf_header_written = true;
+        }
+        out += fmt::format("pjurominer_perf_hardware{{thread=\"{}\"}} {}\n", t.id, t.perf->hardware ? 1 : 0);
+    }
+
+    append_metric_header(out, "pjurominer_hashes_total", "counter", "Hashes computed per worker thread.");
+    for (const auto& t : s.threads) {
+        out += fmt::format("pjurominer_hashes_total{{thread=\"{}\"}} {}\n", t.id, t.hashes);
+    }
+
+    append_metric_header(out, "pjurominer_shares_accepted_total", "counter", "Shares accepted by the pool.");
+    out += fmt::format("pjurominer_shares_accepted_total {}\n", s.shares_accepted);
+    append_metric_header(out, "pjurominer_shares_rejected_total", "counter", "Shares rejected by the pool.");
+    out += fmt::format("pjurominer_shares_rejected_total {}\n", s.shares_rejected);
+    if (s.share_journal) {
+        const auto& sj = *s.share_journal;
+        append_metric_header(out, "pjurominer_share_journal_pending", "gauge", "Journaled shares without a pool response.");
+        out += fmt::format("pjurominer_share_journal_pending {}\n", sj.pending);
+        append_metric_header(out, "pjurominer_share_journal_appended_total", "counter", "Shares written to the share journal.");
+        out += fmt::format("pjurominer_share_journal_appended_total {}\n", sj.appended);
+        append_metric_header(out, "pjurominer_share_journal_stale_total", "counter", "Unacknowledged shares from an earlier pool session, closed without resubmitting.");
+        out += fmt::format("pjurominer_share_journal_stale_total {}\n", sj.stale);
+        append_metric_header(out, "pjurominer_share_journal_dropped_total", "counter", "Shares not journaled because no segment was ready.");
+        out += fmt::format("pjurominer_share_journal_dropped_total {}\n", sj.dropped);
+    }
+    if (s.share_accounting) {
+        const auto& sa = *s.share_accounting;
+        struct WindowMetric {
+            const char* name;
+            const char* help;
+            double ShareAccountingStats::Window::* field;
+        };
+        static const WindowMetric window_metrics[] = {
+                {"pjurominer_effective_hashrate", "Hashrate credited by the pool (accepted difficulty / time) over a sliding window.",
+                 &ShareAccountingStats::Window::effective_rate},
+                {"pjurominer_effective_hashrate_low", "Lower 95% confidence bound of the effective hashrate.",
+                 &ShareAccountingStats::Window::effective_low},
+                {"pjurominer_effective_hashrate_high", "Upper 95% confidence bound of the effective hashrate.",
+                 &ShareAccountingStats::Window::effective_high},
+                {"pjurominer_expected_shares", "Shares expected from the local hashrate at the current difficulty.",
+                 &ShareAccountingStats::Window::expected_shares},
+        };
+        for (const auto& metric : window_metrics) {
+            append_metric_header(out, metric.name, "gauge", metric.help);
+            for (size_t w = 0; w < s.windows.size() && w < sa.windows.size(); ++w) {
+                out += fmt::format("{}{{window=\"{}\"}} {:.3f}\n", metric.name, s.windows[w], sa.windows[w].*metric.field);
+            }
+        }
+        append_metric_header(out, "pjurominer_pool_shares_total", "counter", "Share results per pool.");
+        for (const auto& p : sa.pools) {
+            out += fmt::format("pjurominer_pool_shares_total{{pool=\"{}\",result=\"accepted\"}} {}\n", p.pool, p.accepted);
+            out += fmt::format("pjurominer_pool_shares_total{{pool=\"{}\",result=\"rejected\"}} {}\n", p.pool, p.rejected);
+            out += fmt::format("pjurominer_pool_shares_total{{pool=\"{}\",result=\"stale\"}} {}\n", p.pool, p.stale);
+        }
+        append_metric_header(out, "pjurominer_pool_accepted_difficulty_total", "counter", "Sum of the difficulty of accepted shares per pool.");
+        for (const auto& p : sa.pools) {
+            out += fmt::format("pjurominer_pool_accepted_difficulty_total{{pool=\"{}\"}} {}\n", p.pool, p.accepted_difficulty);
+        }
+        append_metric_header(out, "pjurominer_shares_rejected_by_reason_total", "counter", "Rejected and stale shares by classified reason.");
+        for (size_t r = 1; r < sa.reasons.size(); ++r) {
+            out += fmt::format("pjurominer_shares_rejected_by_reason_total{{reason=\"{}\"}} {}\n",
+                               reject_reason_name(static_cast<RejectReason>(r)), sa.reasons[r]);
+        }
+        append_metric_header(out, "pjurominer_share_pipeline_alert", "gauge", "1 if the effective hashrate or rejections point to a share pipeline problem.");
+        out += fmt::format("pjurominer_share_pipeline_alert {}\n", sa.alert ? 1 : 0);
+    }
+
+    if (!s.pools.empty()) {
+        append_metric_header(out, "pjurominer_pool_connected", "gauge", "Whether the pool session is connected.");
+        for (const auto& p : s.pools) {
+            out += fmt::format("pjurominer_pool_connected{{pool=\"{}\"}} {}\n", p.pool, p.connected ? 1 : 0);
+        }
+        append_metric_header(out, "pjurominer_pool_threads", "gauge", "Worker threads assigned to the pool session.");
+        for (const auto& p : s.pools) {
+            out += fmt::format("pjurominer_pool_threads{{pool=\"{}\"}} {}\n", p.pool, p.threads);
+        }
+        append_metric_header(out, "pjurominer_pool_weight", "gauge", "Configured share of worker capacity for the pool session.");
+        for (const auto& p : s.pools) {
+            out += fmt::format("pjurominer_pool_weight{{pool=\"{}\"}} {}\n", p.pool, p.weight);
+        }
+        append_metric_header(out, "pjurominer_pool_session_rtt_seconds", "gauge", "Round-trip time of the last share submission per pool (-1 if unknown).");
+        for (const auto& p : s.pools) {
+            out += fmt::format("pjurominer_pool_session_rtt_seconds{{pool=\"{}\"}} {:.6f}\n", p.pool, p.rtt_seconds);
+        }
+    }
+    append_metric_header(out, "pjurominer_randomx_datasets", "gauge", "RandomX managers resident (one per distinct seed across pools).");
+    out += fmt::format("pjurominer_randomx_datasets {}\n", s.datasets);
+
+    append_metric_header(out, "pjurominer_dataset_build_seconds", "gauge", "Duration of the last dataset build.");
+    out += fmt::format("pjurominer_dataset_build_seconds {:.3f}\n", s.dataset_build_seconds);
+    append_metric_header(out, "pjurominer_dataset_init_progress", "gauge", "Fraction of dataset items initialised (0-1).");
+    out += fmt::format("pjurominer_dataset_init_progress {:.4f}\n", s.dataset_init.fraction());
+    append_metric_header(out, "pjurominer_dataset_init_active", "gauge", "Whether a dataset initialisation is running.");
+    out += fmt::format("pjurominer_dataset_init_active {}\n", s.dataset_init.active ? 1 : 0);
+    append_metric_header(out, "pjurominer_dataset_init_eta_seconds", "gauge", "Estimated time to finish the dataset initialisation (-1 = unknown).");
+    out += fmt::format("pjurominer_dataset_init_eta_seconds {:.1f}\n", s.dataset_init.eta_seconds);
+    append_metric_header(out, "pjurominer_dataset_init_threads", "gauge", "Threads currently initialising the dataset.");
+    out += fmt::format("pjurominer_dataset_init_threads {}\n", s.dataset_init.participants);
+    append_metric_header(out, "pjurominer_dataset_scrub_items_total", "counter", "Dataset items verified against the cache by the background scrubber.");
+    out += fmt::format("pjurominer_dataset_scrub_items_total {}\n", s.dataset_scrub.items_checked);
+    append_metric_header(out, "pjurominer_dataset_corrupt_items_total", "counter", "Dataset items found corrupted (and repaired) by the scrubber.");
+    out += fmt::format("pjurominer_dataset_corrupt_items_total {}\n", s.dataset_scrub.corrupt_items);
+    append_metric_header(out, "pjurominer_dataset_scrub_rebuilds_total", "counter", "Full dataset rebuilds triggered by widespread corruption.");
+    out += fmt::format("pjurominer_dataset_scrub_rebuilds_total {}\n", s.dataset_scrub.rebuilds);
+    append_metric_header(out, "pjurominer_dataset_scrub_passes_total", "counter", "Completed scrubber passes over the whole dataset.");
+    out += fmt::format("pjurominer_dataset_scrub_passes_total {}\n", s.dataset_scrub.passes);
+    append_metric_header(out, "pjurominer_seed_epoch", "counter", "Number of seed changes since start.");
+    out += fmt::format("pjurominer_seed_epoch {}\n", s.seed_epoch);
+    append_metric_header(out, "pjurominer_seed_info", "gauge", "Currently active seed hash.");
+    out += fmt::format("pjurominer_seed_info{{seed=\"{}\"}} 1\n", s.seed_hash);
+
+    append_metric_header(out, "pjurominer_pool_rtt_seconds", "gauge", "Last measured pool request round-trip time (-1 if unknown).");
+    out += fmt::format("pjurominer_pool_rtt_seconds {:.6f}\n", s.pool_rtt_seconds);
+    append_metric_header(out, "pjurominer_job_age_seconds", "gauge", "Time since the last job was received (-1 if none).");
+    out += fmt::format("pjurominer_job_age_seconds {:.3f}\n", s.job_age_seconds);
+
+    append_metric_header(out, "pjurominer_uptime_seconds", "counter", "Process uptime.");
+    out += fmt::format("pjurominer_uptime_seconds {:.3f}\n", s.uptime_seconds);
+
+    append_metric_header(out, "pjurominer_log_dropped_total", "counter", "Log messages dropped because a per-thread buffer was full.");
+    out += fmt::format("pjurominer_log_dropped_total {}\n", s.log_dropped);
+
+    auto optional_gauge = [&out](const char* name, const char* help, const std::optional<uint64_t>& value) {
+        if (value) {
+            append_metric_header(out, name, "gauge", help);
+            out += fmt::format("{} {}\n", name, *value);
+        }
+    };
+    optional_gauge("pjurominer_memory_rss_bytes", "Resident set size of the process.", s.memory.rss_bytes);
+    optional_gauge("pjurominer_memory_peak_rss_bytes", "Peak resident set size of the process.", s.memory.peak_rss_bytes);
+    optional_gauge("pjurominer_memory_hugetlb_bytes", "Huge pages (hugetlb) mapped by the process.", s.memory.hugetlb_bytes);
+    optional_gauge("pjurominer_hugepages_total", "Huge pages configured on the host.", s.memory.hugepages_total);
+    optional_gauge("pjurominer_hugepages_free", "Free huge pages on the host.", s.memory.hugepages_free);
+    append_metric_header(out, "pjurominer_randomx_memory_bytes", "gauge", "Memory held by the RandomX cache and dataset.");
+    out += fmt::format("pjurominer_randomx_memory_bytes{{region=\"cache\",large_pages=\"{}\"}} {}\n",
+                       s.randomx_memory.cache_large_pages ? 1 : 0, s.randomx_memory.cache_bytes);
+    out += fmt::format("pjurominer_randomx_memory_bytes{{region=\"dataset\",large_pages=\"{}\"}} {}\n",
+                       s.randomx_memory.dataset_large_pages ? 1 : 0, s.randomx_memory.dataset_bytes);
+
+    append_metric_header(out, "pjurominer_randomx_mode", "gauge", "Active RandomX mode (fast = full dataset, light = cache only).");
+    out += fmt::format("pjurominer_randomx_mode{{mode=\"{}\"}} 1\n", s.randomx_mode);
+    append_metric_header(out, "pjurominer_randomx_algorithm", "gauge", "RandomX variant of the current seed.");
+    out += fmt::format("pjurominer_randomx_algorithm{{algo=\"{}\"}} 1\n", s.algorithm);
+    append_metric_header(out, "pjurominer_cgroup_cpu_limit", "gauge", "CPU limit from cgroup quota/cpuset (-1 if none).");
+    out += fmt::format("pjurominer_cgroup_cpu_limit {:.3f}\n", s.cpu_limit);
+    append_metric_header(out, "pjurominer_cgroup_memory_limit_bytes", "gauge", "Memory limit from cgroup (-1 if none).");
+    out += fmt::format("pjurominer_cgroup_memory_limit_bytes {:.0f}\n", s.memory_limit_bytes);
+
+    if (s.limit) {
+        const auto& l = *s.limit;
+        append_metric_header(out, "pjurominer_limit_target", "gauge", "Configured limit (H/s for hashrate, cores for cpu, W for power).");
+        out += fmt::format("pjurominer_limit_target{{kind=\"{}\"}} {:.3f}\n", l.kind, l.target);
+        append_metric_header(out, "pjurominer_limit_measured", "gauge", "Measured value in the limit's unit.");
+        out += fmt::format("pjurominer_limit_measured{{kind=\"{}\"}} {:.3f}\n", l.kind, l.measured);
+        append_metric_header(out, "pjurominer_limit_deviation_ratio", "gauge", "Relative deviation from the limit ((measured - target) / target).");
+        out += fmt::format("pjurominer_limit_deviation_ratio{{kind=\"{}\"}} {:.4f}\n", l.kind, l.deviation);
+        append_metric_header(out, "pjurominer_limit_correction", "gauge", "Closed-loop correction factor applied to worker setpoints.");
+        out += fmt::format("pjurominer_limit_correction {:.4f}\n", l.correction);
+        append_metric_header(out, "pjurominer_limit_throttle_seconds_total", "counter", "Time workers slept to stay within the limit (summed over threads).");
+        out += fmt::format("pjurominer_limit_throttle_seconds_total {:.3f}\n", l.throttle_seconds);
+    }
+
+    if (s.watchdog) {
+        const auto& w = *s.watchdog;
+        append_metric_header(out, "pjurominer_watchdog_interventions_total", "counter", "Worker repairs performed by the watchdog, by action.");
+        out += fmt::format("pjurominer_watchdog_interventions_total{{action=\"repin\"}} {}\n", w.repins);
+        out += fmt::format("pjurominer_watchdog_interventions_total{{action=\"vm_reset\"}} {}\n", w.vm_resets);
+        out += fmt::format("pjurominer_watchdog_interventions_total{{action=\"restart\"}} {}\n", w.restarts);
+        append_metric_header(out, "pjurominer_watchdog_degraded_workers", "gauge", "Workers slower than their peers and their own history in the last check.");
+        out += fmt::format("pjurominer_watchdog_degraded_workers {}\n", w.degraded_workers);
+        append_metric_header(out, "pjurominer_watchdog_stalled_workers", "gauge", "Workers without progress for the stall timeout in the last check.");
+        out += fmt::format("pjurominer_watchdog_stalled_workers {}\n", w.stalled_workers);
+        append_metric_header(out, "pjurominer_watchdog_hung_workers", "gauge", "Workers stuck inside a single hash (reported, not restarted).");
+        out += fmt::format("pjurominer_watchdog_hung_workers {}\n", w.hung_workers);
+    }
+
+    if (s.fleet) {
+        const auto& f = *s.fleet;
+        append_metric_header(out, "pjurominer_fleet_snapshots_sent_total", "counter", "Snapshots sent to the fleet collector.");
+        out += fmt::format("pjurominer_fleet_snapshots_sent_total {}\n", f.snapshots_sent);
+        append_metric_header(out, "pjurominer_fleet_snapshots_dropped_total", "counter", "Snapshots lost to a full queue or a failed UDP send.");
+        out += fmt::format("pjurominer_fleet_snapshots_dropped_total {}\n", f.snapshots_dropped);
+        append_metric_header(out, "pjurominer_fleet_bytes_sent_total", "counter", "Bytes sent to the fleet collector.");
+        out += fmt::format("pjurominer_fleet_bytes_sent_total {}\n", f.bytes_sent);
+        append_metric_header(out, "pjurominer_fleet_send_errors_total", "counter", "Failed resolves, connects and sends to the fleet collector.");
+        out += fmt::format("pjurominer_fleet_send_errors_total {}\n", f.send_errors);
+        append_metric_header(out, "pjurominer_fleet_connected", "gauge", "Whether the fleet collector is reachable (1) or not (0).");
+        out += fmt::format("pjurominer_fleet_connected {}\n", f.connected ? 1 : 0);
+    }
+
+    if (s.energy) {
+        const auto& e = *s.energy;
+        append_metric_header(out, "pjurominer_energy_available", "gauge", "Whether RAPL energy counters can be read (1) or not (0).");
+        out += fmt::format("pjurominer_energy_available {}\n", e.available ? 1 : 0);
+        append_metric_header(out, "pjurominer_energy_watts", "gauge", "Average power since the previous RAPL sample, per zone.");
+        out += fmt::format("pjurominer_energy_watts{{zone=\"package\"}} {:.3f}\n", e.package_watts);
+        out += fmt::format("pjurominer_energy_watts{{zone=\"dram\"}} {:.3f}\n", e.dram_watts);
+        append_metric_header(out, "pjurominer_energy_joules_total", "counter", "Energy measured by RAPL since monitoring started, per zone.");
+        out += fmt::format("pjurominer_energy_joules_total{{zone=\"package\"}} {:.3f}\n", e.package_joules_total);
+        out += fmt::format("pjurominer_energy_joules_total{{zone=\"dram\"}} {:.3f}\n", e.dram_joules_total);
+        append_metric_header(out, "pjurominer_energy_hashes_per_joule", "gauge", "Hashes per joule (package + DRAM) over the last RAPL sample.");
+        out += fmt::format("pjurominer_energy_hashes_per_joule {:.4f}\n", e.hashes_per_joule);
+        append_metric_header(out, "pjurominer_energy_joules_per_share", "gauge", "Joules per accepted share since monitoring started (0 before the first share).");
+        out += fmt::format("pjurominer_energy_joules_per_share {:.3f}\n", e.joules_per_share);
+        append_metric_header(out, "pjurominer_energy_counter_wraps_total", "counter", "RAPL energy_uj counter wraparounds handled.");
+        out += fmt::format("pjurominer_energy_counter_wraps_total {}\n", e.counter_wraps);
+    }
+
+    if (s.cotenant) {
+        const auto& c = *s.cotenant;
+        append_metric_header(out, "pjurominer_cotenant_active_workers", "gauge", "Workers allowed to hash in co-tenant mode.");
+        out += fmt::format("pjurominer_cotenant_active_workers {}\n", c.active_workers);
+        append_metric_header(out, "pjurominer_cotenant_parked_workers", "gauge", "Workers parked to leave CPU for other processes.");
+        out += fmt::format("pjurominer_cotenant_parked_workers {}\n", c.parked_workers);
+        append_metric_header(out, "pjurominer_cotenant_park_events_total", "counter", "Times the number of active workers was reduced.");
+        out += fmt::format("pjurominer_cotenant_park_events_total {}\n", c.park_events);
+        append_metric_header(out, "pjurominer_cotenant_hashrate_forgone", "gauge", "Estimated hashrate given up by parked workers (H/s).");
+        out += fmt::format("pjurominer_cotenant_hashrate_forgone {:.3f}\n", c.hashrate_forgone);
+        append_metric_header(out, "pjurominer_cotenant_hashes_forgone_total", "counter", "Estimated hashes given up by parked workers.");
+        out += fmt::format("pjurominer_cotenant_hashes_forgone_total {:.0f}\n", c.hashes_forgone_total);
+        append_metric_header(out, "pjurominer_cotenant_cpu_yielded_seconds_total", "counter", "CPU time left to other processes by parked workers.");
+        out += fmt::format("pjurominer_cotenant_cpu_yielded_seconds_total {:.3f}\n", c.cpu_seconds_yielded);
+        append_metric_header(out, "pjurominer_pressure_avg10_percent", "gauge", "PSI 'some avg10' observed by co-tenant mode (-1 if unavailable).");
+        out += fmt::format("pjurominer_pressure_avg10_percent{{resource=\"cpu\"}} {:.2f}\n", c.cpu_pressure_avg10);
+        out += fmt::format("pjurominer_pressure_avg10_percent{{resource=\"memory\"}} {:.2f}\n", c.memory_pressure_avg10);
+        append_metric_header(out, "pjurominer_pressure_stall_seconds_total", "counter", "PSI 'some total' stall time on the host (-1 if unavailable).");
+        out += fmt::format("pjurominer_pressure_stall_seconds_total{{resource=\"cpu\"}} {:.6f}\n", c.cpu_stall_seconds);
+        out += fmt::format("pjurominer_pressure_stall_seconds_total{{resource=\"memory\"}} {:.6f}\n", c.memory_stall_seconds);
+    }
+
+    return out;
+}
+
+std::string render_metrics_json(const MetricsSnapshot& s) {
+    auto windowed = [&s](const std::vector<double>& rates) {
+        json obj = json::object();
+        for (size_t w = 0; w < s.windows.size() && w < rates.size(); ++w) {
+            obj[s.windows[w]] = rates[w];
+        }
+        return obj;
+    };
+
+    auto optional_value = [](const std::optional<uint64_t>& v) {
+        return v ? json(*v) : json(nullptr);
+    };
+
+    json threads = json::array();
+    for (const auto& t : s.threads) {
+        json perf = nullptr;
+        if (t.perf) {
+            perf = {{"hardware", t.perf->hardware},
+                    {"cycles", optional_value(t.perf->cycles)},
+                    {"instructions", optional_value(t.perf->instructions)},
+                    {"ipc", t.perf->ipc()},
+                    {"llc_misses", optional_value(t.perf->llc_misses)},
+                    {"dtlb_misses", optional_value(t.perf->dtlb_misses)},
+                    {"context_switches", optional_value(t.perf->context_switches)},
+                    {"cpu_migrations", optional_value(t.perf->cpu_migrations)},
+                    {"task_clock_ns", optional_value(t.perf->task_clock_ns)}};
+        }
+        threads.push_back({{"id", t.id},
+                           {"perf", perf},
+                           {"hashes", t.hashes},
+                           {"ewma", t.ewma_rate},
+                           {"windows", windowed(t.window_rates)},
+                           {"latency_seconds", {{"p50", t.latency_p50_seconds},
+                                                {"p90", t.latency_p90_seconds},
+                                                {"p99", t.latency_p99_seconds},
+                                                {"count", t.latency_count}}}});
+    }
+
+    json j = {
+            {"hashrate", {{"total", windowed(s.total_window_rates)},
+                          {"total_ewma", s.total_ewma_rate},
+                          {"threads", threads}}},
+            {"shares", {{"accepted", s.shares_accepted}, {"rejected", s.shares_rejected}}},
+            {"dataset", {{"build_seconds", s.dataset_build_seconds},
+                         {"seed_epoch", s.seed_epoch},
+                         {"seed_hash", s.seed_hash},
+                         {"algo", s.algorithm},
+                         {"init", {{"active", s.dataset_init.active},
+                                   {"progress", s.dataset_init.fraction()},
+                                   {"elapsed_seconds", s.dataset_init.elapsed_seconds},
+                                   {"eta_seconds", s.dataset_init.eta_seconds},
+                                   {"threads", s.dataset_init.participants}}},
+                         {"scrub", {{"active", s.dataset_scrub.active},
+                                    {"items_checked", s.dataset_scrub.items_checked},
+                                    {"corrupt_items", s.dataset_scrub.corrupt_items},
+                                    {"corrupt_ranges", s.dataset_scrub.corrupt_ranges},
+                                    {"rebuilds", s.dataset_scrub.rebuilds},
+                                    {"passes", s.dataset_scrub.passes},
+                                    {"pass_progress", s.dataset_scrub.pass_progress}}}}},
+            {"pool", {{"rtt_seconds", s.pool_rtt_seconds}, {"job_age_seconds", s.job_age_seconds}}},
+            {"uptime_seconds", s.uptime_seconds},
+            {"log_dropped", s.log_dropped},
+            {"memory", {{"rss_bytes", optional_value(s.memory.rss_bytes)},
+                        {"peak_rss_bytes", optional_value(s.memory.peak_rss_bytes)},
+                        {"hugetlb_bytes", optional_value(s.memory.hugetlb_bytes)},
+                        {"hugepages_total", optional_value(s.memory.hugepages_total)},
+                        {"hugepages_free", optional_value(s.memory.hugepages_free)},
+                        {"randomx_cache_bytes", s.randomx_memory.cache_bytes},
+                        {"randomx_cache_large_pages", s.randomx_memory.cache_large_pages},
+                        {"randomx_dataset_bytes", s.randomx_memory.dataset_bytes},
+                        {"randomx_dataset_large_pages", s.randomx_memory.dataset_large_pages}}},
+            {"limits", {{"randomx_mode", s.randomx_mode},
+                        {"cpu", s.cpu_limit},
+                        {"memory_bytes", s.memory_limit_bytes}}}
+    };
+    if (s.limit) {
+        const auto& l = *s.limit;
+        j["limit"] = {{"kind", l.kind},
+                      {"target", l.target},
+                      {"measured", l.measured},
+                      {"deviation", l.deviation},
+                      {"correction", l.correction},
+                      {"throttle_seconds", l.throttle_seconds}};
+    }
+    if (s.share_journal) {
+        const auto& sj = *s.share_journal;
+        j["share_journal"] = {{"pending", sj.pending},
+                              {"appended", sj.appended},
+                              {"stale", sj.stale},
+                              {"dropped", sj.dropped}};
+    }
+    if (s.share_accounting) {
+        const auto& sa = *s.share_accounting;
+        json windows = json::object();
+        for (size_t w = 0; w < s.windows.size() && w < sa.windows.size(); ++w) {
+            const auto& sw = sa.windows[w];
+            windows[s.windows[w]] = {{"accepted", sw.accepted},
+                                     {"rejected", sw.rejected},
+                                     {"stale", sw.stale},
+                                     {"effective", sw.effective_rate},
+                                     {"effective_low", sw.effective_low},
+                                     {"effective_high", sw.effective_high},
+                                     {"local", sw.local_rate},
+                                     {"expected_shares", sw.expected_shares}};
+        }
+        json pools = json::array();
+        for (const auto& p : sa.pools) {
+            pools.push_back({{"pool", p.pool},
+                             {"accepted", p.accepted},
+                             {"rejected", p.rejected},
+                             {"stale", p.stale},
+                             {"accepted_difficulty", p.accepted_difficulty},
+                             {"rejected_difficulty", p.rejected_difficulty}});
+        }
+        json jobs = json::array();
+        for (const auto& job : sa.jobs) {
+            jobs.push_back({{"pool", job.pool},
+                            {"job_id", job.job_id},
+                            {"difficulty", job.difficulty},
+                            {"accepted", job.accepted},
+                            {"rejected", job.rejected},
+                            {"stale", job.stale}});
+        }
+        json reasons = json::object();
+        for (size_t r = 1; r < sa.reasons.size(); ++r) {
+            reasons[reject_reason_name(static_cast<RejectReason>(r))] = sa.reasons[r];
+        }
+        j["share_accounting"] = {{"windows", windows},
+                                 {"pools", pools},
+                                 {"jobs", jobs},
+                                 {"rejected_by_reason", reasons},
+                                 {"alert", sa.alert},
+                                 {"alert_reason", sa.alert_reason}};
+    }
+    if (!s.pools.empty()) {
+        json pools = json::array();
+        for (const auto& p : s.pools) {
+            pools.push_back({{"pool", p.pool},
+                             {"connected", p.connected},
+                             {"active", p.active},
+                             {"threads", p.threads},
+                             {"weight", p.weight},
+                             {"dataset", p.dataset},
+                             {"rtt_seconds", p.rtt_seconds},
+                             {"job_age_seconds", p.job_age_seconds}});
+        }
+        j["pool_sessions"] = pools;
+    }
+    j["randomx_datasets"] = s.datasets;
+    if (s.watchdog) {
+        const auto& w = *s.watchdog;
+        j["watchdog"] = {{"degraded_workers", w.degraded_workers},
+                         {"stalled_workers", w.stalled_workers},
+                         {"hung_workers", w.hung_workers},
+                         {"peer_median_rate", w.peer_median_rate},
+                         {"interventions", {{"repin", w.repins}, {"vm_reset", w.vm_resets}, {"restart", w.restarts}}}};
+    }
+    if (s.fleet) {
+        const auto& f = *s.fleet;
+        j["fleet"] = {{"connected", f.connected},
+                      {"batches_sent", f.batches_sent},
+                      {"snapshots_sent", f.snapshots_sent},
+                      {"snapshots_dropped", f.snapshots_dropped},
+                      {"bytes_sent", f.bytes_sent},
+                      {"send_errors", f.send_errors}};
+    }
+    if (s.energy) {
+        const auto& e = *s.energy;
+        j["energy"] = {{"available", e.available},
+                       {"package_zones", e.package_zones},
+                       {"dram_zones", e.dram_zones},
+                       {"watts", {{"package", e.package_watts}, {"dram", e.dram_watts}, {"total", e.watts()}}},
+                       {"joules", {{"package", e.package_joules_total}, {"dram", e.dram_joules_total}}},
+                       {"hashes_per_joule", e.hashes_per_joule},
+                       {"joules_per_share", e.joules_per_share},
+                       {"counter_wraps", e.counter_wraps}};
+    }
+    if (s.cotenant) {
+        const auto& c = *s.cotenant;
+        j["cotenant"] = {{"active_workers", c.active_workers},
+                         {"parked_workers", c.parked_workers},
+                         {"park_events", c.park_events},
+                         {"hashrate_forgone", c.hashrate_forgone},
+                         {"hashes_forgone", c.hashes_forgone_total},
+                         {"cpu_seconds_yielded", c.cpu_seconds_yielded},
+                         {"pressure", {{"cpu_avg10", c.cpu_pressure_avg10},
+                                       {"memory_avg10", c.memory_pressure_avg10},
+                                       {"cpu_stall_seconds", c.cpu_stall_seconds},
+                                       {"memory_stall_seconds", c.memory_stall_seconds}}}};
+    }
+    return j.dump();
+}
+
+MetricsServer::MetricsServer(asio::io_context& io_context,
+                             const std::string& bind_address,
+                             uint16_t port,
+                             SnapshotProvider provider)
+        : m_io_context(io_context),
+          m_acceptor(io_context),
+          m_bind_address(bind_address),
+          m_port(port),
+          m_provider(std::move(provider)) {}
+
+void MetricsServer::start() {
+    tcp::endpoint endpoint(asio::ip::make_address(m_bind_address), m_port);
+    m_acceptor.open(endpoint.protocol());
+    m_acceptor.set_option(tcp::acceptor::reuse_address(true));
+    m_acceptor.bind(endpoint);
+    m_acceptor.listen();
+
+    LOG_INFO(LogCategory::Metrics, "[Metrics] Nasłuchuję na http://{}:{}/metrics", m_bind_address, m_port);
+
+    do_accept();
+}
+
+void MetricsServer::stop() {
+    asio::error_code ignored;
+    m_acceptor.close(ignored);
+}
+
+void MetricsServer::do_accept() {
+    auto self = shared_from_this();
+    auto socket = std::make_shared<tcp::socket>(m_io_context);
+    m_acceptor.async_accept(*socket, [this, self, socket](const asio::error_code& ec) {
+        if (ec) {
+            if (ec != asio::error::operation_aborted) {
+                LOG_WARN(LogCategory::Metrics, "[Metrics] Błąd akceptacji połączenia: {}", ec.message());
+            }
+            if (!m_acceptor.is_open()) {
+                return;
+            }
+        } else {
+            handle_connection(socket);
+        }
+        do_accept();
+    });
+}
+
+void MetricsServer::handle_connection(std::shared_ptr<tcp::socket> socket) {
+    auto self = shared_from_this();
+    auto buffer = std::make_shared<asio::streambuf>(MAX_REQUEST_SIZE);
+    auto deadline = std::make_shared<asio::steady_timer>(m_io_context, REQUEST_TIMEOUT);
+    deadline->async_wait([socket](const asio::error_code& ec) {
+        if (!ec) {
+            // Zamknięcie przerywa oczekujący odczyt lub zapis (kończą się błędem)
+            asio::error_code ignored;
+            socket->close(ignored);
+        }
+    });
+
+    asio::async_read_until(*socket, *buffer, "\r\n\r\n",
+                           [this, self, socket, buffer, deadline](const asio::error_code& ec, std::size_t /*length*/) {
+                               if (ec) {
+                                   // Klient rozłączył się, przysłał za duże żądanie albo minął czas
+                                   deadline->cancel();
+                                   asio::error_code ignored;
+                                   socket->close(ignored);
+                                   return;
+                               }
+
+                               std::istream is(buffer.get());
+                               std::string request_line;
+                               std::getline(is, request_line);
+                               if (!request_line.empty() && request_line.back() == '\r') {
+                                   request_line.pop_back();
+                               }
+
+                               auto response = std::make_shared<std::string>(build_response(request_line));
+                               asio::async_write(*socket, asio::buffer(*response),
+                                                 [socket, response, deadline](const asio::error_code& /*ec*/, std::size_t /*length*/) {
+                                                     deadline->cancel();
+                                                     asio::error_code ignored;
+                                                     socket->shutdown(tcp::socket::shutdown_both, ignored);
+                                                     socket->close(ignored);
+                                                 });
+                           });
+}
+
+std::string MetricsServer::build_response(const std::string& request_line) {
+    // Oczekujemy: "GET /sciezka HTTP/1.x"
+    auto first_space = request_line.find(' ');
+    auto second_space = request_line.find(' ', first_space + 1);
+    if (first_space == std::string::npos || second_space == std::string::npos) {
+        return http_response(400, "Bad Request", "text/plain", "bad request\n");
+    }
+
+    std::string method = request_line.substr(0, first_space);
+    std::string target = request_line.substr(first_space + 1, second_space - first_space - 1);
+
+    if (method != "GET") {
+        return http_response(405, "Method Not Allowed", "text/plain", "method not allowed\n");
+    }
+
+    if (target == "/metrics") {
+        return http_response(200, "OK", "text/plain; version=0.0.4; charset=utf-8", render_metrics_text(m_provider()));
+    }
+    if (target == "/metrics.json" || target == "/metrics?format=json") {
+        return http_response(200, "OK", "application/json", render_metrics_json(m_provider()));
+    }
+
+    if (target == "/trace") {
+        // Ślad Chrome na żądanie (pusty, jeśli śledzenie nie było włączone)
+        return http_response(200, "OK", "application/json", trace_export_chrome_json());
+    }
+
+    return http_response(404, "Not Found", "text/plain", "not found\n");
+}
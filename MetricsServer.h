@@ -0,0 +1,177 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+#include <asio.hpp>
+
+#include "PerfCounters.h"
+#include "MemoryReport.h"
+#include "DatasetInit.h"
+#include "DatasetScrubber.h"
+#include "EnergyMonitor.h"
+#include "FleetReporter.h"
+#include "WorkerWatchdog.h"
+#include "ShareJournal.h"
+#include "ShareAccounting.h"
+
+/**
+ * @struct MetricsSnapshot
+ * @brief Migawka statystyk minera, z której renderowane są metryki.
+ * Zbierana w wątku io_context bez blokowania wątków roboczych
+ * (tylko odczyty atomowe z rdzenia telemetrii).
+ */
+struct MetricsSnapshot {
+    struct ThreadStats {
+        int id = 0;
+        uint64_t hashes = 0;              // Licznik hashy od startu
+        double ewma_rate = 0.0;           // H/s (EWMA)
+        std::vector<double> window_rates; // H/s w oknach z `windows`
+        double latency_p50_seconds = 0.0; // Opóźnienie pojedynczego hasha
+        double latency_p90_seconds = 0.0;
+        double latency_p99_seconds = 0.0;
+        uint64_t latency_count = 0;
+        std::optional<PerfSample> perf;   // Liczniki perf_event_open (opcjonalne)
+    };
+
+    std::vector<std::string> windows; // Etykiety okien, np. "10s", "1m"
+    std::vector<ThreadStats> threads;
+    std::vector<double> total_window_rates;
+    double total_ewma_rate = 0.0;
+
+    uint64_t shares_accepted = 0;
+    uint64_t shares_rejected = 0;
+
+    double dataset_build_seconds = 0.0; // Czas ostatniej budowy datasetu
+    uint64_t seed_epoch = 0;            // Liczba zmian seeda od startu
+    std::string seed_hash;
+    DatasetInitProgress dataset_init;   // Postęp bieżącej lub ostatniej inicjalizacji datasetu
+    DatasetScrubStats dataset_scrub;    // Skanowanie datasetu (suma po datasetach wszystkich pul)
+
+    double pool_rtt_seconds = -1.0;     // -1 = brak pomiaru
+    double job_age_seconds = -1.0;      // -1 = brak pracy
+    double uptime_seconds = 0.0;
+    uint64_t log_dropped = 0;           // Wiadomości porzucone przez logger
+
+    MemoryUsage memory;                 // RSS i huge pages
+    RandomXFootprint randomx_memory;    // Cache i dataset RandomX
+
+    std::string randomx_mode = "fast";  // "fast" / "light"
+    std::string algorithm = "rx/0";     // Wariant RandomX bieżącego seeda
+    double cpu_limit = -1.0;            // Limit CPU z cgroup (-1 = brak)
+    double memory_limit_bytes = -1.0;   // Limit pamięci z cgroup (-1 = brak)
+
+    // Tryb co-tenant (zobacz CotenantMonitor.h); pomijany, gdy wyłączony
+    struct Cotenant {
+        unsigned active_workers = 0;
+        unsigned parked_workers = 0;
+        uint64_t park_events = 0;
+        double hashrate_forgone = 0.0;       // H/s oddane innym procesom
+        double hashes_forgone_total = 0.0;
+        double cpu_seconds_yielded = 0.0;
+        double cpu_pressure_avg10 = -1.0;    // PSI "some avg10" w % (-1 = brak PSI)
+        double memory_pressure_avg10 = -1.0;
+        double cpu_stall_seconds = -1.0;     // PSI "some total" (-1 = brak PSI)
+        double memory_stall_seconds = -1.0;
+    };
+    std::optional<Cotenant> cotenant;
+
+    // Nadzór workerów (zobacz WorkerWatchdog.h); pomijany, gdy wyłączony
+    std::optional<WorkerWatchdog::Stats> watchdog;
+
+    // Wysyłka do agregatora floty (zobacz FleetReporter.h); pomijana, gdy wyłączona
+    std::optional<FleetReporter::Stats> fleet;
+
+    // Pomiar energii RAPL (zobacz EnergyMonitor.h); pomijany, gdy wyłączony
+    std::optional<EnergyMonitor::Stats> energy;
+
+    // Limit hashrate/CPU/mocy (zobacz RateLimiter.h); pomijany, gdy brak limitu
+    struct Limit {
+        std::string kind;             // "hashrate", "cpu" lub "power"
+        double target = 0.0;          // H/s, rdzenie lub W
+        double measured = 0.0;
+        double deviation = 0.0;       // (measured - target) / target
+        double correction = 1.0;
+        double throttle_seconds = 0.0;
+    };
+    std::optional<Limit> limit;
+
+    // Dziennik udziałów (zobacz ShareJournal.h); pomijany, gdy wyłączony
+    std::optional<ShareJournalStats> share_journal;
+
+    // Rozliczenie udziałów (zobacz ShareAccounting.h)
+    std::optional<ShareAccountingStats> share_accounting;
+
+    // Sesje pul (zobacz PoolScheduler.h); jedna przy kopaniu na jedną pulę
+    struct Pool {
+        std::string pool;              // "host:port"
+        bool connected = false;
+        bool active = false;
+        unsigned threads = 0;
+        unsigned weight = 1;
+        int dataset = -1;              // Numer współdzielonego datasetu (-1 = brak)
+        double rtt_seconds = -1.0;
+        double job_age_seconds = -1.0;
+    };
+    std::vector<Pool> pools;
+    std::size_t datasets = 1;          // Liczba managerów RandomX (różnych seedów)
+};
+
+/**
+ * @brief Renderuje migawkę w formacie tekstowym Prometheusa (text exposition 0.0.4).
+ */
+std::string render_metrics_text(const MetricsSnapshot& snapshot);
+
+/**
+ * @brief Renderuje migawkę jako obiekt JSON.
+ */
+std::string render_metrics_json(const MetricsSnapshot& snapshot);
+
+/**
+ * @class MetricsServer
+ * @brief Minimalny serwer HTTP na istniejącym io_context, udostępniający
+ * /metrics (Prometheus), /metrics.json oraz /trace (Chrome trace JSON).
+ *
+ * Każde połączenie obsługuje jedno żądanie GET i jest zamykane po odpowiedzi.
+ */
+class MetricsServer : public std::enable_shared_from_this<MetricsServer> {
+public:
+    using SnapshotProvider = std::function<MetricsSnapshot()>;
+
+    /**
+     * @brief Konstruktor.
+     * @param io_context Główna pętla zdarzeń Asio.
+     * @param bind_address Adres nasłuchu (np. "127.0.0.1" lub "0.0.0.0").
+     * @param port Port TCP.
+     * @param provider Funkcja zbierająca migawkę (wywoływana w wątku io_context).
+     */
+    MetricsServer(asio::io_context& io_context,
+                  const std::string& bind_address,
+                  uint16_t port,
+                  SnapshotProvider provider);
+
+    /**
+     * @brief Otwiera gniazdo i zaczyna przyjmować połączenia.
+     * @throws std::system_error jeśli nie można powiązać portu.
+     */
+    void start();
+
+    /**
+     * @brief Zamyka gniazdo nasłuchujące.
+     */
+    void stop();
+
+private:
+    void do_accept();
+    void handle_connection(std::shared_ptr<asio::ip::tcp::socket> socket);
+    std::string build_response(const std::string& request_line);
+
+    asio::io_context& m_io_context;
+    asio::ip::tcp::acceptor m_acceptor;
+    std::string m_bind_address;
+    uint16_t m_port;
+    SnapshotProvider m_provider;
+};
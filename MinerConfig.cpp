@@ -0,0 +1,510 @@
+#include "MinerConfig.h"
+#include "RandomXAlgorithm.h"
+#include <stdexcept>
+#include <charconv>
+#include <fstream>
+#include <algorithm>
+#include <fmt/core.h>
+#include <fmt/ranges.h>
+#include <nlohmann/json.hpp>
+
+namespace {
+
+/**
+ * @brief Pobiera wartość opcji (kolejny argument) lub rzuca wyjątek.
+ */
+std::string take_value(const std::vector<std::string>& args, std::size_t& i) {
+    if (i + 1 >= args.size()) {
+        throw std::invalid_argument(fmt::format("Opcja {} wymaga wartości", args[i]));
+    }
+    return args[++i];
+}
+
+/**
+ * @brief Parsuje liczbę całkowitą bez znaku z zakresem [0, max].
+ */
+unsigned long parse_unsigned(const std::string& option, const std::string& value, unsigned long max) {
+    unsigned long result = 0;
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+    if (ec != std::errc() || ptr != value.data() + value.size() || result > max) {
+        throw std::invalid_argument(fmt::format("Nieprawidłowa wartość dla {}: '{}'", option, value));
+    }
+    return result;
+}
+
+/**
+ * @brief Dzieli "HOST:PORT" (port po ostatnim dwukropku).
+ */
+void parse_host_port(const std::string& option, const std::string& value, std::string& host, std::string& port) {
+    auto colon = value.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == value.size()) {
+        throw std::invalid_argument(fmt::format("Oczekiwano HOST:PORT dla {}, otrzymano '{}'", option, value));
+    }
+    host = value.substr(0, colon);
+    port = value.substr(colon + 1);
+}
+
+/**
+ * @brief Parsuje listę pul "[PORTFEL@]HOST:PORT,...".
+ */
+std::vector<PoolEndpoint> parse_pool_list(const std::string& option, const std::string& value) {
+    std::vector<PoolEndpoint> pools;
+    std::size_t start = 0;
+    while (start <= value.size()) {
+        std::size_t comma = value.find(',', start);
+        std::string item = value.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        PoolEndpoint pool;
+        auto at = item.find('@');
+        if (at != std::string::npos) {
+            pool.wallet = item.substr(0, at);
+            if (pool.wallet.empty()) {
+                throw std::invalid_argument(fmt::format("Pusty portfel w {}: '{}'", option, item));
+            }
+            item.erase(0, at + 1);
+        }
+        parse_host_port(option, item, pool.host, pool.port);
+        pools.push_back(std::move(pool));
+        if (comma == std::string::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+    return pools;
+}
+
+/**
+ * @brief Parsuje listę wag, np. "3,1" (każda 1-1000).
+ */
+std::vector<unsigned> parse_weights(const std::string& option, const std::string& value) {
+    std::vector<unsigned> weights;
+    std::size_t start = 0;
+    while (start <= value.size()) {
+        std::size_t comma = value.find(',', start);
+        std::string item = value.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        unsigned weight = static_cast<unsigned>(parse_unsigned(option, item, 1000));
+        if (weight == 0) {
+            throw std::invalid_argument(fmt::format("Waga w {} musi być dodatnia", option));
+        }
+        weights.push_back(weight);
+        if (comma == std::string::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+    return weights;
+}
+
+/**
+ * @brief Parsuje listę okien czasowych, np. "10s,1m,15m,1h".
+ */
+std::vector<std::chrono::seconds> parse_windows(const std::string& option, const std::string& value) {
+    std::vector<std::chrono::seconds> windows;
+    std::size_t start = 0;
+    while (start <= value.size()) {
+        std::size_t comma = value.find(',', start);
+        std::string item = value.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        if (item.empty()) {
+            throw std::invalid_argument(fmt::format("Puste okno w {}: '{}'", option, value));
+        }
+
+        unsigned long multiplier = 1;
+        switch (item.back()) {
+            case 's': item.pop_back(); break;
+            case 'm': item.pop_back(); multiplier = 60; break;
+            case 'h': item.pop_back(); multiplier = 3600; break;
+            default: break;
+        }
+        unsigned long amount = parse_unsigned(option, item, 7 * 24 * 3600);
+        if (amount == 0) {
+            throw std::invalid_argument(fmt::format("Okno w {} musi być dodatnie", option));
+        }
+        windows.emplace_back(amount * multiplier);
+
+        if (comma == std::string::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+    return windows;
+}
+
+/**
+ * @brief Parsuje listę CPU, np. "0,2,4" lub "0-3,8".
+ */
+std::vector<unsigned> parse_cpu_list(const std::string& option, const std::string& value) {
+    std::vector<unsigned> cpus;
+    std::size_t start = 0;
+    while (start <= value.size()) {
+        std::size_t comma = value.find(',', start);
+        std::string item = value.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+
+        auto dash = item.find('-');
+        unsigned first = static_cast<unsigned>(parse_unsigned(option, item.substr(0, dash), 4095));
+        unsigned last = dash == std::string::npos
+                        ? first
+                        : static_cast<unsigned>(parse_unsigned(option, item.substr(dash + 1), 4095));
+        if (last < first) {
+            throw std::invalid_argument(fmt::format("Pusty zakres CPU w {}: '{}'", option, item));
+        }
+        for (unsigned cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+
+        if (comma == std::string::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+    return cpus;
+}
+
+/**
+ * @brief Parsuje próg procentowy z zakresu [0, 100], np. "12.5".
+ */
+double parse_percent(const std::string& option, const std::string& value) {
+    double result = 0.0;
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+    if (ec != std::errc() || ptr != value.data() + value.size() || result < 0.0 || result > 100.0) {
+        throw std::invalid_argument(fmt::format("Nieprawidłowa wartość dla {}: '{}' (oczekiwano 0-100)", option, value));
+    }
+    return result;
+}
+
+/**
+ * @brief Parsuje listę wariantów RandomX, np. "rx/0,rx/wow", do nazw kanonicznych.
+ */
+std::vector<std::string> parse_algorithms(const std::string& option, const std::string& value) {
+    std::vector<std::string> names;
+    std::size_t start = 0;
+    while (start <= value.size()) {
+        std::size_t comma = value.find(',', start);
+        std::string item = value.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        const RandomXAlgorithm* algorithm = find_randomx_algorithm(item);
+        if (!algorithm) {
+            throw std::invalid_argument(fmt::format("Nieobsługiwany algorytm dla {}: '{}' (wkompilowane: {})",
+                                                    option, item, fmt::join(randomx_algorithm_names(), ", ")));
+        }
+        if (std::find(names.begin(), names.end(), algorithm->name) == names.end()) {
+            names.emplace_back(algorithm->name);
+        }
+        if (comma == std::string::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+    return names;
+}
+
+/**
+ * @brief Ustawia opcję-przełącznik (bez wartości). Zwraca false dla innych opcji.
+ */
+bool set_flag(MinerConfig& config, const std::string& arg, bool value) {
+    if (arg == "--perf-counters") {
+        config.perf_counters = value;
+    } else if (arg == "--trace") {
+        config.trace = value;
+    } else if (arg == "--log-json") {
+        config.logging.json_lines = value;
+    } else if (arg == "--release-cache") {
+        config.release_cache = value;
+    } else if (arg == "--cotenant") {
+        config.cotenant.enabled = value;
+    } else if (arg == "--energy") {
+        config.energy.enabled = value;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Zamienia obiekt JSON pliku konfiguracyjnego na listę argumentów.
+ * Przełączniki z wartością false są ustawiane bezpośrednio.
+ */
+std::vector<std::string> json_to_arguments(const nlohmann::json& j, MinerConfig& config) {
+    if (!j.is_object()) {
+        throw std::invalid_argument("Plik konfiguracyjny musi zawierać obiekt JSON");
+    }
+
+    std::vector<std::string> args;
+    for (const auto& [key, value] : j.items()) {
+        std::string arg = "--" + key;
+        if (value.is_boolean()) {
+            if (!set_flag(config, arg, value.get<bool>())) {
+                throw std::invalid_argument(fmt::format("Opcja {} nie jest przełącznikiem", key));
+            }
+            continue;
+        }
+
+        args.push_back(arg);
+        if (value.is_string()) {
+            args.push_back(value.get<std::string>());
+        } else if (value.is_number_unsigned()) {
+            args.push_back(std::to_string(value.get<uint64_t>()));
+        } else if (value.is_number_float()) {
+            args.push_back(value.dump()); // Progi procentowe, np. "cotenant-psi-high": 12.5
+        } else if (value.is_array()) {
+            std::string joined;
+            for (const auto& item : value) {
+                if (!joined.empty()) {
+                    joined += ',';
+                }
+                joined += item.is_string() ? item.get<std::string>() : item.dump();
+            }
+            args.push_back(joined);
+        } else {
+            throw std::invalid_argument(fmt::format("Nieprawidłowa wartość dla {}: {}", key, value.dump()));
+        }
+    }
+    return args;
+}
+
+void apply_arguments(const std::vector<std::string>& args, MinerConfig& config) {
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+
+        if (set_flag(config, arg, true)) {
+            continue;
+        }
+
+        if (arg == "--pool") {
+            parse_host_port(arg, take_value(args, i), config.pool_host, config.pool_port);
+        } else if (arg == "--extra-pool") {
+            auto pools = parse_pool_list(arg, take_value(args, i));
+            config.extra_pools.insert(config.extra_pools.end(), pools.begin(), pools.end());
+        } else if (arg == "--pool-weights") {
+            config.pool_weights = parse_weights(arg, take_value(args, i));
+        } else if (arg == "--pool-split") {
+            std::string value = take_value(args, i);
+            if (value == "threads") {
+                config.pool_split = PoolSplit::Threads;
+            } else if (value == "time") {
+                config.pool_split = PoolSplit::Time;
+            } else {
+                throw std::invalid_argument(fmt::format("Nieprawidłowa wartość dla --pool-split: '{}' (threads lub time)", value));
+            }
+        } else if (arg == "--pool-slice") {
+            auto windows = parse_windows(arg, take_value(args, i));
+            if (windows.size() != 1) {
+                throw std::invalid_argument("--pool-slice przyjmuje jeden czas, np. 60s lub 5m");
+            }
+            config.pool_slice = windows.front();
+        } else if (arg == "--user") {
+            config.wallet = take_value(args, i);
+        } else if (arg == "--threads") {
+            config.threads = static_cast<unsigned int>(parse_unsigned(arg, take_value(args, i), 4096));
+        } else if (arg == "--scrub-rate") {
+            config.scrub_rate = static_cast<unsigned int>(parse_unsigned(arg, take_value(args, i), 10000000));
+        } else if (arg == "--scrub-rebuild") {
+            config.scrub_rebuild = static_cast<unsigned int>(parse_unsigned(arg, take_value(args, i), 1000000));
+        } else if (arg == "--init-threads") {
+            config.init_threads = static_cast<unsigned int>(parse_unsigned(arg, take_value(args, i), 4096));
+        } else if (arg == "--dataset-kernel") {
+            std::string value = take_value(args, i);
+            auto kernel = parse_dataset_kernel(value);
+            if (!kernel) {
+                throw std::invalid_argument(fmt::format(
+                        "Oczekiwano auto, library, scalar, avx2 lub avx512 dla --dataset-kernel, otrzymano '{}'", value));
+            }
+            config.dataset_kernel = *kernel;
+        } else if (arg == "--affinity") {
+            std::string value = take_value(args, i);
+            config.affinity = value.empty() ? std::vector<unsigned>{} : parse_cpu_list(arg, value);
+        } else if (arg == "--metrics-port") {
+            config.metrics_port = static_cast<uint16_t>(parse_unsigned(arg, take_value(args, i), 65535));
+        } else if (arg == "--metrics-bind") {
+            config.metrics_bind = take_value(args, i);
+        } else if (arg == "--fleet-collector") {
+            parse_fleet_collector(take_value(args, i), config.fleet);
+        } else if (arg == "--fleet-interval") {
+            auto windows = parse_windows(arg, take_value(args, i));
+            if (windows.size() != 1) {
+                throw std::invalid_argument("--fleet-interval przyjmuje jeden czas, np. 10s lub 1m");
+            }
+            config.fleet.interval = windows.front();
+        } else if (arg == "--fleet-batch") {
+            config.fleet.batch = static_cast<unsigned>(parse_unsigned(arg, take_value(args, i), 60));
+            if (config.fleet.batch == 0) {
+                throw std::invalid_argument("--fleet-batch musi być dodatnie");
+            }
+        } else if (arg == "--fleet-host") {
+            config.fleet.host = take_value(args, i);
+            if (config.fleet.host.empty() || config.fleet.host.size() > 255) {
+                throw std::invalid_argument("--fleet-host musi mieć od 1 do 255 znaków");
+            }
+        } else if (arg == "--stats-windows") {
+            config.stats_windows = parse_windows(arg, take_value(args, i));
+        } else if (arg == "--trace-file") {
+            config.trace_file = take_value(args, i);
+        } else if (arg == "--share-journal") {
+            std::string value = take_value(args, i);
+            config.share_journal = value == "none" ? "" : value;
+        } else if (arg == "--seed-file") {
+            std::string value = take_value(args, i);
+            config.seed_file = value == "none" ? "" : value;
+        } else if (arg == "--log-level") {
+            config.logging.min_level = parse_log_level(take_value(args, i));
+        } else if (arg == "--log-categories") {
+            config.logging.category_mask = parse_log_categories(take_value(args, i));
+        } else if (arg == "--control-port") {
+            config.control_port = static_cast<uint16_t>(parse_unsigned(arg, take_value(args, i), 65535));
+        } else if (arg == "--control-bind") {
+            config.control_bind = take_value(args, i);
+        } else if (arg == "--mode") {
+            std::string value = take_value(args, i);
+            if (value == "auto") {
+                config.randomx_mode.reset();
+            } else if (value == "fast") {
+                config.randomx_mode = RandomXMode::Fast;
+            } else if (value == "light") {
+                config.randomx_mode = RandomXMode::Light;
+            } else {
+                throw std::invalid_argument(fmt::format("Oczekiwano auto, fast lub light dla --mode, otrzymano '{}'", value));
+            }
+        } else if (arg == "--algo") {
+            config.algorithms = parse_algorithms(arg, take_value(args, i));
+        } else if (arg == "--cgroup-root") {
+            config.cgroup_root = take_value(args, i);
+        } else if (arg == "--watchdog-slow") {
+            config.watchdog.slow_ratio = parse_percent(arg, take_value(args, i)) / 100.0;
+        } else if (arg == "--energy-root") {
+            config.energy.enabled = true;
+            config.energy.sysfs_root = take_value(args, i);
+        } else if (arg == "--cotenant-nice") {
+            config.cotenant.enabled = true;
+            config.cotenant.priority = {ThreadPriority::Class::Nice,
+                                        static_cast<int>(parse_unsigned(arg, take_value(args, i), 19))};
+        } else if (arg == "--stub-share-percent") {
+            config.stub_share_percent = parse_percent(arg, take_value(args, i));
+        } else if (arg == "--cotenant-psi-high") {
+            config.cotenant.cpu_pressure_high = parse_percent(arg, take_value(args, i));
+        } else if (arg == "--cotenant-psi-low") {
+            config.cotenant.cpu_pressure_low = parse_percent(arg, take_value(args, i));
+        } else if (arg == "--limit") {
+            config.limit = parse_rate_limit(take_value(args, i));
+        } else if (arg == "--config") {
+            std::string path = take_value(args, i);
+            config = load_config_file(path, std::move(config));
+        } else {
+            throw std::invalid_argument(fmt::format("Nieznana opcja: {}", arg));
+        }
+    }
+}
+
+/**
+ * @brief Sprawdza zależności między opcjami (po wczytaniu wszystkich).
+ */
+void validate(const MinerConfig& config) {
+    if (config.pool_weights.size() > config.extra_pools.size() + 1) {
+        throw std::invalid_argument(fmt::format("--pool-weights ma {} wag, a pul jest {}",
+                                                config.pool_weights.size(), config.extra_pools.size() + 1));
+    }
+    if (config.limit.kind == RateLimit::Kind::Watts && !config.energy.enabled) {
+        throw std::invalid_argument(fmt::format("Limit mocy {} wymaga pomiaru energii (--energy)", format_rate_limit(config.limit)));
+    }
+    if (config.cotenant.cpu_pressure_low > config.cotenant.cpu_pressure_high) {
+        throw std::invalid_argument(fmt::format("--cotenant-psi-low ({}) nie może przekraczać --cotenant-psi-high ({})",
+                                                config.cotenant.cpu_pressure_low, config.cotenant.cpu_pressure_high));
+    }
+}
+
+} // namespace
+
+MinerConfig parse_command_line(int argc, char* argv[]) {
+    MinerConfig config;
+    apply_arguments(std::vector<std::string>(argv + 1, argv + argc), config);
+    validate(config);
+    return config;
+}
+
+MinerConfig load_config_file(const std::string& path, MinerConfig base) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::invalid_argument(fmt::format("Nie można otworzyć pliku konfiguracyjnego '{}'", path));
+    }
+
+    nlohmann::json j;
+    try {
+        in >> j;
+    } catch (const nlohmann::json::parse_error& e) {
+        throw std::invalid_argument(fmt::format("Błąd składni w '{}': {}", path, e.what()));
+    }
+
+    if (j.contains("config")) {
+        throw std::invalid_argument("Plik konfiguracyjny nie może zawierać klucza 'config'");
+    }
+    apply_arguments(json_to_arguments(j, base), base);
+    validate(base);
+    base.config_file = path;
+    return base;
+}
+
+std::vector<PoolEndpoint> pool_endpoints(const MinerConfig& config) {
+    std::vector<PoolEndpoint> pools{{config.pool_host, config.pool_port, config.wallet}};
+    for (PoolEndpoint pool : config.extra_pools) {
+        if (pool.wallet.empty()) {
+            pool.wallet = config.wallet;
+        }
+        pools.push_back(std::move(pool));
+    }
+    return pools;
+}
+
+unsigned pool_weight(const MinerConfig& config, std::size_t session) {
+    return session < config.pool_weights.size() ? config.pool_weights[session] : 1;
+}
+
+std::string command_line_usage() {
+    return "Użycie: pjurominer [opcje]\n"
+           "       pjurominer bench-init [--threads 1,2,4] [--items N] [--no-numa] [--algo WARIANT]\n"
+           "                             [--kernel library,avx2] [--json PLIK]\n"
+           "       pjurominer hash [--input PLIK] [--output PLIK] [--threads N] [--affinity LISTA]\n"
+           "                       [--mode fast|light] [--algo WARIANT] [--batch N] [--echo]\n"
+           "  --pool HOST:PORT        Adres puli (domyślnie pool.supportxmr.com:3333)\n"
+           "  --user PORTFEL          Adres portfela (login)\n"
+           "  --extra-pool LISTA      Dodatkowe pule kopane równolegle: [PORTFEL@]HOST:PORT,...\n"
+           "  --pool-weights LISTA    Wagi podziału mocy, główna pula pierwsza, np. 3,1\n"
+           "  --pool-split TRYB       threads (grupy wątków wg wag) lub time (przedziały czasu)\n"
+           "  --pool-slice CZAS       Cykl przedziałów przy --pool-split time (domyślnie 60s)\n"
+           "  --threads N             Liczba wątków roboczych (0 = auto)\n"
+           "  --metrics-port PORT     Włącza endpoint metryk HTTP (/metrics, /metrics.json)\n"
+           "  --metrics-bind ADRES    Adres nasłuchu metryk (domyślnie 127.0.0.1)\n"
+           "  --fleet-collector URL   Wysyła migawki do agregatora floty: udp://HOST:PORT lub tcp://HOST:PORT\n"
+           "  --fleet-interval CZAS   Odstęp między migawkami (domyślnie 10s)\n"
+           "  --fleet-batch N         Migawki w jednej wysyłce (domyślnie 3)\n"
+           "  --fleet-host NAZWA      Nazwa hosta w agregatorze (domyślnie nazwa systemu)\n"
+           "  --stats-windows LISTA   Okna hashrate, np. 10s,1m,15m,1h\n"
+           "  --perf-counters         Liczniki sprzętowe per wątek (perf_event_open, Linux)\n"
+           "  --trace                 Włącza śledzenie opóźnień (klawisz 't' zapisuje ślad)\n"
+           "  --trace-file PLIK       Plik śladu Chrome (domyślnie pjurominer_trace.json)\n"
+           "  --share-journal PLIK    Dziennik udziałów (domyślnie pjurominer_shares.journal; none = wyłączony)\n"
+           "  --seed-file PLIK        Ostatni seed do budowy datasetu równolegle z łączeniem (domyślnie\n"
+           "                          pjurominer_seed.json; none = start bez spekulacji)\n"
+           "  --affinity LISTA        Przypięcie wątków do CPU, np. 0-3 lub 0,2,4\n"
+           "  --control-port PORT     Włącza interfejs sterowania HTTP (pauza, wątki, pula)\n"
+           "  --control-bind ADRES    Adres interfejsu sterowania (domyślnie 127.0.0.1)\n"
+           "  --config PLIK           Plik konfiguracyjny JSON (klucze jak opcje bez --)\n"
+           "  --algo LISTA            Warianty RandomX zgłaszane puli, np. rx/0,rx/wow (domyślnie wszystkie)\n"
+           "  --mode TRYB             auto (wg pamięci i huge pages), fast (dataset 2 GB) lub light (cache 256 MB)\n"
+           "  --init-threads N        Wątki inicjalizacji datasetu (0 = wszystkie CPU)\n"
+           "  --dataset-kernel NAZWA  Liczenie datasetu: auto (domyślnie), library, scalar, avx2 lub avx512\n"
+           "                          (kernele wektorowe liczą 4-8 elementów naraz; zawsze sprawdzane z biblioteką)\n"
+           "  --release-cache         Zwalnia cache RandomX (256 MB) po zbudowaniu datasetu\n"
+           "                          (wyłącza skanowanie datasetu - brak cache'a do porównania)\n"
+           "  --scrub-rate N          Elementy datasetu sprawdzane na sekundę w tle (domyślnie 1000, 0 = wył.)\n"
+           "  --scrub-rebuild N       Uszkodzenia w przebiegu, po których dataset jest przebudowany (domyślnie 64)\n"
+           "  --stub-share-percent P  Backend stub: % hashy będących udziałami (0 = wg targetu puli)\n"
+           "  --cgroup-root KATALOG   Korzeń dla odczytu limitów cgroup i /proc (testy)\n"
+           "  --cotenant              Ustępuje innym usługom: SCHED_IDLE, parkowanie wg PSI\n"
+           "  --cotenant-nice N       Jak --cotenant, ale z priorytetem nice N zamiast SCHED_IDLE\n"
+           "  --cotenant-psi-high P   Próg presji CPU (% avg10) parkowania workera (domyślnie 10)\n"
+           "  --cotenant-psi-low P    Próg presji CPU (% avg10) wznowienia workera (domyślnie 2)\n"
+           "  --limit LIMIT           Limit: hashrate (500, 1.5kH/s), % CPU (50%), rdzenie (2.5cores) lub moc (120W)\n"
+           "  --watchdog-slow P       Watchdog: worker poniżej P% mediany i własnej historii jest naprawiany\n"
+           "                          (przepięcie, nowa VM, restart; domyślnie 50, 0 = wyłączony)\n"
+           "  --energy                Pomiar energii z RAPL: waty, hashe na dżul, dżule na udział (Linux)\n"
+           "  --energy-root KATALOG   Korzeń dla /sys/class/powercap (testy); włącza --energy\n"
+           "  --log-level POZIOM      debug, info, notice, warn, error (domyślnie info)\n"
+           "  --log-categories LISTA  Tylko wybrane kategorie, np. stratum,worker\n"
+           "  --log-json              Logi jako JSON (jedna linia na wiadomość)\n";
+}
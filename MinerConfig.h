@@ -0,0 +1,163 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <vector>
+#include <chrono>
+#include <optional>
+#include "CotenantMonitor.h"
+#include "DatasetKernel.h"
+#include "EnergyMonitor.h"
+#include "FleetReporter.h"
+#include "Logger.h"
+#include "MiningCommon.h"
+#include "RateLimiter.h"
+#include "WorkerWatchdog.h"
+
+/**
+ * @struct PoolEndpoint
+ * @brief Pula kopana równolegle z główną (--extra-pool).
+ */
+struct PoolEndpoint {
+    std::string host;
+    std::string port;
+    std::string wallet; // Pusty = portfel z --user
+
+    bool operator==(const PoolEndpoint&) const = default;
+};
+
+/**
+ * @struct MinerConfig
+ * @brief Konfiguracja minera (pula, portfel, wątki, opcjonalne usługi).
+ * Wartości domyślne odpowiadają dotychczasowym stałym z main.cpp.
+ */
+struct MinerConfig {
+    std::string pool_host = "pool.supportxmr.com";
+    std::string pool_port = "3333";
+    std::string wallet = "44xLKKizoqAioFsVQtm9AbUVYW7TrJGFBcYVQErc18qcVRrW5koAK2Yh3kVvGibh8w15E5gym3n5V8RSV7Q2bSuPT7kHQ72";
+
+    // Dodatkowe pule kopane w tym samym procesie (sesje 1..N; sesja 0 to pool_host/wallet)
+    std::vector<PoolEndpoint> extra_pools;
+
+    // Wagi podziału mocy w kolejności sesji (brakujące = 1)
+    std::vector<unsigned> pool_weights;
+    PoolSplit pool_split = PoolSplit::Threads;
+    std::chrono::seconds pool_slice{60}; // Pełny cykl przedziałów przy PoolSplit::Time
+
+    // 0 = automatycznie (std::thread::hardware_concurrency())
+    unsigned int threads = 0;
+
+    // Worker i przypięty do affinity[i % size]; pusta lista = bez przypinania
+    std::vector<unsigned> affinity;
+
+    // Warianty RandomX zgłaszane puli ("algo" przy logowaniu), w kolejności preferencji;
+    // pusta lista = wszystkie wkompilowane (rx/0 pierwszy)
+    std::vector<std::string> algorithms;
+
+    // Tryb RandomX (std::nullopt = auto: fast, chyba że limit pamięci cgroup na to nie pozwala)
+    std::optional<RandomXMode> randomx_mode;
+
+    // Wątki inicjalizacji datasetu (0 = wszystkie dostępne CPU)
+    unsigned int init_threads = 0;
+
+    // Liczenie elementów datasetu: auto (najszybszy kernel zgodny z biblioteką), library, scalar, avx2, avx512
+    DatasetKernel dataset_kernel = DatasetKernel::Auto;
+
+    // Zwolnienie cache'a (256 MB) po zbudowaniu datasetu w trybie fast
+    bool release_cache = false;
+
+    // Skanowanie datasetu w tle: elementy na sekundę (0 = wyłączone) i próg przebudowy
+    unsigned int scrub_rate = 1000;
+    unsigned int scrub_rebuild = 64;
+
+    // Backend stub (kompilacja z PJUROMINER_STUB_BACKEND): % hashy będących udziałami (0 = wg targetu puli)
+    double stub_share_percent = 0.0;
+
+    // Korzeń systemu plików dla odczytu cgroup i PSI (pusty = "/"; inny np. w testach)
+    std::string cgroup_root;
+
+    // Limit hashrate lub budżetu CPU (zmienialny na żywo przez /limit i /reload)
+    RateLimit limit;
+
+    // Tryb co-tenant: niski priorytet wątków i parkowanie przy presji innych procesów
+    CotenantConfig cotenant;
+
+    // Nadzór workerów: zawieszone i wolne wątki są przepinane, dostają nową VM lub restart
+    WatchdogConfig watchdog;
+
+    // Pomiar energii z RAPL (waty, hashe na dżul; wymagany przez limit mocy)
+    EnergyConfig energy;
+
+    // Endpoint metryk HTTP (0 = wyłączony)
+    uint16_t metrics_port = 0;
+    std::string metrics_bind = "127.0.0.1";
+
+    // Migawki dla agregatora floty (pjurominer_fleet); bez kolektora wyłączone
+    FleetConfig fleet;
+
+    // Okna uśredniania hashrate (telemetria, statystyki, metryki)
+    std::vector<std::chrono::seconds> stats_windows = {std::chrono::seconds(10), std::chrono::minutes(1),
+                                                       std::chrono::minutes(15), std::chrono::hours(1)};
+
+    // Liczniki perf_event_open per wątek (Linux)
+    bool perf_counters = false;
+
+    // Śledzenie opóźnień (eksport Chrome trace klawiszem 't' lub przez /trace)
+    bool trace = false;
+    std::string trace_file = "pjurominer_trace.json";
+
+    // Dziennik udziałów (mmap, zobacz ShareJournal.h); pusty = wyłączony
+    std::string share_journal = "pjurominer_shares.journal";
+
+    // Ostatni seed (zobacz LastSeed.h) - spekulacyjna budowa datasetu przy starcie; pusty = wyłączone
+    std::string seed_file = "pjurominer_seed.json";
+
+    // Logowanie (asynchroniczny logger, zobacz Logger.h)
+    LoggerConfig logging;
+
+    // Interfejs sterowania HTTP (0 = wyłączony); tylko adresy lokalne
+    uint16_t control_port = 0;
+    std::string control_bind = "127.0.0.1";
+
+    // Plik konfiguracyjny JSON (--config), ponownie wczytywany przez /reload
+    std::string config_file;
+};
+
+/**
+ * @brief Parsuje argumenty linii poleceń.
+ * Obsługiwane opcje: --pool HOST:PORT, --user PORTFEL, --threads N,
+ * --metrics-port PORT, --metrics-bind ADRES, --stats-windows LISTA,
+ * --trace, --trace-file PLIK, --perf-counters, --log-level POZIOM,
+ * --log-categories LISTA, --log-json, --affinity LISTA, --control-port PORT,
+ * --control-bind ADRES, --config PLIK, --mode auto|fast|light, --algo LISTA, --cgroup-root KATALOG,
+ * --cotenant, --cotenant-nice N, --cotenant-psi-high P, --cotenant-psi-low P, --limit LIMIT,
+ * --energy, --energy-root KATALOG, --watchdog-slow P,
+ * --release-cache, --init-threads N, --dataset-kernel NAZWA, --share-journal PLIK|none, --seed-file PLIK|none,
+ * --extra-pool LISTA, --pool-weights LISTA, --pool-split threads|time, --pool-slice CZAS,
+ * --fleet-collector URL, --fleet-interval CZAS, --fleet-batch N, --fleet-host NAZWA.
+ * @throws std::invalid_argument przy nieznanej opcji lub błędnej wartości.
+ */
+MinerConfig parse_command_line(int argc, char* argv[]);
+
+/**
+ * @brief Wczytuje plik konfiguracyjny JSON i nakłada go na podaną konfigurację.
+ * Klucze odpowiadają opcjom linii poleceń bez "--", np.
+ * {"pool": "host:port", "threads": 4, "affinity": [0, 2], "log-json": true}.
+ * @throws std::invalid_argument przy błędzie odczytu, składni lub wartości.
+ */
+MinerConfig load_config_file(const std::string& path, MinerConfig base);
+
+/**
+ * @brief Wszystkie pule w kolejności sesji (główna pierwsza), z uzupełnionym portfelem.
+ */
+std::vector<PoolEndpoint> pool_endpoints(const MinerConfig& config);
+
+/**
+ * @brief Waga sesji (1, jeśli nie podano).
+ */
+unsigned pool_weight(const MinerConfig& config, std::size_t session);
+
+/**
+ * @brief Zwraca tekst pomocy z listą opcji.
+ */
+std::string command_line_usage();
@@ -1,15 +1,21 @@
 #include "MinerWorker.h"
-#include <iostream>
 #include <fmt/core.h>
+#include "Logger.h"
 #include "MiningCommon.h"
+#include "ThreadAffinity.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstring>
 // RandomXHasher jest już w nagłówku
 
 /**
  * @brief Konstruktor.
  */
-MinerWorker::MinerWorker(int id, SolutionCallback callback, std::shared_ptr<RandomXManager> manager)
+MinerWorker::MinerWorker(int id, SolutionCallback callback, std::shared_ptr<RandomXManager> manager,
+                         std::shared_ptr<WorkerTelemetry> telemetry)
         : m_id(id),
           m_solution_callback(std::move(callback)),
+          m_telemetry(std::move(telemetry)),
           m_rx_manager(std::move(manager)) {
     // m_hasher jest tworzony domyślnie (pusty)
 }
@@ -19,125 +25,386 @@ MinerWorker::MinerWorker(int id, SolutionCallback callback, std::shared_ptr<Rand
  */
 MinerWorker::~MinerWorker() {
     stop();
+    // Czekamy tutaj, a nie w destruktorze jthread - ten działa dopiero po
+    // zniszczeniu m_hasher i pozostałych pól używanych przez run()
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
 }
 
 void MinerWorker::start() {
     m_thread = std::jthread([this](std::stop_token st){ this->run(st); });
-    {
-        std::lock_guard<std::mutex> lock(g_cout_mutex);
-        std::cout << fmt::format("[Worker {}] Uruchomiony.\n", m_id);
-    }
+    LOG_INFO(LogCategory::Worker, "[Worker {}] Uruchomiony.", m_id);
 }
 
 void MinerWorker::stop() {
     m_thread.request_stop();
 }
 
-void MinerWorker::setNewJob(const MiningJob& job) {
+void MinerWorker::join() {
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void MinerWorker::setNewJob(const MiningJob& job, std::shared_ptr<RandomXManager> manager, unsigned nonce_slot_bits,
+                            std::shared_ptr<std::atomic<uint64_t>> nonce_progress) {
     std::lock_guard<std::mutex> lock(m_job_mutex);
     m_current_job = job;
+    m_pending_manager = std::move(manager);
+    m_pending_nonce_bits = nonce_slot_bits;
+    m_pending_progress = std::move(nonce_progress);
+}
+
+void MinerWorker::setPaused(bool paused) {
+    m_paused.store(paused, std::memory_order_relaxed);
+}
+
+void MinerWorker::requestVmReset() {
+    m_vm_reset.store(true, std::memory_order_relaxed);
+}
+
+void MinerWorker::setAffinity(std::vector<unsigned> cpus) {
+    std::lock_guard<std::mutex> lock(m_job_mutex);
+    m_pending_affinity = std::move(cpus);
 }
 
 uint64_t MinerWorker::getHashCount() const {
-    return m_hash_count.load();
+    return m_telemetry->hash_count();
+}
+
+void MinerWorker::setPriority(const ThreadPriority& priority) {
+    m_priority = priority;
+}
+
+void MinerWorker::setPerfCountersEnabled(bool enabled) {
+    m_perf_enabled = enabled;
+}
+
+std::optional<PerfSample> MinerWorker::getPerfSample() const {
+    return m_perf.read();
+}
+
+void MinerWorker::setRateLimiter(std::shared_ptr<RateLimiter> limiter) {
+    m_limiter = std::move(limiter);
+}
+
+namespace {
+constexpr uint32_t NONCE_OFFSET = 39;        // Pozycja nonce w blobie Monero
+constexpr uint32_t LIMITER_BATCH = 8;        // Hashe między kolejnymi rozliczeniami limitu
+constexpr double LIMITER_BURST_SECONDS = 0.5; // Zapas kubełka po przerwie (np. po pauzie)
+constexpr auto LIMITER_MAX_SLEEP = std::chrono::milliseconds(100); // Krok uśpienia (reakcja na stop)
+}
+
+void MinerWorker::throttle(uint32_t hashes, std::chrono::nanoseconds busy, std::stop_token& stoken) {
+    auto now = std::chrono::steady_clock::now();
+    uint64_t generation = m_limiter->generation();
+    if (generation != m_limiter_generation) {
+        m_limiter_generation = generation;
+        m_hash_bucket.reset(now);
+        m_cpu_bucket.reset(now);
+    }
+
+    std::chrono::nanoseconds wait{0};
+    double rate = m_limiter->worker_hash_rate();
+    if (rate > 0.0) {
+        wait = m_hash_bucket.consume(hashes, rate, std::max<double>(LIMITER_BATCH, rate * LIMITER_BURST_SECONDS), now);
+    }
+    double duty = m_limiter->worker_duty_cycle();
+    if (duty < 1.0) {
+        double busy_seconds = std::chrono::duration<double>(busy).count();
+        wait = std::max(wait, m_cpu_bucket.consume(busy_seconds, duty, duty * LIMITER_BURST_SECONDS, now));
+    }
+    if (wait.count() <= 0) {
+        return;
+    }
+
+    // Długi dług (niski limit) odsypiamy w krokach, aby stop i pauza działały od razu
+    auto deadline = now + wait;
+    while (!stoken.stop_requested() && !m_paused.load(std::memory_order_relaxed)) {
+        auto remaining = deadline - std::chrono::steady_clock::now();
+        if (remaining <= std::chrono::nanoseconds(0)) {
+            break;
+        }
+        std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(remaining, LIMITER_MAX_SLEEP));
+    }
+    m_limiter->record_throttle(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::min(std::chrono::steady_clock::now(), deadline) - now));
+}
+
+void MinerWorker::prepare_vm() {
+    if (m_vm_generation == m_rx_manager->get_generation()) {
+        return;
+    }
+    auto dataset_lock = m_rx_manager->try_acquire();
+    if (!dataset_lock.owns_lock()) {
+        return;
+    }
+    RandomXBinding binding = m_rx_manager->binding();
+    if (binding.seed_hex.empty() || !binding.algorithm) {
+        return; // Nic jeszcze nie zbudowano
+    }
+    // Generację zapisujemy także po błędzie - bez ponowień co obieg; praca spróbuje jeszcze raz
+    m_vm_generation = binding.generation;
+    try {
+        bool reused = m_hasher.bind(*binding.algorithm, binding.cache, binding.dataset);
+        m_current_seed_hex = binding.seed_hex;
+        m_current_algo = binding.algorithm->name;
+        LOG_DEBUG(LogCategory::Worker, "[Worker {}] {} VM {} dla seeda ...{} przed pracą", m_id,
+                  reused ? "Przełączono" : "Przygotowano", m_current_algo,
+                  m_current_seed_hex.substr(m_current_seed_hex.length() - 6));
+    } catch (const std::exception& e) {
+        m_current_seed_hex.clear();
+        LOG_WARN(LogCategory::Worker, "[Worker {}] Nie udało się przygotować VM: {}", m_id, e.what());
+    }
 }
 
 /**
  * @brief Główna pętla robocza wątku.
  */
 void MinerWorker::run(std::stop_token stoken) {
-    uint32_t nonce = (rand() % 10000) * m_id;
+    // Rozłączne zakresy nonce workerów (podział ustala pula dla każdej pracy)
+    unsigned nonce_slot_bits = 0;
+    uint32_t nonce_base = 0;
+    uint64_t nonce_count = 0;   // Rozmiar zakresu tego workera
+    uint64_t nonce_counter = 0;
+    std::shared_ptr<std::atomic<uint64_t>> nonce_progress; // Postęp zakresu wspólny z pulą (może być pusty)
     std::optional<MiningJob> local_job;
+    std::vector<uint8_t> job_blob;   // Blob pracy w bajtach (nonce wstawiany w miejscu)
+    std::vector<uint8_t> job_target; // Target pracy (32 bajty)
+    bool first_hash_on_job = false; // Do śledzenia opóźnienia job -> pierwszy hash
+    uint32_t batch_hashes = 0;      // Partia rozliczana w limiterze
+    std::chrono::nanoseconds batch_busy{0};
+
+    if (trace_enabled()) {
+        trace_set_thread_name(fmt::format("worker {}", m_id));
+    }
+
+    if (!set_current_thread_priority(m_priority)) {
+        LOG_WARN(LogCategory::Worker, "[Worker {}] Nie udało się ustawić priorytetu '{}'.", m_id,
+                 thread_priority_name(m_priority.cls));
+    }
+
+    // Liczniki perf_event_open muszą być otwarte z mierzonego wątku
+    if (m_perf_enabled) {
+        bool opened = m_perf.open_for_current_thread();
+        auto sample = m_perf.read();
+        if (!opened) {
+            LOG_WARN(LogCategory::Worker, "[Worker {}] Liczniki perf_event_open niedostępne (sprawdź perf_event_paranoid).", m_id);
+        } else if (m_id == 0) {
+            LOG_INFO(LogCategory::Worker, "[Worker {}] Liczniki wydajności: {}", m_id,
+                     sample && sample->hardware ? "sprzętowe (PMU)" : "programowe (brak PMU)");
+        }
+    }
 
     // m_hasher (RandomXHasher) jest teraz członkiem klasy
     // m_current_seed_hex jest teraz członkiem klasy
 
     while (!stoken.stop_requested()) {
 
+        std::optional<std::vector<unsigned>> affinity;
+        std::shared_ptr<RandomXManager> manager;
+        bool new_job = false;
         {
             std::lock_guard<std::mutex> lock(m_job_mutex);
             if (m_current_job) {
                 local_job = m_current_job;
                 m_current_job.reset();
-                nonce = 0; // Resetuj nonce dla nowej pracy
+                manager.swap(m_pending_manager);
+                nonce_slot_bits = m_pending_nonce_bits;
+                nonce_progress = std::move(m_pending_progress);
+                // Powrót do pracy (restart, przedział innej sesji) wznawia zakres zamiast go powtarzać
+                nonce_counter = nonce_progress ? nonce_progress->load(std::memory_order_acquire) : 0;
+                first_hash_on_job = true;
+                new_job = true;
             }
+            affinity.swap(m_pending_affinity);
+        }
+        if (new_job) {
+            // Konwersja hex raz na pracę, nie na hash
+            try {
+                job_blob = hex_to_bytes(local_job->blob);
+            } catch (const std::exception&) {
+                job_blob.clear();
+            }
+            job_target = expand_target(local_job->target);
+            if (job_blob.size() < NONCE_OFFSET + sizeof(uint32_t) || job_target.size() != 32) {
+                LOG_WARN(LogCategory::Worker, "[Worker {}] Nieprawidłowy blob lub target pracy {} - pomijam.", m_id,
+                         local_job->job_id);
+                local_job.reset();
+            } else if ((static_cast<uint64_t>(m_id) >> nonce_slot_bits) != 0) {
+                // Dołączył po podziale nonce tej pracy - każdy wolny zakres ma już właściciela
+                LOG_DEBUG(LogCategory::Worker, "[Worker {}] Praca {} dzieli nonce na {} workerów - czekam na następną.",
+                          m_id, local_job->job_id, uint64_t{1} << nonce_slot_bits);
+                local_job.reset();
+            } else {
+                unsigned range_bits = 32 - nonce_slot_bits;
+                nonce_base = range_bits == 32 ? 0 : static_cast<uint32_t>(m_id) << range_bits;
+                nonce_count = uint64_t{1} << range_bits;
+            }
+        }
+        if (manager && manager != m_rx_manager) {
+            // Praca innej sesji z innym datasetem - generacje managerów nie są porównywalne
+            m_rx_manager = std::move(manager);
+            m_vm_generation = ~0ULL;
         }
 
-        if (!local_job) {
+        if (affinity && !set_current_thread_affinity(*affinity)) {
+            LOG_WARN(LogCategory::Worker, "[Worker {}] Nie udało się ustawić powinowactwa CPU.", m_id);
+        }
+
+        if (m_paused.load(std::memory_order_relaxed)) {
+            m_telemetry->mark_idle();
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
             continue;
         }
+        if (!local_job) {
+            // Bez pracy pomagamy w budowie datasetu (jeśli trwa), zamiast spać
+            m_telemetry->mark_idle();
+            if (!m_rx_manager->help_init(stoken)) {
+                prepare_vm();
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            continue;
+        }
+        if (nonce_counter >= nonce_count) {
+            // Bez zawijania: powtórzone nonce dałyby te same udziały co wcześniej
+            LOG_WARN(LogCategory::Worker, "[Worker {}] Wyczerpany zakres nonce pracy {} ({} wartości) - czekam na nową pracę.",
+                     m_id, local_job->job_id, nonce_count);
+            local_job.reset();
+            continue;
+        }
+
+        // Blokada odczytu na czas hasha: przebudowa datasetu (w miejscu) czeka, aż ją zwolnimy
+        auto dataset_lock = m_rx_manager->try_acquire();
+        if (!dataset_lock.owns_lock()) {
+            // Trwa przebudowa datasetu - liczymy jej fragmenty
+            m_telemetry->mark_idle();
+            if (!m_rx_manager->help_init(stoken)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            continue;
+        }
+
+        if (m_vm_reset.exchange(false, std::memory_order_relaxed)) {
+            m_hasher.release();
+            m_vm_generation = ~0ULL;
+            LOG_WARN(LogCategory::Worker, "[Worker {}] Odtwarzam VM (zlecenie watchdoga).", m_id);
+        }
 
         // --- KLUCZOWA ZMIANA: Sprawdzanie i aktualizacja VM ---
-        if (local_job->seed_hash != m_current_seed_hex) {
+        if (m_vm_generation != m_rx_manager->get_generation() || local_job->seed_hash != m_current_seed_hex ||
+            local_job->algo != m_current_algo) {
+            RandomXBinding binding = m_rx_manager->binding();
+            if (binding.seed_hex != local_job->seed_hash || !binding.algorithm || binding.algorithm->name != local_job->algo) {
+                // Manager jeszcze nie zbudował tego seeda. Zachowujemy pracę
+                // (zacznie się zaraz po budowie) i pomagamy w inicjalizacji.
+                dataset_lock.unlock();
+                m_telemetry->mark_idle();
+                if (!m_rx_manager->help_init(stoken)) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                continue;
+            }
             try {
-                // Seed się zmienił, musimy odtworzyć naszą lokalną VM
-                // Pobieramy wskaźniki do globalnego, gotowego cache'a i datasetu
-                auto [cache_ptr, dataset_ptr] = m_rx_manager->get_pointers();
-
-                if (dataset_ptr) { // Sprawdzamy, czy dataset jest gotowy
-                    m_hasher.create_vm(cache_ptr, dataset_ptr);
-                    m_current_seed_hex = local_job->seed_hash;
-                    {
-                        std::lock_guard<std::mutex> lock(g_cout_mutex);
-                        std::cout << fmt::format("[Worker {}] Zaktualizowano VM do seeda ...{}\n", m_id, m_current_seed_hex.substr(m_current_seed_hex.length() - 6));
-                    }
-                } else {
-                    // Manager jeszcze nie skończył budować datasetu. Czekamy.
-                    local_job.reset(); // Porzucamy pracę i czekamy
-                    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-                    continue;
+                // Ta sama VM (scratchpad, JIT) - zmienia się tylko zawartość lub wskaźnik datasetu
+                TRACE_EVENT(TraceEvent::VmRecreate, TracePhase::Begin, m_id, binding.seed_hex);
+                bool reused = m_hasher.bind(*binding.algorithm, binding.cache, binding.dataset);
+                TRACE_EVENT(TraceEvent::VmRecreate, TracePhase::End, m_id, reused ? "reused" : "created");
+                m_vm_generation = binding.generation;
+                if (binding.seed_hex != m_current_seed_hex || local_job->algo != m_current_algo) {
+                    m_current_seed_hex = binding.seed_hex;
+                    m_current_algo = local_job->algo;
+                    LOG_INFO(LogCategory::Worker, "[Worker {}] {} VM {} dla seeda ...{}", m_id,
+                             reused ? "Przełączono" : "Utworzono", m_current_algo,
+                             m_current_seed_hex.substr(m_current_seed_hex.length() - 6));
                 }
             } catch (const std::exception& e) {
-                {
-                    std::lock_guard<std::mutex> lock(g_cout_mutex);
-                    std::cerr << fmt::format("[Worker {}] Krytyczny błąd Hashera (VM): {}\n", m_id, e.what());
-                }
+                LOG_ERROR(LogCategory::Worker, "[Worker {}] Krytyczny błąd Hashera (VM): {}", m_id, e.what());
                 local_job.reset(); // Nie możemy pracować
+                dataset_lock.unlock();
                 std::this_thread::sleep_for(std::chrono::seconds(5));
                 continue;
             }
         }
         // --- KONIEC ZMIANY ---
 
-        std::string hash_result_hex = m_hasher.hash(local_job->blob, nonce);
+        // Paczka hashy pod jedną blokadą (HASH_BATCH backendu; dla RandomX jeden hash)
+        auto hash_start = std::chrono::steady_clock::now();
+        m_telemetry->busy_since_ns.store(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(hash_start.time_since_epoch()).count(),
+                std::memory_order_relaxed);
+        uint8_t hash[32];
+        uint32_t hashed = 0;
+        bool found = false;
+        uint32_t nonce = 0;
+        while (hashed < MinerHashBackend::HASH_BATCH && nonce_counter < nonce_count) {
+            nonce = nonce_base + static_cast<uint32_t>(nonce_counter++);
+            std::memcpy(job_blob.data() + NONCE_OFFSET, &nonce, sizeof(nonce));
+            if (!m_hasher.hash_bytes(job_blob.data(), job_blob.size(), hash)) {
+                break; // VM nie jest gotowa
+            }
+            hashed++;
+            if (hash_meets_target(hash, job_target.data())) {
+                found = true;
+                break;
+            }
+        }
+        dataset_lock.unlock(); // Przed zgłoszeniem rozwiązania i uśpieniem przez limit
+        if (nonce_progress) {
+            nonce_progress->store(nonce_counter, std::memory_order_release);
+        }
+        m_telemetry->busy_since_ns.store(0, std::memory_order_relaxed);
+        m_telemetry->cpu.store(current_cpu(), std::memory_order_relaxed);
+        auto hash_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - hash_start).count();
+        if (hashed == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        m_telemetry->hash_latency.record(static_cast<uint64_t>(hash_ns) / hashed);
+        m_telemetry->add_hashes(hashed);
 
-        m_hash_count++;
+        if (first_hash_on_job) {
+            TRACE_EVENT(TraceEvent::FirstHash, TracePhase::Instant, nonce, local_job->job_id);
+            first_hash_on_job = false;
+        }
 
-        if (check_hash_target_real(hash_result_hex, local_job->target)) {
-            std::string solution_report = fmt::format("\n!!! [Worker {}] ZNALAZŁEM ROZWIĄZANIE !!!\n", m_id);
-            solution_report += fmt::format("    Job:  {}\n", local_job->job_id);
-            solution_report += fmt::format("    Nonce: {}\n", nonce);
-            solution_report += fmt::format("    Hash: {}\n\n", hash_result_hex);
+        if (found) {
+            std::string hash_result_hex = bytes_to_hex(hash, sizeof(hash));
+            TRACE_EVENT(TraceEvent::SolutionFound, TracePhase::Instant, nonce, local_job->job_id);
 
-            {
-                std::lock_guard<std::mutex> lock(g_cout_mutex);
-                std::cout << solution_report;
-                std::cout.flush();
-            }
+            LOG_INFO(LogCategory::Worker, "\n!!! [Worker {}] ZNALAZŁEM ROZWIĄZANIE !!!\n"
+                                          "    Job:  {}\n"
+                                          "    Nonce: {}\n"
+                                          "    Hash: {}\n",
+                     m_id, local_job->job_id, nonce, hash_result_hex);
 
             Solution sol = {
                     local_job->job_id,
                     nonce,
-                    hash_result_hex
+                    hash_result_hex,
+                    local_job->pool
             };
 
+            // Szukamy dalej: kolejne udziały tej pracy też są ważne, a praca
+            // kończy się dopiero nową pracą albo wyczerpaniem zakresu nonce
             m_solution_callback(sol);
-            local_job.reset(); // Znaleziono, czekamy na nową pracę
         }
 
-        nonce++;
-
-        // Szybkie sprawdzanie zatrzymania, aby nie blokować pętli
-        if (nonce % 1024 == 0) { // Zwiększono z 256
-            if (stoken.stop_requested()) {
-                break;
+        // Rozliczenie limitu po zgłoszeniu rozwiązania - uśpienie nie opóźnia share'a
+        if (m_limiter) {
+            batch_hashes += hashed;
+            batch_busy += std::chrono::nanoseconds(hash_ns);
+            if (batch_hashes >= LIMITER_BATCH) {
+                throttle(batch_hashes, batch_busy, stoken);
+                batch_hashes = 0;
+                batch_busy = std::chrono::nanoseconds(0);
             }
         }
     }
 
-    {
-        std::lock_guard<std::mutex> lock(g_cout_mutex);
-        std::cout << fmt::format("[Worker {}] Zatrzymany.\n", m_id);
-    }
+    LOG_INFO(LogCategory::Worker, "[Worker {}] Zatrzymany.", m_id);
+    m_exited.store(true, std::memory_order_release);
 }
\ No newline at end of file
@@ -1,8 +1,12 @@
 #pragma once
 
 #include "MiningCommon.h"
-#include "RandomXHasher.h" // Zmodyfikowany hasher
+#include "HashBackend.h" // RandomXHasher lub StubHasher (wybór przy kompilacji)
 #include "RandomXManager.h" // Nowy manager
+#include "Telemetry.h"
+#include "PerfCounters.h"
+#include "ThreadPriority.h"
+#include "RateLimiter.h"
 #include <thread>
 #include <functional>
 #include <mutex>
@@ -10,6 +14,7 @@
 #include <string>
 #include <atomic>
 #include <memory> // Dla std::shared_ptr
+#include <vector>
 
 /**
  * @class MinerWorker
@@ -24,34 +29,132 @@ public:
      * @param id Unikalny identyfikator tego workera.
      * @param callback Funkcja zwrotna do wysyłania znalezionych rozwiązań.
      * @param manager Wskaźnik do współdzielonego managera RandomX.
+     * @param telemetry Liczniki tego workera (wyrównane do linii cache).
      */
-    MinerWorker(int id, SolutionCallback callback, std::shared_ptr<RandomXManager> manager);
+    MinerWorker(int id, SolutionCallback callback, std::shared_ptr<RandomXManager> manager,
+                std::shared_ptr<WorkerTelemetry> telemetry);
 
     /**
-     * @brief Destruktor.
+     * @brief Destruktor. Zatrzymuje wątek i czeka na jego zakończenie.
      */
     ~MinerWorker();
 
     void start();
     void stop();
-    void setNewJob(const MiningJob& job);
+
+    /**
+     * @brief Czeka na zakończenie wątku (po stop()). Wołający musi trzymać
+     * własną referencję - join nie może się zbiec z destruktorem.
+     */
+    void join();
+    /**
+     * @brief Przekazuje pracę; manager (jeśli podany) to dataset seeda tej pracy -
+     * sesje pul o różnych seedach mają osobne managery (zobacz PoolScheduler.h).
+     * @param nonce_slot_bits Bity numeru workera w nonce: worker dostaje 2^(32 - bity)
+     * wartości od id << (32 - bity). Worker o ID spoza 2^bity czeka na następną pracę,
+     * a po wyczerpaniu zakresu przestaje haszować (bez zawijania - duplikaty udziałów).
+     * @param nonce_progress Przeszukana część zakresu tej pracy, wspólna dla kolejnych
+     * przydziałów tego ID: worker zaczyna od niej i zapisuje ją po każdej paczce (nullptr = od zera).
+     */
+    void setNewJob(const MiningJob& job, std::shared_ptr<RandomXManager> manager, unsigned nonce_slot_bits,
+                   std::shared_ptr<std::atomic<uint64_t>> nonce_progress);
     uint64_t getHashCount() const;
+    const WorkerTelemetry& getTelemetry() const { return *m_telemetry; }
+    int getId() const { return m_id; }
+
+    /**
+     * @brief Wstrzymuje/wznawia haszowanie. Wstrzymany worker zachowuje VM
+     * i bieżącą pracę, więc wznowienie nie wymaga ich odtwarzania.
+     */
+    void setPaused(bool paused);
+
+    /**
+     * @brief Zmienia powinowactwo wątku (stosowane przez sam wątek przed kolejnym hashem).
+     * @param cpus Numery CPU; pusta lista zdejmuje przypięcie.
+     */
+    void setAffinity(std::vector<unsigned> cpus);
+
+    /**
+     * @brief Włącza liczniki perf_event_open dla tego wątku. Wywołać przed start().
+     */
+    void setPerfCountersEnabled(bool enabled);
+
+    /**
+     * @brief Klasa szeregowania wątku (np. SCHED_IDLE w trybie co-tenant). Wywołać przed start().
+     */
+    void setPriority(const ThreadPriority& priority);
+
+    /**
+     * @brief Wspólny regulator limitu hashrate/CPU. Wywołać przed start().
+     */
+    void setRateLimiter(std::shared_ptr<RateLimiter> limiter);
+
+    /**
+     * @brief Zleca odtworzenie VM przed następnym hashem (watchdog: uszkodzona lub zdegradowana VM).
+     */
+    void requestVmReset();
+
+    /**
+     * @brief true, gdy pętla robocza już się zakończyła (po stop()).
+     */
+    bool exited() const { return m_exited.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Odczyt liczników wydajności (std::nullopt, jeśli wyłączone/niedostępne).
+     * Bezpieczne z dowolnego wątku.
+     */
+    std::optional<PerfSample> getPerfSample() const;
 
 private:
     void run(std::stop_token stoken);
 
+    /**
+     * @brief Rozlicza partię hashy w kubełkach i usypia wątek, jeśli przekroczył limit.
+     */
+    void throttle(uint32_t hashes, std::chrono::nanoseconds busy, std::stop_token& stoken);
+
+    /**
+     * @brief Bez pracy: przygotowuje VM dla gotowego seeda managera (np. spekulacyjnego
+     * przy starcie), żeby pierwsza praca z tym seedem haszowała od razu.
+     */
+    void prepare_vm();
+
     int m_id;
     std::jthread m_thread;
     SolutionCallback m_solution_callback;
 
-    // Mutex chroniący dostęp do m_current_job
+    // Mutex chroniący dostęp do m_current_job (z managerem i podziałem nonce) i m_pending_affinity
     std::mutex m_job_mutex;
     std::optional<MiningJob> m_current_job;
-    std::atomic<uint64_t> m_hash_count{0};
+    std::shared_ptr<RandomXManager> m_pending_manager; // Manager dla m_current_job (nullptr = bez zmian)
+    unsigned m_pending_nonce_bits = 0;                 // Podział nonce dla m_current_job
+    std::shared_ptr<std::atomic<uint64_t>> m_pending_progress; // Postęp zakresu dla m_current_job
+    std::optional<std::vector<unsigned>> m_pending_affinity;
+
+    std::atomic<bool> m_paused{false};
+    std::atomic<bool> m_vm_reset{false};
+    std::atomic<bool> m_exited{false};
+
+    // Liczniki i histogram opóźnień (zapisywane tylko przez ten wątek)
+    std::shared_ptr<WorkerTelemetry> m_telemetry;
+
+    ThreadPriority m_priority;
+
+    // Limit hashrate/CPU: kubełki są stanem tego wątku, nastawy czyta z regulatora
+    std::shared_ptr<RateLimiter> m_limiter;
+    TokenBucket m_hash_bucket;
+    TokenBucket m_cpu_bucket;
+    uint64_t m_limiter_generation = ~0ULL;
+
+    // Liczniki sprzętowe (otwierane w wątku roboczym)
+    bool m_perf_enabled = false;
+    PerfCounters m_perf;
 
     // --- NOWA ARCHITEKTURA ---
-    std::shared_ptr<RandomXManager> m_rx_manager; // Wskaźnik do managera
-    RandomXHasher m_hasher;                       // Lokalny wrapper VM
+    std::shared_ptr<RandomXManager> m_rx_manager; // Wskaźnik do managera (zmieniany tylko przez wątek workera)
+    MinerHashBackend m_hasher;                    // Lokalny wrapper VM (zobacz HashBackend.h)
     std::string m_current_seed_hex;             // Seed, na którym pracuje ten worker
+    std::string m_current_algo;                 // Wariant RandomX jego VM (np. "rx/0")
+    uint64_t m_vm_generation = ~0ULL;           // Wersja zasobów managera, na którą wskazuje VM
     // --- KONIEC NOWEJ SEKCJI ---
 };
\ No newline at end of file
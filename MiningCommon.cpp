@@ -2,14 +2,17 @@
 #include <stdexcept>
 #include <fmt/core.h> // <-- ZMIANA
 #include <algorithm> // Dla std::reverse
-#include <mutex> // <-- DODANO
 
-// --- NOWA SEKCJA ---
-// Definicja globalnego mutexu
-std::mutex g_cout_mutex;
-// --- KONIEC NOWEJ SEKCJI ---
 
 
+const char* randomx_mode_name(RandomXMode mode) {
+    return mode == RandomXMode::Light ? "light" : "fast";
+}
+
+const char* pool_split_name(PoolSplit split) {
+    return split == PoolSplit::Time ? "time" : "threads";
+}
+
 // Funkcja pomocnicza do konwersji pojedynczego znaku hex
 uint8_t hex_char_to_byte(char c) {
     if (c >= '0' && c <= '9') return c - '0';
@@ -53,20 +56,75 @@ bool check_hash_target_real(const std::string& hash_hex, const std::string& targ
         return false; // Nieprawidłowy rozmiar
     }
 
-    // 2. Porównanie Little-Endian (od końca do początku)
-    // int memcmp(a, b, n) zwraca:
-    // < 0 jeśli a < b
-    // = 0 jeśli a == b
-    // > 0 jeśli a > b
+    return hash_meets_target(hash_bytes.data(), target_bytes.data());
+}
+
+bool hash_meets_target(const uint8_t* hash, const uint8_t* target) {
+    // Porównanie Little-Endian (od końca do początku)
     // My musimy porównać od tyłu (najbardziej znaczący bajt jest na końcu)
     for (int i = 31; i >= 0; --i) {
-        if (hash_bytes[i] < target_bytes[i]) {
+        if (hash[i] < target[i]) {
             return true; // hash < target
         }
-        if (hash_bytes[i] > target_bytes[i]) {
+        if (hash[i] > target[i]) {
             return false; // hash > target
         }
     }
     // Jeśli pętla się zakończyła, są równe
     return true; // hash == target
-}
\ No newline at end of file
+}
+
+std::vector<uint8_t> expand_target(const std::string& target_hex) {
+    std::vector<uint8_t> target;
+    try {
+        target = hex_to_bytes(target_hex);
+    } catch (const std::exception&) {
+        return {};
+    }
+    if (target.empty() || target.size() > 32) {
+        return {};
+    }
+    std::vector<uint8_t> expanded(32, 0);
+    std::copy(target.begin(), target.end(), expanded.end() - static_cast<std::ptrdiff_t>(target.size()));
+    return expanded;
+}
+
+uint64_t target_to_difficulty(const std::string& target_hex) {
+    std::vector<uint8_t> target;
+    try {
+        target = hex_to_bytes(target_hex);
+    } catch (const std::exception&) {
+        return 0;
+    }
+    if (target.empty() || target.size() > 32) {
+        return 0;
+    }
+    // Najbardziej znaczące 64 bity (koniec tablicy); krótki target to górne bajty
+    uint64_t top = 0;
+    std::size_t count = std::min<std::size_t>(target.size(), 8);
+    for (std::size_t i = 0; i < count; ++i) {
+        top |= static_cast<uint64_t>(target[target.size() - count + i]) << (8 * (8 - count + i));
+    }
+    return top ? UINT64_MAX / top : 0;
+}
+
+std::string blob_prev_id(const std::string& blob_hex) {
+    std::vector<uint8_t> blob;
+    try {
+        blob = hex_to_bytes(blob_hex);
+    } catch (const std::exception&) {
+        return {};
+    }
+    // major_version, minor_version, timestamp (varint), potem 32 bajty prev_id
+    std::size_t pos = 0;
+    for (int field = 0; field < 3; ++field) {
+        while (pos < blob.size() && (blob[pos] & 0x80)) {
+            ++pos;
+        }
+        ++pos;
+    }
+    if (pos + 32 > blob.size()) {
+        return {};
+    }
+    return bytes_to_hex(blob.data() + pos, 32);
+}
@@ -3,7 +3,6 @@
 #include <string>
 #include <cstdint>
 #include <vector>
-#include <mutex> // <-- DODANO
 
 /**
  * @struct MiningJob
@@ -15,6 +14,8 @@ struct MiningJob {
     std::string blob;
     std::string target;
     std::string seed_hash; // Niezbędny do inicjalizacji RandomX Cache
+    std::string algo;      // Wariant RandomX ("rx/0", "rx/wow", ...), ustalany przez StratumClient
+    unsigned pool = 0;     // Sesja puli, od której pochodzi praca (0 = główna, zobacz PoolScheduler.h)
 };
 
 /**
@@ -25,13 +26,41 @@ struct Solution {
     std::string job_id;
     uint32_t nonce;
     std::string result_hash; // Hash w formacie hex
+    unsigned pool = 0;       // Sesja puli, do której trzeba wysłać rozwiązanie
 };
 
-// --- NOWA SEKCJA ---
-// Globalny mutex chroniący std::cout i std::cerr
-// Zadeklarowany tutaj, zdefiniowany w MiningCommon.cpp
-extern std::mutex g_cout_mutex;
-// --- KONIEC NOWEJ SEKCJI ---
+/**
+ * @enum RandomXMode
+ * @brief Tryb RandomX: Fast = pełny dataset (~2 GB, szybkie haszowanie),
+ * Light = tylko cache 256 MB (kilkukrotnie wolniejsze haszowanie).
+ */
+enum class RandomXMode {
+    Fast,
+    Light,
+};
+
+/**
+ * @brief Nazwa trybu ("fast" / "light").
+ */
+const char* randomx_mode_name(RandomXMode mode);
+
+/**
+ * @enum PoolSplit
+ * @brief Podział mocy między kilka pul: Threads = stałe grupy wątków
+ * proporcjonalne do wag, Time = wszystkie wątki na zmianę, w przedziałach
+ * czasu proporcjonalnych do wag.
+ */
+enum class PoolSplit {
+    Threads,
+    Time,
+};
+
+/**
+ * @brief Nazwa podziału ("threads" / "time").
+ */
+const char* pool_split_name(PoolSplit split);
+
+// Wyjście konsoli: zobacz Logger.h (g_logger, makra LOG_*)
 
 
 // --- NOWE FUNKCJE POMOCNICZE ---
@@ -57,4 +86,31 @@ std::string bytes_to_hex(const uint8_t* bytes, size_t size);
  * @param target_hex Cel trudności z puli (32 bajty hex).
  * @return true, jeśli hash <= target, false w przeciwnym razie.
  */
-bool check_hash_target_real(const std::string& hash_hex, const std::string& target_hex);
\ No newline at end of file
+bool check_hash_target_real(const std::string& hash_hex, const std::string& target_hex);
+
+/**
+ * @brief Jak check_hash_target_real(), ale na bajtach (gorąca pętla workera, bez konwersji hex).
+ * @param hash 32 bajty little-endian.
+ * @param target 32 bajty little-endian.
+ */
+bool hash_meets_target(const uint8_t* hash, const uint8_t* target);
+
+/**
+ * @brief Target puli (4, 8 lub 32 bajty hex) jako 32 bajty little-endian dla hash_meets_target().
+ * Krótki target to najbardziej znaczące bajty; młodsze są zerowe.
+ * @return Pusty wektor dla nieprawidłowego targetu.
+ */
+std::vector<uint8_t> expand_target(const std::string& target_hex);
+
+/**
+ * @brief Trudność odpowiadająca targetowi puli (4, 8 lub 32 bajty hex, little-endian).
+ * @return 0 dla nieprawidłowego targetu.
+ */
+uint64_t target_to_difficulty(const std::string& target_hex);
+
+/**
+ * @brief Hash poprzedniego bloku z bloba pracy (po wersjach i znaczniku czasu).
+ * Prace z tym samym prev_id dotyczą tej samej wysokości łańcucha.
+ * @return 64 znaki hex lub pusty string dla nieczytelnego bloba.
+ */
+std::string blob_prev_id(const std::string& blob_hex);
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include "PerfCounters.h"
+#include <algorithm>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+double PerfSample::ipc() const {
+    if (!cycles || !instructions || *cycles == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(*instructions) / static_cast<double>(*cycles);
+}
+
+PerfCounters::~PerfCounters() {
+    close();
+}
+
+#ifdef __linux__
+
+namespace {
+
+int perf_event_open_fd(uint32_t type, uint64_t config, int group_fd, bool exclude_kernel) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group_fd == -1 ? 1 : 0; // Grupę włączamy jednym ioctl na liderze
+    attr.exclude_kernel = exclude_kernel ? 1 : 0;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0 /* ten wątek */, -1 /* dowolny CPU */,
+                                    group_fd, PERF_FLAG_FD_CLOEXEC));
+}
+
+constexpr uint64_t hw_cache_config(uint64_t cache, uint64_t op, uint64_t result) {
+    return cache | (op << 8) | (result << 16);
+}
+
+} // namespace
+
+bool PerfCounters::open_group(Group& group, bool hardware) {
+    struct EventSpec {
+        uint32_t type;
+        uint64_t config;
+        Slot slot;
+    };
+
+    std::vector<EventSpec> specs;
+    if (hardware) {
+        specs = {
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, Slot::Cycles},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, Slot::Instructions},
+                {PERF_TYPE_HW_CACHE, hw_cache_config(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ,
+                                                     PERF_COUNT_HW_CACHE_RESULT_MISS), Slot::LlcMisses},
+                {PERF_TYPE_HW_CACHE, hw_cache_config(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                                                     PERF_COUNT_HW_CACHE_RESULT_MISS), Slot::DtlbMisses},
+        };
+    } else {
+        specs = {
+                {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, Slot::TaskClock},
+                {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, Slot::ContextSwitches},
+                {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS, Slot::CpuMigrations},
+                {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, Slot::PageFaults},
+        };
+    }
+
+    // Przełączenia kontekstu zachodzą w jądrze - dla liczników programowych próbujemy
+    // najpierw bez exclude_kernel (wymaga perf_event_paranoid <= 1)
+    for (bool exclude_kernel : {hardware, true}) {
+        close_group(group);
+
+        group.leader_fd = perf_event_open_fd(specs[0].type, specs[0].config, -1, exclude_kernel);
+        if (group.leader_fd < 0) {
+            continue;
+        }
+        group.fds.push_back(group.leader_fd);
+        group.slots.push_back(specs[0].slot);
+
+        // Pozostałe zdarzenia są opcjonalne (np. brak dTLB w danym modelu CPU)
+        for (std::size_t i = 1; i < specs.size(); ++i) {
+            int fd = perf_event_open_fd(specs[i].type, specs[i].config, group.leader_fd, exclude_kernel);
+            if (fd >= 0) {
+                group.fds.push_back(fd);
+                group.slots.push_back(specs[i].slot);
+            }
+        }
+
+        ioctl(group.leader_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(group.leader_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        return true;
+    }
+    return false;
+}
+
+std::optional<std::vector<uint64_t>> PerfCounters::read_group(const Group& group) {
+    if (group.leader_fd < 0) {
+        return std::nullopt;
+    }
+
+    // Format PERF_FORMAT_GROUP: nr, time_enabled, time_running, value[nr]
+    std::vector<uint64_t> buffer(3 + group.fds.size());
+    ssize_t n = ::read(group.leader_fd, buffer.data(), buffer.size() * sizeof(uint64_t));
+    if (n < static_cast<ssize_t>(3 * sizeof(uint64_t))) {
+        return std::nullopt;
+    }
+
+    uint64_t nr = std::min<uint64_t>(buffer[0], group.fds.size());
+    uint64_t time_enabled = buffer[1];
+    uint64_t time_running = buffer[2];
+
+    std::vector<uint64_t> values(nr);
+    for (uint64_t i = 0; i < nr; ++i) {
+        uint64_t v = buffer[3 + i];
+        // Skalowanie przy multipleksowaniu liczników przez jądro
+        if (time_running > 0 && time_running < time_enabled) {
+            v = static_cast<uint64_t>(static_cast<double>(v) * time_enabled / time_running);
+        }
+        values[i] = v;
+    }
+    return values;
+}
+
+void PerfCounters::close_group(Group& group) {
+    for (int fd : group.fds) {
+        ::close(fd);
+    }
+    group.fds.clear();
+    group.slots.clear();
+    group.leader_fd = -1;
+}
+
+bool PerfCounters::open_for_current_thread() {
+    m_has_hardware = open_group(m_hardware, true);
+    bool has_software = open_group(m_software, false);
+    bool ok = m_has_hardware || has_software;
+    m_ready.store(ok, std::memory_order_release);
+    return ok;
+}
+
+std::optional<PerfSample> PerfCounters::read() const {
+    if (!is_open()) {
+        return std::nullopt;
+    }
+
+    PerfSample sample;
+    sample.hardware = m_has_hardware;
+
+    auto assign = [&sample](Slot slot, uint64_t value) {
+        switch (slot) {
+            case Slot::Cycles: sample.cycles = value; break;
+            case Slot::Instructions: sample.instructions = value; break;
+            case Slot::LlcMisses: sample.llc_misses = value; break;
+            case Slot::DtlbMisses: sample.dtlb_misses = value; break;
+            case Slot::ContextSwitches: sample.context_switches = value; break;
+            case Slot::TaskClock: sample.task_clock_ns = value; break;
+            case Slot::CpuMigrations: sample.cpu_migrations = value; break;
+            case Slot::PageFaults: sample.page_faults = value; break;
+        }
+    };
+
+    for (const Group* group : {&m_hardware, &m_software}) {
+        if (auto values = read_group(*group)) {
+            for (std::size_t i = 0; i < values->size(); ++i) {
+                assign(group->slots[i], (*values)[i]);
+            }
+        }
+    }
+    return sample;
+}
+
+void PerfCounters::close() {
+    m_ready.store(false, std::memory_order_release);
+    close_group(m_hardware);
+    close_group(m_software);
+    m_has_hardware = false;
+}
+
+#else // !__linux__
+
+bool PerfCounters::open_group(Group&, bool) { return false; }
+std::optional<std::vector<uint64_t>> PerfCounters::read_group(const Group&) { return std::nullopt; }
+void PerfCounters::close_group(Group&) {}
+bool PerfCounters::open_for_current_thread() { return false; }
+std::optional<PerfSample> PerfCounters::read() const { return std::nullopt; }
+void PerfCounters::close() { m_ready.store(false, std::memory_order_release); }
+
+#endif
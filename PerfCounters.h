@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/**
+ * @struct PerfSample
+ * @brief Odczyt liczników wydajności jednego wątku (wartości skumulowane).
+ * Liczniki niedostępne na danej maszynie mają wartość std::nullopt.
+ */
+struct PerfSample {
+    bool hardware = false; // false = fallback na liczniki programowe (np. VM bez PMU)
+
+    std::optional<uint64_t> cycles;
+    std::optional<uint64_t> instructions;
+    std::optional<uint64_t> llc_misses;
+    std::optional<uint64_t> dtlb_misses;
+    std::optional<uint64_t> context_switches;
+
+    // Liczniki programowe (zawsze próbujemy je otworzyć)
+    std::optional<uint64_t> task_clock_ns;
+    std::optional<uint64_t> cpu_migrations;
+    std::optional<uint64_t> page_faults;
+
+    /**
+     * @brief Instrukcje na cykl (0, jeśli brak danych).
+     */
+    double ipc() const;
+};
+
+/**
+ * @class PerfCounters
+ * @brief Grupa liczników perf_event_open dla bieżącego wątku (tylko Linux).
+ *
+ * Otwierana z wątku, który ma być mierzony (pid = 0, cpu = -1). Odczyt
+ * (read() na deskryptorze lidera) jest bezpieczny z dowolnego wątku.
+ * Gdy PMU sprzętowe są niedostępne, używa liczników programowych.
+ */
+class PerfCounters {
+public:
+    PerfCounters() = default;
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /**
+     * @brief Otwiera grupę liczników dla wywołującego wątku.
+     * @return true, jeśli otwarto przynajmniej liczniki programowe.
+     */
+    bool open_for_current_thread();
+
+    /**
+     * @brief Czy liczniki są otwarte i gotowe do odczytu.
+     */
+    bool is_open() const { return m_ready.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Odczytuje liczniki (skalowane przy multipleksowaniu).
+     */
+    std::optional<PerfSample> read() const;
+
+    /**
+     * @brief Zamyka deskryptory.
+     */
+    void close();
+
+private:
+    // Kolejność pól w PerfSample, którą wypełnia dany deskryptor grupy
+    enum class Slot : uint8_t {
+        Cycles, Instructions, LlcMisses, DtlbMisses, ContextSwitches,
+        TaskClock, CpuMigrations, PageFaults
+    };
+
+    struct Group {
+        int leader_fd = -1;
+        std::vector<int> fds;     // Łącznie z liderem
+        std::vector<Slot> slots;  // Równoległe do fds
+    };
+
+    bool open_group(Group& group, bool hardware);
+    static std::optional<std::vector<uint64_t>> read_group(const Group& group);
+    static void close_group(Group& group);
+
+    Group m_hardware;
+    Group m_software;
+    bool m_has_hardware = false;
+    std::atomic<bool> m_ready{false};
+};
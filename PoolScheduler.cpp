@@ -0,0 +1,223 @@
+#include "PoolScheduler.h"
+#include "Logger.h"
+#include <algorithm>
+#include <fmt/core.h>
+#include <fmt/ranges.h>
+
+namespace {
+constexpr std::chrono::milliseconds MIN_SLICE{1000}; // Krótszy przedział nie zwraca kosztu przełączenia VM
+}
+
+PoolScheduler::PoolScheduler(std::vector<Session> sessions, PoolSplit split, std::chrono::seconds slice,
+                             std::shared_ptr<WorkerPool> workers, std::shared_ptr<RandomXManager> primary,
+                             ManagerFactory factory)
+        : m_split(split),
+          m_slice(slice),
+          m_workers(std::move(workers)),
+          m_factory(std::move(factory)) {
+    for (auto& session : sessions) {
+        m_sessions.push_back({std::move(session)});
+    }
+    m_slots.push_back(std::make_shared<Slot>(Slot{std::move(primary), {}, {}, m_next_slot_id++}));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    apply_weights();
+}
+
+std::size_t PoolScheduler::users(const std::shared_ptr<Slot>& slot) const {
+    return std::count_if(m_sessions.begin(), m_sessions.end(),
+                         [&](const SessionState& session) { return session.slot == slot; });
+}
+
+void PoolScheduler::apply_weights() {
+    bool any_connected = std::any_of(m_sessions.begin(), m_sessions.end(),
+                                     [](const SessionState& session) { return session.connected; });
+    std::vector<unsigned> weights(m_sessions.size(), 0);
+    for (std::size_t i = 0; i < m_sessions.size(); ++i) {
+        // Bez żadnego połączenia zostawiamy podział z konfiguracji (wątki i tak czekają na pracę)
+        bool eligible = !any_connected || m_sessions[i].connected;
+        if (m_split == PoolSplit::Time) {
+            weights[i] = i == m_active ? 1 : 0;
+        } else {
+            weights[i] = eligible ? m_sessions[i].config.weight : 0;
+        }
+    }
+    m_workers->set_pool_weights(weights);
+
+    if (m_sessions.size() > 1) {
+        auto threads = m_workers->pool_threads();
+        std::vector<std::string> parts;
+        for (std::size_t i = 0; i < m_sessions.size(); ++i) {
+            parts.push_back(fmt::format("{}: {}", m_sessions[i].config.name, i < threads.size() ? threads[i] : 0));
+        }
+        if (m_split == PoolSplit::Time) {
+            LOG_DEBUG(LogCategory::Manager, "[MANAGER] Przedział puli {}", m_sessions[m_active].config.name);
+        } else {
+            LOG_INFO(LogCategory::Manager, "[MANAGER] Podział wątków między pule: {}", fmt::join(parts, ", "));
+        }
+    }
+}
+
+bool PoolScheduler::set_job(unsigned session, const MiningJob& job, const RandomXAlgorithm& algorithm) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    SessionState& state = m_sessions.at(session);
+
+    // Inna sesja ma już ten seed - wspólny dataset
+    std::shared_ptr<Slot> slot;
+    for (const auto& candidate : m_slots) {
+        if (candidate->seed_hash == job.seed_hash && candidate->algo == algorithm.name) {
+            slot = candidate;
+            break;
+        }
+    }
+
+    bool requested = false;
+    if (!slot) {
+        if (state.slot && users(state.slot) == 1) {
+            slot = state.slot; // Dataset tylko tej sesji - przebudowa w miejscu
+        } else {
+            for (const auto& candidate : m_slots) {
+                if (users(candidate) == 0) {
+                    slot = candidate;
+                    break;
+                }
+            }
+        }
+        if (!slot) {
+            try {
+                slot = std::make_shared<Slot>(Slot{m_factory(algorithm), {}, {}, m_next_slot_id++});
+            } catch (const std::exception& e) {
+                LOG_ERROR(LogCategory::Manager, "[MANAGER] Nie udało się utworzyć datasetu dla puli {}: {}",
+                          state.config.name, e.what());
+                return false;
+            }
+            m_slots.push_back(slot);
+            LOG_INFO(LogCategory::Manager, "[MANAGER] Pula {} ma inny seed niż pozostałe - osobny dataset #{}",
+                     state.config.name, slot->id);
+        }
+        slot->seed_hash = job.seed_hash;
+        slot->algo = algorithm.name;
+        requested = slot->manager->request_seed(job.seed_hash, algorithm);
+    }
+
+    if (state.slot != slot && state.slot && m_sessions.size() > 1) {
+        LOG_INFO(LogCategory::Manager, "[MANAGER] Pula {} przechodzi na dataset #{} (seed ...{})", state.config.name,
+                 slot->id, job.seed_hash.substr(job.seed_hash.length() - std::min<std::size_t>(6, job.seed_hash.length())));
+    }
+    state.slot = slot;
+    state.job = job;
+
+    // Dataset bez sesji zwalniamy (workery oddają wskaźnik przy następnej pracy)
+    std::erase_if(m_slots, [&](const std::shared_ptr<Slot>& candidate) { return users(candidate) == 0; });
+
+    m_workers->set_job(job, slot->manager);
+
+    if (!state.connected) {
+        state.connected = true;
+        if (m_sessions.size() > 1) {
+            LOG_INFO(LogCategory::Manager, "[MANAGER] Pula {} aktywna - przywracam jej udział", state.config.name);
+        }
+        apply_weights();
+    }
+    return requested;
+}
+
+bool PoolScheduler::speculate(const std::string& seed_hash, const RandomXAlgorithm& algorithm) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& slot : m_slots) {
+        if (users(slot) == 0 && slot->seed_hash.empty()) {
+            slot->seed_hash = seed_hash;
+            slot->algo = algorithm.name;
+            return slot->manager->request_seed(seed_hash, algorithm);
+        }
+    }
+    return false;
+}
+
+void PoolScheduler::set_connected(unsigned session, bool connected) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    SessionState& state = m_sessions.at(session);
+    if (state.connected == connected) {
+        return;
+    }
+    state.connected = connected;
+    if (m_sessions.size() > 1 && !connected) {
+        LOG_WARN(LogCategory::Manager, "[MANAGER] Pula {} rozłączona - jej udział przejmują pozostałe", state.config.name);
+    }
+    if (m_split == PoolSplit::Time && !connected && session == m_active) {
+        for (std::size_t k = 1; k < m_sessions.size(); ++k) {
+            unsigned next = static_cast<unsigned>((m_active + k) % m_sessions.size());
+            if (m_sessions[next].connected) {
+                m_active = next;
+                break;
+            }
+        }
+    }
+    apply_weights();
+}
+
+std::chrono::milliseconds PoolScheduler::advance_slice() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (std::size_t k = 1; k <= m_sessions.size(); ++k) {
+        unsigned next = static_cast<unsigned>((m_active + k) % m_sessions.size());
+        if (m_sessions[next].connected) {
+            m_active = next;
+            break;
+        }
+    }
+    apply_weights();
+
+    // Przedział proporcjonalny do wagi wśród połączonych sesji
+    uint64_t total = 0;
+    for (const auto& session : m_sessions) {
+        if (session.connected) {
+            total += session.config.weight;
+        }
+    }
+    if (total == 0) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(m_slice);
+    }
+    std::chrono::milliseconds slice = std::chrono::duration_cast<std::chrono::milliseconds>(m_slice) *
+                                      static_cast<int64_t>(m_sessions[m_active].config.weight) /
+                                      static_cast<int64_t>(total);
+    return std::max(slice, MIN_SLICE);
+}
+
+std::shared_ptr<RandomXManager> PoolScheduler::primary_manager() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_sessions.empty() && m_sessions.front().slot) {
+        return m_sessions.front().slot->manager;
+    }
+    return m_slots.front()->manager;
+}
+
+std::vector<std::shared_ptr<RandomXManager>> PoolScheduler::managers() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::shared_ptr<RandomXManager>> managers;
+    for (const auto& slot : m_slots) {
+        managers.push_back(slot->manager);
+    }
+    return managers;
+}
+
+std::vector<PoolScheduler::SessionStats> PoolScheduler::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto threads = m_workers->pool_threads();
+    std::vector<SessionStats> stats;
+    for (std::size_t i = 0; i < m_sessions.size(); ++i) {
+        const SessionState& session = m_sessions[i];
+        SessionStats s;
+        s.pool = session.config.name;
+        s.weight = session.config.weight;
+        s.connected = session.connected;
+        s.threads = i < threads.size() ? threads[i] : 0;
+        s.active = m_split == PoolSplit::Time ? i == m_active : s.threads > 0;
+        if (session.slot) {
+            s.seed_hash = session.slot->seed_hash;
+            s.algo = session.slot->algo;
+            s.dataset = session.slot->id;
+        }
+        stats.push_back(std::move(s));
+    }
+    return stats;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "MiningCommon.h"
+#include "RandomXManager.h"
+#include "WorkerPool.h"
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @class PoolScheduler
+ * @brief Kilka sesji Stratum w jednym procesie: podział workerów i datasety.
+ *
+ * Moc jest dzielona wg wag: PoolSplit::Threads przydziela każdej sesji stałą
+ * grupę wątków (ciągłe ID, więc przy --affinity ciągłe CPU), PoolSplit::Time
+ * daje wszystkie wątki kolejnym sesjom na przedziały czasu z cyklu --pool-slice.
+ * Sesja bez połączenia traci swój udział, który wraca po pierwszej pracy
+ * nowego połączenia.
+ *
+ * Sesje pracujące na tym samym seedzie i wariancie dzielą jeden RandomXManager
+ * (jeden dataset 2 GB). Sesja, której seed się rozjechał, przebudowuje swój
+ * manager w miejscu, jeśli nie dzieli go z nikim, a inaczej dostaje nowy z
+ * fabryki; manager bez sesji jest zwalniany. Przy zmianie epoki seeda dwie
+ * pule tej samej sieci przez chwilę trzymają więc dwa datasety.
+ *
+ * Wszystkie metody są bezpieczne wątkowo; set_job(), set_connected()
+ * i advance_slice() wywołuje wątek io_context.
+ */
+class PoolScheduler {
+public:
+    using ManagerFactory = std::function<std::shared_ptr<RandomXManager>(const RandomXAlgorithm&)>;
+
+    struct Session {
+        std::string name;    // "host:port" (logi, metryki)
+        unsigned weight = 1;
+    };
+
+    struct SessionStats {
+        std::string pool;
+        unsigned weight = 1;
+        bool connected = false;
+        bool active = false;  // Tryb Time: sesja bieżącego przedziału; Threads: ma wątki
+        unsigned threads = 0;
+        std::string seed_hash;
+        std::string algo;
+        int dataset = -1;     // Numer datasetu (wspólny dla sesji o tym samym seedzie, -1 = brak)
+    };
+
+    /**
+     * @param sessions Sesje w kolejności indeksów (MiningJob::pool).
+     * @param primary Manager utworzony przy starcie (pierwszy dataset).
+     * @param factory Tworzy kolejny manager (ten sam tryb i ustawienia).
+     */
+    PoolScheduler(std::vector<Session> sessions, PoolSplit split, std::chrono::seconds slice,
+                  std::shared_ptr<WorkerPool> workers, std::shared_ptr<RandomXManager> primary,
+                  ManagerFactory factory);
+
+    /**
+     * @brief Nowa praca sesji: wybiera (lub buduje) dataset i przekazuje pracę jej workerom.
+     * Pierwsza praca po utracie połączenia przywraca udział sesji.
+     * @return true, jeśli zlecono budowę datasetu dla nowego seeda.
+     */
+    bool set_job(unsigned session, const MiningJob& job, const RandomXAlgorithm& algorithm);
+
+    /**
+     * @brief Przed pierwszą pracą: zleca budowę zapisanego seeda w wolnym managerze
+     * (głównym). Pierwsza praca z tym seedem trafi do niego bez nowej budowy;
+     * praca z innym seedem przejmie manager i przerwie spekulacyjną budowę.
+     * @return true, jeśli budowa została zlecona.
+     */
+    bool speculate(const std::string& seed_hash, const RandomXAlgorithm& algorithm);
+
+    /**
+     * @brief Utrata połączenia sesji - jej wątki (lub przedziały) przejmują pozostałe.
+     */
+    void set_connected(unsigned session, bool connected);
+
+    /**
+     * @brief Tryb Time: przełącza wszystkie wątki na następną połączoną sesję.
+     * @return Długość rozpoczętego przedziału.
+     */
+    std::chrono::milliseconds advance_slice();
+
+    /**
+     * @brief Manager sesji 0 (lub pierwszy istniejący) - do raportu i statystyk.
+     */
+    std::shared_ptr<RandomXManager> primary_manager() const;
+
+    /**
+     * @brief Wszystkie managery (zmiana trybu, ustawień inicjalizacji, pamięć).
+     */
+    std::vector<std::shared_ptr<RandomXManager>> managers() const;
+
+    std::vector<SessionStats> stats() const;
+    std::size_t size() const { return m_sessions.size(); }
+    PoolSplit split() const { return m_split; }
+
+private:
+    struct Slot {
+        std::shared_ptr<RandomXManager> manager;
+        std::string seed_hash; // Ostatnio zlecony seed i wariant
+        std::string algo;
+        int id = 0;
+    };
+    struct SessionState {
+        Session config;
+        bool connected = false;
+        std::optional<MiningJob> job;
+        std::shared_ptr<Slot> slot;
+    };
+
+    std::size_t users(const std::shared_ptr<Slot>& slot) const; // wymaga m_mutex
+    void apply_weights();                                         // wymaga m_mutex
+
+    const PoolSplit m_split;
+    const std::chrono::seconds m_slice;
+    const std::shared_ptr<WorkerPool> m_workers;
+    const ManagerFactory m_factory;
+
+    mutable std::mutex m_mutex;
+    std::vector<SessionState> m_sessions;
+    std::vector<std::shared_ptr<Slot>> m_slots;
+    int m_next_slot_id = 0;
+    unsigned m_active = 0; // Tryb Time: sesja bieżącego przedziału
+};
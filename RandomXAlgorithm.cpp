@@ -0,0 +1,92 @@
+#include "RandomXAlgorithm.h"
+#include <algorithm>
+#include <cctype>
+
+#ifndef PJUROMINER_RX_IMPORT
+#ifdef _WIN32
+#define PJUROMINER_RX_IMPORT __declspec(dllimport)
+#else
+#define PJUROMINER_RX_IMPORT
+#endif
+#endif
+
+// Tablice wariantów: rx/0 z biblioteki linkowanej statycznie, pozostałe
+// z modułów pjurominer_rx_* (RandomXVariant.cpp, zobacz CMakeLists.txt)
+extern "C" const RandomXAlgorithm pjurominer_rx_0;
+#ifdef PJUROMINER_RX_WOW
+extern "C" PJUROMINER_RX_IMPORT const RandomXAlgorithm pjurominer_rx_wow;
+#endif
+#ifdef PJUROMINER_RX_ARQ
+extern "C" PJUROMINER_RX_IMPORT const RandomXAlgorithm pjurominer_rx_arq;
+#endif
+
+namespace {
+
+struct Alias {
+    std::string_view alias;
+    std::string_view name;
+};
+
+constexpr Alias ALIASES[] = {
+        {"rx", "rx/0"},
+        {"randomx", "rx/0"},
+        {"randomx/0", "rx/0"},
+        {"randomwow", "rx/wow"},
+        {"randomx/wow", "rx/wow"},
+        {"randomarq", "rx/arq"},
+        {"randomx/arq", "rx/arq"},
+};
+
+std::string lowercase(std::string_view text) {
+    std::string result(text);
+    std::transform(result.begin(), result.end(), result.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return result;
+}
+
+} // namespace
+
+const std::vector<const RandomXAlgorithm*>& randomx_algorithms() {
+    static const std::vector<const RandomXAlgorithm*> algorithms = {
+            &pjurominer_rx_0,
+#ifdef PJUROMINER_RX_WOW
+            &pjurominer_rx_wow,
+#endif
+#ifdef PJUROMINER_RX_ARQ
+            &pjurominer_rx_arq,
+#endif
+    };
+    return algorithms;
+}
+
+const RandomXAlgorithm* find_randomx_algorithm(std::string_view name) {
+    std::string key = lowercase(name);
+    for (const auto& alias : ALIASES) {
+        if (key == alias.alias) {
+            key = alias.name;
+            break;
+        }
+    }
+    for (const RandomXAlgorithm* algorithm : randomx_algorithms()) {
+        if (key == algorithm->name) {
+            return algorithm;
+        }
+    }
+    return nullptr;
+}
+
+const RandomXAlgorithm& default_randomx_algorithm() {
+    return pjurominer_rx_0;
+}
+
+std::vector<std::string> randomx_algorithm_names() {
+    std::vector<std::string> names;
+    for (const RandomXAlgorithm* algorithm : randomx_algorithms()) {
+        names.emplace_back(algorithm->name);
+    }
+    return names;
+}
+
+bool randomx_dataset_reusable(const RandomXAlgorithm& from, const RandomXAlgorithm& to) {
+    return from.dataset_bytes == to.dataset_bytes;
+}
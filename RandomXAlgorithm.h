@@ -0,0 +1,83 @@
+#pragma once
+
+#include "DatasetKernel.h"
+#include "randomx.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @struct RandomXApi
+ * @brief Funkcje jednej kompilacji libRandomX.
+ *
+ * Parametry algorytmu (sól Argon2, rozmiary scratchpada, częstotliwości
+ * instrukcji) są stałymi czasu kompilacji biblioteki, więc każdy wariant
+ * jest osobną kompilacją tych samych źródeł, a minerowi udostępnia tylko
+ * tę tablicę. Obiekty (cache, dataset, VM) należy zwalniać funkcjami
+ * wariantu, który je zaalokował.
+ */
+struct RandomXApi {
+    randomx_flags (*get_flags)();
+    randomx_cache* (*alloc_cache)(randomx_flags flags);
+    void (*init_cache)(randomx_cache* cache, const void* key, size_t key_size);
+    void (*release_cache)(randomx_cache* cache);
+    randomx_dataset* (*alloc_dataset)(randomx_flags flags);
+    unsigned long (*dataset_item_count)();
+    void (*init_dataset)(randomx_dataset* dataset, randomx_cache* cache, unsigned long start_item, unsigned long item_count);
+    // Jak init_dataset, ale kernelem wielu elementów naraz (SuperscalarKernel.h); false = nieobsługiwany
+    bool (*init_dataset_kernel)(randomx_dataset* dataset, randomx_cache* cache, unsigned long start_item,
+                                unsigned long item_count, DatasetKernel kernel);
+    // Jak init_dataset_kernel, ale do bufora wywołującego (item_count * 64 B) - dataset nietknięty
+    bool (*compute_dataset_items)(randomx_cache* cache, void* out, unsigned long start_item,
+                                  unsigned long item_count, DatasetKernel kernel);
+    void (*release_dataset)(randomx_dataset* dataset);
+    void* (*get_dataset_memory)(randomx_dataset* dataset);
+    randomx_vm* (*create_vm)(randomx_flags flags, randomx_cache* cache, randomx_dataset* dataset);
+    void (*vm_set_cache)(randomx_vm* vm, randomx_cache* cache);
+    void (*vm_set_dataset)(randomx_vm* vm, randomx_dataset* dataset);
+    void (*destroy_vm)(randomx_vm* vm);
+    void (*calculate_hash)(randomx_vm* vm, const void* input, size_t input_size, void* output);
+};
+
+/**
+ * @struct RandomXAlgorithm
+ * @brief Wariant z rodziny RandomX (rx/0, rx/wow, rx/arq) i jego rozmiary.
+ */
+struct RandomXAlgorithm {
+    const char* name;            // Nazwa w protokole Stratum, np. "rx/0"
+    const RandomXApi* api;
+    uint64_t cache_bytes;        // Pamięć Argon2 (cache)
+    uint64_t dataset_bytes;      // Pełny dataset (tryb Fast)
+    uint64_t scratchpad_bytes;   // Scratchpad jednej VM (L3)
+};
+
+/**
+ * @brief Warianty wkompilowane w minera (pierwszy = rx/0, domyślny).
+ */
+const std::vector<const RandomXAlgorithm*>& randomx_algorithms();
+
+/**
+ * @brief Wyszukuje wariant po nazwie Stratum (także aliasy: "rx", "randomx",
+ * "randomx/0", "randomwow", "randomarq"; wielkość liter bez znaczenia).
+ * @return nullptr, jeśli wariant nie jest wkompilowany.
+ */
+const RandomXAlgorithm* find_randomx_algorithm(std::string_view name);
+
+/**
+ * @brief Wariant domyślny (rx/0).
+ */
+const RandomXAlgorithm& default_randomx_algorithm();
+
+/**
+ * @brief Nazwy wkompilowanych wariantów (np. do listy "algo" przy logowaniu).
+ */
+std::vector<std::string> randomx_algorithm_names();
+
+/**
+ * @brief Czy dataset jednego wariantu może zostać ponownie zainicjalizowany
+ * dla drugiego bez realokacji (ten sam rozmiar; warianty budowane z tych
+ * samych źródeł mają identyczny układ struktury datasetu).
+ * Cache nie jest współdzielony: zawiera wskaźniki na kod swojego wariantu.
+ */
+bool randomx_dataset_reusable(const RandomXAlgorithm& from, const RandomXAlgorithm& to);
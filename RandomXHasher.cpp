@@ -1,7 +1,7 @@
 #include "RandomXHasher.h"
-#include "MiningCommon.h" // Dla hex_to_bytes, bytes_to_hex i g_cout_mutex
+#include "MiningCommon.h" // Dla hex_to_bytes, bytes_to_hex
+#include "Logger.h"
 #include <stdexcept>
-#include <iostream>
 #include <cstring> // Dla std::memcpy
 #include <fmt/core.h>
 #include <thread>
@@ -12,42 +12,70 @@ RandomXHasher::RandomXHasher() : m_vm(nullptr) {
 
 RandomXHasher::~RandomXHasher() {
     if (m_vm) {
-        randomx_destroy_vm(m_vm);
+        m_algorithm->api->destroy_vm(m_vm);
     }
 }
 
-void RandomXHasher::create_vm(randomx_cache* cache, randomx_dataset* dataset) {
-    // 1. Zniszcz starą VM, jeśli istnieje
+void RandomXHasher::release() {
     if (m_vm) {
-        randomx_destroy_vm(m_vm);
+        m_algorithm->api->destroy_vm(m_vm);
         m_vm = nullptr;
     }
+}
 
-    if (!cache || !dataset) {
-        {
-            std::lock_guard<std::mutex> lock(g_cout_mutex);
-            std::cerr << "[Hasher] Błąd: Próba utworzenia VM z pustym cache lub datasetem.\n";
-        }
+void RandomXHasher::create_vm(const RandomXAlgorithm& algorithm, randomx_cache* cache, randomx_dataset* dataset) {
+    // 1. Zniszcz starą VM, jeśli istnieje (funkcją wariantu, który ją utworzył)
+    if (m_vm) {
+        m_algorithm->api->destroy_vm(m_vm);
+        m_vm = nullptr;
+    }
+    m_algorithm = &algorithm;
+
+    if (!cache && !dataset) {
+        LOG_ERROR(LogCategory::Hasher, "[Hasher] Błąd: Próba utworzenia VM z pustym cache.");
         return;
     }
 
     // 2. Ustaw flagi dla VM (Tryb Szybki, JIT, Large Pages)
     // RANDOMX_FLAG_HARD_AES jest domyślnie włączone, jeśli CPU wspiera
-    randomx_flags vm_flags = RANDOMX_FLAG_DEFAULT | RANDOMX_FLAG_JIT | RANDOMX_FLAG_FULL_MEM | RANDOMX_FLAG_LARGE_PAGES | RANDOMX_FLAG_HARD_AES;
+    randomx_flags vm_flags = RANDOMX_FLAG_DEFAULT | RANDOMX_FLAG_JIT | RANDOMX_FLAG_LARGE_PAGES | RANDOMX_FLAG_HARD_AES;
+    if (dataset) {
+        vm_flags |= RANDOMX_FLAG_FULL_MEM;
+    }
 
     // 3. Stwórz nową VM
-    m_vm = randomx_create_vm(vm_flags, cache, dataset);
+    m_vm = algorithm.api->create_vm(vm_flags, cache, dataset);
     if (!m_vm) {
-        // To może się zdarzyć, jeśli np. Large Pages zawiodą
-        {
-            std::lock_guard<std::mutex> lock(g_cout_mutex);
-            std::cerr << "[Hasher] KRYTYCZNY BŁĄD: Nie udało się utworzyć RandomX VM!\n";
-            std::cerr << "[Hasher] Sprawdź uprawnienia 'Large Pages' (secpol.msc -> Lock pages in memory).\n";
+        // Scratchpad bez huge pages (brak wolnych stron) - wolniej, ale działa
+        m_vm = algorithm.api->create_vm(vm_flags & ~RANDOMX_FLAG_LARGE_PAGES, cache, dataset);
+        if (m_vm) {
+            LOG_WARN(LogCategory::Hasher, "[Hasher] VM bez Large Pages (brak wolnych huge pages).");
         }
+    }
+    m_full_mem = dataset != nullptr;
+    if (!m_vm) {
+        // To może się zdarzyć, jeśli np. Large Pages zawiodą
+        LOG_ERROR(LogCategory::Hasher, "[Hasher] KRYTYCZNY BŁĄD: Nie udało się utworzyć RandomX VM!\n"
+                                       "[Hasher] Sprawdź uprawnienia 'Large Pages' (secpol.msc -> Lock pages in memory).");
         throw std::runtime_error("Nie udało się utworzyć RandomX VM");
     }
 }
 
+bool RandomXHasher::bind(const RandomXAlgorithm& algorithm, randomx_cache* cache, randomx_dataset* dataset) {
+    bool full_mem = dataset != nullptr;
+    // Inny wariant = inna kompilacja biblioteki (i często inny rozmiar scratchpada)
+    if (!m_vm || full_mem != m_full_mem || &algorithm != m_algorithm) {
+        create_vm(algorithm, cache, dataset);
+        return false;
+    }
+    if (full_mem) {
+        algorithm.api->vm_set_dataset(m_vm, dataset);
+    } else {
+        // Tryb lekki: VM przelicza programy superskalarne z nowej zawartości cache'a
+        algorithm.api->vm_set_cache(m_vm, cache);
+    }
+    return true;
+}
 
 std::string RandomXHasher::hash(const std::string& blob_hex, uint32_t nonce) {
     const static std::string ZEROHASH = "0000000000000000000000000000000000000000000000000000000000000000";
@@ -69,7 +97,15 @@ std::string RandomXHasher::hash(const std::string& blob_hex, uint32_t nonce) {
     uint8_t hash_result_bytes[RANDOMX_HASH_SIZE];
 
     // Obliczanie hasha (teraz bardzo szybkie)
-    randomx_calculate_hash(m_vm, blob_bytes.data(), blob_bytes.size(), hash_result_bytes);
+    m_algorithm->api->calculate_hash(m_vm, blob_bytes.data(), blob_bytes.size(), hash_result_bytes);
 
     return bytes_to_hex(hash_result_bytes, RANDOMX_HASH_SIZE);
-}
\ No newline at end of file
+}
+
+bool RandomXHasher::hash_bytes(const void* input, size_t size, void* output) {
+    if (!m_vm) {
+        return false;
+    }
+    m_algorithm->api->calculate_hash(m_vm, input, size, output);
+    return true;
+}
@@ -3,7 +3,7 @@
 #include <string>
 #include <vector>
 #include <cstdint>
-#include "randomx.h" // Nagłówek z libRandomX
+#include "RandomXAlgorithm.h" // Warianty libRandomX
 
 /**
  * @class RandomXHasher
@@ -13,6 +13,9 @@
  */
 class RandomXHasher {
 public:
+    static constexpr const char* BACKEND_NAME = "randomx";
+    static constexpr uint32_t HASH_BATCH = 1; // Hash trwa ~1 ms - blokada datasetu na jeden hash
+
     /**
      * @brief Konstruktor.
      */
@@ -29,10 +32,27 @@ public:
 
     /**
      * @brief Tworzy (lub odtwarza) maszynę wirtualną (VM).
+     * @param algorithm Wariant RandomX (VM należy do jego kompilacji biblioteki).
      * @param cache Wskaźnik do współdzielonego cache'a.
-     * @param dataset Wskaźnik do współdzielonego datasetu (Tryb Szybki).
+     * @param dataset Wskaźnik do współdzielonego datasetu (Tryb Szybki);
+     * nullptr = tryb lekki (VM liczy elementy datasetu z cache'a).
+     */
+    void create_vm(const RandomXAlgorithm& algorithm, randomx_cache* cache, randomx_dataset* dataset);
+
+    /**
+     * @brief Wskazuje VM nowy cache/dataset bez jej niszczenia (scratchpad i bufory JIT
+     * zostają). Tworzy VM tylko, gdy jej nie ma, zmienia się tryb (lekki <-> pełny)
+     * lub wariant algorytmu.
+     * @return true, jeśli istniejąca VM została użyta ponownie.
      */
-    void create_vm(randomx_cache* cache, randomx_dataset* dataset);
+    bool bind(const RandomXAlgorithm& algorithm, randomx_cache* cache, randomx_dataset* dataset);
+
+    bool has_vm() const { return m_vm != nullptr; }
+
+    /**
+     * @brief Niszczy VM (scratchpad i kod JIT); następny bind() tworzy nową.
+     */
+    void release();
 
     /**
      * @brief Haszuje blob przy użyciu danego nonce.
@@ -42,6 +62,15 @@ public:
      */
     std::string hash(const std::string& blob_hex, uint32_t nonce);
 
+    /**
+     * @brief Haszuje gotowe bajty (bez konwersji hex i wstrzykiwania nonce).
+     * @param output Bufor na RANDOMX_HASH_SIZE bajtów.
+     * @return false, jeśli VM nie jest gotowa.
+     */
+    bool hash_bytes(const void* input, size_t size, void* output);
+
 private:
     randomx_vm* m_vm = nullptr;     // Wskaźnik na maszynę wirtualną RandomX
+    const RandomXAlgorithm* m_algorithm = nullptr; // Wariant, który utworzył m_vm
+    bool m_full_mem = false;        // VM utworzona z datasetem (RANDOMX_FLAG_FULL_MEM)
 };
\ No newline at end of file
@@ -1,99 +1,563 @@
 #include "RandomXManager.h"
-#include "MiningCommon.h" // Dla hex_to_bytes i g_cout_mutex
+#include "MiningCommon.h" // Dla hex_to_bytes
+#include "Logger.h"
+#include "Trace.h"
+#include <array>
+#include <cstring>
 #include <stdexcept>
-#include <iostream>
 #include <fmt/core.h>
+#include <chrono>
+#include <utility>
 
-RandomXManager::RandomXManager() {
-    // Flagi: JIT, Hard AES (domyślne), Wielkie Strony
-    randomx_flags flags = RANDOMX_FLAG_DEFAULT | RANDOMX_FLAG_JIT | RANDOMX_FLAG_LARGE_PAGES | RANDOMX_FLAG_HARD_AES;
+namespace {
 
-    m_cache = randomx_alloc_cache(flags);
-    if (!m_cache) {
+/**
+ * @brief Blokada wyłączna z pierwszeństwem przed nowymi odczytami.
+ */
+class WriterLock {
+public:
+    WriterLock(std::shared_mutex& mutex, std::atomic<bool>& waiting) : m_lock(mutex, std::defer_lock), m_waiting(waiting) {
+        m_waiting.store(true, std::memory_order_release);
+        m_lock.lock();
+    }
+    ~WriterLock() { m_waiting.store(false, std::memory_order_release); }
+
+private:
+    std::unique_lock<std::shared_mutex> m_lock;
+    std::atomic<bool>& m_waiting;
+};
+
+} // namespace
+
+RandomXManager::RandomXManager(RandomXMode mode, const RandomXAlgorithm& algorithm)
+        : m_algorithm(&algorithm), m_mode(mode), m_topology(read_numa_topology()) {
+    if (!ensure_cache()) {
         throw std::runtime_error("Nie udało się zaalokować RandomX Cache (256MB)");
     }
+    publish_status();
+    m_builder = std::jthread([this](std::stop_token st) { builder_loop(st); });
+    m_scrubber = std::make_unique<DatasetScrubber>(*this);
 }
 
 RandomXManager::~RandomXManager() {
+    m_scrubber.reset();
+    {
+        std::lock_guard<std::mutex> lock(m_session_mutex);
+        if (m_session) {
+            m_session->cancel();
+        }
+    }
+    m_builder.request_stop();
+    if (m_builder.joinable()) {
+        m_builder.join();
+    }
+
     // Ważna kolejność: najpierw dataset, potem cache
     if (m_dataset) {
-        randomx_release_dataset(m_dataset);
+        m_dataset_algorithm->api->release_dataset(m_dataset);
     }
     if (m_cache) {
-        randomx_release_cache(m_cache);
+        m_cache_algorithm->api->release_cache(m_cache);
+    }
+}
+
+bool RandomXManager::ensure_cache() {
+    const RandomXAlgorithm* algorithm = m_algorithm.load(std::memory_order_relaxed);
+    if (m_cache && m_cache_algorithm == algorithm) {
+        return true;
+    }
+    if (m_cache) {
+        // Cache zawiera wskaźniki na kod swojego wariantu - nie da się go przenieść
+        m_cache_algorithm->api->release_cache(m_cache);
+        m_cache = nullptr;
+    }
+    // Flagi: JIT, Hard AES (domyślne), Wielkie Strony
+    randomx_flags flags = RANDOMX_FLAG_DEFAULT | RANDOMX_FLAG_JIT | RANDOMX_FLAG_HARD_AES;
+    m_cache_algorithm = algorithm;
+    m_cache = algorithm->api->alloc_cache(flags | RANDOMX_FLAG_LARGE_PAGES);
+    m_cache_large_pages = m_cache != nullptr;
+    if (!m_cache) {
+        // Bez huge pages wolniej, ale lepiej niż wcale
+        m_cache = algorithm->api->alloc_cache(flags);
+        if (m_cache) {
+            LOG_WARN(LogCategory::RandomX, "[RandomXManager] Cache bez Large Pages (brak wolnych huge pages).");
+        }
     }
+    return m_cache != nullptr;
 }
 
-bool RandomXManager::updateSeed(const std::string& seed_hash_hex) {
-    // Blokujemy mutex na cały czas trwania aktualizacji
-    std::lock_guard<std::mutex> lock(m_mutex);
+void RandomXManager::maybe_release_cache() {
+    if (m_release_cache && m_dataset && m_cache) {
+        // VM w trybie pełnym nie potrzebują cache'a po zbudowaniu datasetu
+        m_cache_algorithm->api->release_cache(m_cache);
+        m_cache = nullptr;
+        LOG_INFO(LogCategory::RandomX, "[RandomXManager] Zwolniono cache ({} MB) - dataset gotowy.",
+                 m_cache_algorithm->cache_bytes >> 20);
+    }
+}
 
-    if (seed_hash_hex == m_current_seed_hex) {
-        return false; // Seed jest ten sam, brak zmian
+bool RandomXManager::updateSeed(const std::string& seed_hash_hex, const RandomXAlgorithm& algorithm) {
+    auto is_current = [&] {
+        return seed_hash_hex == m_current_seed_hex && &algorithm == m_algorithm.load(std::memory_order_relaxed);
+    };
+    {
+        std::shared_lock<std::shared_mutex> read_lock(m_mutex);
+        if (is_current()) {
+            return false; // Seed jest ten sam, brak zmian
+        }
+    }
+
+    // Blokada wyłączna na cały czas przebudowy - workery czekają z haszowaniem
+    WriterLock lock(m_mutex, m_writer_waiting);
+    if (is_current()) {
+        return false;
     }
+    bool built = build_seed(seed_hash_hex, algorithm);
+    publish_status();
+    return built;
+}
 
+bool RandomXManager::request_seed(const std::string& seed_hash_hex, const RandomXAlgorithm& algorithm) {
     {
-        std::lock_guard<std::mutex> cout_lock(g_cout_mutex);
-        std::cout << "[RandomXManager] Wykryto nowy seed. Rozpoczynam aktualizację...\n";
+        std::lock_guard<std::mutex> lock(m_session_mutex);
+        if (seed_hash_hex == m_requested_seed && &algorithm == m_requested_algorithm) {
+            return false;
+        }
+        m_requested_seed = seed_hash_hex;
+        m_requested_algorithm = &algorithm;
+        // Budowa dla starszego seeda jest już bezużyteczna
+        if (m_session) {
+            m_session->cancel();
+        }
+    }
+    m_request_cv.notify_all();
+    return true;
+}
+
+void RandomXManager::set_seed_callback(std::function<void(const std::string&, bool)> callback) {
+    std::lock_guard<std::mutex> lock(m_session_mutex);
+    m_seed_callback = std::move(callback);
+}
+
+void RandomXManager::builder_loop(std::stop_token stoken) {
+    while (true) {
+        std::string seed;
+        const RandomXAlgorithm* algorithm = nullptr;
+        std::function<void(const std::string&, bool)> callback;
+        {
+            std::unique_lock<std::mutex> lock(m_session_mutex);
+            if (!m_request_cv.wait(lock, stoken, [this] {
+                    return m_requested_seed != m_attempted_seed || m_requested_algorithm != m_attempted_algorithm ||
+                           m_rebuild_requested || m_requested_mode || m_requested_release;
+                })) {
+                return; // Zatrzymanie managera
+            }
+            // Ustawienia przed budową - nowy seed zbuduje się już z nimi
+            if (m_requested_release) {
+                bool release = *std::exchange(m_requested_release, std::nullopt);
+                lock.unlock();
+                WriterLock writer(m_mutex, m_writer_waiting);
+                m_release_cache = release;
+                if (release && m_dataset && m_cache) {
+                    maybe_release_cache();
+                    m_generation.fetch_add(1, std::memory_order_release);
+                }
+                publish_status();
+                continue;
+            }
+            if (m_requested_mode) {
+                RandomXMode mode = *std::exchange(m_requested_mode, std::nullopt);
+                lock.unlock();
+                {
+                    WriterLock writer(m_mutex, m_writer_waiting);
+                    apply_mode(mode);
+                    publish_status();
+                }
+                std::lock_guard<std::mutex> pending(m_session_mutex);
+                m_mode_pending = m_requested_mode.has_value();
+                continue;
+            }
+            bool rebuild = m_rebuild_requested &&
+                           m_requested_seed == m_attempted_seed && m_requested_algorithm == m_attempted_algorithm;
+            m_rebuild_requested = false;
+            if (rebuild) {
+                lock.unlock();
+                WriterLock writer(m_mutex, m_writer_waiting);
+                rebuild_current();
+                publish_status();
+                continue;
+            }
+            seed = m_requested_seed;
+            algorithm = m_requested_algorithm;
+            m_attempted_seed = seed;
+            m_attempted_algorithm = algorithm;
+            callback = m_seed_callback;
+        }
+
+        bool ok = false;
+        {
+            WriterLock lock(m_mutex, m_writer_waiting);
+            ok = (seed == m_current_seed_hex && algorithm == m_algorithm.load(std::memory_order_relaxed)) ||
+                 build_seed(seed, *algorithm);
+            publish_status();
+        }
+        if (callback) {
+            callback(seed, ok);
+        }
     }
+}
 
+bool RandomXManager::build_seed(const std::string& seed_hash_hex, const RandomXAlgorithm& algorithm) {
     auto seed_bytes = hex_to_bytes(seed_hash_hex);
     if (seed_bytes.size() != 32) {
-        {
-            std::lock_guard<std::mutex> cout_lock(g_cout_mutex);
-            std::cerr << "[RandomXManager] Błąd: Seed ma nieprawidłową długość.\n";
+        LOG_ERROR(LogCategory::RandomX, "[RandomXManager] Błąd: Seed ma nieprawidłową długość.");
+        return false;
+    }
+
+    const RandomXAlgorithm* previous = m_algorithm.load(std::memory_order_relaxed);
+    if (previous != &algorithm) {
+        LOG_INFO(LogCategory::RandomX, "[RandomXManager] Zmiana algorytmu: {} -> {}", previous->name, algorithm.name);
+        m_current_seed_hex.clear();
+        m_algorithm.store(&algorithm, std::memory_order_relaxed);
+    }
+    LOG_INFO(LogCategory::RandomX, "[RandomXManager] Wykryto nowy seed ({}). Rozpoczynam aktualizację...", algorithm.name);
+
+    auto build_start = std::chrono::steady_clock::now();
+    TRACE_EVENT(TraceEvent::SeedUpdate, TracePhase::Begin, 0, seed_hash_hex);
+
+    // 1. Inicjalizuj cache nowym seedem (w tej samej pamięci, chyba że została zwolniona)
+    if (!ensure_cache()) {
+        LOG_ERROR(LogCategory::RandomX, "[RandomXManager] KRYTYCZNY BŁĄD: Nie udało się zaalokować Cache (256MB)!");
+        TRACE_EVENT(TraceEvent::SeedUpdate, TracePhase::End, 0, "alloc failed");
+        return false;
+    }
+    algorithm.api->init_cache(m_cache, seed_bytes.data(), seed_bytes.size());
+
+    // Od tej chwili stare VM nie mogą liczyć - nawet jeśli budowa się nie uda
+    m_current_seed_hex.clear();
+    m_generation.fetch_add(1, std::memory_order_release);
+    publish_status();
+
+    // 2. W trybie Fast przebuduj dataset (w trybie Light VM liczą z samego cache'a)
+    if (m_mode.load(std::memory_order_relaxed) == RandomXMode::Fast) {
+        if (build_dataset()) {
+            maybe_release_cache();
+        } else if (!m_dataset) {
+            // Brak pamięci na dataset - lepiej kopać wolniej z samego cache'a niż wcale
+            LOG_WARN(LogCategory::RandomX, "[RandomXManager] Przechodzę na tryb light (brak pamięci na dataset).");
+            m_mode.store(RandomXMode::Light, std::memory_order_relaxed);
+        } else {
+            TRACE_EVENT(TraceEvent::SeedUpdate, TracePhase::End, 0, "not built");
+            // Wątki robocze będą musiały poczekać na następny seed
+            return false;
         }
+    }
+
+    auto build_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - build_start).count();
+    m_dataset_build_ms.store(static_cast<uint64_t>(build_ms), std::memory_order_relaxed);
+    m_seed_epoch.fetch_add(1, std::memory_order_relaxed);
+    TRACE_EVENT(TraceEvent::SeedUpdate, TracePhase::End, static_cast<uint64_t>(build_ms), seed_hash_hex);
+
+    m_current_seed_hex = seed_hash_hex;
+    m_generation.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+bool RandomXManager::rebuild_current() {
+    if (m_current_seed_hex.empty() || !m_dataset || m_mode.load(std::memory_order_relaxed) != RandomXMode::Fast) {
+        return false; // Seed zmienił się w międzyczasie albo brak datasetu
+    }
+    const RandomXAlgorithm& algorithm = *m_algorithm.load(std::memory_order_relaxed);
+    LOG_WARN(LogCategory::RandomX, "[RandomXManager] Ponowna inicjalizacja datasetu {} (uszkodzenie pamięci).",
+             algorithm.name);
+    if (!m_cache) {
+        if (!ensure_cache()) {
+            return false;
+        }
+        auto seed_bytes = hex_to_bytes(m_current_seed_hex);
+        algorithm.api->init_cache(m_cache, seed_bytes.data(), seed_bytes.size());
+    }
+
+    m_generation.fetch_add(1, std::memory_order_release);
+    if (!build_dataset()) {
+        m_current_seed_hex.clear(); // Niepełny dataset - workery czekają na kolejny seed
+        m_generation.fetch_add(1, std::memory_order_release);
         return false;
     }
+    maybe_release_cache();
+    m_generation.fetch_add(1, std::memory_order_release);
+    return true;
+}
 
-    // 1. Inicjalizuj cache nowym seedem
-    randomx_init_cache(m_cache, seed_bytes.data(), seed_bytes.size());
+void RandomXManager::request_rebuild() {
+    {
+        std::lock_guard<std::mutex> lock(m_session_mutex);
+        m_rebuild_requested = true;
+    }
+    m_request_cv.notify_all();
+}
 
-    // 2. Zniszcz stary dataset, jeśli istnieje
-    if (m_dataset) {
-        randomx_release_dataset(m_dataset);
-        m_dataset = nullptr;
+int64_t RandomXManager::repair_dataset_items(uint64_t generation, const std::vector<uint64_t>& items) {
+    WriterLock lock(m_mutex, m_writer_waiting);
+    RandomXBinding b = binding();
+    if (b.generation != generation || !b.algorithm || !b.dataset || !b.cache) {
+        return -1;
+    }
+    const RandomXApi& api = *b.algorithm->api;
+    auto* memory = static_cast<uint8_t*>(api.get_dataset_memory(b.dataset));
+    int64_t changed = 0;
+    for (uint64_t item : items) {
+        uint8_t* stored = memory + item * RANDOMX_DATASET_ITEM_SIZE;
+        std::array<uint8_t, RANDOMX_DATASET_ITEM_SIZE> before;
+        std::memcpy(before.data(), stored, before.size());
+        api.init_dataset(b.dataset, b.cache, item, 1);
+        changed += std::memcmp(before.data(), stored, before.size()) != 0;
+    }
+    return changed;
+}
+
+void RandomXManager::set_scrub_config(const DatasetScrubConfig& config) {
+    m_scrubber->set_config(config);
+}
+
+DatasetScrubStats RandomXManager::get_scrub_stats() const {
+    return m_scrubber->stats();
+}
+
+bool RandomXManager::build_dataset() {
+    const RandomXAlgorithm& algorithm = *m_algorithm.load(std::memory_order_relaxed);
+
+    // Dataset innego wariantu o tym samym rozmiarze jest nadpisywany w miejscu
+    if (m_dataset && m_dataset_algorithm != &algorithm) {
+        if (randomx_dataset_reusable(*m_dataset_algorithm, algorithm)) {
+            LOG_INFO(LogCategory::RandomX, "[RandomXManager] Dataset {} użyty ponownie dla {} (ten sam rozmiar).",
+                     m_dataset_algorithm->name, algorithm.name);
+        } else {
+            m_dataset_algorithm->api->release_dataset(m_dataset);
+            m_dataset = nullptr;
+        }
     }
 
-    // 3. Alokuj nowy dataset (z flagą Large Pages)
-    m_dataset = randomx_alloc_dataset(RANDOMX_FLAG_LARGE_PAGES);
+    // Alokacja tylko za pierwszym razem: kolejne seedy nadpisują tę samą pamięć,
+    // więc nie potrzebujemy ponownie 2GB ciągłych huge pages (fragmentacja)
     if (!m_dataset) {
-        {
-            std::lock_guard<std::mutex> cout_lock(g_cout_mutex);
-            std::cerr << "[RandomXManager] KRYTYCZNY BŁĄD: Nie udało się zaalokować Datasetu (2GB)!\n";
-            std::cerr << "[RandomXManager] Upewnij się, że masz wystarczająco RAM i uprawnienia do 'Large Pages'.\n";
+        m_dataset_algorithm = &algorithm;
+        m_dataset = algorithm.api->alloc_dataset(RANDOMX_FLAG_LARGE_PAGES);
+        m_dataset_large_pages = m_dataset != nullptr;
+        if (!m_dataset) {
+            m_dataset = algorithm.api->alloc_dataset(RANDOMX_FLAG_DEFAULT);
+            if (m_dataset) {
+                LOG_WARN(LogCategory::RandomX, "[RandomXManager] Dataset bez Large Pages - hashrate będzie niższy.\n"
+                                               "[RandomXManager] Upewnij się, że masz uprawnienia do 'Large Pages' i wolne huge pages.");
+            }
         }
-        // Wątki robocze będą musiały poczekać na następny seed
-        return false;
+        if (!m_dataset) {
+            LOG_ERROR(LogCategory::RandomX, "[RandomXManager] KRYTYCZNY BŁĄD: Nie udało się zaalokować Datasetu (2GB)!\n"
+                                            "[RandomXManager] Upewnij się, że masz wystarczająco RAM.");
+            return false;
+        }
+        publish_status(); // Planista pamięci widzi dataset już w trakcie budowy
     }
 
-    // 4. Inicjalizuj dataset (TO JEST WOLNA OPERACJA - kilka sekund)
-    unsigned int num_threads = 0; // 0 = auto-detect
-    unsigned int dataset_item_count = randomx_dataset_item_count();
+    // Inicjalizuj dataset (TO JEST WOLNA OPERACJA). randomx_init_dataset liczy podany
+    // zakres w wątku wywołującym, więc dzielimy go na fragmenty dla wielu wątków
+    DatasetInitConfig config;
+    NumaTopology topology;
+    std::shared_ptr<DatasetInitSession> session;
+    {
+        std::lock_guard<std::mutex> lock(m_session_mutex);
+        config = m_init_config;
+        topology = config.numa ? m_topology : NumaTopology{{{}}};
+    }
+
+    // Kernel wielu elementów naraz - tylko zgodny bit w bit z biblioteką dla tego cache'a
+    DatasetKernel kernel = select_dataset_kernel(algorithm, m_dataset, m_cache, config.kernel);
 
     {
-        std::lock_guard<std::mutex> cout_lock(g_cout_mutex);
-        std::cout << "[RandomXManager] Inicjalizuję 2GB Dataset... (to potrwa kilka sekund)\n";
+        std::lock_guard<std::mutex> lock(m_session_mutex);
+        unsigned threads = config.threads ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+        session = std::make_shared<DatasetInitSession>(algorithm, m_dataset, m_cache, algorithm.api->dataset_item_count(),
+                                                       topology, threads, kernel);
+        if (!m_requested_seed.empty() &&
+            (m_requested_seed != m_attempted_seed || m_requested_algorithm != m_attempted_algorithm)) {
+            session->cancel(); // Zlecono już nowszy seed - szkoda pracy
+        }
+        m_session = session;
     }
+    m_progress_session.store(session, std::memory_order_release);
+
+    LOG_INFO(LogCategory::RandomX, "[RandomXManager] Inicjalizuję Dataset {} ({} MB, {} wątków, węzły NUMA: {}, kernel: {})...",
+             algorithm.name, algorithm.dataset_bytes >> 20, config.threads ? config.threads : std::thread::hardware_concurrency(),
+             topology.nodes.size(), dataset_kernel_name(kernel));
 
-    // Używamy 0, aby pozwolić bibliotece zrównoleglić tę operację
-    randomx_init_dataset(m_dataset, m_cache, 0, dataset_item_count);
+    bool complete = run_dataset_init(*session, config, topology, [](const DatasetInitProgress& p) {
+        LOG_INFO(LogCategory::RandomX, "[RandomXManager] Dataset: {:.0f}% ({:.1f} s, ETA {:.1f} s, wątki: {})",
+                 p.fraction() * 100.0, p.elapsed_seconds, p.eta_seconds, p.participants);
+    });
 
+    auto last_progress = std::make_shared<const DatasetInitProgress>(session->progress());
     {
-        std::lock_guard<std::mutex> cout_lock(g_cout_mutex);
-        std::cout << "[RandomXManager] Inicjalizacja Datasetu zakończona.\n";
+        std::lock_guard<std::mutex> lock(m_session_mutex);
+        m_session.reset();
     }
+    m_last_progress.store(last_progress, std::memory_order_release);
+    m_progress_session.store(nullptr, std::memory_order_release);
 
-    m_current_seed_hex = seed_hash_hex;
+    if (!complete) {
+        LOG_INFO(LogCategory::RandomX, "[RandomXManager] Inicjalizacja Datasetu przerwana (nowszy seed).");
+        return false;
+    }
+    LOG_INFO(LogCategory::RandomX, "[RandomXManager] Inicjalizacja Datasetu zakończona w {:.1f} s.",
+             last_progress->elapsed_seconds);
     return true;
 }
 
-std::tuple<randomx_cache*, randomx_dataset*> RandomXManager::get_pointers() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return {m_cache, m_dataset};
+void RandomXManager::set_init_config(const DatasetInitConfig& config) {
+    std::lock_guard<std::mutex> lock(m_session_mutex);
+    m_init_config = config;
+}
+
+bool RandomXManager::help_init(const std::stop_token& stop) {
+    std::shared_ptr<DatasetInitSession> session;
+    {
+        std::lock_guard<std::mutex> lock(m_session_mutex);
+        if (!m_init_config.worker_help) {
+            return false;
+        }
+        session = m_session;
+    }
+    return session && session->participate(m_topology.node_of(current_cpu()), stop);
+}
+
+DatasetInitProgress RandomXManager::get_init_progress() const {
+    if (auto session = m_progress_session.load(std::memory_order_acquire)) {
+        return session->progress();
+    }
+    auto last = m_last_progress.load(std::memory_order_acquire);
+    return last ? *last : DatasetInitProgress{};
+}
+
+std::shared_lock<std::shared_mutex> RandomXManager::try_acquire() {
+    if (m_writer_waiting.load(std::memory_order_acquire)) {
+        return std::shared_lock<std::shared_mutex>(m_mutex, std::defer_lock);
+    }
+    return std::shared_lock<std::shared_mutex>(m_mutex, std::try_to_lock);
+}
+
+RandomXBinding RandomXManager::binding() const {
+    RandomXBinding b;
+    if (m_current_seed_hex.empty()) {
+        b.generation = m_generation.load(std::memory_order_acquire);
+        return b; // Cache nie został jeszcze zainicjalizowany
+    }
+    b.algorithm = m_algorithm.load(std::memory_order_relaxed);
+    b.cache = m_cache;
+    b.dataset = m_dataset;
+    b.generation = m_generation.load(std::memory_order_acquire);
+    b.seed_hex = m_current_seed_hex;
+    return b;
+}
+
+uint64_t RandomXManager::get_generation() const {
+    return m_generation.load(std::memory_order_acquire);
+}
+
+void RandomXManager::set_release_cache(bool release) {
+    {
+        std::lock_guard<std::mutex> lock(m_session_mutex);
+        m_requested_release = release;
+    }
+    m_request_cv.notify_all();
+}
+
+void RandomXManager::publish_status() {
+    auto status = std::make_shared<Status>();
+    status->seed_hex = m_current_seed_hex;
+    if (m_cache) {
+        status->footprint.cache_bytes = m_cache_algorithm->cache_bytes;
+        status->footprint.cache_large_pages = m_cache_large_pages;
+    }
+    if (m_dataset) {
+        status->footprint.dataset_bytes =
+                static_cast<uint64_t>(m_dataset_algorithm->api->dataset_item_count()) * RANDOMX_DATASET_ITEM_SIZE;
+        status->footprint.dataset_large_pages = m_dataset_large_pages;
+    }
+    m_status.store(std::move(status), std::memory_order_release);
+}
+
+RandomXFootprint RandomXManager::get_footprint() const {
+    return m_status.load(std::memory_order_acquire)->footprint;
+}
+
+RandomXMode RandomXManager::get_mode() const {
+    return m_mode.load(std::memory_order_relaxed);
+}
+
+void RandomXManager::request_mode(RandomXMode mode) {
+    {
+        std::lock_guard<std::mutex> lock(m_session_mutex);
+        m_requested_mode = mode;
+        m_mode_pending = true;
+    }
+    m_request_cv.notify_all();
+}
+
+bool RandomXManager::mode_change_pending() {
+    std::lock_guard<std::mutex> lock(m_session_mutex);
+    return m_mode_pending;
+}
+
+void RandomXManager::apply_mode(RandomXMode mode) {
+    if (m_mode.load(std::memory_order_relaxed) == mode) {
+        return;
+    }
+    m_mode.store(mode, std::memory_order_relaxed);
+    m_generation.fetch_add(1, std::memory_order_release);
+    LOG_INFO(LogCategory::RandomX, "[RandomXManager] Przełączam tryb na {}.", randomx_mode_name(mode));
+
+    if (mode == RandomXMode::Light) {
+        if (m_dataset) {
+            m_dataset_algorithm->api->release_dataset(m_dataset);
+            m_dataset = nullptr;
+        }
+        if (!m_current_seed_hex.empty() && !m_cache) {
+            // Cache był zwolniony po zbudowaniu datasetu - odtwarzamy go dla VM w trybie lekkim
+            auto seed_bytes = hex_to_bytes(m_current_seed_hex);
+            if (!ensure_cache()) {
+                m_current_seed_hex.clear(); // Workery poczekają na kolejny seed
+                return;
+            }
+            m_cache_algorithm->api->init_cache(m_cache, seed_bytes.data(), seed_bytes.size());
+        }
+    } else if (!m_current_seed_hex.empty()) {
+        if (!build_dataset()) {
+            if (!m_dataset) {
+                // Brak pamięci na dataset - zostajemy przy samym cache'u
+                m_mode.store(RandomXMode::Light, std::memory_order_relaxed);
+            } else {
+                // Przerwana przez nowszy seed - niepełny dataset nie może służyć do haszowania
+                m_current_seed_hex.clear();
+            }
+            m_generation.fetch_add(1, std::memory_order_release);
+            return;
+        }
+        maybe_release_cache();
+    }
+}
+
+const RandomXAlgorithm& RandomXManager::get_algorithm() const {
+    return *m_algorithm.load(std::memory_order_relaxed);
 }
 
-std::string RandomXManager::get_current_seed() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_current_seed_hex;
-}
\ No newline at end of file
+std::string RandomXManager::get_current_seed() const {
+    return m_status.load(std::memory_order_acquire)->seed_hex;
+}
+
+uint64_t RandomXManager::get_seed_epoch() const {
+    return m_seed_epoch.load(std::memory_order_relaxed);
+}
+
+uint64_t RandomXManager::get_dataset_build_ms() const {
+    return m_dataset_build_ms.load(std::memory_order_relaxed);
+}
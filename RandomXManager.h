@@ -1,22 +1,69 @@
 #pragma once
 
-#include "randomx.h"
+#include "RandomXAlgorithm.h"
+#include "MiningCommon.h"
+#include "DatasetInit.h"
+#include "DatasetScrubber.h"
+#include <condition_variable>
+#include <functional>
+#include <thread>
 #include <string>
 #include <mutex>
-#include <tuple>
+#include <shared_mutex>
 #include <memory>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/**
+ * @struct RandomXBinding
+ * @brief Zasoby, na które workery wskazują swoje VM (ważne przy trzymanej blokadzie odczytu).
+ */
+struct RandomXBinding {
+    const RandomXAlgorithm* algorithm = nullptr; // Wariant, dla którego zbudowano cache/dataset
+    randomx_cache* cache = nullptr;     // nullptr przed pierwszym seedem lub po zwolnieniu (tryb Fast)
+    randomx_dataset* dataset = nullptr; // nullptr w trybie Light
+    uint64_t generation = 0;            // Zmienia się przy każdej zmianie zawartości lub wskaźników
+    std::string seed_hex;
+};
+
+/**
+ * @struct RandomXFootprint
+ * @brief Pamięć zajmowana przez cache i dataset (do raportu RSS / huge pages).
+ */
+struct RandomXFootprint {
+    uint64_t cache_bytes = 0;        // 0 = cache zwolniony
+    bool cache_large_pages = false;
+    uint64_t dataset_bytes = 0;      // 0 = brak datasetu (Light)
+    bool dataset_large_pages = false;
+};
 
 /**
  * @class RandomXManager
  * @brief Zarządza globalnym, współdzielonym stanem RandomX (Cache i Dataset).
  * Ta klasa jest thread-safe.
+ *
+ * Pamięć cache'a i datasetu jest alokowana raz i przy zmianie seeda
+ * inicjalizowana w miejscu. Przy zmianie wariantu algorytmu (np. rx/0 ->
+ * rx/wow) dataset o tym samym rozmiarze jest inicjalizowany ponownie bez
+ * realokacji; cache jest alokowany przez nowy wariant. Na czas przebudowy manager trzyma blokadę
+ * wyłączną, więc workery (blokada współdzielona na czas hasha) nie liczą
+ * na częściowo zapisanym datasecie.
+ *
+ * Wszystkie zmiany (seed, tryb, zwolnienie cache'a) wykonuje wątek managera;
+ * seed i pamięć do raportów są publikowane osobno (get_current_seed(),
+ * get_footprint()), więc ich odczyt nie czeka na blokadę datasetu.
  */
 class RandomXManager {
 public:
     /**
      * @brief Konstruktor. Alokuje wstępny cache.
+     * @param mode Fast = cache + dataset, Light = tylko cache.
+     * @param algorithm Wariant używany do pierwszego seeda z innym algorytmem.
      */
-    RandomXManager();
+    explicit RandomXManager(RandomXMode mode = RandomXMode::Fast,
+                            const RandomXAlgorithm& algorithm = default_randomx_algorithm());
 
     /**
      * @brief Destruktor. Zwalnia cache i dataset.
@@ -29,28 +76,228 @@ public:
 
     /**
      * @brief Aktualizuje seed, jeśli jest nowy.
-     * To jest wolna, blokująca operacja, która przebudowuje 2GB datasetu.
+     * To jest wolna, blokująca operacja, która przebudowuje 2GB datasetu
+     * (równolegle, zobacz DatasetInit.h).
      * @param seed_hash_hex Nowy seed z puli.
+     * @param algorithm Wariant algorytmu pracy (zmiana wariantu też wymaga przebudowy).
      * @return true, jeśli seed był nowy i dataset został przebudowany.
      */
-    bool updateSeed(const std::string& seed_hash_hex);
+    bool updateSeed(const std::string& seed_hash_hex,
+                    const RandomXAlgorithm& algorithm = default_randomx_algorithm());
+
+    /**
+     * @brief Zleca przebudowę dla nowego seeda w wątku managera i wraca od razu.
+     * Trwająca budowa dla starszego seeda jest przerywana. Workery czekają
+     * z pracą na nowy seed (lub pomagają w budowie).
+     * @return true, jeśli seed lub wariant różni się od ostatnio zleconego.
+     */
+    bool request_seed(const std::string& seed_hash_hex,
+                      const RandomXAlgorithm& algorithm = default_randomx_algorithm());
+
+    /**
+     * @brief Wywoływana po każdej budowie zleconej przez request_seed() (wątek managera).
+     * @param seed Seed, którego dotyczyła budowa; ok = false przy błędzie lub przerwaniu.
+     */
+    void set_seed_callback(std::function<void(const std::string& seed, bool ok)> callback);
 
     /**
-     * @brief Zwraca wskaźniki do aktualnego cache'a i datasetu.
-     * @return Para wskaźników {cache, dataset}.
+     * @brief Parametry równoległej inicjalizacji datasetu (dla kolejnych budów).
      */
-    std::tuple<randomx_cache*, randomx_dataset*> get_pointers();
+    void set_init_config(const DatasetInitConfig& config);
 
     /**
-     * @brief Zwraca aktualnie używany seed.
+     * @brief Pozwala czekającemu workerowi policzyć fragmenty trwającej inicjalizacji.
+     * @return true, jeśli wątek coś policzył (false = brak budowy lub kompletu miejsc).
      */
-    std::string get_current_seed();
+    bool help_init(const std::stop_token& stop);
+
+    /**
+     * @brief Zleca ponowną inicjalizację datasetu bieżącego seeda w wątku managera
+     * (masowe uszkodzenie wykryte przez DatasetScrubber).
+     */
+    void request_rebuild();
+
+    /**
+     * @brief Przelicza podane elementy datasetu biblioteką pod blokadą zapisu
+     * (naprawa uszkodzeń wykrytych przez DatasetScrubber; workery czekają
+     * kilka mikrosekund na element). Nie zmienia generacji - wskaźniki zostają.
+     * @param generation Generacja, w której wykryto uszkodzenia.
+     * @return Liczba elementów, które faktycznie się zmieniły; -1, gdy dataset
+     * zmienił się od wykrycia (przebudowa, zmiana trybu) albo nie ma cache'a.
+     */
+    int64_t repair_dataset_items(uint64_t generation, const std::vector<uint64_t>& items);
+
+    /**
+     * @brief Tempo skanowania datasetu w tle (zobacz DatasetScrubber.h).
+     */
+    void set_scrub_config(const DatasetScrubConfig& config);
+
+    DatasetScrubStats get_scrub_stats() const;
+
+    /**
+     * @brief Postęp trwającej (lub ostatniej) inicjalizacji datasetu (odczyt atomowy, bez blokad).
+     */
+    DatasetInitProgress get_init_progress() const;
+
+    /**
+     * @brief Blokada odczytu na czas haszowania. Nie czeka: gdy trwa przebudowa,
+     * zwraca blokadę bez własności (owns_lock() == false).
+     */
+    std::shared_lock<std::shared_mutex> try_acquire();
+
+    /**
+     * @brief Aktualne wskaźniki i seed. Wymaga blokady z try_acquire().
+     */
+    RandomXBinding binding() const;
+
+    /**
+     * @brief Numer wersji zasobów (porównywany przez workery z ich VM bez blokady).
+     */
+    uint64_t get_generation() const;
+
+    /**
+     * @brief Zwalnia cache po zbudowaniu datasetu (tryb Fast), oszczędzając 256 MB.
+     * Przy kolejnym seedzie cache jest alokowany ponownie. Stosowane w wątku managera
+     * przed następną budową; wraca od razu.
+     */
+    void set_release_cache(bool release);
+
+    /**
+     * @brief Rozmiary i rodzaj stron cache'a i datasetu (ostatnio opublikowane, bez blokady datasetu).
+     */
+    RandomXFootprint get_footprint() const;
+
+    /**
+     * @brief Aktualny tryb.
+     */
+    RandomXMode get_mode() const;
+
+    /**
+     * @brief Zleca zmianę trybu w wątku managera i wraca od razu: Light zwalnia dataset,
+     * Fast buduje go dla bieżącego seeda. Haszowanie czeka na zakończenie zmiany;
+     * workery odtwarzają VM (inne flagi). Przy braku pamięci na dataset manager
+     * zostaje w trybie Light (widać to w get_mode() po mode_change_pending() == false).
+     */
+    void request_mode(RandomXMode mode);
+
+    /**
+     * @brief Czy zlecona zmiana trybu jeszcze nie została zakończona.
+     */
+    bool mode_change_pending();
+
+    /**
+     * @brief Wariant algorytmu bieżącego (lub budowanego) seeda.
+     */
+    const RandomXAlgorithm& get_algorithm() const;
+
+    /**
+     * @brief Zwraca aktualnie używany seed (pusty w trakcie przebudowy; bez blokady datasetu).
+     */
+    std::string get_current_seed() const;
+
+    /**
+     * @brief Liczba zakończonych przebudów datasetu (zmian seeda) od startu.
+     * Odczyt bez blokady - bezpieczny z dowolnego wątku.
+     */
+    uint64_t get_seed_epoch() const;
+
+    /**
+     * @brief Czas trwania ostatniej budowy datasetu w milisekundach.
+     */
+    uint64_t get_dataset_build_ms() const;
 
 private:
+    /**
+     * @brief Inicjalizuje dataset z bieżącego cache'a, alokując go tylko za pierwszym razem
+     * (wymaga blokady wyłącznej).
+     */
+    bool build_dataset();
+
+    /**
+     * @brief Przebudowa dla seeda (wymaga blokady wyłącznej). False przy błędzie lub przerwaniu.
+     */
+    bool build_seed(const std::string& seed_hash_hex, const RandomXAlgorithm& algorithm);
+
+    /**
+     * @brief Ponowna inicjalizacja datasetu bieżącego seeda (wymaga blokady wyłącznej).
+     */
+    bool rebuild_current();
+
+    /**
+     * @brief Pętla wątku managera obsługująca request_seed(), request_rebuild(),
+     * request_mode() i set_release_cache().
+     */
+    void builder_loop(std::stop_token stoken);
+
+    /**
+     * @brief Zmiana trybu (wymaga blokady wyłącznej).
+     */
+    void apply_mode(RandomXMode mode);
+
+    /**
+     * @brief Publikuje seed i pamięć dla get_current_seed() i get_footprint()
+     * (wymaga blokady wyłącznej albo konstruktora).
+     */
+    void publish_status();
+
+    /**
+     * @brief Alokuje cache bieżącego wariantu, jeśli został zwolniony lub należy
+     * do innego wariantu (wymaga blokady wyłącznej).
+     */
+    bool ensure_cache();
+
+    /**
+     * @brief Zwalnia cache, jeśli tak skonfigurowano i dataset jest gotowy (wymaga blokady wyłącznej).
+     */
+    void maybe_release_cache();
+
     randomx_cache* m_cache = nullptr;
     randomx_dataset* m_dataset = nullptr;
+    std::atomic<const RandomXAlgorithm*> m_algorithm;        // Wariant bieżącego seeda
+    const RandomXAlgorithm* m_cache_algorithm = nullptr;     // Wariant, który zaalokował m_cache
+    const RandomXAlgorithm* m_dataset_algorithm = nullptr;   // Wariant, który zaalokował m_dataset
+    bool m_cache_large_pages = false;
+    bool m_dataset_large_pages = false;
+    bool m_release_cache = false;
     std::string m_current_seed_hex;
+    std::atomic<RandomXMode> m_mode;
+
+    // Zapis (seed, tryb) - blokada wyłączna; hashe i odczyty - współdzielona
+    mutable std::shared_mutex m_mutex;
+    std::atomic<uint64_t> m_generation{0};
+    std::atomic<bool> m_writer_waiting{false}; // Nowe odczyty czekają - inaczej zapis mógłby się zagłodzić
+
+    // Równoległa inicjalizacja: sesja widoczna dla pomagających workerów
+    DatasetInitConfig m_init_config;
+    NumaTopology m_topology;
+    std::mutex m_session_mutex;  // Chroni pola poniżej (nie m_mutex - workery czekają na tamten)
+    std::shared_ptr<DatasetInitSession> m_session;
+    // Dla metryk bez m_session_mutex (biorą go też czekające workery)
+    std::atomic<std::shared_ptr<DatasetInitSession>> m_progress_session;  // Trwająca budowa
+    std::atomic<std::shared_ptr<const DatasetInitProgress>> m_last_progress; // Ostatnia zakończona
+
+    // Budowy zlecone przez request_seed()
+    std::condition_variable_any m_request_cv;
+    std::string m_requested_seed;   // Ostatnio zlecony (chroni m_session_mutex)
+    std::string m_attempted_seed;   // Ostatnio budowany przez wątek managera
+    const RandomXAlgorithm* m_requested_algorithm = nullptr;
+    const RandomXAlgorithm* m_attempted_algorithm = nullptr;
+    bool m_rebuild_requested = false;
+    std::function<void(const std::string&, bool)> m_seed_callback;
+    std::optional<RandomXMode> m_requested_mode;  // Zmiany ustawień (chroni m_session_mutex)
+    bool m_mode_pending = false;                  // Zlecona albo właśnie wykonywana
+    std::optional<bool> m_requested_release;
+    std::jthread m_builder;         // Uruchamiany w konstruktorze, zatrzymywany w destruktorze
+    std::unique_ptr<DatasetScrubber> m_scrubber; // Zatrzymywany w destruktorze przed zwolnieniem datasetu
+
+    // Stan do raportów i metryk, publikowany przez wątek zmieniający zasoby (bez m_mutex)
+    struct Status {
+        std::string seed_hex;
+        RandomXFootprint footprint;
+    };
+    std::atomic<std::shared_ptr<const Status>> m_status;
 
-    // Mutex chroniący dostęp do wszystkich zasobów (cache, dataset, seed)
-    std::mutex m_mutex;
+    // Statystyki dla metryk (atomowe, bez m_mutex)
+    std::atomic<uint64_t> m_seed_epoch{0};
+    std::atomic<uint64_t> m_dataset_build_ms{0};
 };
\ No newline at end of file
@@ -0,0 +1,52 @@
+/**
+ * @file RandomXVariant.cpp
+ * @brief Tablica funkcji jednego wariantu RandomX.
+ *
+ * Kompilowany raz dla rx/0 (w pjurominer) i raz w każdym module wariantu
+ * (pjurominer_rx_wow, pjurominer_rx_arq) - wtedy randomx.h i configuration.h
+ * pochodzą z kopii źródeł z parametrami tego wariantu, a nazwę i symbol
+ * ustawia CMake (PJUROMINER_RX_NAME, PJUROMINER_RX_SYMBOL).
+ */
+#include "RandomXAlgorithm.h"
+#include "SuperscalarKernel.h"
+#include "configuration.h" // Parametry wariantu (z katalogu źródeł jego kompilacji)
+
+#ifndef PJUROMINER_RX_NAME
+#define PJUROMINER_RX_NAME "rx/0"
+#define PJUROMINER_RX_SYMBOL pjurominer_rx_0
+#endif
+
+#ifndef PJUROMINER_RX_EXPORT
+#define PJUROMINER_RX_EXPORT
+#endif
+
+namespace {
+
+const RandomXApi VARIANT_API = {
+        randomx_get_flags,
+        randomx_alloc_cache,
+        randomx_init_cache,
+        randomx_release_cache,
+        randomx_alloc_dataset,
+        randomx_dataset_item_count,
+        randomx_init_dataset,
+        superscalar::init_dataset,
+        superscalar::compute_dataset_items,
+        randomx_release_dataset,
+        randomx_get_dataset_memory,
+        randomx_create_vm,
+        randomx_vm_set_cache,
+        randomx_vm_set_dataset,
+        randomx_destroy_vm,
+        randomx_calculate_hash,
+};
+
+} // namespace
+
+extern "C" PJUROMINER_RX_EXPORT const RandomXAlgorithm PJUROMINER_RX_SYMBOL = {
+        PJUROMINER_RX_NAME,
+        &VARIANT_API,
+        static_cast<uint64_t>(RANDOMX_ARGON_MEMORY) * 1024,
+        static_cast<uint64_t>(RANDOMX_DATASET_BASE_SIZE) + RANDOMX_DATASET_EXTRA_SIZE,
+        RANDOMX_SCRATCHPAD_L3,
+};
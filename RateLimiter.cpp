@@ -0,0 +1,219 @@
+#include "RateLimiter.h"
+#include "Logger.h"
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <fmt/core.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
+namespace {
+
+constexpr double MIN_CORRECTION = 0.25;
+constexpr double MAX_CORRECTION = 4.0;
+constexpr double CONTROLLER_GAIN = 0.3;    // Część błędu względnego korygowana w jednym kroku
+constexpr double MIN_DUTY_CYCLE = 0.01;
+
+// Kroki pominięte po zmianie limitu lub liczby workerów: hashrate mierzymy
+// w oknie 5 s, więc wcześniejsze pomiary odzwierciedlają stare nastawy
+constexpr unsigned HASHRATE_SETTLE_STEPS = 5;
+constexpr unsigned CPU_SETTLE_STEPS = 1;
+
+double parse_positive(const std::string& spec, std::string_view number) {
+    double value = 0.0;
+    auto [ptr, ec] = std::from_chars(number.data(), number.data() + number.size(), value);
+    if (ec != std::errc() || ptr != number.data() + number.size() || !(value > 0.0)) {
+        throw std::invalid_argument(fmt::format("Nieprawidłowy limit: '{}'", spec));
+    }
+    return value;
+}
+
+bool strip_suffix(std::string_view& text, std::string_view suffix) {
+    if (text.ends_with(suffix)) {
+        text.remove_suffix(suffix.size());
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+RateLimit parse_rate_limit(const std::string& spec) {
+    if (spec.empty() || spec == "none" || spec == "off") {
+        return {};
+    }
+
+    std::string_view text(spec);
+    if (strip_suffix(text, "%")) {
+        double percent = parse_positive(spec, text);
+        if (percent > 100.0) {
+            throw std::invalid_argument(fmt::format("Limit CPU ponad 100%: '{}'", spec));
+        }
+        return {RateLimit::Kind::CpuPercent, percent};
+    }
+    if (strip_suffix(text, "cores")) {
+        return {RateLimit::Kind::Cores, parse_positive(spec, text)};
+    }
+    if (strip_suffix(text, "W")) {
+        return {RateLimit::Kind::Watts, parse_positive(spec, text)};
+    }
+
+    double multiplier = 1.0;
+    if (strip_suffix(text, "H/s")) {
+        if (strip_suffix(text, "k")) {
+            multiplier = 1e3;
+        } else if (strip_suffix(text, "M")) {
+            multiplier = 1e6;
+        }
+    }
+    return {RateLimit::Kind::Hashrate, parse_positive(spec, text) * multiplier};
+}
+
+std::string format_rate_limit(const RateLimit& limit) {
+    switch (limit.kind) {
+        case RateLimit::Kind::None: return "none";
+        case RateLimit::Kind::Hashrate: return fmt::format("{}H/s", limit.value);
+        case RateLimit::Kind::CpuPercent: return fmt::format("{}%", limit.value);
+        case RateLimit::Kind::Cores: return fmt::format("{}cores", limit.value);
+        case RateLimit::Kind::Watts: return fmt::format("{}W", limit.value);
+    }
+    return "none";
+}
+
+double process_cpu_seconds() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return 0.0;
+    }
+    auto to_100ns = [](const FILETIME& ft) {
+        return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+    };
+    return static_cast<double>(to_100ns(kernel) + to_100ns(user)) / 1e7;
+#else
+    timespec ts{};
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0) {
+        return 0.0;
+    }
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+#endif
+}
+
+void TokenBucket::reset(std::chrono::steady_clock::time_point now) {
+    m_tokens = 0.0;
+    m_last = now;
+}
+
+std::chrono::nanoseconds TokenBucket::consume(double amount, double rate, double burst,
+                                              std::chrono::steady_clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - m_last).count();
+    m_last = now;
+    m_tokens = std::min(burst, m_tokens + rate * elapsed) - amount;
+    if (m_tokens >= 0.0 || rate <= 0.0) {
+        return std::chrono::nanoseconds(0);
+    }
+    return std::chrono::nanoseconds(static_cast<int64_t>(-m_tokens / rate * 1e9));
+}
+
+void RateLimiter::set_limit(const RateLimit& limit) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (limit == m_limit) {
+        return;
+    }
+    m_limit = limit;
+    m_correction = 1.0;
+    m_last_active = 0; // Nastawy zostaną wyliczone w najbliższym update()
+    m_warned_no_power = false;
+    m_stats = Stats{};
+    m_stats.limit = limit;
+    if (limit.kind == RateLimit::Kind::None) {
+        m_worker_hash_rate.store(0.0, std::memory_order_relaxed);
+        m_worker_duty.store(1.0, std::memory_order_relaxed);
+    }
+    m_generation.fetch_add(1, std::memory_order_relaxed);
+    LOG_INFO(LogCategory::Manager, "[Limit] Nowy limit: {}", format_rate_limit(limit));
+}
+
+RateLimit RateLimiter::limit() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_limit;
+}
+
+void RateLimiter::update(double measured_hashrate, double measured_cpu_cores, unsigned active_workers, unsigned usable_cpus,
+                         std::optional<double> measured_watts) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    uint64_t throttle_ns = m_throttle_ns.load(std::memory_order_relaxed);
+    bool throttled = throttle_ns != m_last_throttle_ns;
+    m_last_throttle_ns = throttle_ns;
+    m_stats.throttle_seconds = static_cast<double>(throttle_ns) / 1e9;
+
+    bool by_hashrate = m_limit.kind == RateLimit::Kind::Hashrate;
+    bool by_power = m_limit.kind == RateLimit::Kind::Watts;
+    switch (m_limit.kind) {
+        case RateLimit::Kind::None:
+            return;
+        case RateLimit::Kind::Hashrate:
+            m_stats.target = m_limit.value;
+            m_stats.measured = measured_hashrate;
+            break;
+        case RateLimit::Kind::CpuPercent:
+            m_stats.target = m_limit.value / 100.0 * std::max(1u, usable_cpus);
+            m_stats.measured = measured_cpu_cores;
+            break;
+        case RateLimit::Kind::Cores:
+            m_stats.target = m_limit.value;
+            m_stats.measured = measured_cpu_cores;
+            break;
+        case RateLimit::Kind::Watts:
+            if (!measured_watts) {
+                if (!m_warned_no_power) {
+                    m_warned_no_power = true;
+                    LOG_WARN(LogCategory::Manager, "[Limit] Limit mocy bez pomiaru energii (--energy, RAPL) - nieaktywny.");
+                }
+                return;
+            }
+            m_stats.target = m_limit.value;
+            m_stats.measured = *measured_watts;
+            break;
+    }
+    m_stats.deviation = (m_stats.measured - m_stats.target) / m_stats.target;
+
+    if (active_workers == 0) {
+        return; // Nic nie haszuje (pauza) - pomiar nie mówi nic o nastawach
+    }
+    if (active_workers != m_last_active) {
+        m_last_active = active_workers;
+        m_settle_steps = by_hashrate ? HASHRATE_SETTLE_STEPS : CPU_SETTLE_STEPS;
+    } else if (m_settle_steps > 0) {
+        --m_settle_steps;
+    } else {
+        // Anti-windup: poniżej celu bez usypiania workerów limit nie jest osiągalny
+        // (za mało wątków), więc nie zwiększamy korekty w nieskończoność
+        double error = -m_stats.deviation;
+        if (error < 0.0 || throttled) {
+            m_correction = std::clamp(m_correction * (1.0 + CONTROLLER_GAIN * error),
+                                      by_power ? MIN_DUTY_CYCLE : MIN_CORRECTION, by_power ? 1.0 : MAX_CORRECTION);
+        }
+    }
+    m_stats.correction = m_correction;
+
+    // Moc nie dzieli się na workery (pobór jałowy pakietu) - korekta to wprost wypełnienie cyklu
+    double per_worker = by_power ? m_correction : m_stats.target * m_correction / active_workers;
+    if (by_hashrate) {
+        m_worker_hash_rate.store(per_worker, std::memory_order_relaxed);
+        m_worker_duty.store(1.0, std::memory_order_relaxed);
+    } else {
+        m_worker_hash_rate.store(0.0, std::memory_order_relaxed);
+        m_worker_duty.store(std::clamp(per_worker, MIN_DUTY_CYCLE, 1.0), std::memory_order_relaxed);
+    }
+}
+
+RateLimiter::Stats RateLimiter::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+/**
+ * @struct RateLimit
+ * @brief Docelowy limit minera: hashrate całkowity albo budżet CPU.
+ */
+struct RateLimit {
+    enum class Kind { None, Hashrate, CpuPercent, Cores, Watts };
+    Kind kind = Kind::None;
+    double value = 0.0; // H/s, % dostępnych CPU, liczba rdzeni lub waty (RAPL)
+
+    bool operator==(const RateLimit&) const = default;
+};
+
+/**
+ * @brief Parsuje limit: "none", "500", "500H/s", "1.5kH/s", "50%", "2.5cores" lub "120W".
+ * @throws std::invalid_argument przy błędnym formacie lub wartości <= 0.
+ */
+RateLimit parse_rate_limit(const std::string& spec);
+
+/**
+ * @brief Zapis limitu w formacie akceptowanym przez parse_rate_limit().
+ */
+std::string format_rate_limit(const RateLimit& limit);
+
+/**
+ * @brief Czas CPU zużyty przez cały proces (wszystkie wątki), w sekundach.
+ */
+double process_cpu_seconds();
+
+/**
+ * @class TokenBucket
+ * @brief Kubełek żetonów jednego wątku (bez synchronizacji).
+ * Praca jest wykonywana "na kredyt": consume() odejmuje jej koszt
+ * i zwraca czas, po którym saldo wróci do zera.
+ */
+class TokenBucket {
+public:
+    void reset(std::chrono::steady_clock::time_point now);
+
+    /**
+     * @param amount Koszt wykonanej pracy (hashe lub sekundy CPU).
+     * @param rate Przyrost żetonów na sekundę.
+     * @param burst Maksymalne saldo (zapas po bezczynności).
+     * @return Czas do odczekania (0, jeśli saldo jest nieujemne).
+     */
+    std::chrono::nanoseconds consume(double amount, double rate, double burst,
+                                     std::chrono::steady_clock::time_point now);
+
+private:
+    double m_tokens = 0.0;
+    std::chrono::steady_clock::time_point m_last{};
+};
+
+/**
+ * @class RateLimiter
+ * @brief Regulator limitu wspólny dla wszystkich workerów.
+ *
+ * Workery haszują partiami i po każdej partii rozliczają ją w lokalnych
+ * kubełkach: limit hashrate zużywa żeton na hash, budżet CPU - żeton na
+ * sekundę pracy (wypełnienie cyklu). Pętla zamknięta w update() porównuje
+ * zmierzony hashrate lub zużycie CPU z celem i koryguje nastawy workerów,
+ * kompensując np. turbo, SMT i koszt wątków pomocniczych. Limit mocy
+ * reguluje wypełnienie cyklu wg mocy z RAPL (pakiet + DRAM, razem z poborem
+ * jałowym, więc zależność nie jest liniowa - koryguje ją pętla).
+ *
+ * Nastawy są odczytywane przez workery bez blokad; update() i set_limit()
+ * wywołuje jeden wątek (io_context).
+ */
+class RateLimiter {
+public:
+    /**
+     * @struct Stats
+     * @brief Stan regulatora dla metryk i /status.
+     */
+    struct Stats {
+        RateLimit limit;
+        double target = 0.0;     // H/s, liczba rdzeni lub W
+        double measured = 0.0;   // W tych samych jednostkach co target
+        double deviation = 0.0;  // (measured - target) / target
+        double correction = 1.0; // Mnożnik nastaw z pętli zamkniętej
+        double throttle_seconds = 0.0; // Łączny czas uśpienia workerów przez limit
+    };
+
+    void set_limit(const RateLimit& limit);
+    RateLimit limit() const;
+
+    /**
+     * @brief Krok regulatora (co sekundę).
+     * @param measured_hashrate Hashrate całkowity z krótkiego okna telemetrii.
+     * @param measured_cpu_cores Zużycie CPU procesu od poprzedniego kroku (w rdzeniach).
+     * @param active_workers Workery, które mogą haszować (bez pauzy i parkowania).
+     * @param usable_cpus CPU dostępne dla procesu (dla limitu w %).
+     * @param measured_watts Moc z RAPL (std::nullopt = brak pomiaru; limit mocy wtedy nie działa).
+     */
+    void update(double measured_hashrate, double measured_cpu_cores, unsigned active_workers, unsigned usable_cpus,
+                std::optional<double> measured_watts = std::nullopt);
+
+    Stats stats() const;
+
+    // --- Strona workera (bez blokad) ---
+    double worker_hash_rate() const { return m_worker_hash_rate.load(std::memory_order_relaxed); } // 0 = bez limitu
+    double worker_duty_cycle() const { return m_worker_duty.load(std::memory_order_relaxed); }    // 1 = bez limitu
+    uint64_t generation() const { return m_generation.load(std::memory_order_relaxed); }          // Zmiana = reset kubełków
+    void record_throttle(std::chrono::nanoseconds slept) {
+        m_throttle_ns.fetch_add(static_cast<uint64_t>(slept.count()), std::memory_order_relaxed);
+    }
+
+private:
+    mutable std::mutex m_mutex; // Chroni pola poniżej (update() vs stats())
+    RateLimit m_limit;
+    Stats m_stats;
+    double m_correction = 1.0;
+    unsigned m_settle_steps = 0;    // Kroki do pominięcia po zmianie (pomiar z poprzednich nastaw)
+    unsigned m_last_active = 0;
+    bool m_warned_no_power = false;
+    uint64_t m_last_throttle_ns = 0;
+
+    std::atomic<double> m_worker_hash_rate{0.0};
+    std::atomic<double> m_worker_duty{1.0};
+    std::atomic<uint64_t> m_generation{0};
+    std::atomic<uint64_t> m_throttle_ns{0};
+};
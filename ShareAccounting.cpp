@@ -0,0 +1,259 @@
+#include "ShareAccounting.h"
+#include "Logger.h"
+#include "Telemetry.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fmt/core.h>
+
+namespace {
+
+constexpr std::size_t MAX_JOBS = 64;            // Prace z licznikami per-job
+constexpr std::size_t MAX_EVENTS = 1 << 20;     // Górna granica pamięci okien
+constexpr double CONFIDENCE_Z = 1.96;           // Przedział raportowany (95%)
+constexpr double ALERT_Z = 3.0;                 // Próg alarmu (~99.9%, jednostronnie)
+constexpr double MIN_EXPECTED_SHARES = 10.0;    // Mniej - za mało danych na ocenę
+constexpr uint64_t MIN_RESULTS_FOR_RATIO = 10;
+constexpr double ALERT_REJECT_RATIO = 0.10;
+
+/**
+ * @brief Granice przedziału ufności dla liczby zdarzeń Poissona
+ * (przybliżenie Wilsona-Hilferty'ego, dokładne do kilku % już od n = 0).
+ */
+double poisson_lower(uint64_t n, double z) {
+    if (n == 0) {
+        return 0.0;
+    }
+    double k = static_cast<double>(n);
+    double base = 1.0 - 1.0 / (9.0 * k) - z / (3.0 * std::sqrt(k));
+    return base > 0.0 ? k * base * base * base : 0.0;
+}
+
+double poisson_upper(uint64_t n, double z) {
+    double k = static_cast<double>(n) + 1.0;
+    double base = 1.0 - 1.0 / (9.0 * k) + z / (3.0 * std::sqrt(k));
+    return k * base * base * base;
+}
+
+bool contains(const std::string& haystack, const char* needle) {
+    return haystack.find(needle) != std::string::npos;
+}
+
+/**
+ * @brief Podpowiedź, gdzie szukać problemu, dla dominującego powodu odrzuceń.
+ */
+const char* reason_hint(RejectReason reason) {
+    switch (reason) {
+        case RejectReason::LowDifficulty: return "wyniki nie spełniają targetu - sprawdź porównanie z targetem, wariant i seed";
+        case RejectReason::Stale: return "udziały docierają po zmianie pracy - opóźnione przełączanie pracy lub wysokie RTT";
+        case RejectReason::Duplicate: return "powtórzone nonce - nakładające się zakresy wątków";
+        case RejectReason::InvalidResult: return "pula liczy inny hash - zły wariant RandomX, seed lub uszkodzony dataset";
+        case RejectReason::Unauthorized: return "sesja odrzucona przez pulę - login, portfel lub ban";
+        default: return "nieznany powód";
+    }
+}
+
+} // namespace
+
+const char* reject_reason_name(RejectReason reason) {
+    switch (reason) {
+        case RejectReason::None: return "none";
+        case RejectReason::LowDifficulty: return "low_difficulty";
+        case RejectReason::Stale: return "stale";
+        case RejectReason::Duplicate: return "duplicate";
+        case RejectReason::InvalidResult: return "invalid_result";
+        case RejectReason::Unauthorized: return "unauthorized";
+        case RejectReason::Other: return "other";
+    }
+    return "other";
+}
+
+RejectReason classify_reject_reason(const std::string& message) {
+    std::string m = message;
+    std::transform(m.begin(), m.end(), m.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    // Kolejność ma znaczenie: "invalid job id" to praca nieaktualna, a nie zły wynik
+    if (contains(m, "duplicate")) {
+        return RejectReason::Duplicate;
+    }
+    if (contains(m, "low difficulty") || contains(m, "low-difficulty") || contains(m, "above target") ||
+        contains(m, "high-hash") || contains(m, "low diff")) {
+        return RejectReason::LowDifficulty;
+    }
+    if (contains(m, "stale") || contains(m, "expired") || contains(m, "unknown job") || contains(m, "job not found") ||
+        contains(m, "invalid job") || contains(m, "outdated") || contains(m, "old job")) {
+        return RejectReason::Stale;
+    }
+    if (contains(m, "unauthenticated") || contains(m, "unauthorized") || contains(m, "not logged") ||
+        contains(m, "banned") || contains(m, "login")) {
+        return RejectReason::Unauthorized;
+    }
+    if (contains(m, "incorrect") || contains(m, "invalid") || contains(m, "malformed") || contains(m, "bad nonce") ||
+        contains(m, "wrong")) {
+        return RejectReason::InvalidResult;
+    }
+    return RejectReason::Other;
+}
+
+ShareAccounting::ShareAccounting(std::vector<std::chrono::seconds> windows)
+        : m_windows(std::move(windows)),
+          m_max_window(m_windows.empty() ? std::chrono::seconds(0)
+                                         : *std::max_element(m_windows.begin(), m_windows.end())),
+          m_start(std::chrono::steady_clock::now()) {}
+
+ShareAccountingStats::Job& ShareAccounting::job_entry(const std::string& pool, const std::string& job_id) {
+    auto it = std::find_if(m_jobs.rbegin(), m_jobs.rend(), [&](const ShareAccountingStats::Job& job) {
+        return job.job_id == job_id && job.pool == pool;
+    });
+    if (it != m_jobs.rend()) {
+        return *it;
+    }
+    m_jobs.push_back({pool, job_id});
+    if (m_jobs.size() > MAX_JOBS) {
+        m_jobs.pop_front();
+    }
+    return m_jobs.back();
+}
+
+void ShareAccounting::record_job(const std::string& pool, const std::string& job_id, uint64_t difficulty) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    job_entry(pool, job_id).difficulty = difficulty;
+    if (difficulty) {
+        m_job_difficulty = difficulty;
+    }
+}
+
+void ShareAccounting::record(const ShareResult& result) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto& job = job_entry(result.pool, result.job_id);
+    uint64_t difficulty = result.difficulty ? result.difficulty : job.difficulty;
+    auto& pool = m_pools[result.pool];
+    pool.pool = result.pool;
+    switch (result.outcome) {
+        case ShareOutcome::Accepted:
+            job.accepted++;
+            pool.accepted++;
+            pool.accepted_difficulty += difficulty;
+            break;
+        case ShareOutcome::Rejected:
+            job.rejected++;
+            pool.rejected++;
+            pool.rejected_difficulty += difficulty;
+            break;
+        case ShareOutcome::Stale:
+            job.stale++;
+            pool.stale++;
+            pool.rejected_difficulty += difficulty;
+            break;
+    }
+    if (result.outcome != ShareOutcome::Accepted) {
+        m_reasons[static_cast<std::size_t>(result.reason)]++;
+    }
+
+    m_events.push_back({now, difficulty, result.outcome});
+    while (!m_events.empty() && (now - m_events.front().time > m_max_window || m_events.size() > MAX_EVENTS)) {
+        m_events.pop_front();
+    }
+}
+
+ShareAccountingStats ShareAccounting::stats(const std::vector<double>& local_rates) const {
+    auto now = std::chrono::steady_clock::now();
+    auto uptime = std::chrono::duration<double>(now - m_start).count();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ShareAccountingStats stats;
+    for (std::size_t w = 0; w < m_windows.size(); ++w) {
+        ShareAccountingStats::Window window;
+        window.window = m_windows[w];
+        window.span_seconds = std::min(static_cast<double>(m_windows[w].count()), uptime);
+        window.local_rate = w < local_rates.size() ? local_rates[w] : 0.0;
+
+        uint64_t accepted_difficulty = 0;
+        for (auto it = m_events.rbegin(); it != m_events.rend() && now - it->time <= m_windows[w]; ++it) {
+            switch (it->outcome) {
+                case ShareOutcome::Accepted:
+                    window.accepted++;
+                    accepted_difficulty += it->difficulty;
+                    break;
+                case ShareOutcome::Rejected: window.rejected++; break;
+                case ShareOutcome::Stale: window.stale++; break;
+            }
+        }
+
+        if (window.span_seconds > 0.0) {
+            // Bez udziałów w oknie odniesieniem jest trudność ostatniej pracy
+            double mean_difficulty = window.accepted
+                                     ? static_cast<double>(accepted_difficulty) / static_cast<double>(window.accepted)
+                                     : static_cast<double>(m_job_difficulty);
+            window.effective_rate = static_cast<double>(accepted_difficulty) / window.span_seconds;
+            window.effective_low = poisson_lower(window.accepted, CONFIDENCE_Z) * mean_difficulty / window.span_seconds;
+            window.effective_high = poisson_upper(window.accepted, CONFIDENCE_Z) * mean_difficulty / window.span_seconds;
+            if (mean_difficulty > 0.0) {
+                window.expected_shares = window.local_rate * window.span_seconds / mean_difficulty;
+            }
+        }
+        stats.windows.push_back(window);
+    }
+    for (const auto& [name, pool] : m_pools) {
+        stats.pools.push_back(pool);
+    }
+    stats.jobs.assign(m_jobs.begin(), m_jobs.end());
+    stats.reasons = m_reasons;
+    stats.alert = m_alert.load(std::memory_order_relaxed);
+    stats.alert_reason = m_alert_reason;
+    return stats;
+}
+
+std::string ShareAccounting::evaluate(const ShareAccountingStats& stats) const {
+    // Dominujący powód odrzuceń (od startu) - wskazuje etap, na którym giną udziały
+    auto dominant = static_cast<RejectReason>(
+            std::max_element(stats.reasons.begin() + 1, stats.reasons.end()) - stats.reasons.begin());
+
+    for (const auto& w : stats.windows) {
+        uint64_t results = w.accepted + w.rejected + w.stale;
+        if (results >= MIN_RESULTS_FOR_RATIO) {
+            double ratio = static_cast<double>(w.rejected + w.stale) / static_cast<double>(results);
+            if (ratio >= ALERT_REJECT_RATIO) {
+                return fmt::format("{:.0f}% udziałów odrzuconych w oknie {} (głównie {}): {}", ratio * 100.0,
+                                   format_window_label(w.window), reject_reason_name(dominant), reason_hint(dominant));
+            }
+        }
+    }
+
+    for (const auto& w : stats.windows) {
+        if (w.expected_shares < MIN_EXPECTED_SHARES) {
+            continue;
+        }
+        // Zaakceptowano mniej udziałów, niż pozwala przypadek przy lokalnym hashrate
+        if (poisson_upper(w.accepted, ALERT_Z) < w.expected_shares) {
+            return fmt::format("efektywny hashrate {:.1f} H/s wobec lokalnego {:.1f} H/s w oknie {} "
+                               "({} udziałów, oczekiwano {:.1f}) - rozwiązania giną przed pulą "
+                               "(porównanie z targetem, kolejka submit, połączenie) lub lokalny licznik jest zawyżony",
+                               w.effective_rate, w.local_rate, format_window_label(w.window), w.accepted,
+                               w.expected_shares);
+        }
+    }
+    return {};
+}
+
+ShareAccountingStats ShareAccounting::check(const std::vector<double>& local_rates) {
+    ShareAccountingStats current = stats(local_rates);
+    std::string reason = evaluate(current);
+    bool alert = !reason.empty();
+    bool was_alert = m_alert.exchange(alert, std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_alert_reason = reason;
+    }
+    if (alert && !was_alert) {
+        LOG_WARN(LogCategory::Stats, "[Shares] Rozbieżność udziałów: {}", reason);
+    } else if (!alert && was_alert) {
+        LOG_INFO(LogCategory::Stats, "[Shares] Efektywny hashrate zgodny z lokalnym - alarm wyłączony.");
+    }
+    current.alert = alert;
+    current.alert_reason = reason;
+    return current;
+}
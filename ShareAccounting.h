@@ -0,0 +1,170 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @enum ShareOutcome
+ * @brief Ostateczny wynik udziału.
+ */
+enum class ShareOutcome {
+    Accepted,
+    Rejected,
+    Stale,    // Odrzucony jako nieaktualny lub porzucony z dziennika po zmianie pracy
+};
+
+/**
+ * @enum RejectReason
+ * @brief Klasa powodu odrzucenia (z komunikatu błędu puli).
+ */
+enum class RejectReason {
+    None,          // Udział zaakceptowany
+    LowDifficulty, // "Low difficulty share" - wynik nie spełnia targetu
+    Stale,         // "Block expired", "Unknown job" - praca już nieaktualna
+    Duplicate,     // "Duplicate share" - nonce wysłany ponownie
+    InvalidResult, // "Incorrect hash", "Invalid nonce" - pula liczy inny hash
+    Unauthorized,  // "Unauthenticated", ban - sesja lub login nieważne
+    Other,
+};
+
+constexpr std::size_t REJECT_REASON_COUNT = 7;
+
+/**
+ * @brief Nazwa powodu ("low_difficulty", "stale", ...).
+ */
+const char* reject_reason_name(RejectReason reason);
+
+/**
+ * @brief Klasyfikuje komunikat błędu puli (pole "message" lub całe "error").
+ */
+RejectReason classify_reject_reason(const std::string& message);
+
+/**
+ * @struct ShareResult
+ * @brief Odpowiedź puli na udział (lub porzucenie nieaktualnego udziału).
+ */
+struct ShareResult {
+    std::string pool;        // "host:port"
+    std::string job_id;
+    uint64_t difficulty = 0; // Trudność targetu pracy (0 = nieznana)
+    ShareOutcome outcome = ShareOutcome::Accepted;
+    RejectReason reason = RejectReason::None;
+    std::string message;     // Komunikat puli przy odrzuceniu
+};
+
+/**
+ * @struct ShareAccountingStats
+ * @brief Rozliczenie udziałów dla metryk, /status i raportu.
+ */
+struct ShareAccountingStats {
+    struct Window {
+        std::chrono::seconds window{0};
+        double span_seconds = 0.0;    // Okno przycięte do czasu działania
+        uint64_t accepted = 0;
+        uint64_t rejected = 0;
+        uint64_t stale = 0;
+        double effective_rate = 0.0;  // H/s: zaakceptowana trudność / czas
+        double effective_low = 0.0;   // 95% przedział ufności (Poisson)
+        double effective_high = 0.0;
+        double local_rate = 0.0;      // H/s z telemetrii workerów
+        double expected_shares = 0.0; // Przy lokalnym hashrate i bieżącej trudności
+    };
+    struct Pool {
+        std::string pool;
+        uint64_t accepted = 0;
+        uint64_t rejected = 0;
+        uint64_t stale = 0;
+        uint64_t accepted_difficulty = 0;
+        uint64_t rejected_difficulty = 0; // Odrzucone i nieaktualne
+    };
+    struct Job {
+        std::string pool;
+        std::string job_id;
+        uint64_t difficulty = 0;
+        uint64_t accepted = 0;
+        uint64_t rejected = 0;
+        uint64_t stale = 0;
+    };
+
+    std::vector<Window> windows;
+    std::vector<Pool> pools;
+    std::vector<Job> jobs;                                  // Ostatnie prace (najnowsza na końcu)
+    std::array<uint64_t, REJECT_REASON_COUNT> reasons{};    // Indeks = RejectReason
+    bool alert = false;
+    std::string alert_reason;
+};
+
+/**
+ * @class ShareAccounting
+ * @brief Rozliczenie udziałów: efektywny hashrate z trudności zaakceptowanych
+ * udziałów i porównanie z hashrate liczonym lokalnie.
+ *
+ * Znalezienie udziału to proces Poissona: przy lokalnym hashrate H i trudności
+ * d pula powinna zaliczyć średnio H*T/d udziałów w oknie T. Liczba
+ * zaakceptowanych udziałów daje przedział ufności efektywnego hashrate
+ * (przybliżenie Wilsona-Hilferty'ego); lokalny hashrate wyraźnie powyżej tego
+ * przedziału albo duży udział odrzuceń oznacza, że rozwiązania giną lub są
+ * liczone źle gdzieś między workerami a pulą - check() ustawia wtedy alarm.
+ *
+ * record() i record_job() wywołuje wątek io_context, check() wątek raportu;
+ * wszystkie metody są bezpieczne wątkowo.
+ */
+class ShareAccounting {
+public:
+    /**
+     * @param windows Okna przesuwne (jak w telemetrii).
+     */
+    explicit ShareAccounting(std::vector<std::chrono::seconds> windows);
+
+    /**
+     * @brief Zapamiętuje trudność nowej pracy (odniesienie, gdy brak udziałów).
+     */
+    void record_job(const std::string& pool, const std::string& job_id, uint64_t difficulty);
+
+    void record(const ShareResult& result);
+
+    /**
+     * @brief Rozliczenie w oknach.
+     * @param local_rates Lokalny hashrate w tych samych oknach (H/s).
+     */
+    ShareAccountingStats stats(const std::vector<double>& local_rates) const;
+
+    /**
+     * @brief Ocenia rozbieżność i loguje zmianę stanu alarmu.
+     * @return Aktualne rozliczenie.
+     */
+    ShareAccountingStats check(const std::vector<double>& local_rates);
+
+    bool alert() const { return m_alert.load(std::memory_order_relaxed); }
+
+private:
+    struct Event {
+        std::chrono::steady_clock::time_point time;
+        uint64_t difficulty;
+        ShareOutcome outcome;
+    };
+
+    ShareAccountingStats::Job& job_entry(const std::string& pool, const std::string& job_id);
+    std::string evaluate(const ShareAccountingStats& stats) const;
+
+    const std::vector<std::chrono::seconds> m_windows;
+    const std::chrono::seconds m_max_window;
+    const std::chrono::steady_clock::time_point m_start;
+
+    mutable std::mutex m_mutex;
+    std::deque<Event> m_events;                               // Wyniki z najdłuższego okna
+    std::map<std::string, ShareAccountingStats::Pool> m_pools;
+    std::deque<ShareAccountingStats::Job> m_jobs;
+    std::array<uint64_t, REJECT_REASON_COUNT> m_reasons{};
+    uint64_t m_job_difficulty = 0;                            // Ostatnia praca
+    std::string m_alert_reason;
+
+    std::atomic<bool> m_alert{false};
+};
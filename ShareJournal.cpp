@@ -0,0 +1,433 @@
+#include "ShareJournal.h"
+#include "Logger.h"
+#include "MiningCommon.h"
+#include "SystemUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fmt/core.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char JOURNAL_MAGIC[8] = {'P', 'J', 'S', 'H', 'A', 'R', 'E', '1'};
+constexpr uint32_t JOURNAL_VERSION = 1;
+constexpr std::chrono::seconds SYNC_INTERVAL{1}; // msync bieżącego segmentu
+
+/**
+ * @brief Nagłówek segmentu (pierwsze 256 bajtów pliku).
+ */
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t capacity;
+    uint64_t first_sequence; // Sekwencja pierwszego nowego rekordu (kopie mogą być starsze)
+    int64_t created_us;
+    uint8_t reserved[216];
+};
+static_assert(sizeof(Header) == 256);
+
+void copy_text(char* dst, std::size_t size, const std::string& src) {
+    std::memset(dst, 0, size);
+    std::memcpy(dst, src.data(), std::min(src.size(), size - 1));
+}
+
+std::string read_text(const char* src, std::size_t size) {
+    return std::string(src, strnlen(src, size));
+}
+
+void copy_hash(uint8_t* dst, const std::string& hex) {
+    std::memset(dst, 0, 32);
+    if (hex.size() == 64) {
+        auto bytes = hex_to_bytes(hex);
+        std::memcpy(dst, bytes.data(), 32);
+    }
+}
+
+std::string read_hash(const uint8_t* src) {
+    bool empty = std::all_of(src, src + 32, [](uint8_t b) { return b == 0; });
+    return empty ? std::string() : bytes_to_hex(src, 32);
+}
+
+} // namespace
+
+/**
+ * @brief Rekord udziału w pliku (256 bajtów). Pole state jest zapisywane na końcu.
+ */
+struct ShareJournal::Record {
+    uint32_t state;
+    uint32_t attempts;
+    uint64_t sequence;
+    int64_t found_us;
+    int64_t submitted_us;
+    int64_t resolved_us;
+    uint64_t difficulty;
+    uint32_t nonce;
+    uint32_t reserved0;
+    uint8_t result[32];
+    uint8_t prev_id[32];
+    char job_id[64];
+    char pool[64];
+    uint8_t reserved1[8];
+
+    ShareState load_state() const {
+        return static_cast<ShareState>(std::atomic_ref<const uint32_t>(state).load(std::memory_order_acquire));
+    }
+    void store_state(ShareState value) {
+        std::atomic_ref<uint32_t>(state).store(static_cast<uint32_t>(value), std::memory_order_release);
+    }
+
+    ShareEntry to_entry() const {
+        ShareEntry entry;
+        entry.sequence = sequence;
+        entry.state = load_state();
+        entry.pool = read_text(pool, sizeof(pool));
+        entry.job_id = read_text(job_id, sizeof(job_id));
+        entry.nonce = nonce;
+        entry.result_hash = read_hash(result);
+        entry.prev_id = read_hash(prev_id);
+        entry.difficulty = difficulty;
+        entry.found_us = found_us;
+        entry.submitted_us = submitted_us;
+        entry.resolved_us = resolved_us;
+        entry.attempts = attempts;
+        return entry;
+    }
+};
+
+/**
+ * @brief Zmapowany plik segmentu.
+ */
+struct ShareJournal::Segment {
+    std::string path;
+    int fd = -1;
+    void* map = nullptr;
+    std::size_t size = 0;
+    Header* header = nullptr;
+    Record* records = nullptr;
+    uint32_t capacity = 0;
+    uint32_t used = 0; // Rekordy niepuste (wątek io_context)
+
+    ~Segment() {
+#ifndef _WIN32
+        if (map) {
+            munmap(map, size);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+#endif
+    }
+
+    void sync() const {
+#ifndef _WIN32
+        msync(map, size, MS_SYNC);
+#endif
+    }
+};
+
+const char* share_state_name(ShareState state) {
+    switch (state) {
+        case ShareState::Empty: return "empty";
+        case ShareState::Submitted: return "submitted";
+        case ShareState::Accepted: return "accepted";
+        case ShareState::Rejected: return "rejected";
+        case ShareState::Stale: return "stale";
+    }
+    return "unknown";
+}
+
+ShareJournal::ShareJournal(std::string path, uint32_t capacity)
+        : m_path(std::move(path)), m_capacity(std::max<uint32_t>(capacity, 16)) {
+    static_assert(sizeof(Record) == 256, "Układ rekordu jest częścią formatu pliku");
+}
+
+ShareJournal::~ShareJournal() {
+    if (m_background.joinable()) {
+        m_background.request_stop();
+        m_background.join();
+    }
+    for (const auto& segment : m_retired) {
+        segment->sync();
+    }
+    if (m_segment) {
+        m_segment->sync();
+    }
+}
+
+std::unique_ptr<ShareJournal::Segment> ShareJournal::open_segment(const std::string& path, bool create) {
+#ifdef _WIN32
+    (void)path;
+    (void)create;
+    return nullptr;
+#else
+    auto segment = std::make_unique<Segment>();
+    segment->path = path;
+    segment->fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT : 0), 0644);
+    if (segment->fd < 0) {
+        return nullptr;
+    }
+    struct stat st{};
+    if (fstat(segment->fd, &st) != 0) {
+        return nullptr;
+    }
+
+    bool fresh = st.st_size == 0;
+    uint64_t capacity = m_capacity;
+    if (!fresh) {
+        Header header{};
+        if (pread(segment->fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+            std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0 ||
+            header.version != JOURNAL_VERSION || header.record_size != sizeof(Record) ||
+            static_cast<uint64_t>(st.st_size) < sizeof(Header) + header.capacity * sizeof(Record)) {
+            LOG_ERROR(LogCategory::Stratum, "[Journal] {} nie jest dziennikiem udziałów pjurominer - pomijam.", path);
+            return nullptr;
+        }
+        capacity = header.capacity;
+    }
+
+    segment->capacity = static_cast<uint32_t>(capacity);
+    segment->size = sizeof(Header) + capacity * sizeof(Record);
+    if (fresh) {
+        // Bloki rezerwowane od razu: zapis do mapy dziury przy pełnym dysku kończy się SIGBUS
+#ifdef __linux__
+        if (posix_fallocate(segment->fd, 0, static_cast<off_t>(segment->size)) != 0) {
+            return nullptr;
+        }
+#else
+        if (ftruncate(segment->fd, static_cast<off_t>(segment->size)) != 0) {
+            return nullptr;
+        }
+#endif
+    }
+    segment->map = mmap(nullptr, segment->size, PROT_READ | PROT_WRITE, MAP_SHARED, segment->fd, 0);
+    if (segment->map == MAP_FAILED) {
+        segment->map = nullptr;
+        return nullptr;
+    }
+    segment->header = static_cast<Header*>(segment->map);
+    segment->records = reinterpret_cast<Record*>(static_cast<char*>(segment->map) + sizeof(Header));
+
+    if (fresh) {
+        std::memcpy(segment->header->magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+        segment->header->version = JOURNAL_VERSION;
+        segment->header->record_size = sizeof(Record);
+        segment->header->capacity = capacity;
+        segment->header->created_us = now_us();
+    }
+    while (segment->used < segment->capacity &&
+           segment->records[segment->used].load_state() != ShareState::Empty) {
+        segment->used++;
+    }
+    return segment;
+#endif
+}
+
+bool ShareJournal::open() {
+#ifdef _WIN32
+    LOG_WARN(LogCategory::Stratum, "[Journal] Dziennik udziałów jest dostępny tylko na systemach POSIX.");
+    return false;
+#else
+    // Przełączenie segmentu przerwane awarią: dokończ je (.next ma już nowe rekordy)
+    std::string next_path = m_path + ".next";
+    if (auto next = open_segment(next_path, false)) {
+        bool has_records = next->used > 0;
+        next.reset();
+        if (has_records) {
+            std::rename(m_path.c_str(), (m_path + ".1").c_str());
+            std::rename(next_path.c_str(), m_path.c_str());
+        } else {
+            std::remove(next_path.c_str());
+        }
+    }
+
+    m_segment = open_segment(m_path, true);
+    if (!m_segment) {
+        LOG_ERROR(LogCategory::Stratum, "[Journal] Nie udało się otworzyć dziennika udziałów {}.", m_path);
+        return false;
+    }
+
+    m_next_sequence = std::max<uint64_t>(m_next_sequence, m_segment->header->first_sequence);
+    for (uint32_t i = 0; i < m_segment->used; ++i) {
+        Record& record = m_segment->records[i];
+        m_next_sequence = std::max(m_next_sequence, record.sequence + 1);
+        if (record.load_state() == ShareState::Submitted) {
+            m_pending[record.sequence] = {&record, false};
+        }
+    }
+    m_pending_count.store(m_pending.size(), std::memory_order_relaxed);
+    if (!m_pending.empty()) {
+        LOG_INFO(LogCategory::Stratum, "[Journal] {} niepotwierdzonych udziałów z poprzedniego uruchomienia.",
+                 m_pending.size());
+    }
+    m_want_prepare.store(m_segment->used >= m_segment->capacity / 4 * 3, std::memory_order_relaxed);
+    m_enabled.store(true, std::memory_order_relaxed);
+    m_background = std::jthread([this](std::stop_token st) { background_loop(st); });
+    return true;
+#endif
+}
+
+uint64_t ShareJournal::append(const ShareEntry& entry) {
+    if (!m_segment) {
+        return 0;
+    }
+    if (m_segment->used == m_segment->capacity && !rotate()) {
+        if (m_dropped.fetch_add(1, std::memory_order_relaxed) == 0) {
+            LOG_WARN(LogCategory::Stratum, "[Journal] Segment pełny, a następny nie jest gotowy - udział nie zapisany.");
+        }
+        return 0;
+    }
+
+    Record& record = m_segment->records[m_segment->used++];
+    record.sequence = m_next_sequence++;
+    record.attempts = 1;
+    record.found_us = entry.found_us;
+    record.submitted_us = entry.submitted_us ? entry.submitted_us : now_us();
+    record.resolved_us = 0;
+    record.difficulty = entry.difficulty;
+    record.nonce = entry.nonce;
+    copy_hash(record.result, entry.result_hash);
+    copy_hash(record.prev_id, entry.prev_id);
+    copy_text(record.job_id, sizeof(record.job_id), entry.job_id);
+    copy_text(record.pool, sizeof(record.pool), entry.pool);
+    record.store_state(ShareState::Submitted);
+
+    m_pending[record.sequence] = {&record, true};
+    m_pending_count.store(m_pending.size(), std::memory_order_relaxed);
+    m_appended.fetch_add(1, std::memory_order_relaxed);
+    if (m_segment->used >= m_segment->capacity / 4 * 3 && !m_want_prepare.exchange(true)) {
+        m_background_cv.notify_one();
+    }
+    return record.sequence;
+}
+
+void ShareJournal::resolve(uint64_t sequence, ShareState state) {
+    auto it = m_pending.find(sequence);
+    if (it == m_pending.end()) {
+        return;
+    }
+    it->second.record->resolved_us = now_us();
+    it->second.record->store_state(state);
+    m_pending.erase(it);
+    m_pending_count.store(m_pending.size(), std::memory_order_relaxed);
+    if (state == ShareState::Stale) {
+        m_stale.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ShareJournal::release(uint64_t sequence) {
+    auto it = m_pending.find(sequence);
+    if (it != m_pending.end()) {
+        it->second.claimed = false;
+    }
+}
+
+std::vector<ShareEntry> ShareJournal::claim_unacknowledged(const std::string& pool) {
+    std::vector<ShareEntry> entries;
+    for (auto& [sequence, pending] : m_pending) {
+        if (!pending.claimed && read_text(pending.record->pool, sizeof(pending.record->pool)) == pool) {
+            pending.claimed = true;
+            entries.push_back(pending.record->to_entry());
+        }
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const ShareEntry& a, const ShareEntry& b) { return a.sequence < b.sequence; });
+    return entries;
+}
+
+ShareJournalStats ShareJournal::stats() const {
+    ShareJournalStats stats;
+    stats.enabled = m_enabled.load(std::memory_order_relaxed);
+    stats.appended = m_appended.load(std::memory_order_relaxed);
+    stats.stale = m_stale.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.pending = m_pending_count.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool ShareJournal::rotate() {
+    // Wątek io_context nie czeka na wątek tła: zajęty = brak miejsca tym razem
+    std::unique_lock<std::mutex> lock(m_background_mutex, std::try_to_lock);
+    if (!lock.owns_lock() || !m_prepared) {
+        m_want_prepare.store(true, std::memory_order_relaxed);
+        m_background_cv.notify_one();
+        return false;
+    }
+
+    std::unique_ptr<Segment> next = std::move(m_prepared);
+    next->header->first_sequence = m_next_sequence;
+
+    // Niepotwierdzone przechodzą do nowego segmentu (najnowsze, najwyżej połowa miejsca);
+    // starsze, na które pula i tak już nie odpowie, zostają w archiwum jako Stale
+    std::vector<uint64_t> sequences;
+    sequences.reserve(m_pending.size());
+    for (const auto& [sequence, pending] : m_pending) {
+        sequences.push_back(sequence);
+    }
+    std::sort(sequences.begin(), sequences.end());
+    std::size_t keep_from = sequences.size() > next->capacity / 2 ? sequences.size() - next->capacity / 2 : 0;
+    for (std::size_t i = 0; i < sequences.size(); ++i) {
+        if (i < keep_from) {
+            resolve(sequences[i], ShareState::Stale);
+            continue;
+        }
+        Pending& pending = m_pending[sequences[i]];
+        Record& copy = next->records[next->used++];
+        std::memcpy(static_cast<void*>(&copy), pending.record, sizeof(Record));
+        pending.record = &copy;
+    }
+    m_retired.push_back(std::move(m_segment));
+    m_segment = std::move(next);
+    lock.unlock();
+    m_background_cv.notify_one();
+    return true;
+}
+
+void ShareJournal::background_loop(std::stop_token st) {
+    std::string next_path = m_path + ".next";
+    while (!st.stop_requested()) {
+        std::vector<std::unique_ptr<Segment>> retired;
+        const Segment* current = nullptr;
+        bool prepare = false;
+        {
+            std::unique_lock<std::mutex> lock(m_background_mutex);
+            m_background_cv.wait_for(lock, st, SYNC_INTERVAL, [&] {
+                return !m_retired.empty() || (m_want_prepare.load(std::memory_order_relaxed) && !m_prepared);
+            });
+            retired.swap(m_retired);
+            current = m_segment.get(); // Segment niszczy tylko ten wątek (przez m_retired)
+            prepare = m_want_prepare.load(std::memory_order_relaxed) && !m_prepared;
+        }
+
+        current->sync();
+        for (auto& segment : retired) {
+            segment->sync();
+            segment.reset();
+            // Kolejność ważna dla open(): najpierw archiwum, potem nowy segment pod główną nazwą
+            std::rename(m_path.c_str(), (m_path + ".1").c_str());
+            std::rename(next_path.c_str(), m_path.c_str());
+            LOG_INFO(LogCategory::Stratum, "[Journal] Nowy segment dziennika; poprzedni zapisany jako {}.1", m_path);
+        }
+
+        if (prepare && !st.stop_requested()) {
+            std::remove(next_path.c_str());
+            auto segment = open_segment(next_path, true);
+            if (!segment) {
+                LOG_WARN(LogCategory::Stratum, "[Journal] Nie udało się przygotować segmentu {}.", next_path);
+                m_want_prepare.store(false, std::memory_order_relaxed); // Ponowna próba przy kolejnym udziale
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(m_background_mutex);
+            m_prepared = std::move(segment);
+            m_want_prepare.store(false, std::memory_order_relaxed);
+        }
+    }
+}
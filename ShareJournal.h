@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @enum ShareState
+ * @brief Stan udziału w dzienniku (wartości zapisywane w pliku).
+ */
+enum class ShareState : uint32_t {
+    Empty = 0,     // Wolny rekord (koniec danych)
+    Submitted = 1, // Wysłany, bez odpowiedzi puli
+    Accepted = 2,
+    Rejected = 3,
+    Stale = 4,     // Niepotwierdzony, z poprzedniej sesji puli - nie wysłany ponownie
+};
+
+/**
+ * @brief Nazwa stanu ("submitted", "accepted", ...).
+ */
+const char* share_state_name(ShareState state);
+
+/**
+ * @struct ShareEntry
+ * @brief Udział do zapisania lub odczytany z dziennika.
+ */
+struct ShareEntry {
+    uint64_t sequence = 0;      // Nadawany przez dziennik, rosnący
+    ShareState state = ShareState::Empty;
+    std::string pool;           // "host:port"
+    std::string job_id;
+    uint32_t nonce = 0;
+    std::string result_hash;    // 32 bajty hex
+    std::string prev_id;        // Hash poprzedniego bloku z bloba pracy (hex, pusty = nieznany)
+    uint64_t difficulty = 0;
+    int64_t found_us = 0;       // Czasy: mikrosekundy system_clock, 0 = brak
+    int64_t submitted_us = 0;
+    int64_t resolved_us = 0;
+    uint32_t attempts = 0;      // Liczba wysłań
+};
+
+/**
+ * @struct ShareJournalStats
+ * @brief Liczniki dziennika (odczyt z dowolnego wątku).
+ */
+struct ShareJournalStats {
+    bool enabled = false;
+    uint64_t appended = 0;
+    uint64_t stale = 0;
+    uint64_t dropped = 0;   // Brak miejsca (następny segment nie był gotowy)
+    uint64_t pending = 0;   // Bez odpowiedzi puli
+};
+
+/**
+ * @class ShareJournal
+ * @brief Dziennik udziałów w pliku mapowanym w pamięć (append-only).
+ *
+ * Każdy udział zajmuje rekord stałej długości; dopisanie i zmiana stanu to
+ * zwykłe zapisy do pamięci (bez wywołań systemowych), więc ścieżka submit
+ * nigdy nie czeka na dysk. Stan rekordu jest zapisywany na końcu (release),
+ * dlatego po awarii procesu dane w page cache są spójne. Wątek tła robi msync
+ * i przygotowuje następny segment, gdy bieżący zapełni się w 3/4; przy
+ * przełączeniu niepotwierdzone rekordy są kopiowane do nowego segmentu,
+ * a stary zostaje jako <plik>.1.
+ *
+ * Metody poza stats() wywołuje tylko wątek io_context.
+ */
+class ShareJournal {
+public:
+    /**
+     * @param path Plik dziennika.
+     * @param capacity Rekordów na segment.
+     */
+    explicit ShareJournal(std::string path, uint32_t capacity = 65536);
+    ~ShareJournal();
+
+    ShareJournal(const ShareJournal&) = delete;
+    ShareJournal& operator=(const ShareJournal&) = delete;
+
+    /**
+     * @brief Otwiera (lub tworzy) plik i odtwarza niepotwierdzone udziały.
+     * @return false, jeśli dziennik jest niedostępny (brak mmap, błąd pliku).
+     */
+    bool open();
+
+    /**
+     * @brief Dopisuje wysłany udział (stan Submitted, przypisany do wywołującego).
+     * @return Numer sekwencyjny lub 0, jeśli zabrakło miejsca.
+     */
+    uint64_t append(const ShareEntry& entry);
+
+    /**
+     * @brief Zapisuje ostateczny stan udziału (Accepted, Rejected, Stale).
+     */
+    void resolve(uint64_t sequence, ShareState state);
+
+    /**
+     * @brief Oddaje niepotwierdzony udział (np. zerwane połączenie) - może go
+     * przejąć kolejne połączenie przez claim_unacknowledged().
+     */
+    void release(uint64_t sequence);
+
+    /**
+     * @brief Przejmuje nieprzypisane, niepotwierdzone udziały danej puli
+     * (z poprzednich połączeń lub poprzedniego uruchomienia).
+     */
+    std::vector<ShareEntry> claim_unacknowledged(const std::string& pool);
+
+    ShareJournalStats stats() const;
+    const std::string& path() const { return m_path; }
+
+private:
+    struct Record;
+    struct Segment;
+    struct Pending {
+        Record* record = nullptr;
+        bool claimed = false;
+    };
+
+    std::unique_ptr<Segment> open_segment(const std::string& path, bool create);
+    bool rotate();
+    void background_loop(std::stop_token st);
+
+    std::string m_path;
+    uint32_t m_capacity;
+
+    std::unique_ptr<Segment> m_segment;             // Bieżący (wątek io_context)
+    uint64_t m_next_sequence = 1;
+    std::unordered_map<uint64_t, Pending> m_pending; // Sekwencja -> rekord Submitted
+
+    std::mutex m_background_mutex;                   // Wątek io_context używa tylko try_lock
+    std::condition_variable_any m_background_cv;
+    std::unique_ptr<Segment> m_prepared;             // Następny segment (<plik>.next)
+    std::vector<std::unique_ptr<Segment>> m_retired; // Do msync, zamknięcia i zmiany nazwy
+    std::atomic<bool> m_want_prepare{false};
+
+    std::atomic<uint64_t> m_appended{0};
+    std::atomic<uint64_t> m_stale{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_pending_count{0};
+    std::atomic<bool> m_enabled{false};
+
+    std::jthread m_background; // Ostatni: zatrzymywany przed zniszczeniem reszty
+};
@@ -0,0 +1,150 @@
+#include "StartupTimeline.h"
+#include <algorithm>
+#include <fmt/core.h>
+
+using json = nlohmann::json;
+
+namespace {
+
+std::string seed_suffix(const std::string& seed_hash) {
+    return seed_hash.substr(seed_hash.length() - std::min<std::size_t>(6, seed_hash.length()));
+}
+
+} // namespace
+
+StartupTimeline::StartupTimeline(Clock::time_point start) : m_start(start) {}
+
+void StartupTimeline::speculate(const std::string& seed_hash) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_speculated) {
+        m_speculated = Clock::now();
+        m_speculative_seed = seed_hash;
+    }
+}
+
+void StartupTimeline::cancel_speculation() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_speculated.reset();
+    m_speculative_seed.clear();
+}
+
+void StartupTimeline::pool_connected() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_connected) {
+        m_connected = Clock::now();
+    }
+}
+
+bool StartupTimeline::first_job(const std::string& seed_hash) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_first_job) {
+        return false;
+    }
+    m_first_job = Clock::now();
+    m_job_seed = seed_hash;
+    return true;
+}
+
+void StartupTimeline::seed_built(const std::string& seed_hash) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto known = std::find_if(m_built.begin(), m_built.end(),
+                              [&](const Built& built) { return built.seed_hash == seed_hash; });
+    if (known == m_built.end()) {
+        m_built.push_back({seed_hash, Clock::now()});
+    }
+}
+
+void StartupTimeline::first_hash() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_first_hash) {
+        m_first_hash = Clock::now();
+    }
+}
+
+bool StartupTimeline::finished() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_first_hash.has_value();
+}
+
+std::optional<StartupTimeline::Clock::time_point> StartupTimeline::dataset_ready() const {
+    if (!m_first_job) {
+        return std::nullopt;
+    }
+    for (const auto& built : m_built) {
+        if (built.seed_hash == m_job_seed) {
+            return built.at;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<bool> StartupTimeline::speculation_hit() const {
+    if (!m_speculated || !m_first_job) {
+        return std::nullopt;
+    }
+    return m_speculative_seed == m_job_seed;
+}
+
+std::string StartupTimeline::report() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto offset = [this](Clock::time_point at) { return std::chrono::duration<double>(at - m_start).count(); };
+
+    std::vector<std::pair<Clock::time_point, std::string>> steps;
+    if (m_speculated) {
+        steps.emplace_back(*m_speculated, fmt::format("spekulacyjna budowa dla zapisanego seeda ...{}",
+                                                      seed_suffix(m_speculative_seed)));
+    }
+    if (m_connected) {
+        steps.emplace_back(*m_connected, "połączono z pulą");
+    }
+    if (m_first_job) {
+        std::string label = fmt::format("pierwsza praca (seed ...{})", seed_suffix(m_job_seed));
+        if (auto hit = speculation_hit()) {
+            label += *hit ? " - spekulacja trafiona" : " - spekulacja odrzucona";
+        }
+        steps.emplace_back(*m_first_job, std::move(label));
+    }
+    if (auto ready = dataset_ready()) {
+        steps.emplace_back(*ready, "cache i dataset gotowe");
+    }
+    if (m_first_hash) {
+        steps.emplace_back(*m_first_hash, "pierwszy hash");
+    }
+    std::stable_sort(steps.begin(), steps.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::string out = "\n--- START ---\n";
+    out += fmt::format(" {:>8.3f} s  uruchomienie\n", 0.0);
+    for (const auto& [at, label] : steps) {
+        out += fmt::format(" {:>8.3f} s  {}\n", offset(at), label);
+    }
+    if (m_first_hash) {
+        out += fmt::format(" Czas do pierwszego hasha: {:.2f} s", offset(*m_first_hash));
+        auto ready = dataset_ready();
+        if (speculation_hit().value_or(false) && ready) {
+            // Bez spekulacji budowa zaczęłaby się dopiero po pierwszej pracy
+            double saved = std::chrono::duration<double>(std::min(*m_first_job, *ready) - *m_speculated).count();
+            out += fmt::format(" (spekulacja skróciła go o ok. {:.2f} s)", std::max(saved, 0.0));
+        }
+        out += "\n";
+    }
+    out += "---------------";
+    return out;
+}
+
+json StartupTimeline::to_json() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto offset = [this](const std::optional<Clock::time_point>& at) -> json {
+        return at ? json(std::chrono::duration<double>(*at - m_start).count()) : json(nullptr);
+    };
+    json j = {{"speculated_seconds", offset(m_speculated)},
+              {"pool_connected_seconds", offset(m_connected)},
+              {"first_job_seconds", offset(m_first_job)},
+              {"dataset_ready_seconds", offset(dataset_ready())},
+              {"first_hash_seconds", offset(m_first_hash)}};
+    if (auto hit = speculation_hit()) {
+        j["speculation"] = *hit ? "hit" : "miss";
+    } else {
+        j["speculation"] = m_speculated ? "pending" : "none";
+    }
+    return j;
+}
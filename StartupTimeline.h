@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+/**
+ * @class StartupTimeline
+ * @brief Oś czasu startu minera: od uruchomienia do pierwszego hasha.
+ *
+ * Każdy etap jest zapisywany tylko za pierwszym razem (ponowne połączenia
+ * i kolejne seedy nie przesuwają osi). Gotowość datasetu liczy się dla
+ * seeda pierwszej pracy - przy trafionej spekulacji może poprzedzać login.
+ * Metody są bezpieczne wątkowo (wątek io_context, wątek budujący managera
+ * i pętla raportu).
+ */
+class StartupTimeline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit StartupTimeline(Clock::time_point start = Clock::now());
+
+    /**
+     * @brief Początek spekulacyjnej budowy dla zapisanego seeda.
+     */
+    void speculate(const std::string& seed_hash);
+
+    /**
+     * @brief Wycofuje speculate(), gdy budowy nie udało się zlecić.
+     */
+    void cancel_speculation();
+
+    void pool_connected();
+
+    /**
+     * @brief Pierwsza praca z puli - potwierdza albo odrzuca spekulację.
+     * @return true, jeśli to była pierwsza praca (zapisana w osi).
+     */
+    bool first_job(const std::string& seed_hash);
+
+    /**
+     * @brief Zakończona budowa cache'a/datasetu dla seeda.
+     */
+    void seed_built(const std::string& seed_hash);
+
+    void first_hash();
+
+    /**
+     * @brief Czy zapisano już pierwszy hash (oś jest kompletna).
+     */
+    bool finished() const;
+
+    /**
+     * @brief Raport tekstowy (etapy w kolejności czasu, wynik spekulacji).
+     */
+    std::string report() const;
+
+    nlohmann::json to_json() const;
+
+private:
+    struct Built {
+        std::string seed_hash;
+        Clock::time_point at;
+    };
+
+    std::optional<Clock::time_point> dataset_ready() const; // wymaga m_mutex
+    std::optional<bool> speculation_hit() const;           // wymaga m_mutex
+
+    const Clock::time_point m_start;
+    mutable std::mutex m_mutex;
+    std::string m_speculative_seed;
+    std::optional<Clock::time_point> m_speculated;
+    std::optional<Clock::time_point> m_connected;
+    std::string m_job_seed;
+    std::optional<Clock::time_point> m_first_job;
+    std::vector<Built> m_built;
+    std::optional<Clock::time_point> m_first_hash;
+};
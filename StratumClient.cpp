@@ -1,7 +1,13 @@
 #include "StratumClient.h"
-#include <iostream>
 #include <fmt/core.h>
+#include <fmt/ranges.h>
+#include "Logger.h"
 #include "MiningCommon.h"
+#include "RandomXAlgorithm.h"
+#include "SystemUtils.h"
+#include "Trace.h"
+#include <algorithm>
+#include <optional>
 
 /**
  * @brief Konstruktor klienta Stratum.
@@ -11,7 +17,7 @@ StratumClient::StratumClient(asio::io_context& io_context,
                              const std::string& port,
                              const std::string& user,
                              JobCallback job_cb,
-                             AcceptedShareCallback share_cb)
+                             ShareResultCallback share_cb)
         : m_io_context(io_context),
           m_socket(io_context),
           m_resolver(io_context),
@@ -19,14 +25,24 @@ StratumClient::StratumClient(asio::io_context& io_context,
           m_port(port),
           m_user(user),
           m_pass("x"),
+          m_algorithms(randomx_algorithm_names()),
           m_job_callback(std::move(job_cb)),
-          m_accepted_share_callback(std::move(share_cb)),
+          m_share_result_callback(std::move(share_cb)),
           m_request_id(1) {}
 
 void StratumClient::connect() {
     do_resolve();
 }
 
+void StratumClient::close() {
+    m_closed = true;
+    release_in_flight();
+    m_resolver.cancel();
+    asio::error_code ignored;
+    m_socket.shutdown(tcp::socket::shutdown_both, ignored);
+    m_socket.close(ignored);
+}
+
 void StratumClient::do_resolve() {
     auto self = shared_from_this();
     m_resolver.async_resolve(m_host, m_port,
@@ -36,11 +52,12 @@ void StratumClient::do_resolve() {
 }
 
 void StratumClient::on_resolve(const asio::error_code& ec, tcp::resolver::results_type endpoints) {
+    if (m_closed) {
+        return;
+    }
     if (ec) {
-        {
-            std::lock_guard<std::mutex> lock(g_cout_mutex);
-            std::cerr << fmt::format("Błąd rozwiązywania adresu: {}\n", ec.message());
-        }
+        LOG_ERROR(LogCategory::Stratum, "Błąd rozwiązywania adresu: {}", ec.message());
+        notify_disconnect();
         return;
     }
     auto self = shared_from_this();
@@ -51,17 +68,18 @@ void StratumClient::on_resolve(const asio::error_code& ec, tcp::resolver::result
 }
 
 void StratumClient::on_connect(const asio::error_code& ec) {
+    if (m_closed) {
+        return;
+    }
     if (ec) {
-        {
-            std::lock_guard<std::mutex> lock(g_cout_mutex);
-            std::cerr << fmt::format("Błąd połączenia: {}\n", ec.message());
-        }
+        LOG_ERROR(LogCategory::Stratum, "Błąd połączenia: {}", ec.message());
+        notify_disconnect();
         return;
     }
 
-    {
-        std::lock_guard<std::mutex> lock(g_cout_mutex);
-        std::cout << fmt::format("[Stratum] Połączono z {}:{}\n", m_host, m_port);
+    LOG_INFO(LogCategory::Stratum, "[Stratum] Połączono z {}:{}", m_host, m_port);
+    if (m_connect_callback) {
+        m_connect_callback();
     }
 
     do_login();
@@ -69,19 +87,154 @@ void StratumClient::on_connect(const asio::error_code& ec) {
 }
 
 void StratumClient::do_login() {
+    int req_id = m_request_id++;
+    {
+        std::lock_guard<std::mutex> lock(m_state_mutex);
+        m_login_request_id = req_id;
+        m_login_sent_time = std::chrono::steady_clock::now();
+    }
+
     json login_req = {
-            {"id", m_request_id++},
+            {"id", req_id},
             {"method", "login"},
             {"params", {
                            {"login", m_user},
                            {"pass", m_pass},
-                           {"agent", "pjurominer/0.1"}
+                           {"agent", "pjurominer/0.1"},
+                           {"algo", m_algorithms}
                    }}
     };
     do_write(login_req);
 }
 
+void StratumClient::set_algorithms(std::vector<std::string> algorithms) {
+    if (!algorithms.empty()) {
+        m_algorithms = std::move(algorithms);
+    }
+}
+
+void StratumClient::set_journal(std::shared_ptr<ShareJournal> journal) {
+    m_journal = std::move(journal);
+}
+
+void StratumClient::set_disconnect_callback(DisconnectCallback callback) {
+    m_disconnect_callback = std::move(callback);
+}
+
+void StratumClient::set_connect_callback(ConnectCallback callback) {
+    m_connect_callback = std::move(callback);
+}
+
+void StratumClient::notify_disconnect() {
+    if (m_closed || m_disconnected) {
+        return;
+    }
+    m_disconnected = true;
+    release_in_flight();
+    if (m_disconnect_callback) {
+        m_disconnect_callback();
+    }
+}
+
+void StratumClient::release_in_flight() {
+    std::lock_guard<std::mutex> lock(m_state_mutex);
+    if (m_journal) {
+        for (const auto& [id, share] : m_submitted_share_ids) {
+            if (share.journal_sequence) {
+                m_journal->release(share.journal_sequence);
+            }
+        }
+        for (const ShareEntry& orphan : m_orphans) {
+            m_journal->release(orphan.sequence);
+        }
+    }
+    m_submitted_share_ids.clear();
+    m_orphans.clear();
+}
+
+void StratumClient::track_job(const MiningJob& job) {
+    std::string prev_id = blob_prev_id(job.blob);
+    m_recent_jobs.push_back({job.job_id, prev_id, target_to_difficulty(job.target)});
+    if (m_recent_jobs.size() > 16) {
+        m_recent_jobs.pop_front();
+    }
+    if (!m_journal || m_orphans.empty()) {
+        return;
+    }
+
+    // Przejęte udziały pochodzą z poprzednich połączeń lub uruchomień: job_id znaczy coś
+    // tylko w sesji, która go wydała, a każde logowanie dostaje nowe ID - pula odrzuciłaby
+    // je jako nieznaną pracę. Zamykamy je bez wysyłania.
+    for (const ShareEntry& orphan : m_orphans) {
+        m_journal->resolve(orphan.sequence, ShareState::Stale);
+        if (m_share_result_callback) {
+            m_share_result_callback({orphan.pool, orphan.job_id, orphan.difficulty, ShareOutcome::Stale,
+                                     RejectReason::Stale, "z poprzedniej sesji puli - nie wysłany"});
+        }
+    }
+    LOG_INFO(LogCategory::Stratum, "[Journal] Niepotwierdzone udziały z poprzednich sesji puli: {} (nieaktualne, nie wysłane).",
+             m_orphans.size());
+    m_orphans.clear();
+}
+
+bool StratumClient::resolve_job_algo(const json& params, MiningJob& job) {
+    // "algo" (rozszerzenie xmrig/xmrig-proxy); starsze pule podają "variant"
+    std::string name;
+    if (params.contains("algo") && params["algo"].is_string()) {
+        name = params["algo"];
+    } else if (params.contains("variant") && params["variant"].is_string()) {
+        name = params["variant"];
+    }
+    if (name.empty()) {
+        job.algo = m_algorithms.front();
+        return true;
+    }
+
+    const RandomXAlgorithm* algorithm = find_randomx_algorithm(name);
+    if (!algorithm || std::find(m_algorithms.begin(), m_algorithms.end(), algorithm->name) == m_algorithms.end()) {
+        LOG_ERROR(LogCategory::Stratum, "[Stratum] Praca {} dla nieobsługiwanego algorytmu '{}' - pomijam (obsługiwane: {})",
+                  job.job_id, name, fmt::join(m_algorithms, ", "));
+        return false;
+    }
+    job.algo = algorithm->name;
+    return true;
+}
+
 void StratumClient::submit(const Solution& solution) {
+    int64_t found_us = now_us();
+    // Gniazdo obsługuje tylko wątek io_context - przekazujemy rozwiązanie do pętli
+    auto self = shared_from_this();
+    asio::post(m_io_context, [this, self, solution, found_us]() {
+        if (!m_closed) {
+            do_submit(solution, found_us);
+        }
+    });
+}
+
+void StratumClient::do_submit(const Solution& solution, int64_t found_us) {
+    auto job = std::find_if(m_recent_jobs.rbegin(), m_recent_jobs.rend(),
+                            [&](const KnownJob& known) { return known.job_id == solution.job_id; });
+    uint64_t difficulty = job != m_recent_jobs.rend() ? job->difficulty : 0;
+
+    uint64_t journal_sequence = 0;
+    if (m_journal) {
+        ShareEntry entry;
+        entry.pool = fmt::format("{}:{}", m_host, m_port);
+        entry.job_id = solution.job_id;
+        entry.nonce = solution.nonce;
+        entry.result_hash = solution.result_hash;
+        entry.found_us = found_us;
+        entry.difficulty = difficulty;
+        if (job != m_recent_jobs.rend()) {
+            entry.prev_id = job->prev_id;
+        }
+        // Zapis do pamięci mapowanej - bez wywołań systemowych
+        journal_sequence = m_journal->append(entry);
+    }
+    send_submit(solution, journal_sequence, difficulty);
+}
+
+void StratumClient::send_submit(const Solution& solution, uint64_t journal_sequence, uint64_t difficulty) {
     int req_id = m_request_id++;
 
     json submit_req = {
@@ -97,27 +250,28 @@ void StratumClient::submit(const Solution& solution) {
 
     {
         std::lock_guard<std::mutex> lock(m_state_mutex);
-        m_submitted_share_ids.insert(req_id);
+        m_submitted_share_ids[req_id] = {std::chrono::steady_clock::now(), journal_sequence, solution.job_id, difficulty};
     }
 
-    {
-        std::lock_guard<std::mutex> lock(g_cout_mutex);
-        std::cout << fmt::format("[Stratum] Wysyłam rozwiązanie dla {}\n", solution.job_id);
-    }
+    LOG_INFO(LogCategory::Stratum, "[Stratum] Wysyłam rozwiązanie dla {}", solution.job_id);
     do_write(submit_req);
 }
 
 void StratumClient::do_write(const json& j) {
     auto self = shared_from_this();
-    std::string request = j.dump() + "\n";
-
-    asio::async_write(m_socket, asio::buffer(request.data(), request.length()),
-                      [this, self](const asio::error_code& ec, std::size_t /*length*/) {
-                          if (ec) {
-                              {
-                                  std::lock_guard<std::mutex> lock(g_cout_mutex);
-                                  std::cerr << fmt::format("Błąd zapisu: {}\n", ec.message());
-                              }
+    auto request = std::make_shared<std::string>(j.dump() + "\n");
+
+    // Zapis 'submit' jest punktem pomiarowym śledzenia (ID zapytania jako argument)
+    bool is_submit = j.contains("method") && j["method"] == "submit";
+    uint64_t request_id = j.contains("id") && j["id"].is_number() ? j["id"].get<uint64_t>() : 0;
+
+    asio::async_write(m_socket, asio::buffer(request->data(), request->length()),
+                      [this, self, request, is_submit, request_id](const asio::error_code& ec, std::size_t /*length*/) {
+                          if (is_submit && !ec) {
+                              TRACE_EVENT(TraceEvent::SubmitWritten, TracePhase::Instant, request_id);
+                          }
+                          if (ec && !m_closed) {
+                              LOG_ERROR(LogCategory::Stratum, "Błąd zapisu: {}", ec.message());
                           }
                       });
 }
@@ -131,16 +285,17 @@ void StratumClient::do_read() {
 }
 
 void StratumClient::on_read(const asio::error_code& ec, std::size_t length) {
+    if (m_closed) {
+        return;
+    }
     if (ec) {
-        {
-            std::lock_guard<std::mutex> lock(g_cout_mutex);
-            if (ec != asio::error::eof) {
-                std::cerr << fmt::format("Błąd odczytu: {}\n", ec.message());
-            } else {
-                std::cout << "[Stratum] Pula zamknęła połączenie.\n";
-            }
+        if (ec != asio::error::eof) {
+            LOG_ERROR(LogCategory::Stratum, "Błąd odczytu: {}", ec.message());
+        } else {
+            LOG_INFO(LogCategory::Stratum, "[Stratum] Pula zamknęła połączenie.");
         }
         m_socket.close();
+        notify_disconnect();
         return;
     }
 
@@ -185,25 +340,55 @@ void StratumClient::handle_message(const std::string& message_str) {
         if (j.contains("id") && j["id"].is_number()) {
             int response_id = j["id"];
             bool is_share_response = false;
+            SubmittedShare share;
+            std::optional<std::chrono::steady_clock::time_point> sent_time;
 
             {
                 std::lock_guard<std::mutex> lock(m_state_mutex);
-                if (m_submitted_share_ids.count(response_id)) {
+                auto it = m_submitted_share_ids.find(response_id);
+                if (it != m_submitted_share_ids.end()) {
                     is_share_response = true;
-                    m_submitted_share_ids.erase(response_id);
+                    sent_time = it->second.sent_time;
+                    share = std::move(it->second);
+                    m_submitted_share_ids.erase(it);
+                } else if (response_id == m_login_request_id) {
+                    sent_time = m_login_sent_time;
                 }
             }
 
+            if (sent_time) {
+                record_rtt(*sent_time);
+            }
+
+            if (is_share_response) {
+                TRACE_EVENT(TraceEvent::ResponseReceived, TracePhase::Instant, static_cast<uint64_t>(response_id),
+                            j.contains("error") && !j["error"].is_null() ? "rejected" : "accepted");
+            }
+
             if (is_share_response) {
+                ShareResult result{fmt::format("{}:{}", m_host, m_port), share.job_id, share.difficulty};
                 if (j.contains("result") && !j["result"].is_null()) {
-                    if (m_accepted_share_callback) {
-                        m_accepted_share_callback();
+                    m_shares_accepted.fetch_add(1, std::memory_order_relaxed);
+                    if (m_journal && share.journal_sequence) {
+                        m_journal->resolve(share.journal_sequence, ShareState::Accepted);
                     }
                 } else if (j.contains("error") && !j["error"].is_null()) {
-                    {
-                        std::lock_guard<std::mutex> lock(g_cout_mutex);
-                        std::cerr << fmt::format("[Stratum] Share odrzucony: {}\n", j["error"].dump());
+                    m_shares_rejected.fetch_add(1, std::memory_order_relaxed);
+                    if (m_journal && share.journal_sequence) {
+                        m_journal->resolve(share.journal_sequence, ShareState::Rejected);
                     }
+                    const json& error = j["error"];
+                    result.message = error.is_object() && error.contains("message") && error["message"].is_string()
+                                     ? error["message"].get<std::string>() : error.dump();
+                    result.reason = classify_reject_reason(result.message);
+                    result.outcome = result.reason == RejectReason::Stale ? ShareOutcome::Stale : ShareOutcome::Rejected;
+                    LOG_WARN(LogCategory::Stratum, "[Stratum] Share odrzucony ({}): {}",
+                             reject_reason_name(result.reason), error.dump());
+                } else {
+                    return;
+                }
+                if (m_share_result_callback) {
+                    m_share_result_callback(result);
                 }
                 return;
             }
@@ -211,14 +396,12 @@ void StratumClient::handle_message(const std::string& message_str) {
 
 
         if (!j["error"].is_null()) {
-            {
-                std::lock_guard<std::mutex> lock(g_cout_mutex);
-                std::cerr << fmt::format("[Stratum] Błąd puli: {}\n", j["error"].dump());
-            }
+            LOG_ERROR(LogCategory::Stratum, "[Stratum] Błąd puli: {}", j["error"].dump());
         }
 
 
         if (!j["method"].is_null() && j["method"] == "job") {
+            TRACE_EVENT(TraceEvent::JobParse, TracePhase::Begin);
             auto params = j["params"];
             MiningJob job = {
                     params["job_id"],
@@ -226,25 +409,36 @@ void StratumClient::handle_message(const std::string& message_str) {
                     params["target"],
                     params["seed_hash"]
             };
-
-            {
-                std::lock_guard<std::mutex> lock(g_cout_mutex);
-                std::cout << fmt::format("[Stratum] Otrzymano nową pracę: {} (Seed: ...{})\n",
-                                         job.job_id,
-                                         job.seed_hash);
+            TRACE_EVENT(TraceEvent::JobParse, TracePhase::End, 0, job.job_id);
+            if (!resolve_job_algo(params, job)) {
+                return;
             }
 
+            LOG_INFO(LogCategory::Stratum, "[Stratum] Otrzymano nową pracę: {} ({}, Seed: ...{})", job.job_id, job.algo, job.seed_hash);
+
+            record_job_received();
             m_job_callback(job);
+            track_job(job);
 
         } else if (!j["result"].is_null() && !j["result"]["id"].is_null()) {
 
             m_login_id = j["result"]["id"];
-            {
-                std::lock_guard<std::mutex> lock(g_cout_mutex);
-                std::cout << fmt::format("[Stratum] Zalogowano. ID subskrypcji: {}\n", m_login_id);
+            LOG_INFO(LogCategory::Stratum, "[Stratum] Zalogowano. ID subskrypcji: {}", m_login_id);
+            if (m_journal) {
+                m_orphans = m_journal->claim_unacknowledged(fmt::format("{}:{}", m_host, m_port));
+            }
+
+            // Rozszerzenie "algo": pula zna naszą listę wariantów i podaje algo w każdej pracy
+            auto extensions = j["result"].value("extensions", json::array());
+            bool algo_extension = extensions.is_array() &&
+                                  std::find(extensions.begin(), extensions.end(), "algo") != extensions.end();
+            if (!algo_extension) {
+                LOG_INFO(LogCategory::Stratum, "[Stratum] Pula nie obsługuje negocjacji algo - prace bez pola algo to {}",
+                         m_algorithms.front());
             }
 
             if (!j["result"]["job"].is_null()) {
+                TRACE_EVENT(TraceEvent::JobParse, TracePhase::Begin);
                 auto job_params = j["result"]["job"];
                 MiningJob job = {
                         job_params["job_id"],
@@ -252,15 +446,16 @@ void StratumClient::handle_message(const std::string& message_str) {
                         job_params["target"],
                         job_params["seed_hash"]
                 };
-
-                {
-                    std::lock_guard<std::mutex> lock(g_cout_mutex);
-                    std::cout << fmt::format("[Stratum] Otrzymano pierwszą pracę: {} (Seed: ...{})\n",
-                                             job.job_id,
-                                             job.seed_hash.substr(job.seed_hash.length() - 6));
+                TRACE_EVENT(TraceEvent::JobParse, TracePhase::End, 0, job.job_id);
+                if (!resolve_job_algo(job_params, job)) {
+                    return;
                 }
 
+                LOG_INFO(LogCategory::Stratum, "[Stratum] Otrzymano pierwszą pracę: {} ({}, Seed: ...{})", job.job_id, job.algo, job.seed_hash.substr(job.seed_hash.length() - 6));
+
+                record_job_received();
                 m_job_callback(job);
+                track_job(job);
             }
 
         } else if (!j["error"].is_null()) {
@@ -268,15 +463,41 @@ void StratumClient::handle_message(const std::string& message_str) {
         }
 
     } catch (json::parse_error& e) {
+        LOG_ERROR(LogCategory::Stratum, "Błąd parsowania JSON: {}\nOtrzymana (uszkodzona?) wiadomość: {}",
+                  e.what(), message_str);
+    }
+}
 
-        // --- ZMIANA: Zbuduj string PRZED blokadą ---
-        std::string error_msg = fmt::format("Błąd parsowania JSON: {}\n", e.what());
-        error_msg += fmt::format("Otrzymana (uszkodzona?) wiadomość: {}\n", message_str);
-        // --- Koniec budowania stringa ---
+uint64_t StratumClient::getAcceptedShares() const {
+    return m_shares_accepted.load(std::memory_order_relaxed);
+}
 
-        {
-            std::lock_guard<std::mutex> lock(g_cout_mutex);
-            std::cerr << error_msg; // Wypisz gotowy string
-        }
+uint64_t StratumClient::getRejectedShares() const {
+    return m_shares_rejected.load(std::memory_order_relaxed);
+}
+
+double StratumClient::getPoolRttSeconds() const {
+    int64_t rtt_us = m_last_rtt_us.load(std::memory_order_relaxed);
+    return rtt_us < 0 ? -1.0 : rtt_us / 1e6;
+}
+
+double StratumClient::getJobAgeSeconds() const {
+    int64_t job_ns = m_last_job_time_ns.load(std::memory_order_relaxed);
+    if (job_ns == 0) {
+        return -1.0;
     }
+    int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    return (now_ns - job_ns) / 1e9;
+}
+
+void StratumClient::record_rtt(std::chrono::steady_clock::time_point sent_time) {
+    auto rtt = std::chrono::steady_clock::now() - sent_time;
+    m_last_rtt_us.store(std::chrono::duration_cast<std::chrono::microseconds>(rtt).count(),
+                        std::memory_order_relaxed);
+}
+
+void StratumClient::record_job_received() {
+    m_last_job_time_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
 }
\ No newline at end of file
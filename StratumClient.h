@@ -4,13 +4,18 @@
 #include <memory>       // Dla std::shared_ptr i std::enable_shared_from_this
 #include <functional>   // Dla std::function (callback)
 #include <atomic>       // Dla std::atomic (licznik ID zapytań)
-#include <set>          // <-- DODANO
+#include <map>          // Dla mapy ID wysłanych udziałów -> czas wysłania
 #include <mutex>        // <-- DODANO
+#include <chrono>       // Dla pomiaru RTT i wieku pracy
+#include <deque>
+#include <vector>
 
 #include <asio.hpp>               // Główny plik nagłówkowy Asio
 #include <nlohmann/json.hpp>      // Biblioteka do obsługi JSON
 
 #include "MiningCommon.h" // Potrzebujemy definicji struktur MiningJob i Solution
+#include "ShareJournal.h"
+#include "ShareAccounting.h"
 
 // Używamy aliasów dla czytelności
 using asio::ip::tcp;
@@ -32,13 +37,23 @@ public:
      */
     using JobCallback = std::function<void(const MiningJob&)>;
 
-    // --- NOWA SEKCJA ---
     /**
      * @brief Definicja typu dla funkcji zwrotnej (callback),
-     * wywoływanej po pomyślnym zaakceptowaniu rozwiązania (share).
+     * wywoływanej po odpowiedzi puli na udział (zaakceptowany, odrzucony)
+     * oraz po porzuceniu nieaktualnego udziału z dziennika.
      */
-    using AcceptedShareCallback = std::function<void()>;
-    // --- KONIEC NOWEJ SEKCJI ---
+    using ShareResultCallback = std::function<void(const ShareResult&)>;
+
+    /**
+     * @brief Wywoływana po utracie połączenia (błąd DNS, połączenia lub odczytu),
+     * ale nie po close().
+     */
+    using DisconnectCallback = std::function<void()>;
+
+    /**
+     * @brief Wywoływana po nawiązaniu połączenia TCP, przed wysłaniem loginu.
+     */
+    using ConnectCallback = std::function<void()>;
 
 
     /**
@@ -48,20 +63,47 @@ public:
      * @param port Port serwera puli.
      * @param user Adres portfela (login).
      * @param job_cb Funkcja callback do przekazywania nowych zadań.
-     * @param share_cb Funkcja callback dla zaakceptowanych udziałów.
+     * @param share_cb Funkcja callback dla wyników udziałów.
      */
     StratumClient(asio::io_context& io_context,
                   const std::string& host,
                   const std::string& port,
                   const std::string& user,
                   JobCallback job_cb,
-                  AcceptedShareCallback share_cb); // <-- ZMODYFIKOWANO
+                  ShareResultCallback share_cb);
 
     /**
      * @brief Inicjuje proces łączenia z serwerem.
      */
     void connect();
 
+    /**
+     * @brief Zamyka połączenie (np. przy zmianie puli). Wywoływać w wątku io_context.
+     * Oczekujące operacje kończą się bez komunikatów o błędach.
+     */
+    void close();
+
+    /**
+     * @brief Warianty RandomX zgłaszane puli przy logowaniu ("algo"), w kolejności
+     * preferencji. Pierwszy obowiązuje dla prac bez pola algo. Wywoływać przed connect().
+     */
+    void set_algorithms(std::vector<std::string> algorithms);
+
+    /**
+     * @brief Dziennik udziałów: każdy submit jest zapisywany, a po zalogowaniu
+     * niepotwierdzone udziały tej puli z poprzednich połączeń są zamykane jako
+     * Stale. Nie są wysyłane ponownie - nowe logowanie dostaje nowe ID sesji,
+     * w której ich job_id jest nieznany. Wywoływać przed connect().
+     */
+    void set_journal(std::shared_ptr<ShareJournal> journal);
+
+    void set_disconnect_callback(DisconnectCallback callback);
+    void set_connect_callback(ConnectCallback callback);
+
+    const std::string& host() const { return m_host; }
+    const std::string& port() const { return m_port; }
+    const std::string& user() const { return m_user; }
+
     /**
      * @brief Wysyła znalezione rozwiązanie (Solution) do puli.
      * Ta metoda jest bezpieczna do wywołania z dowolnego wątku.
@@ -69,7 +111,31 @@ public:
      */
     void submit(const Solution& solution);
 
+    /**
+     * @brief Liczba udziałów zaakceptowanych przez pulę.
+     */
+    uint64_t getAcceptedShares() const;
+
+    /**
+     * @brief Liczba udziałów odrzuconych przez pulę.
+     */
+    uint64_t getRejectedShares() const;
+
+    /**
+     * @brief Ostatnio zmierzony czas odpowiedzi puli (login/submit) w sekundach.
+     * @return -1.0, jeśli nie było jeszcze pomiaru.
+     */
+    double getPoolRttSeconds() const;
+
+    /**
+     * @brief Czas, jaki upłynął od otrzymania ostatniej pracy, w sekundach.
+     * @return -1.0, jeśli nie otrzymano jeszcze żadnej pracy.
+     */
+    double getJobAgeSeconds() const;
+
 private:
+    friend struct StratumClientBenchAccess; // pjurominer_bench: handle_message() bez gniazda
+
     // --- Metody obsługi łańcucha połączenia Asio ---
 
     /**
@@ -94,6 +160,34 @@ private:
      */
     void do_login();
 
+    /**
+     * @brief Wysyła 'submit' (w wątku io_context).
+     */
+    void do_submit(const Solution& solution, int64_t found_us);
+
+    /**
+     * @brief Wysyła zapytanie 'submit' i zapamiętuje je do odpowiedzi.
+     * @param journal_sequence Rekord w dzienniku (0 = brak).
+     * @param difficulty Trudność targetu pracy (0 = nieznana).
+     */
+    void send_submit(const Solution& solution, uint64_t journal_sequence, uint64_t difficulty);
+
+    /**
+     * @brief Zapamiętuje pracę (prev_id, trudność) dla dziennika i rozliczenia udziałów; przy pierwszej
+     * pracy po zalogowaniu oznacza przejęte udziały z poprzednich sesji jako Stale (bez wysyłania).
+     */
+    void track_job(const MiningJob& job);
+
+    /**
+     * @brief Oddaje dziennikowi udziały bez odpowiedzi (zerwane połączenie).
+     */
+    void release_in_flight();
+
+    /**
+     * @brief Zgłasza utratę połączenia (jeśli nie było close()).
+     */
+    void notify_disconnect();
+
     // --- Metody obsługi odczytu i zapisu Asio ---
 
     /**
@@ -112,6 +206,12 @@ private:
      */
     void handle_message(const std::string& message_str);
 
+    /**
+     * @brief Ustala job.algo z pól "algo"/"variant" pracy.
+     * @return false, jeśli wariant nie jest obsługiwany (praca jest pomijana).
+     */
+    bool resolve_job_algo(const json& params, MiningJob& job);
+
     /**
      * @brief Wysyła asynchronicznie obiekt JSON do serwera (z dodanym '\n').
      * @param j Obiekt nlohmann::json do wysłania.
@@ -131,15 +231,55 @@ private:
     std::string m_port;
     std::string m_user; // Portfel
     std::string m_pass; // Hasło (zazwyczaj "x")
+    std::vector<std::string> m_algorithms; // Zgłaszane warianty RandomX (pierwszy = domyślny)
 
     // Stan i logika
     JobCallback m_job_callback;     // Callback dla nowych zadań
-    AcceptedShareCallback m_accepted_share_callback; // <-- DODANO
+    ShareResultCallback m_share_result_callback;
+    DisconnectCallback m_disconnect_callback;
+    ConnectCallback m_connect_callback;
     std::atomic<int> m_request_id;  // Licznik dla ID zapytań JSON-RPC
     std::string m_login_id;         // ID sesji/subskrypcji otrzymane z puli
+    bool m_closed = false;          // Ustawiane przez close(); tylko wątek io_context
 
     // --- NOWA SEKCJA ---
-    std::mutex m_state_mutex; // Chroni m_submitted_share_ids
-    std::set<int> m_submitted_share_ids; // Przechowuje ID wysłanych zapytań 'submit'
+    std::mutex m_state_mutex; // Chroni m_submitted_share_ids i m_login_sent_time
+    struct SubmittedShare {
+        std::chrono::steady_clock::time_point sent_time; // Do pomiaru RTT
+        uint64_t journal_sequence = 0;                   // 0 = poza dziennikiem
+        std::string job_id;
+        uint64_t difficulty = 0;                         // Trudność targetu pracy (0 = nieznana)
+    };
+    // ID wysłanych zapytań 'submit' -> udział
+    std::map<int, SubmittedShare> m_submitted_share_ids;
+    int m_login_request_id = 0;
+    std::chrono::steady_clock::time_point m_login_sent_time;
     // --- KONIEC NOWEJ SEKCJI ---
+
+    // Ostatnie prace i dziennik udziałów (tylko wątek io_context)
+    struct KnownJob {
+        std::string job_id;
+        std::string prev_id;
+        uint64_t difficulty = 0;
+    };
+    std::shared_ptr<ShareJournal> m_journal;
+    std::deque<KnownJob> m_recent_jobs;     // Ostatnie prace tej sesji (najnowsza na końcu)
+    std::vector<ShareEntry> m_orphans;      // Przejęte po zalogowaniu, czekają na pierwszą pracę
+    bool m_disconnected = false;            // Utrata połączenia już zgłoszona
+
+    // Statystyki odczytywane przez endpoint metryk (bez blokad)
+    std::atomic<uint64_t> m_shares_accepted{0};
+    std::atomic<uint64_t> m_shares_rejected{0};
+    std::atomic<int64_t> m_last_rtt_us{-1};
+    std::atomic<int64_t> m_last_job_time_ns{0}; // steady_clock, 0 = brak pracy
+
+    /**
+     * @brief Zapisuje RTT zmierzone od momentu wysłania zapytania.
+     */
+    void record_rtt(std::chrono::steady_clock::time_point sent_time);
+
+    /**
+     * @brief Zapisuje moment otrzymania nowej pracy.
+     */
+    void record_job_received();
 };
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "StubHasher.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+std::atomic<uint64_t> StubHasher::s_share_threshold{0};
+
+namespace {
+
+uint64_t splitmix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+constexpr double TWO_POW_64 = 18446744073709551616.0;
+
+} // namespace
+
+bool StubHasher::bind(const RandomXAlgorithm&, randomx_cache*, randomx_dataset*) {
+    return true; // Bez VM - nic do odtwarzania
+}
+
+bool StubHasher::hash_bytes(const void* input, size_t size, void* output) {
+    const auto* bytes = static_cast<const uint8_t*>(input);
+    uint64_t state = size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        state = splitmix64(state ^ word);
+    }
+    if (i < size) {
+        uint64_t word = 0;
+        std::memcpy(&word, bytes + i, size - i);
+        state = splitmix64(state ^ word);
+    }
+
+    uint64_t words[4];
+    for (uint64_t k = 0; k < 4; ++k) {
+        words[k] = splitmix64(state + k);
+    }
+    // Little-endian: ostatnie 8 bajtów to najbardziej znaczące bity porównywane z targetem
+    uint64_t threshold = s_share_threshold.load(std::memory_order_relaxed);
+    if (threshold) {
+        words[3] = words[0] < threshold ? 0 : ~0ULL;
+    }
+    std::memcpy(output, words, sizeof(words));
+    return true;
+}
+
+void StubHasher::set_share_probability(double probability) {
+    probability = std::clamp(probability, 0.0, 1.0);
+    uint64_t threshold = probability >= 1.0 ? ~0ULL : static_cast<uint64_t>(std::ldexp(probability, 64));
+    s_share_threshold.store(threshold, std::memory_order_relaxed);
+}
+
+double StubHasher::share_probability() {
+    return static_cast<double>(s_share_threshold.load(std::memory_order_relaxed)) / TWO_POW_64;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "RandomXAlgorithm.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class StubHasher
+ * @brief Szybki, deterministyczny zamiennik RandomX do testów obciążeniowych.
+ *
+ * Wynik to mieszanie (splitmix64) bajtów wejścia - ten sam blob i nonce dają
+ * ten sam "hash", a jeden wątek liczy miliony hashy na sekundę. Dzięki temu
+ * harmonogram nonce, porównanie z targetem, kolejka udziałów i wysyłanie do
+ * puli pracują pod obciążeniem, którego RandomX (~1 kH/s na wątek) nigdy
+ * nie wytworzy.
+ *
+ * Przy share_probability == 0 wynik jest równomierny, więc udziały pojawiają
+ * się z prawdopodobieństwem 1/trudność targetu puli. Przy p > 0 górne 64 bity
+ * to zero (spełnia każdy target) z prawdopodobieństwem p, a w przeciwnym razie
+ * same jedynki (nie spełnia żadnego) - niezależnie od trudności.
+ * Zasoby managera są ignorowane; --mode light oszczędza budowy datasetu.
+ */
+class StubHasher {
+public:
+    static constexpr const char* BACKEND_NAME = "stub";
+    static constexpr uint32_t HASH_BATCH = 256;
+
+    bool bind(const RandomXAlgorithm& algorithm, randomx_cache* cache, randomx_dataset* dataset);
+    bool has_vm() const { return true; }
+    void release() {}
+
+    bool hash_bytes(const void* input, size_t size, void* output);
+
+    /**
+     * @brief Prawdopodobieństwo udziału na hash (0 = wg targetu puli). Wspólne dla wszystkich wątków.
+     */
+    static void set_share_probability(double probability);
+    static double share_probability();
+
+private:
+    static std::atomic<uint64_t> s_share_threshold; // p * 2^64 (0 = wyłączone)
+};
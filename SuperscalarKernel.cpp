@@ -0,0 +1,207 @@
+/**
+ * @file SuperscalarKernel.cpp
+ * @brief Dekodowanie programów cache'a i wybór kernela dla jednego wariantu RandomX.
+ *
+ * Kompilowany razem z RandomXVariant.cpp (rx/0 w pjurominer, pozostałe
+ * w modułach wariantów): struktura randomx_cache i RANDOMX_CACHE_ACCESSES
+ * pochodzą ze źródeł biblioteki tej kompilacji.
+ */
+#include "SuperscalarKernel.h"
+#include "DatasetKernel.h"
+#include "randomx.h"
+#include "configuration.h"
+#include "dataset.hpp"     // randomx_cache (wewnętrzna struktura biblioteki)
+#include "superscalar.hpp" // SuperscalarInstructionType
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using superscalar::Op;
+
+// Elementy wykonujące razem jedną instrukcję programu w wersji skalarnej
+constexpr unsigned SCALAR_GROUP = 8;
+
+static_assert(RANDOMX_CACHE_ACCESSES <= superscalar::MAX_PROGRAMS, "Za dużo programów SuperscalarHash");
+static_assert(RANDOMX_DATASET_ITEM_SIZE == superscalar::ITEM_SIZE, "Kernel zakłada elementy 64-bajtowe");
+
+uint64_t sign_extend(uint32_t imm) {
+    return static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(imm)));
+}
+
+/**
+ * @struct Scalar
+ * @brief Jeden element na "wektor": reszta zakresu po wersji wektorowej i CPU bez AVX2.
+ */
+struct Scalar {
+    using Reg = uint64_t;
+    static constexpr unsigned LANES = 1;
+
+    static Reg set(uint64_t value) { return value; }
+    static Reg items(uint64_t first) { return first; }
+    static Reg add(Reg a, Reg b) { return a + b; }
+    static Reg sub(Reg a, Reg b) { return a - b; }
+    static Reg bxor(Reg a, Reg b) { return a ^ b; }
+    static Reg shl(Reg a, unsigned shift) { return a << shift; }
+    static Reg ror(Reg a, unsigned bits) { return (a >> bits) | (a << ((64 - bits) & 63)); }
+    static Reg mul(Reg a, Reg b) { return a * b; }
+    static Reg mulhi(Reg a, Reg b) {
+#if defined(__SIZEOF_INT128__)
+        return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+        uint64_t a_hi = a >> 32, a_lo = a & 0xFFFFFFFF, b_hi = b >> 32, b_lo = b & 0xFFFFFFFF;
+        uint64_t lh = a_lo * b_hi, hl = a_hi * b_lo;
+        uint64_t mid = ((a_lo * b_lo) >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+        return a_hi * b_hi + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+    }
+    static Reg smulhi(Reg a, Reg b) {
+        return mulhi(a, b) - (static_cast<int64_t>(a) < 0 ? b : 0) - (static_cast<int64_t>(b) < 0 ? a : 0);
+    }
+
+    static Reg line_offsets(Reg address, uint64_t mask) { return (address & mask) << 6; }
+    static void prefetch(const uint8_t* memory, Reg offset) {
+#if defined(__GNUC__)
+        __builtin_prefetch(memory + offset, 0, 0);
+#else
+        (void)memory;
+        (void)offset;
+#endif
+    }
+    static void xor_line(Reg (&r)[8], const uint8_t* memory, Reg offset) {
+        uint64_t line[8];
+        std::memcpy(line, memory + offset, sizeof(line));
+        for (unsigned q = 0; q < 8; ++q) {
+            r[q] ^= line[q];
+        }
+    }
+    static void store(const Reg (&r)[8], uint8_t* out) { std::memcpy(out, r, sizeof(r)); }
+};
+
+bool cpu_supports(DatasetKernel kernel) {
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    switch (kernel) {
+        case DatasetKernel::Avx2: return __builtin_cpu_supports("avx2");
+        case DatasetKernel::Avx512: return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq");
+        default: return true;
+    }
+#else
+    return kernel != DatasetKernel::Avx2 && kernel != DatasetKernel::Avx512;
+#endif
+}
+
+bool available(DatasetKernel kernel) {
+    switch (kernel) {
+        case DatasetKernel::Scalar: return true;
+        case DatasetKernel::Avx2: return superscalar::avx2_built() && cpu_supports(kernel);
+        case DatasetKernel::Avx512: return superscalar::avx512_built() && cpu_supports(kernel);
+        default: return false;
+    }
+}
+
+/**
+ * @struct DecodedCache
+ * @brief Programy cache'a w postaci superscalar::Instruction (stałe rozszerzone,
+ * odwrotności IMUL_RCP wstawione z reciprocalCache).
+ */
+struct DecodedCache {
+    superscalar::CacheView view;
+    std::vector<superscalar::Instruction> code;
+
+    explicit DecodedCache(randomx_cache* cache) {
+        using Type = randomx::SuperscalarInstructionType;
+        uint32_t offsets[RANDOMX_CACHE_ACCESSES];
+        for (unsigned p = 0; p < RANDOMX_CACHE_ACCESSES; ++p) {
+            randomx::SuperscalarProgram& program = cache->programs[p];
+            offsets[p] = static_cast<uint32_t>(code.size());
+            for (uint32_t j = 0; j < program.getSize(); ++j) {
+                randomx::Instruction& in = program(static_cast<int>(j));
+                superscalar::Instruction decoded{Op::Sub, in.dst, in.src, 0, 0};
+                switch (static_cast<Type>(in.opcode)) {
+                    case Type::ISUB_R: decoded.op = Op::Sub; break;
+                    case Type::IXOR_R: decoded.op = Op::Xor; break;
+                    case Type::IADD_RS:
+                        decoded.op = Op::AddShift;
+                        decoded.shift = static_cast<uint8_t>((in.mod >> 2) % 4);
+                        break;
+                    case Type::IMUL_R: decoded.op = Op::Mul; break;
+                    case Type::IROR_C:
+                        decoded.op = Op::Ror;
+                        decoded.imm = in.getImm32() & 63;
+                        break;
+                    case Type::IADD_C7:
+                    case Type::IADD_C8:
+                    case Type::IADD_C9:
+                        decoded.op = Op::AddConst;
+                        decoded.imm = sign_extend(in.getImm32());
+                        break;
+                    case Type::IXOR_C7:
+                    case Type::IXOR_C8:
+                    case Type::IXOR_C9:
+                        decoded.op = Op::XorConst;
+                        decoded.imm = sign_extend(in.getImm32());
+                        break;
+                    case Type::IMULH_R: decoded.op = Op::MulHigh; break;
+                    case Type::ISMULH_R: decoded.op = Op::SMulHigh; break;
+                    case Type::IMUL_RCP:
+                        // initCache zamienia imm32 na indeks w reciprocalCache
+                        decoded.op = Op::MulConst;
+                        decoded.imm = cache->reciprocalCache[in.getImm32()];
+                        break;
+                    default: break;
+                }
+                code.push_back(decoded);
+            }
+            view.programs[p].size = program.getSize();
+            view.programs[p].address_register = static_cast<uint32_t>(program.getAddressRegister());
+        }
+        for (unsigned p = 0; p < RANDOMX_CACHE_ACCESSES; ++p) {
+            view.programs[p].code = code.data() + offsets[p];
+        }
+        view.program_count = RANDOMX_CACHE_ACCESSES;
+        view.memory = cache->memory;
+        view.line_mask = static_cast<uint64_t>(RANDOMX_ARGON_MEMORY) * 1024 / RANDOMX_DATASET_ITEM_SIZE - 1;
+    }
+};
+
+} // namespace
+
+namespace superscalar {
+
+bool init_dataset(randomx_dataset* dataset, randomx_cache* cache, unsigned long start_item,
+                  unsigned long item_count, DatasetKernel kernel) {
+    if (item_count == 0) {
+        return available(kernel); // Pusty zakres (także bez datasetu) tylko sprawdza obsługę
+    }
+    uint8_t* out = static_cast<uint8_t*>(randomx_get_dataset_memory(dataset)) + static_cast<uint64_t>(start_item) * ITEM_SIZE;
+    return compute_dataset_items(cache, out, start_item, item_count, kernel);
+}
+
+bool compute_dataset_items(randomx_cache* cache, void* memory, unsigned long start_item, unsigned long item_count,
+                           DatasetKernel kernel) {
+    if (!available(kernel)) {
+        return false;
+    }
+    if (item_count == 0) {
+        return true;
+    }
+
+    // Dekodowanie to kilka tysięcy instrukcji - pomijalne wobec fragmentu datasetu
+    DecodedCache decoded(cache);
+    auto* out = static_cast<uint8_t*>(memory);
+    uint64_t done = 0;
+    if (kernel == DatasetKernel::Avx512) {
+        done = compute_items_avx512(decoded.view, out, start_item, item_count);
+    } else if (kernel == DatasetKernel::Avx2) {
+        done = compute_items_avx2(decoded.view, out, start_item, item_count);
+    }
+    uint64_t rest = item_count - done;
+    uint64_t grouped = rest - rest % SCALAR_GROUP;
+    compute_items<Scalar, SCALAR_GROUP>(decoded.view, out + done * ITEM_SIZE, start_item + done, grouped);
+    done += grouped;
+    compute_items<Scalar, 1>(decoded.view, out + done * ITEM_SIZE, start_item + done, item_count - done);
+    return true;
+}
+
+} // namespace superscalar
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @file SuperscalarKernel.h
+ * @brief SuperscalarHash elementów datasetu liczony kilka elementów naraz.
+ *
+ * SuperscalarKernel.cpp (kompilowany w każdym wariancie RandomX, bo czyta
+ * wewnętrzną strukturę randomx_cache) dekoduje programy cache'a do postaci
+ * niezależnej od parametrów wariantu, a pliki SuperscalarKernelAvx2.cpp
+ * i SuperscalarKernelAvx512.cpp - kompilowane z flagami swojego zestawu
+ * instrukcji - liczą na niej elementy. Te pliki nie dołączają nagłówków
+ * biblioteki standardowej z szablonami: ich instancje skompilowane z AVX
+ * mogłyby zostać wybrane przez linker także dla kodu bez AVX.
+ */
+
+enum class DatasetKernel;
+struct randomx_cache;
+struct randomx_dataset;
+
+namespace superscalar {
+
+enum class Op : uint8_t {
+    Sub,      // ISUB_R
+    Xor,      // IXOR_R
+    AddShift, // IADD_RS: dst += src << shift
+    Mul,      // IMUL_R
+    Ror,      // IROR_C: obrót o imm
+    AddConst, // IADD_C7/C8/C9 (imm rozszerzone znakiem)
+    XorConst, // IXOR_C7/C8/C9 (imm rozszerzone znakiem)
+    MulHigh,  // IMULH_R
+    SMulHigh, // ISMULH_R
+    MulConst, // IMUL_RCP (imm = odwrotność z cache'a)
+};
+
+struct Instruction {
+    Op op;
+    uint8_t dst;
+    uint8_t src;
+    uint8_t shift;
+    uint64_t imm;
+};
+
+struct Program {
+    const Instruction* code = nullptr;
+    uint32_t size = 0;
+    uint32_t address_register = 0;
+};
+
+constexpr unsigned MAX_PROGRAMS = 16;   // RANDOMX_CACHE_ACCESSES znanych wariantów to 8
+constexpr unsigned ITEM_SIZE = 64;      // RANDOMX_DATASET_ITEM_SIZE
+
+/**
+ * @struct CacheView
+ * @brief Zdekodowany cache: pamięć Argon2 i programy SuperscalarHash.
+ */
+struct CacheView {
+    const uint8_t* memory = nullptr;
+    uint64_t line_mask = 0;             // Linie cache'a - 1 (ich liczba jest potęgą dwójki)
+    Program programs[MAX_PROGRAMS];
+    unsigned program_count = 0;
+};
+
+// Stałe inicjalizacji rejestrów elementu (dataset.cpp RandomX)
+constexpr uint64_t INIT_MUL0 = 6364136223846793005ULL;
+constexpr uint64_t INIT_ADD[8] = {0,
+                                  9298411001130361340ULL,
+                                  12065312585734608966ULL,
+                                  9306329213124626780ULL,
+                                  5281919268842080866ULL,
+                                  10536153434571861004ULL,
+                                  3398623926847679864ULL,
+                                  9549104520008361294ULL};
+
+/**
+ * @brief Liczy elementy [first, first + count) i zapisuje je pod out. Każdy
+ * element zajmuje jedną linię wektora, a GROUP wektorów wykonuje tę samą
+ * instrukcję programu - koszt dekodowania instrukcji (skok pośredni) dzieli
+ * się na V::LANES * GROUP elementów. count musi być wielokrotnością tego iloczynu.
+ *
+ * V dostarcza typ Reg (V::LANES rejestrów 64-bitowych) i operacje na nim;
+ * kolejność operacji jest ta sama co w randomx::initDatasetItem.
+ */
+template <class V, unsigned GROUP>
+void compute_items(const CacheView& cache, uint8_t* out, uint64_t first, uint64_t count) {
+    using Reg = typename V::Reg;
+    constexpr uint64_t STEP = static_cast<uint64_t>(V::LANES) * GROUP;
+    for (uint64_t item = first; item < first + count; item += STEP) {
+        Reg r[8][GROUP];
+        Reg address[GROUP];
+        Reg line[GROUP];
+        for (unsigned g = 0; g < GROUP; ++g) {
+            address[g] = V::items(item + g * V::LANES);
+            r[0][g] = V::mul(V::add(address[g], V::set(1)), V::set(INIT_MUL0));
+            for (unsigned i = 1; i < 8; ++i) {
+                r[i][g] = V::bxor(r[0][g], V::set(INIT_ADD[i]));
+            }
+        }
+
+        for (unsigned p = 0; p < cache.program_count; ++p) {
+            const Program& program = cache.programs[p];
+            for (unsigned g = 0; g < GROUP; ++g) {
+                line[g] = V::line_offsets(address[g], cache.line_mask);
+                V::prefetch(cache.memory, line[g]);
+            }
+            for (uint32_t j = 0; j < program.size; ++j) {
+                const Instruction& in = program.code[j];
+                Reg (&dst)[GROUP] = r[in.dst];
+                const Reg (&src)[GROUP] = r[in.src];
+                switch (in.op) {
+                    case Op::Sub:
+                        for (unsigned g = 0; g < GROUP; ++g) dst[g] = V::sub(dst[g], src[g]);
+                        break;
+                    case Op::Xor:
+                        for (unsigned g = 0; g < GROUP; ++g) dst[g] = V::bxor(dst[g], src[g]);
+                        break;
+                    case Op::AddShift:
+                        for (unsigned g = 0; g < GROUP; ++g) dst[g] = V::add(dst[g], V::shl(src[g], in.shift));
+                        break;
+                    case Op::Mul:
+                        for (unsigned g = 0; g < GROUP; ++g) dst[g] = V::mul(dst[g], src[g]);
+                        break;
+                    case Op::Ror:
+                        for (unsigned g = 0; g < GROUP; ++g) dst[g] = V::ror(dst[g], static_cast<unsigned>(in.imm));
+                        break;
+                    case Op::AddConst:
+                        for (unsigned g = 0; g < GROUP; ++g) dst[g] = V::add(dst[g], V::set(in.imm));
+                        break;
+                    case Op::XorConst:
+                        for (unsigned g = 0; g < GROUP; ++g) dst[g] = V::bxor(dst[g], V::set(in.imm));
+                        break;
+                    case Op::MulHigh:
+                        for (unsigned g = 0; g < GROUP; ++g) dst[g] = V::mulhi(dst[g], src[g]);
+                        break;
+                    case Op::SMulHigh:
+                        for (unsigned g = 0; g < GROUP; ++g) dst[g] = V::smulhi(dst[g], src[g]);
+                        break;
+                    case Op::MulConst:
+                        for (unsigned g = 0; g < GROUP; ++g) dst[g] = V::mul(dst[g], V::set(in.imm));
+                        break;
+                }
+            }
+            for (unsigned g = 0; g < GROUP; ++g) {
+                Reg block[8];
+                for (unsigned q = 0; q < 8; ++q) {
+                    block[q] = r[q][g];
+                }
+                V::xor_line(block, cache.memory, line[g]);
+                for (unsigned q = 0; q < 8; ++q) {
+                    r[q][g] = block[q];
+                }
+                address[g] = r[program.address_register][g];
+            }
+        }
+        for (unsigned g = 0; g < GROUP; ++g) {
+            Reg block[8];
+            for (unsigned q = 0; q < 8; ++q) {
+                block[q] = r[q][g];
+            }
+            V::store(block, out + (item - first + g * V::LANES) * ITEM_SIZE);
+        }
+    }
+}
+
+/**
+ * @brief Wersje wektorowe: liczą początkową część zakresu (wielokrotność
+ * elementów grupy) i zwracają liczbę policzonych elementów; resztę liczy
+ * wywołujący. 0, gdy plik skompilowano bez AVX2 (AVX-512). Wywołujący
+ * sprawdza obsługę przez CPU.
+ */
+uint64_t compute_items_avx2(const CacheView& cache, uint8_t* out, uint64_t first, uint64_t count);
+uint64_t compute_items_avx512(const CacheView& cache, uint8_t* out, uint64_t first, uint64_t count);
+bool avx2_built();
+bool avx512_built();
+
+/**
+ * @brief Liczy elementy [start_item, start_item + item_count) datasetu
+ * wybranym kernelem (RandomXApi::init_dataset_kernel wariantu).
+ * @return false, jeśli kernel nie jest obsługiwany (CPU lub kompilacja) - nic nie zapisano.
+ */
+bool init_dataset(randomx_dataset* dataset, randomx_cache* cache, unsigned long start_item,
+                  unsigned long item_count, DatasetKernel kernel);
+
+/**
+ * @brief Jak init_dataset, ale zapisuje elementy pod out (item_count * ITEM_SIZE
+ * bajtów) zamiast do datasetu (RandomXApi::compute_dataset_items wariantu).
+ */
+bool compute_dataset_items(randomx_cache* cache, void* out, unsigned long start_item, unsigned long item_count,
+                           DatasetKernel kernel);
+
+} // namespace superscalar
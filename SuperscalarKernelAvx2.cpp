@@ -0,0 +1,124 @@
+/**
+ * @file SuperscalarKernelAvx2.cpp
+ * @brief Elementy datasetu po cztery w wektorze AVX2 (32 na instrukcję programu). Kompilowany z -mavx2.
+ */
+#include "SuperscalarKernel.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+namespace {
+
+struct Avx2 {
+    using Reg = __m256i;
+    static constexpr unsigned LANES = 4;
+
+    static Reg set(uint64_t value) { return _mm256_set1_epi64x(static_cast<long long>(value)); }
+    static Reg items(uint64_t first) {
+        return _mm256_add_epi64(set(first), _mm256_setr_epi64x(0, 1, 2, 3));
+    }
+    static Reg add(Reg a, Reg b) { return _mm256_add_epi64(a, b); }
+    static Reg sub(Reg a, Reg b) { return _mm256_sub_epi64(a, b); }
+    static Reg bxor(Reg a, Reg b) { return _mm256_xor_si256(a, b); }
+    static Reg shl(Reg a, unsigned shift) { return _mm256_sll_epi64(a, _mm_cvtsi32_si128(static_cast<int>(shift))); }
+    static Reg ror(Reg a, unsigned bits) {
+        // Przesunięcie o 64 daje 0, więc bits == 0 zwraca a
+        return _mm256_or_si256(_mm256_srl_epi64(a, _mm_cvtsi32_si128(static_cast<int>(bits))),
+                               _mm256_sll_epi64(a, _mm_cvtsi32_si128(static_cast<int>(64 - bits))));
+    }
+
+    // AVX2 mnoży tylko 32x32->64: iloczyny częściowe połówek
+    static Reg mul(Reg a, Reg b) {
+        Reg low = _mm256_mul_epu32(a, b);
+        Reg cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                                     _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+        return _mm256_add_epi64(low, _mm256_slli_epi64(cross, 32));
+    }
+    static Reg mulhi(Reg a, Reg b) {
+        Reg a_hi = _mm256_srli_epi64(a, 32);
+        Reg b_hi = _mm256_srli_epi64(b, 32);
+        Reg ll = _mm256_mul_epu32(a, b);
+        Reg lh = _mm256_mul_epu32(a, b_hi);
+        Reg hl = _mm256_mul_epu32(a_hi, b);
+        Reg hh = _mm256_mul_epu32(a_hi, b_hi);
+        Reg low32 = _mm256_set1_epi64x(0xFFFFFFFF);
+        Reg mid = _mm256_add_epi64(_mm256_add_epi64(_mm256_srli_epi64(ll, 32), _mm256_and_si256(lh, low32)),
+                                   _mm256_and_si256(hl, low32));
+        return _mm256_add_epi64(_mm256_add_epi64(hh, _mm256_srli_epi64(mid, 32)),
+                                _mm256_add_epi64(_mm256_srli_epi64(lh, 32), _mm256_srli_epi64(hl, 32)));
+    }
+    static Reg smulhi(Reg a, Reg b) {
+        // smulh(a, b) = mulh(a, b) - (a < 0 ? b : 0) - (b < 0 ? a : 0)
+        Reg zero = _mm256_setzero_si256();
+        Reg a_neg = _mm256_cmpgt_epi64(zero, a);
+        Reg b_neg = _mm256_cmpgt_epi64(zero, b);
+        return _mm256_sub_epi64(_mm256_sub_epi64(mulhi(a, b), _mm256_and_si256(a_neg, b)),
+                                _mm256_and_si256(b_neg, a));
+    }
+
+    static Reg line_offsets(Reg address, uint64_t mask) {
+        return _mm256_slli_epi64(_mm256_and_si256(address, set(mask)), 6);
+    }
+    static void prefetch(const uint8_t* memory, Reg offsets) {
+        alignas(32) uint64_t lane[LANES];
+        _mm256_store_si256(reinterpret_cast<Reg*>(lane), offsets);
+        for (unsigned i = 0; i < LANES; ++i) {
+            _mm_prefetch(reinterpret_cast<const char*>(memory + lane[i]), _MM_HINT_NTA);
+        }
+    }
+    static void xor_line(Reg (&r)[8], const uint8_t* memory, Reg offsets) {
+        for (unsigned q = 0; q < 8; ++q) {
+            r[q] = bxor(r[q], _mm256_i64gather_epi64(reinterpret_cast<const long long*>(memory + 8 * q), offsets, 1));
+        }
+    }
+    static void store(const Reg (&r)[8], uint8_t* out) {
+        // Transpozycja 8 rejestrów x 4 elementy -> 4 elementy po 64 bajty
+        for (unsigned q = 0; q < 8; q += 4) {
+            Reg t0 = _mm256_unpacklo_epi64(r[q], r[q + 1]);
+            Reg t1 = _mm256_unpackhi_epi64(r[q], r[q + 1]);
+            Reg t2 = _mm256_unpacklo_epi64(r[q + 2], r[q + 3]);
+            Reg t3 = _mm256_unpackhi_epi64(r[q + 2], r[q + 3]);
+            auto* dst = reinterpret_cast<Reg*>(out + 8 * q);
+            _mm256_storeu_si256(dst, _mm256_permute2x128_si256(t0, t2, 0x20));
+            _mm256_storeu_si256(dst + 2, _mm256_permute2x128_si256(t1, t3, 0x20));
+            _mm256_storeu_si256(dst + 4, _mm256_permute2x128_si256(t0, t2, 0x31));
+            _mm256_storeu_si256(dst + 6, _mm256_permute2x128_si256(t1, t3, 0x31));
+        }
+    }
+};
+
+// Wektory wykonujące razem jedną instrukcję programu (rejestry grupy mieszczą się w L1)
+constexpr unsigned GROUP = 8;
+
+} // namespace
+
+namespace superscalar {
+
+uint64_t compute_items_avx2(const CacheView& cache, uint8_t* out, uint64_t first, uint64_t count) {
+    constexpr uint64_t STEP = Avx2::LANES * GROUP;
+    uint64_t vector_items = count - count % STEP;
+    compute_items<Avx2, GROUP>(cache, out, first, vector_items);
+    return vector_items;
+}
+
+bool avx2_built() {
+    return true;
+}
+
+} // namespace superscalar
+
+#else
+
+namespace superscalar {
+
+uint64_t compute_items_avx2(const CacheView&, uint8_t*, uint64_t, uint64_t) {
+    return 0;
+}
+
+bool avx2_built() {
+    return false;
+}
+
+} // namespace superscalar
+
+#endif
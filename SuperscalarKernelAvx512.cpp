@@ -0,0 +1,108 @@
+/**
+ * @file SuperscalarKernelAvx512.cpp
+ * @brief Elementy datasetu po osiem w wektorze AVX-512F + DQ (64 na instrukcję programu).
+ * Kompilowany z -mavx512f -mavx512dq.
+ */
+#include "SuperscalarKernel.h"
+
+#if defined(__AVX512F__) && defined(__AVX512DQ__)
+#include <immintrin.h>
+
+namespace {
+
+struct Avx512 {
+    using Reg = __m512i;
+    static constexpr unsigned LANES = 8;
+
+    static Reg set(uint64_t value) { return _mm512_set1_epi64(static_cast<long long>(value)); }
+    static Reg items(uint64_t first) {
+        return _mm512_add_epi64(set(first), _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7));
+    }
+    static Reg add(Reg a, Reg b) { return _mm512_add_epi64(a, b); }
+    static Reg sub(Reg a, Reg b) { return _mm512_sub_epi64(a, b); }
+    static Reg bxor(Reg a, Reg b) { return _mm512_xor_si512(a, b); }
+    static Reg shl(Reg a, unsigned shift) { return _mm512_sll_epi64(a, _mm_cvtsi32_si128(static_cast<int>(shift))); }
+    static Reg ror(Reg a, unsigned bits) { return _mm512_rorv_epi64(a, set(bits)); }
+    static Reg mul(Reg a, Reg b) { return _mm512_mullo_epi64(a, b); }
+
+    // Górnej połowy iloczynu 64x64 nie ma w AVX-512F - iloczyny częściowe 32x32
+    static Reg mulhi(Reg a, Reg b) {
+        Reg a_hi = _mm512_srli_epi64(a, 32);
+        Reg b_hi = _mm512_srli_epi64(b, 32);
+        Reg ll = _mm512_mul_epu32(a, b);
+        Reg lh = _mm512_mul_epu32(a, b_hi);
+        Reg hl = _mm512_mul_epu32(a_hi, b);
+        Reg hh = _mm512_mul_epu32(a_hi, b_hi);
+        Reg low32 = set(0xFFFFFFFF);
+        Reg mid = _mm512_add_epi64(_mm512_add_epi64(_mm512_srli_epi64(ll, 32), _mm512_and_si512(lh, low32)),
+                                   _mm512_and_si512(hl, low32));
+        return _mm512_add_epi64(_mm512_add_epi64(hh, _mm512_srli_epi64(mid, 32)),
+                                _mm512_add_epi64(_mm512_srli_epi64(lh, 32), _mm512_srli_epi64(hl, 32)));
+    }
+    static Reg smulhi(Reg a, Reg b) {
+        // smulh(a, b) = mulh(a, b) - (a < 0 ? b : 0) - (b < 0 ? a : 0)
+        Reg a_neg = _mm512_srai_epi64(a, 63);
+        Reg b_neg = _mm512_srai_epi64(b, 63);
+        return _mm512_sub_epi64(_mm512_sub_epi64(mulhi(a, b), _mm512_and_si512(a_neg, b)),
+                                _mm512_and_si512(b_neg, a));
+    }
+
+    static Reg line_offsets(Reg address, uint64_t mask) {
+        return _mm512_slli_epi64(_mm512_and_si512(address, set(mask)), 6);
+    }
+    static void prefetch(const uint8_t* memory, Reg offsets) {
+        alignas(64) uint64_t lane[LANES];
+        _mm512_store_si512(lane, offsets);
+        for (unsigned i = 0; i < LANES; ++i) {
+            _mm_prefetch(reinterpret_cast<const char*>(memory + lane[i]), _MM_HINT_NTA);
+        }
+    }
+    static void xor_line(Reg (&r)[8], const uint8_t* memory, Reg offsets) {
+        for (unsigned q = 0; q < 8; ++q) {
+            r[q] = bxor(r[q], _mm512_i64gather_epi64(offsets, memory + 8 * q, 1));
+        }
+    }
+    static void store(const Reg (&r)[8], uint8_t* out) {
+        // Element i to i-ta linia wszystkich rejestrów: rozproszony zapis co 64 bajty
+        Reg stride = _mm512_setr_epi64(0, 64, 128, 192, 256, 320, 384, 448);
+        for (unsigned q = 0; q < 8; ++q) {
+            _mm512_i64scatter_epi64(out + 8 * q, stride, r[q], 1);
+        }
+    }
+};
+
+// Wektory wykonujące razem jedną instrukcję programu (rejestry grupy mieszczą się w L1)
+constexpr unsigned GROUP = 8;
+
+} // namespace
+
+namespace superscalar {
+
+uint64_t compute_items_avx512(const CacheView& cache, uint8_t* out, uint64_t first, uint64_t count) {
+    constexpr uint64_t STEP = Avx512::LANES * GROUP;
+    uint64_t vector_items = count - count % STEP;
+    compute_items<Avx512, GROUP>(cache, out, first, vector_items);
+    return vector_items;
+}
+
+bool avx512_built() {
+    return true;
+}
+
+} // namespace superscalar
+
+#else
+
+namespace superscalar {
+
+uint64_t compute_items_avx512(const CacheView&, uint8_t*, uint64_t, uint64_t) {
+    return 0;
+}
+
+bool avx512_built() {
+    return false;
+}
+
+} // namespace superscalar
+
+#endif
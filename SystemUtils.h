@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+/**
+ * @file SystemUtils.h
+ * @brief Drobne funkcje systemowe wspólne dla modułów: odczyt plików /proc
+ * i /sys z jedną wartością oraz zegar ścienny w mikrosekundach.
+ */
+
+/**
+ * @brief Pierwsza linia pliku bez końcowych '\n', '\r' i spacji.
+ * @return std::nullopt, gdy pliku nie ma, nie da się go czytać lub jest pusty.
+ */
+std::optional<std::string> read_first_line(const std::string& path);
+
+/**
+ * @brief Cały tekst jako liczba dziesiętna bez znaku (bez spacji i sufiksów).
+ */
+std::optional<uint64_t> parse_u64(const std::string& text);
+
+/**
+ * @brief Pierwsza linia pliku jako liczba (np. limit cgroup, licznik energii RAPL).
+ */
+std::optional<uint64_t> read_u64(const std::string& path);
+
+/**
+ * @brief Mikrosekundy system_clock od epoki (znaczniki czasu logów i dziennika udziałów).
+ */
+int64_t now_us();
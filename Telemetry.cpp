@@ -0,0 +1,250 @@
+#include "Telemetry.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <fmt/core.h>
+
+namespace {
+
+int64_t steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+// --- LatencyHistogram ---
+
+int LatencyHistogram::bucket_index(uint64_t value) {
+    if (value < static_cast<uint64_t>(SUB_BUCKET_COUNT)) {
+        return static_cast<int>(value);
+    }
+    int msb = 63 - std::countl_zero(value);
+    int shift = msb - SUB_BUCKET_BITS;
+    int sub = static_cast<int>((value >> shift) & (SUB_BUCKET_COUNT - 1));
+    int major = shift + 1;
+    int index = major * SUB_BUCKET_COUNT + sub;
+    return std::min(index, BUCKET_COUNT - 1);
+}
+
+uint64_t LatencyHistogram::bucket_upper_bound(int index) {
+    int major = index / SUB_BUCKET_COUNT;
+    uint64_t sub = static_cast<uint64_t>(index % SUB_BUCKET_COUNT);
+    if (major == 0) {
+        return sub;
+    }
+    // Dolna granica kubełka to (8 + sub) << (major - 1); górna to następna minus 1
+    uint64_t lower = (SUB_BUCKET_COUNT + sub) << (major - 1);
+    return lower + (uint64_t{1} << (major - 1)) - 1;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot s;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        s.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+        s.total += s.counts[i];
+    }
+    return s;
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double q) const {
+    if (total == 0) {
+        return 0;
+    }
+    q = std::clamp(q, 0.0, 1.0);
+    auto rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total)));
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return bucket_upper_bound(i);
+        }
+    }
+    return bucket_upper_bound(BUCKET_COUNT - 1);
+}
+
+// --- RateRing ---
+
+RateRing::RateRing(std::size_t capacity)
+        : m_slots(std::make_unique<Slot[]>(capacity)),
+          m_capacity(capacity) {}
+
+void RateRing::push(int64_t time_ns, uint64_t count) {
+    uint64_t index = m_head.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[index % m_capacity];
+
+    // Unieważniamy slot na czas zapisu, by czytelnik nie złożył mieszanej próbki
+    slot.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.time_ns.store(time_ns, std::memory_order_relaxed);
+    slot.count.store(count, std::memory_order_relaxed);
+    slot.seq.store(index + 1, std::memory_order_release);
+
+    m_head.store(index + 1, std::memory_order_release);
+}
+
+bool RateRing::read_slot(uint64_t index, int64_t& time_ns, uint64_t& count) const {
+    const Slot& slot = m_slots[index % m_capacity];
+    if (slot.seq.load(std::memory_order_acquire) != index + 1) {
+        return false;
+    }
+    time_ns = slot.time_ns.load(std::memory_order_relaxed);
+    count = slot.count.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.seq.load(std::memory_order_relaxed) == index + 1;
+}
+
+double RateRing::rate_over(std::chrono::nanoseconds window) const {
+    uint64_t head = m_head.load(std::memory_order_acquire);
+    if (head < 2) {
+        return 0.0;
+    }
+
+    int64_t newest_ns = 0;
+    uint64_t newest_count = 0;
+    if (!read_slot(head - 1, newest_ns, newest_count)) {
+        return 0.0;
+    }
+
+    // Szukamy najstarszej próbki mieszczącej się w oknie (historia jest monotoniczna w czasie)
+    uint64_t oldest_available = head > m_capacity ? head - m_capacity + 1 : 0;
+    int64_t base_ns = newest_ns;
+    uint64_t base_count = newest_count;
+    for (uint64_t index = head - 1; index-- > oldest_available;) {
+        int64_t t = 0;
+        uint64_t c = 0;
+        if (!read_slot(index, t, c)) {
+            break;
+        }
+        base_ns = t;
+        base_count = c;
+        if (newest_ns - t >= window.count()) {
+            break;
+        }
+    }
+
+    if (newest_ns <= base_ns) {
+        return 0.0;
+    }
+    return static_cast<double>(newest_count - base_count) * 1e9 / static_cast<double>(newest_ns - base_ns);
+}
+
+// --- Telemetry ---
+
+std::size_t Telemetry::ring_capacity_for(const TelemetryConfig& config) {
+    // Co najmniej minuta - tyle obejmuje linia [HASHRATE]
+    std::chrono::seconds longest(60);
+    if (!config.windows.empty()) {
+        longest = std::max(longest, *std::max_element(config.windows.begin(), config.windows.end()));
+    }
+    auto interval_ms = std::max<int64_t>(1, config.sample_interval.count());
+    // Zapas kilku slotów, aby najstarsza próbka okna nie była nadpisywana w trakcie odczytu
+    return static_cast<std::size_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(longest).count() / interval_ms) + 8;
+}
+
+Telemetry::Telemetry(TelemetryConfig config)
+        : m_config(std::move(config)),
+          m_ring_capacity(ring_capacity_for(m_config)),
+          m_total_rates(m_ring_capacity) {}
+
+std::shared_ptr<WorkerTelemetry> Telemetry::register_worker(int id) {
+    std::lock_guard<std::mutex> lock(m_registry_mutex);
+    for (auto& w : m_workers) {
+        if (w->id == id) {
+            return w;
+        }
+    }
+    auto w = std::make_shared<WorkerTelemetry>(id, m_ring_capacity);
+    m_workers.push_back(w);
+    return w;
+}
+
+void Telemetry::unregister_worker(int id) {
+    std::lock_guard<std::mutex> lock(m_registry_mutex);
+    auto it = std::find_if(m_workers.begin(), m_workers.end(),
+                           [id](const auto& w) { return w->id == id; });
+    if (it != m_workers.end()) {
+        m_retired_hashes += (*it)->hash_count();
+        m_workers.erase(it);
+    }
+}
+
+void Telemetry::sample() {
+    std::lock_guard<std::mutex> lock(m_registry_mutex);
+    int64_t now_ns = steady_now_ns();
+    double dt = m_last_sample_ns > 0 ? (now_ns - m_last_sample_ns) / 1e9 : 0.0;
+    double tau = static_cast<double>(std::max<int64_t>(1, m_config.ewma_tau.count()));
+    double alpha = dt > 0.0 ? 1.0 - std::exp(-dt / tau) : 0.0;
+
+    uint64_t total = m_retired_hashes;
+    double total_ewma = 0.0;
+    for (auto& w : m_workers) {
+        uint64_t count = w->hash_count();
+        total += count;
+
+        if (dt > 0.0) {
+            double instant = static_cast<double>(count - w->last_sample_count) / dt;
+            double ewma = w->ewma_rate.load(std::memory_order_relaxed);
+            w->ewma_rate.store(ewma + alpha * (instant - ewma), std::memory_order_relaxed);
+        }
+        w->last_sample_count = count;
+        w->rates.push(now_ns, count);
+        total_ewma += w->ewma_rate.load(std::memory_order_relaxed);
+    }
+
+    m_total_rates.push(now_ns, total);
+    m_total_ewma.store(total_ewma, std::memory_order_relaxed);
+    m_last_sample_ns = now_ns;
+}
+
+Telemetry::View Telemetry::view(bool with_latency) const {
+    View v;
+    v.windows = m_config.windows;
+
+    std::lock_guard<std::mutex> lock(m_registry_mutex);
+    v.total_hashes = m_retired_hashes;
+    for (const auto& w : m_workers) {
+        WorkerView wv;
+        wv.id = w->id;
+        wv.hashes = w->hash_count();
+        wv.ewma_rate = w->ewma_rate.load(std::memory_order_relaxed);
+        for (auto window : m_config.windows) {
+            wv.window_rates.push_back(w->rates.rate_over(window));
+        }
+        if (with_latency) {
+            wv.latency = w->hash_latency.snapshot();
+        }
+        v.total_hashes += wv.hashes;
+        v.workers.push_back(std::move(wv));
+    }
+
+    for (auto window : m_config.windows) {
+        v.total_window_rates.push_back(m_total_rates.rate_over(window));
+    }
+    v.total_ewma_rate = m_total_ewma.load(std::memory_order_relaxed);
+    return v;
+}
+
+double Telemetry::total_rate(std::chrono::seconds window) const {
+    return m_total_rates.rate_over(window);
+}
+
+std::vector<double> Telemetry::worker_rates(std::chrono::seconds window) const {
+    std::lock_guard<std::mutex> lock(m_registry_mutex);
+    std::vector<double> rates;
+    rates.reserve(m_workers.size());
+    for (const auto& w : m_workers) {
+        rates.push_back(w->rates.rate_over(window));
+    }
+    return rates;
+}
+
+std::string format_window_label(std::chrono::seconds window) {
+    auto s = window.count();
+    if (s % 3600 == 0) return fmt::format("{}h", s / 3600);
+    if (s % 60 == 0) return fmt::format("{}m", s / 60);
+    return fmt::format("{}s", s);
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Rozmiar linii cache - liczniki różnych wątków nie mogą jej współdzielić
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * @class LatencyHistogram
+ * @brief Histogram w stylu HDR (log-liniowy) dla czasów w nanosekundach.
+ * Każda potęga dwójki dzielona jest na 8 pod-kubełków (~12.5% precyzji).
+ * Jeden wątek zapisujący, dowolna liczba czytelników (operacje relaxed).
+ */
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 3;
+    static constexpr int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAJOR_BUCKET_COUNT = 48; // do ~2^47 ns
+    static constexpr int BUCKET_COUNT = MAJOR_BUCKET_COUNT * SUB_BUCKET_COUNT;
+
+    struct Snapshot {
+        std::array<uint64_t, BUCKET_COUNT> counts{};
+        uint64_t total = 0;
+
+        /**
+         * @brief Zwraca przybliżony percentyl (górna granica kubełka) w ns.
+         * @param q Kwantyl z zakresu [0, 1].
+         */
+        uint64_t percentile(double q) const;
+    };
+
+    /**
+     * @brief Rejestruje pojedynczy pomiar. Wywoływać tylko z wątku-właściciela.
+     */
+    void record(uint64_t value_ns) {
+        auto& bucket = m_counts[bucket_index(value_ns)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    Snapshot snapshot() const;
+
+    static int bucket_index(uint64_t value);
+    static uint64_t bucket_upper_bound(int index);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_counts{};
+};
+
+/**
+ * @class RateRing
+ * @brief Bezblokadowy bufor cykliczny próbek (czas, licznik skumulowany).
+ * Jeden zapisujący (sampler), wielu czytelników. Każdy slot ma numer
+ * sekwencyjny, więc czytelnik wykrywa slot nadpisany w trakcie odczytu.
+ */
+class RateRing {
+public:
+    explicit RateRing(std::size_t capacity);
+
+    /**
+     * @brief Dodaje próbkę. Wywoływać tylko z wątku samplera.
+     */
+    void push(int64_t time_ns, uint64_t count);
+
+    /**
+     * @brief Średnie tempo (jednostek/s) w oknie kończącym się na ostatniej próbce.
+     * Jeśli historia jest krótsza od okna, używa najstarszej dostępnej próbki.
+     */
+    double rate_over(std::chrono::nanoseconds window) const;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> seq{0}; // indeks próbki + 1 (0 = pusty)
+        std::atomic<int64_t> time_ns{0};
+        std::atomic<uint64_t> count{0};
+    };
+
+    bool read_slot(uint64_t index, int64_t& time_ns, uint64_t& count) const;
+
+    std::unique_ptr<Slot[]> m_slots;
+    std::size_t m_capacity;
+    std::atomic<uint64_t> m_head{0}; // liczba zapisanych próbek
+};
+
+/**
+ * @struct TelemetryConfig
+ * @brief Parametry rdzenia telemetrii.
+ */
+struct TelemetryConfig {
+    std::vector<std::chrono::seconds> windows = {std::chrono::seconds(10), std::chrono::minutes(1),
+                                                 std::chrono::minutes(15), std::chrono::hours(1)};
+    std::chrono::milliseconds sample_interval{1000};
+    std::chrono::seconds ewma_tau{30};
+};
+
+/**
+ * @struct WorkerTelemetry
+ * @brief Liczniki jednego wątku roboczego, wyrównane do linii cache.
+ * Pierwsza linia jest zapisywana wyłącznie przez wątek roboczy;
+ * dane samplera leżą w osobnych liniach.
+ */
+struct alignas(CACHE_LINE_SIZE) WorkerTelemetry {
+    explicit WorkerTelemetry(int worker_id, std::size_t ring_capacity)
+            : id(worker_id), rates(ring_capacity) {}
+
+    /**
+     * @brief Publikuje hashe (jeden zapisujący - bez instrukcji RMW).
+     */
+    void add_hashes(uint64_t n) {
+        hashes.store(hashes.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    uint64_t hash_count() const { return hashes.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Obieg pętli bez haszowania (pauza, brak pracy, budowa datasetu) - dla watchdoga.
+     */
+    void mark_idle() {
+        idle_loops.store(idle_loops.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // --- Zapisywane przez wątek roboczy ---
+    std::atomic<uint64_t> hashes{0};
+    std::atomic<uint64_t> idle_loops{0};
+    std::atomic<int64_t> busy_since_ns{0}; // Początek bieżącej paczki hashy (0 = poza haszowaniem)
+    std::atomic<int> cpu{-1};              // CPU ostatniej paczki
+    alignas(CACHE_LINE_SIZE) LatencyHistogram hash_latency;
+
+    // --- Zapisywane przez sampler ---
+    alignas(CACHE_LINE_SIZE) const int id;
+    std::atomic<double> ewma_rate{0.0};
+    uint64_t last_sample_count = 0;
+    RateRing rates;
+};
+
+/**
+ * @class Telemetry
+ * @brief Rdzeń telemetrii: rejestr liczników workerów, okna czasowe i EWMA.
+ * Wątki robocze piszą tylko do swoich WorkerTelemetry; mutex rejestru
+ * biorą wyłącznie sampler, rejestracja i konsumenci statystyk.
+ */
+class Telemetry {
+public:
+    struct WorkerView {
+        int id = 0;
+        uint64_t hashes = 0;
+        double ewma_rate = 0.0;
+        std::vector<double> window_rates; // w kolejności TelemetryConfig::windows
+        LatencyHistogram::Snapshot latency;
+    };
+
+    struct View {
+        std::vector<std::chrono::seconds> windows;
+        std::vector<double> total_window_rates;
+        double total_ewma_rate = 0.0;
+        uint64_t total_hashes = 0;
+        std::vector<WorkerView> workers;
+    };
+
+    explicit Telemetry(TelemetryConfig config = {});
+
+    /**
+     * @brief Rejestruje (lub zwraca istniejące) liczniki workera o danym ID.
+     */
+    std::shared_ptr<WorkerTelemetry> register_worker(int id);
+
+    /**
+     * @brief Usuwa liczniki workera z rejestru (np. po zmniejszeniu liczby wątków).
+     */
+    void unregister_worker(int id);
+
+    /**
+     * @brief Pobiera próbkę wszystkich liczników. Wywoływać co sample_interval.
+     */
+    void sample();
+
+    /**
+     * @brief Zwraca widok statystyk.
+     * @param with_latency Czy kopiować histogramy opóźnień (droższe).
+     */
+    View view(bool with_latency = false) const;
+
+    /**
+     * @brief Tempo łączne w oknie (H/s).
+     */
+    double total_rate(std::chrono::seconds window) const;
+
+    /**
+     * @brief Tempo każdego workera w oknie (H/s), w kolejności rejestracji.
+     */
+    std::vector<double> worker_rates(std::chrono::seconds window) const;
+
+    const TelemetryConfig& config() const { return m_config; }
+
+private:
+    static std::size_t ring_capacity_for(const TelemetryConfig& config);
+
+    TelemetryConfig m_config;
+    std::size_t m_ring_capacity;
+
+    mutable std::mutex m_registry_mutex;
+    std::vector<std::shared_ptr<WorkerTelemetry>> m_workers;
+
+    // Licznik łączny (suma workerów, łącznie z wyrejestrowanymi)
+    uint64_t m_retired_hashes = 0;
+    std::atomic<double> m_total_ewma{0.0};
+    RateRing m_total_rates;
+    int64_t m_last_sample_ns = 0;
+};
+
+/**
+ * @brief Formatuje okno czasowe jako krótką etykietę ("10s", "1m", "1h").
+ */
+std::string format_window_label(std::chrono::seconds window);
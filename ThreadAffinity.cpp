@@ -0,0 +1,132 @@
+#include "ThreadAffinity.h"
+#include <charconv>
+#include <fstream>
+#include <optional>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+bool set_current_thread_affinity(const std::vector<unsigned>& cpus) {
+    DWORD_PTR process_mask = 0;
+    DWORD_PTR system_mask = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) {
+        return false;
+    }
+
+    DWORD_PTR mask = 0;
+    for (unsigned cpu : cpus) {
+        if (cpu < sizeof(DWORD_PTR) * 8) {
+            mask |= DWORD_PTR(1) << cpu;
+        }
+    }
+    if (cpus.empty()) {
+        mask = process_mask;
+    }
+    mask &= process_mask;
+    return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+}
+
+int current_cpu() {
+    return static_cast<int>(GetCurrentProcessorNumber());
+}
+
+#elif defined(__linux__)
+
+bool set_current_thread_affinity(const std::vector<unsigned>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (cpus.empty()) {
+        // Powinowactwo procesu (np. cpuset kontenera), a nie wszystkie CPU hosta
+        if (sched_getaffinity(getpid() /* główny wątek */, sizeof(set), &set) != 0) {
+            return false;
+        }
+    } else {
+        for (unsigned cpu : cpus) {
+            if (cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+            }
+        }
+    }
+    return CPU_COUNT(&set) > 0 && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+int current_cpu() {
+    return sched_getcpu();
+}
+
+#else
+
+bool set_current_thread_affinity(const std::vector<unsigned>&) {
+    return false;
+}
+
+int current_cpu() {
+    return -1;
+}
+
+#endif
+
+std::vector<unsigned> parse_kernel_cpu_list(const std::string& text) {
+    auto parse = [](const std::string& number) -> std::optional<unsigned> {
+        unsigned value = 0;
+        auto [ptr, ec] = std::from_chars(number.data(), number.data() + number.size(), value);
+        if (ec != std::errc() || ptr != number.data() + number.size()) {
+            return std::nullopt;
+        }
+        return value;
+    };
+
+    std::vector<unsigned> cpus;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        auto dash = item.find('-');
+        auto first = parse(item.substr(0, dash));
+        auto last = dash == std::string::npos ? first : parse(item.substr(dash + 1));
+        if (!first || !last || *last < *first || *last >= 65536) {
+            return {}; // Nieczytelny plik - traktujemy jak brak ograniczenia
+        }
+        for (unsigned cpu = *first; cpu <= *last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+unsigned NumaTopology::node_of(int cpu) const {
+    for (std::size_t node = 0; node < nodes.size(); ++node) {
+        for (unsigned c : nodes[node]) {
+            if (static_cast<int>(c) == cpu) {
+                return static_cast<unsigned>(node);
+            }
+        }
+    }
+    return 0;
+}
+
+NumaTopology read_numa_topology(const std::string& root) {
+    NumaTopology topology;
+    for (unsigned node = 0; node < 1024; ++node) {
+        std::ifstream in(root + "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        std::string line;
+        if (!in || !std::getline(in, line)) {
+            break; // Węzły są numerowane od 0 bez przerw (poza egzotycznymi konfiguracjami)
+        }
+        auto cpus = parse_kernel_cpu_list(line);
+        if (!cpus.empty()) { // Węzły bez CPU (sama pamięć) pomijamy
+            topology.nodes.push_back(std::move(cpus));
+        }
+    }
+    if (topology.nodes.empty()) {
+        topology.nodes.emplace_back();
+    }
+    return topology;
+}
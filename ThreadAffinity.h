@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Przypina wywołujący wątek do podanych procesorów logicznych.
+ * @param cpus Numery CPU; pusta lista przywraca domyślne powinowactwo (wszystkie CPU procesu).
+ * @return true, jeśli system zaakceptował maskę.
+ */
+bool set_current_thread_affinity(const std::vector<unsigned>& cpus);
+
+/**
+ * @brief CPU, na którym aktualnie działa wątek (-1, jeśli nieznany).
+ */
+int current_cpu();
+
+/**
+ * @brief Parsuje listę CPU w formacie jądra, np. "0-3,8,10-11".
+ * @return Pusta lista dla nieczytelnego tekstu.
+ */
+std::vector<unsigned> parse_kernel_cpu_list(const std::string& text);
+
+/**
+ * @struct NumaTopology
+ * @brief Węzły NUMA i ich CPU. Jeden węzeł bez listy CPU = topologia nieznana.
+ */
+struct NumaTopology {
+    std::vector<std::vector<unsigned>> nodes;
+
+    /**
+     * @brief Węzeł danego CPU (0, jeśli nie znaleziono).
+     */
+    unsigned node_of(int cpu) const;
+};
+
+/**
+ * @brief Odczytuje <root>/sys/devices/system/node/node*\/cpulist (Linux).
+ */
+NumaTopology read_numa_topology(const std::string& root = "");
@@ -0,0 +1,64 @@
+#include "ThreadPriority.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+bool set_current_thread_priority(const ThreadPriority& priority) {
+    switch (priority.cls) {
+        case ThreadPriority::Class::Normal:
+            return true;
+        case ThreadPriority::Class::Idle:
+            return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_IDLE) != 0;
+        case ThreadPriority::Class::Nice:
+            // Windows nie ma nice - mapujemy łagodne wartości na BELOW_NORMAL, resztę na LOWEST
+            return SetThreadPriority(GetCurrentThread(), priority.nice < 10 ? THREAD_PRIORITY_BELOW_NORMAL
+                                                                             : THREAD_PRIORITY_LOWEST) != 0;
+    }
+    return false;
+}
+
+#elif defined(__linux__)
+
+bool set_current_thread_priority(const ThreadPriority& priority) {
+    switch (priority.cls) {
+        case ThreadPriority::Class::Normal:
+            return true;
+        case ThreadPriority::Class::Idle: {
+            sched_param param{};
+            param.sched_priority = 0;
+            return pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) == 0;
+        }
+        case ThreadPriority::Class::Nice: {
+            // W Linuksie nice dotyczy pojedynczego wątku (TID), nie całego procesu
+            auto tid = static_cast<id_t>(syscall(SYS_gettid));
+            return setpriority(PRIO_PROCESS, tid, priority.nice) == 0;
+        }
+    }
+    return false;
+}
+
+#else
+
+bool set_current_thread_priority(const ThreadPriority& priority) {
+    return priority.cls == ThreadPriority::Class::Normal;
+}
+
+#endif
+
+const char* thread_priority_name(ThreadPriority::Class cls) {
+    switch (cls) {
+        case ThreadPriority::Class::Normal: return "normal";
+        case ThreadPriority::Class::Idle: return "idle";
+        case ThreadPriority::Class::Nice: return "nice";
+    }
+    return "normal";
+}
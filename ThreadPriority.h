@@ -0,0 +1,29 @@
+#pragma once
+
+/**
+ * @struct ThreadPriority
+ * @brief Klasa szedulowania wątku roboczego.
+ */
+struct ThreadPriority {
+    enum class Class {
+        Normal, // Bez zmian
+        Idle,   // SCHED_IDLE (Linux) / THREAD_PRIORITY_IDLE (Windows)
+        Nice,   // Wartość nice dla wątku (Linux) / obniżony priorytet (Windows)
+    };
+
+    Class cls = Class::Normal;
+    int nice = 19; // Dla Class::Nice, zakres 0..19
+
+    bool operator==(const ThreadPriority&) const = default;
+};
+
+/**
+ * @brief Ustawia priorytet wywołującego wątku.
+ * @return true, jeśli system zaakceptował zmianę (dla Normal zawsze true).
+ */
+bool set_current_thread_priority(const ThreadPriority& priority);
+
+/**
+ * @brief Nazwa klasy do logów ("normal", "idle", "nice").
+ */
+const char* thread_priority_name(ThreadPriority::Class cls);
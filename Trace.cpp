@@ -0,0 +1,173 @@
+#include "Trace.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+std::atomic<bool> g_trace_enabled{false};
+
+namespace {
+
+constexpr std::size_t TRACE_BUFFER_EVENTS = 16384; // Na wątek; najstarsze są nadpisywane
+constexpr std::size_t TRACE_DETAIL_SIZE = 32;
+
+struct TraceRecord {
+    std::atomic<uint64_t> seq{0}; // indeks zdarzenia + 1 (0 = slot w trakcie zapisu)
+    int64_t time_ns = 0;
+    uint64_t arg = 0;
+    TraceEvent event = TraceEvent::JobParse;
+    TracePhase phase = TracePhase::Instant;
+    char detail[TRACE_DETAIL_SIZE] = {};
+};
+
+/**
+ * @brief Bufor cykliczny jednego wątku. Zapisuje tylko wątek-właściciel.
+ */
+struct TraceBuffer {
+    explicit TraceBuffer(uint32_t thread_id) : tid(thread_id) {}
+
+    const uint32_t tid;
+    std::string thread_name; // chronione g_registry_mutex
+    std::atomic<uint64_t> head{0};
+    std::array<TraceRecord, TRACE_BUFFER_EVENTS> records;
+};
+
+std::mutex g_registry_mutex;
+std::vector<std::shared_ptr<TraceBuffer>> g_buffers;
+uint32_t g_next_tid = 1;
+
+const auto g_trace_epoch = std::chrono::steady_clock::now();
+
+TraceBuffer& thread_buffer() {
+    thread_local std::shared_ptr<TraceBuffer> buffer = [] {
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        auto b = std::make_shared<TraceBuffer>(g_next_tid++);
+        g_buffers.push_back(b);
+        return b;
+    }();
+    return *buffer;
+}
+
+const char* event_name(TraceEvent event) {
+    switch (event) {
+        case TraceEvent::JobParse: return "job_parse";
+        case TraceEvent::SeedUpdate: return "seed_update";
+        case TraceEvent::VmRecreate: return "vm_recreate";
+        case TraceEvent::FirstHash: return "first_hash";
+        case TraceEvent::SolutionFound: return "solution_found";
+        case TraceEvent::SubmitWritten: return "submit_written";
+        case TraceEvent::ResponseReceived: return "response_received";
+    }
+    return "unknown";
+}
+
+} // namespace
+
+void trace_set_enabled(bool enabled) {
+    g_trace_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void trace_record(TraceEvent event, TracePhase phase, uint64_t arg, const std::string& detail) {
+    TraceBuffer& buffer = thread_buffer();
+    uint64_t index = buffer.head.load(std::memory_order_relaxed);
+    TraceRecord& r = buffer.records[index % TRACE_BUFFER_EVENTS];
+
+    r.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    r.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - g_trace_epoch).count();
+    r.arg = arg;
+    r.event = event;
+    r.phase = phase;
+    std::size_t len = std::min(detail.size(), TRACE_DETAIL_SIZE - 1);
+    std::memcpy(r.detail, detail.data(), len);
+    r.detail[len] = '\0';
+    r.seq.store(index + 1, std::memory_order_release);
+
+    buffer.head.store(index + 1, std::memory_order_release);
+}
+
+void trace_set_thread_name(const std::string& name) {
+    TraceBuffer& buffer = thread_buffer();
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    buffer.thread_name = name;
+}
+
+std::string trace_export_chrome_json() {
+    struct Exported {
+        int64_t time_ns;
+        json event;
+    };
+    std::vector<Exported> exported;
+    json metadata = json::array();
+
+    {
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        for (const auto& buffer : g_buffers) {
+            if (!buffer->thread_name.empty()) {
+                metadata.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", buffer->tid},
+                                    {"args", {{"name", buffer->thread_name}}}});
+            }
+
+            uint64_t head = buffer->head.load(std::memory_order_acquire);
+            uint64_t first = head > TRACE_BUFFER_EVENTS ? head - TRACE_BUFFER_EVENTS : 0;
+            for (uint64_t index = first; index < head; ++index) {
+                const TraceRecord& r = buffer->records[index % TRACE_BUFFER_EVENTS];
+                if (r.seq.load(std::memory_order_acquire) != index + 1) {
+                    continue; // Slot nadpisywany właśnie przez wątek-właściciela
+                }
+                char detail[TRACE_DETAIL_SIZE];
+                int64_t time_ns = r.time_ns;
+                uint64_t arg = r.arg;
+                TraceEvent event = r.event;
+                TracePhase phase = r.phase;
+                std::memcpy(detail, r.detail, TRACE_DETAIL_SIZE);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (r.seq.load(std::memory_order_relaxed) != index + 1) {
+                    continue;
+                }
+                detail[TRACE_DETAIL_SIZE - 1] = '\0';
+
+                json e = {
+                        {"name", event_name(event)},
+                        {"cat", "pjurominer"},
+                        {"ph", std::string(1, static_cast<char>(phase))},
+                        {"ts", static_cast<double>(time_ns) / 1000.0},
+                        {"pid", 1},
+                        {"tid", buffer->tid},
+                        {"args", {{"arg", arg}, {"detail", std::string(detail)}}}
+                };
+                if (phase == TracePhase::Instant) {
+                    e["s"] = "t";
+                }
+                exported.push_back({time_ns, std::move(e)});
+            }
+        }
+    }
+
+    std::stable_sort(exported.begin(), exported.end(),
+                     [](const Exported& a, const Exported& b) { return a.time_ns < b.time_ns; });
+
+    json events = std::move(metadata);
+    for (auto& e : exported) {
+        events.push_back(std::move(e.event));
+    }
+    json root = {{"traceEvents", std::move(events)}, {"displayTimeUnit", "ms"}};
+    return root.dump();
+}
+
+bool trace_write_chrome_json(const std::string& path) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    out << trace_export_chrome_json();
+    return static_cast<bool>(out);
+}
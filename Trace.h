@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * @enum TraceEvent
+ * @brief Punkty pomiarowe na ścieżce job -> hash -> share -> odpowiedź puli.
+ */
+enum class TraceEvent : uint8_t {
+    JobParse,         // Parsowanie powiadomienia 'job' (B/E)
+    SeedUpdate,       // RandomXManager::updateSeed (B/E)
+    VmRecreate,       // Odtworzenie VM w MinerWorker::run (B/E)
+    FirstHash,        // Pierwszy hash na nowej pracy (i)
+    SolutionFound,    // Znalezione rozwiązanie (i)
+    SubmitWritten,    // Zapytanie 'submit' zapisane do gniazda (i)
+    ResponseReceived, // Odpowiedź puli na 'submit' (i)
+};
+
+/**
+ * @enum TracePhase
+ * @brief Faza zdarzenia w nomenklaturze Chrome trace ('B', 'E', 'i').
+ */
+enum class TracePhase : char {
+    Begin = 'B',
+    End = 'E',
+    Instant = 'i',
+};
+
+// Globalny przełącznik - jedyny koszt wyłączonego śledzenia to odczyt relaxed
+extern std::atomic<bool> g_trace_enabled;
+
+/**
+ * @brief Czy śledzenie jest włączone.
+ */
+inline bool trace_enabled() {
+    return g_trace_enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Włącza lub wyłącza zbieranie zdarzeń.
+ */
+void trace_set_enabled(bool enabled);
+
+/**
+ * @brief Zapisuje zdarzenie do bufora bieżącego wątku (bez blokad po rejestracji wątku).
+ * @param event Rodzaj zdarzenia.
+ * @param phase Faza (początek, koniec, chwila).
+ * @param arg Dowolny argument liczbowy (nonce, ID zapytania...).
+ * @param detail Krótki opis (np. job_id); obcinany do rozmiaru slotu.
+ */
+void trace_record(TraceEvent event, TracePhase phase, uint64_t arg = 0, const std::string& detail = {});
+
+/**
+ * @brief Nadaje nazwę bieżącemu wątkowi w eksportowanym śladzie.
+ */
+void trace_set_thread_name(const std::string& name);
+
+/**
+ * @brief Eksportuje wszystkie zebrane zdarzenia jako JSON Chrome trace
+ * (do otwarcia w chrome://tracing lub Perfetto).
+ */
+std::string trace_export_chrome_json();
+
+/**
+ * @brief Zapisuje ślad Chrome do pliku.
+ * @return true, jeśli zapis się powiódł.
+ */
+bool trace_write_chrome_json(const std::string& path);
+
+// Makro dla punktów pomiarowych: argumenty nie są nawet wyliczane, gdy śledzenie jest wyłączone
+#define TRACE_EVENT(...)                 \
+    do {                                 \
+        if (trace_enabled()) {           \
+            trace_record(__VA_ARGS__);   \
+        }                                \
+    } while (0)
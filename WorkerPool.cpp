@@ -0,0 +1,413 @@
+#include "WorkerPool.h"
+#include "Logger.h"
+#include <algorithm>
+#include <bit>
+
+namespace {
+
+/**
+ * @brief Bity numeru workera w nonce: najmniej takich, żeby każdy worker miał własny zakres.
+ */
+unsigned nonce_slot_bits(std::size_t workers) {
+    return static_cast<unsigned>(std::bit_width(std::max<std::size_t>(workers, 1) - 1));
+}
+
+} // namespace
+
+std::vector<unsigned> partition_threads(unsigned count, const std::vector<unsigned>& weights) {
+    std::vector<unsigned> assignment(count, 0);
+    uint64_t total = 0;
+    unsigned positive = 0;
+    for (unsigned weight : weights) {
+        total += weight;
+        positive += weight > 0;
+    }
+    if (count == 0 || total == 0) {
+        return assignment;
+    }
+
+    // Części całkowite, potem pozostałe wątki wg największych reszt
+    std::vector<unsigned> threads(weights.size());
+    std::vector<uint64_t> remainders(weights.size());
+    unsigned given = 0;
+    for (std::size_t i = 0; i < weights.size(); ++i) {
+        uint64_t share = uint64_t{count} * weights[i];
+        threads[i] = static_cast<unsigned>(share / total);
+        remainders[i] = share % total;
+        given += threads[i];
+    }
+    while (given < count) {
+        auto best = std::max_element(remainders.begin(), remainders.end()) - remainders.begin();
+        threads[best]++;
+        remainders[best] = 0;
+        given++;
+    }
+
+    // Sesja z wagą nie może zostać bez wątku - zabieramy go sesji z największym nadmiarem
+    if (count >= positive) {
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            if (weights[i] == 0 || threads[i] > 0) {
+                continue;
+            }
+            std::size_t donor = 0;
+            double donor_excess = -1e300;
+            for (std::size_t j = 0; j < weights.size(); ++j) {
+                double excess = threads[j] - static_cast<double>(count) * weights[j] / static_cast<double>(total);
+                if (threads[j] > 1 && excess > donor_excess) {
+                    donor = j;
+                    donor_excess = excess;
+                }
+            }
+            threads[donor]--;
+            threads[i]++;
+        }
+    }
+
+    unsigned id = 0;
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        for (unsigned t = 0; t < threads[i]; ++t) {
+            assignment[id++] = static_cast<unsigned>(i);
+        }
+    }
+    return assignment;
+}
+
+WorkerPool::WorkerPool(MinerWorker::SolutionCallback callback,
+                       std::shared_ptr<RandomXManager> manager,
+                       std::shared_ptr<Telemetry> telemetry)
+        : m_solution_callback(std::move(callback)),
+          m_rx_manager(std::move(manager)),
+          m_telemetry(std::move(telemetry)) {
+    m_reaper = std::jthread([this](std::stop_token st) { reaper_loop(st); });
+}
+
+WorkerPool::~WorkerPool() {
+    clear();
+}
+
+void WorkerPool::set_perf_counters_enabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_perf_enabled = enabled;
+}
+
+void WorkerPool::set_priority(const ThreadPriority& priority) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_priority = priority;
+}
+
+void WorkerPool::set_rate_limiter(std::shared_ptr<RateLimiter> limiter) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_limiter = std::move(limiter);
+}
+
+bool WorkerPool::should_pause(int id) const {
+    return m_paused || static_cast<unsigned>(id) >= m_active_limit;
+}
+
+unsigned WorkerPool::pool_of(int id) const {
+    return static_cast<std::size_t>(id) < m_assignment.size() ? m_assignment[id] : 0;
+}
+
+void WorkerPool::reassign() {
+    std::vector<unsigned> previous = std::move(m_assignment);
+    m_assignment = partition_threads(static_cast<unsigned>(m_workers.size()), m_pool_weights);
+    for (auto& worker : m_workers) {
+        int id = worker->getId();
+        unsigned pool = pool_of(id);
+        bool moved = static_cast<std::size_t>(id) >= previous.size() || previous[id] != pool;
+        if (!moved) {
+            continue;
+        }
+        // Bez pracy nowej sesji worker kończy dotychczasową
+        if (auto it = m_last_jobs.find(pool); it != m_last_jobs.end()) {
+            hand_out(*worker, it->second);
+        }
+    }
+}
+
+void WorkerPool::hand_out(MinerWorker& worker, const PoolJob& pool_job) {
+    // Zawsze podmieniamy pracę - worker bez niej haszowałby dalej dla poprzedniej sesji.
+    // ID spoza podziału nonce odrzuca ją sam i czeka na następną.
+    auto id = static_cast<std::size_t>(worker.getId());
+    std::shared_ptr<std::atomic<uint64_t>> progress;
+    if (id < pool_job.progress->size()) {
+        progress = std::shared_ptr<std::atomic<uint64_t>>(pool_job.progress, &(*pool_job.progress)[id]);
+    }
+    worker.setNewJob(pool_job.job, pool_job.manager, pool_job.nonce_slot_bits, std::move(progress));
+}
+
+std::vector<unsigned> WorkerPool::affinity_for(int id) const {
+    if (auto it = m_repinned.find(id); it != m_repinned.end()) {
+        return {it->second};
+    }
+    if (m_affinity.empty()) {
+        return {};
+    }
+    return {m_affinity[static_cast<std::size_t>(id) % m_affinity.size()]};
+}
+
+std::shared_ptr<MinerWorker> WorkerPool::make_worker(int id) {
+    // Ten sam ID = te same liczniki telemetrii (register_worker zwraca istniejące)
+    auto worker = std::make_shared<MinerWorker>(id, m_solution_callback, m_rx_manager,
+                                                m_telemetry->register_worker(id));
+    worker->setPerfCountersEnabled(m_perf_enabled);
+    worker->setPriority(m_priority);
+    worker->setRateLimiter(m_limiter);
+    worker->setPaused(should_pause(id));
+    if (auto cpus = affinity_for(id); !cpus.empty()) {
+        worker->setAffinity(std::move(cpus));
+    }
+    return worker;
+}
+
+void WorkerPool::resize(unsigned count) {
+    std::lock_guard<std::mutex> resize_lock(m_resize_mutex);
+    std::vector<std::shared_ptr<MinerWorker>> removed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        unsigned old_count = static_cast<unsigned>(m_workers.size());
+
+        while (m_workers.size() > count) {
+            m_repinned.erase(m_workers.back()->getId());
+            std::erase(m_restarting, m_workers.back());
+            removed.push_back(std::move(m_workers.back()));
+            m_workers.pop_back();
+        }
+
+        for (unsigned i = old_count; i < count; ++i) {
+            m_workers.push_back(make_worker(static_cast<int>(i)));
+        }
+
+        // Podział między sesje zależy od liczby wątków; nowe workery dostają
+        // w reassign() ostatnią pracę swojej sesji (VM powstaje z gotowego datasetu)
+        reassign();
+        for (unsigned i = old_count; i < count; ++i) {
+            m_workers[i]->start();
+        }
+
+        if (old_count != count) {
+            LOG_INFO(LogCategory::Manager, "[MANAGER] Liczba wątków roboczych: {} -> {}", old_count, count);
+        }
+        bool outgrown = std::any_of(m_last_jobs.begin(), m_last_jobs.end(), [count](const auto& entry) {
+            return (std::size_t{1} << entry.second.nonce_slot_bits) < count;
+        });
+        if (count > old_count && outgrown) {
+            LOG_INFO(LogCategory::Manager, "[MANAGER] Zakresy nonce bieżącej pracy nie obejmują nowych wątków - "
+                                           "zaczną haszować od następnej pracy.");
+        }
+    }
+
+    // Join poza blokadą - set_job() i statystyki nie czekają na kończące się wątki
+    for (auto& worker : removed) {
+        worker->stop();
+    }
+    // Jawny join: referencję może jeszcze trzymać reaper_loop() (czeka na m_resize_mutex)
+    for (auto& worker : removed) {
+        worker->join();
+        m_telemetry->unregister_worker(worker->getId());
+    }
+}
+
+unsigned WorkerPool::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<unsigned>(m_workers.size());
+}
+
+void WorkerPool::set_job(const MiningJob& job, std::shared_ptr<RandomXManager> manager) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Podział nonce obejmuje wszystkie ID (także innych sesji) - przeniesiony worker nie koliduje
+    unsigned bits = nonce_slot_bits(m_workers.size());
+    PoolJob& pool_job = m_last_jobs[job.pool];
+    pool_job = {job, std::move(manager), bits,
+                std::make_shared<std::vector<std::atomic<uint64_t>>>(std::size_t{1} << bits)};
+    for (auto& worker : m_workers) {
+        if (pool_of(worker->getId()) == job.pool) {
+            hand_out(*worker, pool_job);
+        }
+    }
+}
+
+void WorkerPool::set_pool_weights(std::vector<unsigned> weights) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pool_weights = std::move(weights);
+    reassign();
+}
+
+std::vector<unsigned> WorkerPool::pool_threads() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<unsigned> threads(std::max<std::size_t>(m_pool_weights.size(), 1), 0);
+    for (unsigned pool : m_assignment) {
+        if (pool >= threads.size()) {
+            threads.resize(pool + 1, 0);
+        }
+        threads[pool]++;
+    }
+    return threads;
+}
+
+void WorkerPool::pause() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_paused = true;
+    for (auto& worker : m_workers) {
+        worker->setPaused(true);
+    }
+}
+
+void WorkerPool::resume() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_paused = false;
+    for (auto& worker : m_workers) {
+        worker->setPaused(should_pause(worker->getId()));
+    }
+}
+
+void WorkerPool::set_active_limit(unsigned limit) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_active_limit = limit;
+    for (auto& worker : m_workers) {
+        worker->setPaused(should_pause(worker->getId()));
+    }
+}
+
+unsigned WorkerPool::active_count() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_paused) {
+        return 0;
+    }
+    return std::min(static_cast<unsigned>(m_workers.size()), m_active_limit);
+}
+
+bool WorkerPool::paused() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_paused;
+}
+
+void WorkerPool::set_affinity(std::vector<unsigned> cpus) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_affinity = std::move(cpus);
+    m_repinned.clear();
+    for (auto& worker : m_workers) {
+        worker->setAffinity(affinity_for(worker->getId()));
+    }
+}
+
+std::vector<unsigned> WorkerPool::affinity() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_affinity;
+}
+
+std::optional<PerfSample> WorkerPool::perf_sample(int id) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (id < 0 || static_cast<std::size_t>(id) >= m_workers.size()) {
+        return std::nullopt;
+    }
+    return m_workers[id]->getPerfSample();
+}
+
+std::vector<WorkerHealth> WorkerPool::health() const {
+    std::vector<std::shared_ptr<MinerWorker>> workers;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        workers = m_workers;
+    }
+    std::vector<WorkerHealth> health;
+    for (const auto& worker : workers) {
+        const WorkerTelemetry& telemetry = worker->getTelemetry();
+        WorkerHealth h;
+        h.id = worker->getId();
+        h.hashes = telemetry.hash_count();
+        h.idle_loops = telemetry.idle_loops.load(std::memory_order_relaxed);
+        h.busy_since_ns = telemetry.busy_since_ns.load(std::memory_order_relaxed);
+        h.cpu = telemetry.cpu.load(std::memory_order_relaxed);
+        health.push_back(h);
+    }
+    return health;
+}
+
+void WorkerPool::repin_worker(int id, unsigned cpu) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (id < 0 || static_cast<std::size_t>(id) >= m_workers.size()) {
+        return;
+    }
+    m_repinned[id] = cpu;
+    m_workers[id]->setAffinity({cpu});
+}
+
+void WorkerPool::reset_worker_vm(int id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (id >= 0 && static_cast<std::size_t>(id) < m_workers.size()) {
+        m_workers[id]->requestVmReset();
+    }
+}
+
+void WorkerPool::restart_worker(int id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (id < 0 || static_cast<std::size_t>(id) >= m_workers.size()) {
+        return;
+    }
+    const auto& old = m_workers[id];
+    if (std::find(m_restarting.begin(), m_restarting.end(), old) != m_restarting.end()) {
+        return; // Restart już trwa
+    }
+    old->stop();
+    m_restarting.push_back(old);
+    m_reaper_cv.notify_all();
+}
+
+void WorkerPool::reaper_loop(std::stop_token stoken) {
+    while (!stoken.stop_requested()) {
+        std::shared_ptr<MinerWorker> old;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!m_reaper_cv.wait(lock, stoken, [this] { return !m_restarting.empty(); })) {
+                return;
+            }
+            old = m_restarting.front();
+        }
+
+        // Jak w resize(): pod m_resize_mutex nikt inny nie dołącza tego wątku
+        // ani nie zmienia ID workerów. Czekamy tu, a nie w wątku io_context.
+        std::lock_guard<std::mutex> resize_lock(m_resize_mutex);
+        old->join();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::erase(m_restarting, old);
+        int id = old->getId();
+        if (static_cast<std::size_t>(id) >= m_workers.size() || m_workers[id] != old) {
+            continue; // Usunięty w międzyczasie przez resize() lub clear()
+        }
+        // Stary wątek już nie pisze do liczników, postępu zakresu ani nie trzyma
+        // blokady datasetu - następca wznawia jego zakres nonce w bieżącej pracy.
+        auto worker = make_worker(id);
+        if (auto it = m_last_jobs.find(pool_of(id)); it != m_last_jobs.end()) {
+            hand_out(*worker, it->second);
+        }
+        m_workers[id] = worker;
+        worker->start();
+        LOG_INFO(LogCategory::Manager, "[MANAGER] Worker {} zrestartowany.", id);
+    }
+}
+
+void WorkerPool::request_stop() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& worker : m_workers) {
+        worker->stop();
+    }
+}
+
+void WorkerPool::clear() {
+    // Bez trwającego restartu - po powrocie żaden wątek roboczy nie działa
+    std::lock_guard<std::mutex> resize_lock(m_resize_mutex);
+    std::vector<std::shared_ptr<MinerWorker>> removed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        removed.swap(m_workers);
+        m_restarting.clear();
+    }
+    for (auto& worker : removed) {
+        worker->stop();
+    }
+    for (auto& worker : removed) {
+        worker->join();
+    }
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "MinerWorker.h"
+#include "RandomXManager.h"
+#include "Telemetry.h"
+#include "WorkerWatchdog.h"
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Dzieli count wątków między sesje proporcjonalnie do wag (metoda
+ * największych reszt). Każda sesja z wagą > 0 dostaje co najmniej jeden wątek,
+ * jeśli wątków wystarcza. Sesje zajmują ciągłe zakresy ID workerów, więc przy
+ * --affinity także ciągłe zakresy CPU.
+ * @return Sesja dla każdego workera (rozmiar count); puste wagi = wszystko dla sesji 0.
+ */
+std::vector<unsigned> partition_threads(unsigned count, const std::vector<unsigned>& weights);
+
+/**
+ * @class WorkerPool
+ * @brief Zbiór wątków roboczych, którego rozmiar, stan i powinowactwo
+ * można zmieniać w trakcie działania.
+ *
+ * Nowe wątki korzystają z już zbudowanego datasetu managera i od razu
+ * dostają ostatnią pracę swojej sesji, o ile jej podział nonce obejmuje ich ID
+ * (inaczej - następną). Zakres każdego ID jest wznawiany tam, gdzie skończył
+ * poprzedni worker o tym ID w tej pracy. Usuwane wątki są zatrzymywane i dołączane
+ * (join) przed zwróceniem z resize(). Wszystkie metody są bezpieczne
+ * do wywołania z dowolnego wątku.
+ */
+class WorkerPool {
+public:
+    /**
+     * @brief Konstruktor.
+     * @param callback Funkcja zwrotna przekazywana każdemu workerowi.
+     * @param manager Współdzielony manager RandomX.
+     * @param telemetry Rdzeń telemetrii (rejestracja liczników workerów).
+     */
+    WorkerPool(MinerWorker::SolutionCallback callback,
+               std::shared_ptr<RandomXManager> manager,
+               std::shared_ptr<Telemetry> telemetry);
+
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief Włącza liczniki perf_event_open dla workerów uruchamianych od teraz.
+     */
+    void set_perf_counters_enabled(bool enabled);
+
+    /**
+     * @brief Klasa szeregowania dla workerów uruchamianych od teraz.
+     */
+    void set_priority(const ThreadPriority& priority);
+
+    /**
+     * @brief Regulator limitu hashrate/CPU dla workerów uruchamianych od teraz.
+     */
+    void set_rate_limiter(std::shared_ptr<RateLimiter> limiter);
+
+    /**
+     * @brief Ustawia liczbę wątków roboczych (uruchamia nowe lub zatrzymuje ostatnie).
+     */
+    void resize(unsigned count);
+
+    /**
+     * @brief Aktualna liczba wątków roboczych.
+     */
+    unsigned size() const;
+
+    /**
+     * @brief Przekazuje pracę workerom sesji job.pool i zapamiętuje ją dla nowych.
+     * Zakres nonce dzieli na tyle części, ilu jest workerów (do potęgi dwójki).
+     * Postęp każdej części jest zapamiętywany przy pracy - worker, który do niej
+     * wraca (restart, przedział czasu sesji), wznawia zakres zamiast go powtarzać.
+     * @param manager Manager z datasetem seeda pracy (nullptr = manager z konstruktora).
+     */
+    void set_job(const MiningJob& job, std::shared_ptr<RandomXManager> manager = nullptr);
+
+    /**
+     * @brief Dzieli workery między sesje pul wg wag (zobacz partition_threads()).
+     * Workery przeniesione do innej sesji od razu dostają jej ostatnią pracę (zobacz set_job()).
+     */
+    void set_pool_weights(std::vector<unsigned> weights);
+
+    /**
+     * @brief Liczba workerów przydzielonych każdej sesji (indeks = sesja).
+     */
+    std::vector<unsigned> pool_threads() const;
+
+    void pause();
+    void resume();
+    bool paused() const;
+
+    /**
+     * @brief Parkuje workery o ID >= limit (wstrzymane, z zachowaną VM).
+     * Niezależne od pause(): worker haszuje tylko, gdy nie jest ani wstrzymany, ani zaparkowany.
+     */
+    void set_active_limit(unsigned limit);
+
+    /**
+     * @brief Liczba workerów, które aktualnie mogą haszować.
+     */
+    unsigned active_count() const;
+
+    /**
+     * @brief Przypina worker i do cpus[i % cpus.size()]; pusta lista zdejmuje przypięcie.
+     */
+    void set_affinity(std::vector<unsigned> cpus);
+    std::vector<unsigned> affinity() const;
+
+    /**
+     * @brief Liczniki wydajności workera o danym ID (jeśli włączone).
+     */
+    std::optional<PerfSample> perf_sample(int id) const;
+
+    /**
+     * @brief Postęp wszystkich workerów dla watchdoga.
+     */
+    std::vector<WorkerHealth> health() const;
+
+    /**
+     * @brief Przypina jeden worker do cpu (do następnego set_affinity() lub restartu).
+     */
+    void repin_worker(int id, unsigned cpu);
+
+    /**
+     * @brief Zleca workerowi odtworzenie VM.
+     */
+    void reset_worker_vm(int id);
+
+    /**
+     * @brief Zastępuje worker nowym wątkiem o tym samym ID (te same liczniki). Następca
+     * wznawia zakres nonce bieżącej pracy od miejsca, w którym skończył stary wątek.
+     * Nie blokuje: stary wątek dostaje stop, a wątek pomocniczy puli czeka na jego
+     * zakończenie i dopiero wtedy uruchamia następcę - ID i zakres nonce nigdy
+     * nie należą do dwóch żywych wątków. Do tego czasu health() pokazuje stary worker.
+     */
+    void restart_worker(int id);
+
+    /**
+     * @brief Prosi wszystkie wątki o zatrzymanie (bez czekania).
+     */
+    void request_stop();
+
+    /**
+     * @brief Zatrzymuje wszystkie wątki i czeka na ich zakończenie.
+     */
+    void clear();
+
+private:
+    struct PoolJob {
+        MiningJob job;
+        std::shared_ptr<RandomXManager> manager;
+        unsigned nonce_slot_bits = 0; // Z liczby workerów przy set_job() (zobacz MinerWorker::setNewJob())
+        // Przeszukana część zakresu każdego ID (indeks = ID), wspólna z workerami tej pracy
+        std::shared_ptr<std::vector<std::atomic<uint64_t>>> progress;
+    };
+
+    std::vector<unsigned> affinity_for(int id) const; // wymaga m_mutex
+    std::shared_ptr<MinerWorker> make_worker(int id);  // wymaga m_mutex
+    bool should_pause(int id) const;                  // wymaga m_mutex
+    unsigned pool_of(int id) const;                   // wymaga m_mutex
+    void reassign();                                  // wymaga m_mutex
+    void hand_out(MinerWorker& worker, const PoolJob& pool_job); // wymaga m_mutex
+    void reaper_loop(std::stop_token stoken);
+
+    MinerWorker::SolutionCallback m_solution_callback;
+    std::shared_ptr<RandomXManager> m_rx_manager;
+    std::shared_ptr<Telemetry> m_telemetry;
+
+    std::mutex m_resize_mutex;  // Serializuje resize() (ID workerów i rejestracja w telemetrii)
+    mutable std::mutex m_mutex; // Chroni wszystkie pola poniżej
+    std::vector<std::shared_ptr<MinerWorker>> m_workers;
+    std::vector<std::shared_ptr<MinerWorker>> m_restarting; // Zatrzymane przez restart_worker(), czekają na następcę
+    std::map<int, unsigned> m_repinned;                 // Przepięcia watchdoga (ID -> CPU)
+    std::map<unsigned, PoolJob> m_last_jobs;   // Ostatnia praca każdej sesji
+    std::vector<unsigned> m_pool_weights;
+    std::vector<unsigned> m_assignment;        // Sesja każdego workera (indeks = ID)
+    std::vector<unsigned> m_affinity;
+    bool m_paused = false;
+    unsigned m_active_limit = ~0u;
+    bool m_perf_enabled = false;
+    ThreadPriority m_priority;
+    std::shared_ptr<RateLimiter> m_limiter;
+
+    std::condition_variable_any m_reaper_cv; // Nowe wpisy w m_restarting (z m_mutex)
+    std::jthread m_reaper;                   // Ostatnie pole - zatrzymywany przed pozostałymi
+};
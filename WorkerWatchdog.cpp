@@ -0,0 +1,220 @@
+#include "WorkerWatchdog.h"
+#include "Logger.h"
+#include <algorithm>
+#include <set>
+
+namespace {
+constexpr double BASELINE_ALPHA = 0.2;  // Waga nowego zdrowego pomiaru w historii workera
+constexpr unsigned MIN_PEERS = 3;       // Mniej porównywalnych workerów - mediana nic nie mówi
+}
+
+const char* watchdog_action_name(WorkerWatchdog::Action action) {
+    switch (action) {
+        case WorkerWatchdog::Action::Repin: return "repin";
+        case WorkerWatchdog::Action::ResetVm: return "vm_reset";
+        case WorkerWatchdog::Action::Restart: return "restart";
+    }
+    return "unknown";
+}
+
+WorkerWatchdog::WorkerWatchdog(WatchdogConfig config)
+        : m_config(config),
+          m_last_update(std::chrono::steady_clock::now()) {}
+
+std::optional<WorkerWatchdog::Intervention> WorkerWatchdog::escalate(int id, State& state, unsigned first_level,
+                                                                     const std::string& reason, int current_cpu,
+                                                                     const std::vector<unsigned>& free_cpus) {
+    auto now = std::chrono::steady_clock::now();
+    state.bad_streak = 0;
+    state.good_streak = 0;
+    if (state.gave_up) {
+        if (now - *state.gave_up < m_config.give_up_cooldown) {
+            return std::nullopt;
+        }
+        state.gave_up.reset();
+        state.level = 0;
+    }
+
+    unsigned level = std::max(state.level, first_level);
+    if (level > static_cast<unsigned>(Action::Restart)) {
+        state.gave_up = now;
+        LOG_ERROR(LogCategory::Manager, "[Watchdog] Worker {}: {} - przepięcie, nowa VM i restart nie pomogły; "
+                                        "ponowna próba za {} s.", id, reason, m_config.give_up_cooldown.count());
+        return std::nullopt;
+    }
+
+    Intervention intervention;
+    intervention.worker = id;
+    intervention.reason = reason;
+    intervention.action = static_cast<Action>(level);
+    if (intervention.action == Action::Repin) {
+        auto cpu = std::find_if(free_cpus.begin(), free_cpus.end(),
+                                [current_cpu](unsigned c) { return static_cast<int>(c) != current_cpu; });
+        if (cpu == free_cpus.end()) {
+            intervention.action = Action::ResetVm; // Brak wolnego CPU - przepięcie nic nie da
+        } else {
+            intervention.cpu = static_cast<int>(*cpu);
+        }
+    }
+    state.level = static_cast<unsigned>(intervention.action) + 1;
+
+    switch (intervention.action) {
+        case Action::Repin:
+            m_stats.repins += 1;
+            LOG_WARN(LogCategory::Manager, "[Watchdog] Worker {}: {} - przepinam z CPU {} na CPU {}.",
+                     id, reason, current_cpu, intervention.cpu);
+            break;
+        case Action::ResetVm:
+            m_stats.vm_resets += 1;
+            LOG_WARN(LogCategory::Manager, "[Watchdog] Worker {}: {} - odtwarzam VM.", id, reason);
+            break;
+        case Action::Restart:
+            m_stats.restarts += 1;
+            LOG_WARN(LogCategory::Manager, "[Watchdog] Worker {}: {} - restartuję wątek.", id, reason);
+            break;
+    }
+    return intervention;
+}
+
+std::vector<WorkerWatchdog::Intervention> WorkerWatchdog::update(const std::vector<WorkerHealth>& workers,
+                                                                 const std::vector<unsigned>& cpus) {
+    auto now = std::chrono::steady_clock::now();
+    auto elapsed = now - m_last_update;
+    double dt = std::chrono::duration<double>(elapsed).count();
+    m_last_update = now;
+    int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+
+    struct Sample {
+        const WorkerHealth* worker;
+        double rate;
+        bool comparable; // Cały okres haszował
+        bool hung;       // Utknął w jednym hashu
+    };
+    std::vector<Sample> samples;
+    std::vector<double> rates;
+    std::set<int> present;
+    std::set<unsigned> occupied;
+    for (const auto& worker : workers) {
+        present.insert(worker.id);
+        if (worker.cpu >= 0) {
+            occupied.insert(static_cast<unsigned>(worker.cpu));
+        }
+        State& state = m_states[worker.id];
+        bool fresh = !state.have_sample || worker.hashes < state.last_hashes;
+        uint64_t hashes = worker.hashes - (fresh ? worker.hashes : state.last_hashes);
+        bool idle = fresh || worker.idle_loops != state.last_idle;
+        state.last_hashes = worker.hashes;
+        state.last_idle = worker.idle_loops;
+        state.have_sample = true;
+
+        Sample sample{&worker, dt > 0.0 ? hashes / dt : 0.0, !idle && dt > 0.0, false};
+        sample.hung = worker.busy_since_ns != 0 &&
+                      now_ns - worker.busy_since_ns > std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                              m_config.stall_timeout).count();
+        if (sample.comparable && sample.rate > 0.0) {
+            rates.push_back(sample.rate);
+        }
+        samples.push_back(sample);
+    }
+    std::erase_if(m_states, [&](const auto& entry) { return !present.contains(entry.first); });
+
+    double median = 0.0;
+    if (!rates.empty()) {
+        std::nth_element(rates.begin(), rates.begin() + rates.size() / 2, rates.end());
+        median = rates[rates.size() / 2];
+    }
+    bool peers = rates.size() >= MIN_PEERS;
+    m_stats.peer_median_rate = median;
+    m_stats.degraded_workers = 0;
+    m_stats.stalled_workers = 0;
+    m_stats.hung_workers = 0;
+
+    std::vector<unsigned> free_cpus;
+    for (unsigned cpu : cpus) {
+        if (!occupied.contains(cpu)) {
+            free_cpus.push_back(cpu);
+        }
+    }
+
+    std::vector<Intervention> interventions;
+    for (const auto& sample : samples) {
+        int id = sample.worker->id;
+        State& state = m_states[id];
+        if (sample.hung) {
+            // Restart nic nie da: stop() nie przerwie hasha, a następca o tym samym
+            // ID kopałby ten sam zakres nonce. Zgłaszamy raz i nie eskalujemy.
+            m_stats.stalled_workers += 1;
+            m_stats.hung_workers += 1;
+            state.no_progress = {};
+            state.bad_streak = 0;
+            if (!state.hung_reported) {
+                state.hung_reported = true;
+                LOG_ERROR(LogCategory::Manager, "[Watchdog] Worker {} utknął w hashu na ponad {} s - "
+                                                "nie da się go zatrzymać, wymaga restartu procesu.",
+                          id, m_config.stall_timeout.count());
+            }
+            continue;
+        }
+        if (state.hung_reported) {
+            state.hung_reported = false;
+            LOG_INFO(LogCategory::Manager, "[Watchdog] Worker {} wyszedł z zawieszonego hasha.", id);
+        }
+        if (!sample.comparable) {
+            // Pauza, parkowanie, brak pracy lub budowa datasetu - okres nie mówi nic o zdrowiu
+            state.no_progress = {};
+            state.bad_streak = 0;
+            continue;
+        }
+
+        std::optional<Intervention> intervention;
+        if (sample.rate == 0.0) {
+            state.no_progress += elapsed;
+            if (state.no_progress < m_config.stall_timeout) {
+                continue;
+            }
+            m_stats.stalled_workers += 1;
+            state.no_progress = {};
+            intervention = escalate(id, state, static_cast<unsigned>(Action::ResetVm), "brak hashy mimo pracy",
+                                    sample.worker->cpu, free_cpus);
+        } else {
+            state.no_progress = {};
+            bool has_baseline = state.baseline_samples >= m_config.confirm_checks;
+            bool slow_vs_peers = peers && sample.rate < m_config.slow_ratio * median;
+            bool degraded = has_baseline
+                    ? sample.rate < m_config.slow_ratio * state.baseline && (slow_vs_peers || !peers)
+                    : peers && sample.rate < m_config.slow_ratio / 2 * median;
+            if (!degraded) {
+                state.bad_streak = 0;
+                state.good_streak += 1;
+                state.baseline = state.baseline_samples == 0
+                        ? sample.rate
+                        : state.baseline + BASELINE_ALPHA * (sample.rate - state.baseline);
+                state.baseline_samples += 1;
+                if (state.level > 0 && state.good_streak >= m_config.confirm_checks) {
+                    LOG_INFO(LogCategory::Manager, "[Watchdog] Worker {} odzyskał tempo: {:.1f} H/s (mediana {:.1f} H/s).",
+                             id, sample.rate, median);
+                    state.level = 0;
+                }
+                continue;
+            }
+            m_stats.degraded_workers += 1;
+            state.good_streak = 0;
+            if (++state.bad_streak < m_config.confirm_checks) {
+                continue;
+            }
+            std::string reason = has_baseline
+                    ? fmt::format("{:.1f} H/s wobec mediany {:.1f} H/s i własnej historii {:.1f} H/s",
+                                  sample.rate, median, state.baseline)
+                    : fmt::format("{:.1f} H/s wobec mediany {:.1f} H/s", sample.rate, median);
+            intervention = escalate(id, state, 0, reason, sample.worker->cpu, free_cpus);
+        }
+
+        if (intervention) {
+            if (intervention->action == Action::Repin) {
+                std::erase(free_cpus, static_cast<unsigned>(intervention->cpu));
+            }
+            interventions.push_back(std::move(*intervention));
+        }
+    }
+    return interventions;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @struct WatchdogConfig
+ * @brief Parametry nadzoru workerów.
+ */
+struct WatchdogConfig {
+    double slow_ratio = 0.5;                    // Worker wolniejszy niż ta część mediany i własnej historii (0 = wyłączony)
+    unsigned confirm_checks = 3;                // Kolejne złe pomiary przed interwencją (i po niej - na ocenę)
+    std::chrono::seconds interval{10};
+    std::chrono::seconds stall_timeout{30};     // Brak postępu mimo pracy
+    std::chrono::seconds give_up_cooldown{600}; // Po nieudanym restarcie - przerwa przed kolejną eskalacją
+};
+
+/**
+ * @struct WorkerHealth
+ * @brief Odczyt liczników jednego workera (zobacz WorkerTelemetry).
+ */
+struct WorkerHealth {
+    int id = 0;
+    uint64_t hashes = 0;
+    uint64_t idle_loops = 0;
+    int64_t busy_since_ns = 0; // 0 = poza haszowaniem
+    int cpu = -1;
+};
+
+/**
+ * @class WorkerWatchdog
+ * @brief Wykrywa zawieszone i zdegradowane workery i eskaluje naprawę.
+ *
+ * Co interval porównuje tempo każdego workera, który przez cały okres
+ * haszował (bez pauzy, parkowania, czekania na pracę lub dataset), z medianą
+ * pozostałych i z jego własną historią (EWMA zdrowych pomiarów). Worker jest
+ * zdegradowany dopiero, gdy jest wolny na tle obu - spowolnienie całego hosta
+ * (temperatura, limit mocy) nie wywołuje interwencji, a stale wolniejsze
+ * rdzenie (E-core, rodzeństwo SMT) mają niższą własną historię. Przed
+ * zebraniem historii wystarczy mediana, ale z dwa razy ostrzejszym progiem.
+ *
+ * Eskalacja po confirm_checks złych pomiarach z rzędu: przepięcie na wolne
+ * CPU (po złej migracji lub przy sąsiedzie SMT), odtworzenie VM, restart
+ * wątku. Zawieszenie (brak hashy przez stall_timeout) zaczyna od odtworzenia
+ * VM. Wątku utkniętego w samym hashu nie da się naprawić - nie reaguje na
+ * stop i trzyma blokadę datasetu - więc jest tylko zgłaszany, bez eskalacji.
+ * Zdrowy przez confirm_checks pomiarów worker wraca na początek drabiny.
+ * Używany w jednym wątku (io_context).
+ */
+class WorkerWatchdog {
+public:
+    enum class Action { Repin, ResetVm, Restart };
+
+    struct Intervention {
+        int worker = 0;
+        Action action = Action::Repin;
+        int cpu = -1;       // Dla Repin: docelowe CPU
+        std::string reason;
+    };
+
+    struct Stats {
+        unsigned degraded_workers = 0;
+        unsigned stalled_workers = 0;
+        unsigned hung_workers = 0;     // Utknęły w jednym hashu (podzbiór stalled_workers)
+        uint64_t repins = 0;
+        uint64_t vm_resets = 0;
+        uint64_t restarts = 0;
+        double peer_median_rate = 0.0; // H/s porównywalnych workerów w ostatnim okresie
+    };
+
+    explicit WorkerWatchdog(WatchdogConfig config);
+
+    /**
+     * @brief Ocenia workery i zwraca interwencje do wykonania (każda jest już zalogowana).
+     * @param workers Liczniki wszystkich workerów.
+     * @param cpus CPU, na które wolno przepinać (np. --affinity lub cpuset cgroup).
+     */
+    std::vector<Intervention> update(const std::vector<WorkerHealth>& workers, const std::vector<unsigned>& cpus);
+
+    const Stats& stats() const { return m_stats; }
+    const WatchdogConfig& config() const { return m_config; }
+
+private:
+    struct State {
+        uint64_t last_hashes = 0;
+        uint64_t last_idle = 0;
+        bool have_sample = false;
+        double baseline = 0.0;        // EWMA zdrowego tempa
+        unsigned baseline_samples = 0;
+        unsigned bad_streak = 0;
+        unsigned good_streak = 0;
+        std::chrono::steady_clock::duration no_progress{0};
+        unsigned level = 0;           // Wykonane kroki drabiny (0 = brak interwencji)
+        bool hung_reported = false;
+        std::optional<std::chrono::steady_clock::time_point> gave_up;
+    };
+
+    std::optional<Intervention> escalate(int id, State& state, unsigned first_level, const std::string& reason,
+                                         int current_cpu, const std::vector<unsigned>& free_cpus);
+
+    WatchdogConfig m_config;
+    Stats m_stats;
+    std::map<int, State> m_states;
+    std::chrono::steady_clock::time_point m_last_update;
+};
+
+/**
+ * @brief Nazwa akcji do logów i metryk ("repin", "vm_reset", "restart").
+ */
+const char* watchdog_action_name(WorkerWatchdog::Action action);
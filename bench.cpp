@@ -0,0 +1,498 @@
+/**
+ * @file bench.cpp
+ * @brief pjurominer_bench - mikrobenchmarki gorących ścieżek minera.
+ *
+ * Każdy benchmark jest mierzony w kilku powtórzeniach (mediana ns/op).
+ * Wyniki są drukowane jako tabela i JSON, a następnie porównywane
+ * z bazą (bench_baseline.json w repozytorium). Benchmark wolniejszy od
+ * bazy o więcej niż próg jest oznaczany jako regresja (kod wyjścia 2);
+ * benchmark bez wpisu w bazie też kończy porównanie błędem.
+ *
+ * Baza jest związana z maszyną referencyjną (wielordzeniową - benchmarki
+ * worker_pool/broadcast/N mierzą skalowanie) - po zmianie sprzętu, dodaniu
+ * benchmarku lub zamierzonej zmianie wydajności odśwież ją opcją
+ * --update-baseline. Zapis wymaga kompletu benchmarków (REGISTERED_BENCHMARKS).
+ */
+#include "MiningCommon.h"
+#include "StratumClient.h"
+#include "RandomXHasher.h"
+#include "StubHasher.h"
+#include "RandomXManager.h"
+#include "WorkerPool.h"
+#include "Telemetry.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <thread>
+#include <vector>
+#include <fmt/core.h>
+#include <fmt/ranges.h>
+#include <nlohmann/json.hpp>
+
+#ifndef PJUROMINER_BENCH_BASELINE
+#define PJUROMINER_BENCH_BASELINE "bench_baseline.json"
+#endif
+
+/**
+ * @brief Dostęp benchmarku do prywatnego parsera wiadomości Stratum.
+ */
+struct StratumClientBenchAccess {
+    static void handle_message(StratumClient& client, const std::string& message) {
+        client.handle_message(message);
+    }
+};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Wartości, których kompilator nie może wyeliminować
+volatile uint64_t g_sink = 0;
+
+// Wszystkie benchmarki - baza musi zawierać każdy z nich
+constexpr const char* REGISTERED_BENCHMARKS[] = {
+        "hex_to_bytes/blob",
+        "bytes_to_hex/hash32",
+        "check_hash_target_real",
+        "stub/hash_and_check",
+        "stratum/login_response",
+        "stratum/job_notify",
+        "stratum/share_accepted",
+        "stratum/share_rejected",
+        "worker_pool/broadcast/1",
+        "worker_pool/broadcast/8",
+        "worker_pool/broadcast/64",
+        "randomx/cache_init",
+        "randomx/light_hash",
+};
+constexpr unsigned BROADCAST_WORKERS[] = {1, 8, 64};
+// Mniej CPU - rozdanie pracy 8 i 64 workerom nie mówi nic o skalowaniu
+constexpr unsigned MIN_BASELINE_CPUS = 8;
+
+struct BenchOptions {
+    std::string baseline_file = PJUROMINER_BENCH_BASELINE;
+    std::string json_file;
+    std::string filter;
+    double threshold = 0.10;           // Dopuszczalne spowolnienie względem bazy
+    double min_time = 0.2;             // Sekundy na powtórzenie
+    unsigned repetitions = 5;
+    bool update_baseline = false;
+    bool randomx = true;               // Benchmarki wymagające cache'a RandomX (256 MB)
+};
+
+struct BenchResult {
+    std::string name;
+    double ns_per_op = 0.0;            // Mediana z powtórzeń
+    double min_ns_per_op = 0.0;
+    uint64_t iterations = 0;           // Operacje w jednym powtórzeniu
+};
+
+/**
+ * @brief Mierzy op(n) (n operacji na wywołanie). Liczba operacji jest
+ * dobierana tak, aby jedno powtórzenie trwało co najmniej min_time.
+ */
+BenchResult measure(const std::string& name, const BenchOptions& options,
+                    const std::function<void(uint64_t)>& op) {
+    op(1); // Rozgrzewka (cache, JIT, alokacje)
+
+    uint64_t iterations = 1;
+    while (true) {
+        auto start = Clock::now();
+        op(iterations);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds >= options.min_time || iterations >= (1ull << 40)) {
+            break;
+        }
+        // Skok do przewidywanej liczby (z zapasem), co najwyżej x10 na raz
+        double scale = seconds > 0.0 ? options.min_time * 1.2 / seconds : 10.0;
+        iterations = static_cast<uint64_t>(iterations * std::clamp(scale, 2.0, 10.0));
+    }
+
+    std::vector<double> samples;
+    for (unsigned r = 0; r < options.repetitions; ++r) {
+        auto start = Clock::now();
+        op(iterations);
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        samples.push_back(ns / iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+    return {name, samples[samples.size() / 2], samples.front(), iterations};
+}
+
+// --- Wiadomości puli (zapis ruchu Monero Stratum, blob i identyfikatory podmienione) ---
+
+const std::string RECORDED_BLOB =
+        "1f40fc92da241694750979ee6cf582f2d5d7d28e18335de05abc54d0560e0f5302860c652bf0"
+        "8d000000005e74210546f369fbbbce8c12cfc7957b2652fe9a755267768822ee624d48fce15e";
+const std::string RECORDED_SEED = "7a1f3b5c9d2e4f6a8b0c1d3e5f7a9b2c4d6e8f0a1b3c5d7e9f2a4b6c8d0e1f3a";
+
+const std::string MSG_LOGIN =
+        R"({"id":1,"jsonrpc":"2.0","error":null,"result":{"id":"74b2a0c1-5f3e-4d2b-9a8c-1e7f6d5c4b3a",)"
+        R"("job":{"blob":")" + RECORDED_BLOB + R"(","job_id":"RdLk0WnWmBv1dJ8f0tQeZo3Ue0Ks","target":"b88d0600",)"
+        R"("algo":"rx/0","height":3251876,"seed_hash":")" + RECORDED_SEED + R"("},"extensions":["algo"],"status":"OK"}})";
+const std::string MSG_JOB =
+        R"({"jsonrpc":"2.0","method":"job","params":{"blob":")" + RECORDED_BLOB +
+        R"(","job_id":"m2XyV8nR0pLq3sTb7wUc4eJd1fKh","target":"b88d0600","algo":"rx/0","height":3251877,)"
+        R"("seed_hash":")" + RECORDED_SEED + R"("}})";
+const std::string MSG_SHARE_ACCEPTED = R"({"id":5,"jsonrpc":"2.0","error":null,"result":{"status":"OK"}})";
+const std::string MSG_SHARE_REJECTED =
+        R"({"id":6,"jsonrpc":"2.0","error":{"code":-1,"message":"Low difficulty share"},"result":null})";
+
+const std::string HASH_HEX = "4a6f9c3e2b1d0a8f7e6d5c4b3a2f1e0d9c8b7a6f5e4d3c2b1a0f9e8d7c6b5a00";
+const std::string TARGET_HEX = "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff00";
+
+void bench_hex(const BenchOptions& options, std::vector<BenchResult>& results) {
+    results.push_back(measure("hex_to_bytes/blob", options, [](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            g_sink = g_sink + hex_to_bytes(RECORDED_BLOB).size();
+        }
+    }));
+    auto hash_bytes = hex_to_bytes(HASH_HEX);
+    results.push_back(measure("bytes_to_hex/hash32", options, [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            g_sink = g_sink + bytes_to_hex(hash_bytes.data(), hash_bytes.size()).size();
+        }
+    }));
+}
+
+void bench_target(const BenchOptions& options, std::vector<BenchResult>& results) {
+    results.push_back(measure("check_hash_target_real", options, [](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            g_sink = g_sink + check_hash_target_real(HASH_HEX, TARGET_HEX);
+        }
+    }));
+}
+
+/**
+ * @brief Pętla workera bez RandomX: wstawienie nonce, hash backendu stub i porównanie z targetem.
+ * Górna granica tempa, z jakim reszta potoku (udziały, wysyłka) może być testowana.
+ */
+void bench_stub(const BenchOptions& options, std::vector<BenchResult>& results) {
+    auto blob = hex_to_bytes(RECORDED_BLOB);
+    auto target = expand_target("b88d0600");
+    StubHasher hasher;
+    results.push_back(measure("stub/hash_and_check", options, [&](uint64_t n) {
+        uint8_t hash[32];
+        for (uint64_t i = 0; i < n; ++i) {
+            uint32_t nonce = static_cast<uint32_t>(i);
+            std::memcpy(blob.data() + 39, &nonce, sizeof(nonce));
+            hasher.hash_bytes(blob.data(), blob.size(), hash);
+            g_sink = g_sink + hash_meets_target(hash, target.data());
+        }
+    }));
+}
+
+void bench_stratum(const BenchOptions& options, std::vector<BenchResult>& results) {
+    asio::io_context io;
+    uint64_t jobs = 0;
+    auto client = std::make_shared<StratumClient>(io, "127.0.0.1", "0", "bench",
+                                                  [&](const MiningJob& job) { jobs += job.blob.size(); },
+                                                  [](const ShareResult&) {});
+
+    const std::pair<const char*, const std::string*> messages[] = {
+            {"stratum/login_response", &MSG_LOGIN},
+            {"stratum/job_notify", &MSG_JOB},
+            {"stratum/share_accepted", &MSG_SHARE_ACCEPTED},
+            {"stratum/share_rejected", &MSG_SHARE_REJECTED},
+    };
+    for (const auto& [name, message] : messages) {
+        results.push_back(measure(name, options, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                StratumClientBenchAccess::handle_message(*client, *message);
+            }
+        }));
+    }
+    g_sink = g_sink + jobs;
+}
+
+void bench_broadcast(const BenchOptions& options, std::vector<BenchResult>& results,
+                     const std::shared_ptr<RandomXManager>& manager) {
+    // Workery czekają na seed, którego manager nie zna - nie haszują,
+    // więc mierzymy samo rozdanie pracy (blokady i kopie MiningJob)
+    MiningJob job{"bench", RECORDED_BLOB, "b88d0600", std::string(64, '0')};
+    for (unsigned workers : BROADCAST_WORKERS) {
+        auto telemetry = std::make_shared<Telemetry>();
+        WorkerPool pool([](const Solution&) {}, manager, telemetry);
+        pool.resize(workers);
+        results.push_back(measure(fmt::format("worker_pool/broadcast/{}", workers), options, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                pool.set_job(job);
+            }
+        }));
+    }
+}
+
+void bench_randomx(const BenchOptions& options, std::vector<BenchResult>& results,
+                   const std::shared_ptr<RandomXManager>& manager) {
+    const RandomXApi& api = *default_randomx_algorithm().api;
+    randomx_flags flags = api.get_flags();
+    randomx_cache* cache = api.alloc_cache(flags);
+    if (!cache) {
+        std::cerr << "[Bench] Nie udało się zaalokować cache RandomX - pomijam cache_init.\n";
+    } else {
+        BenchOptions single = options;
+        single.min_time = 0.0; // Jedna inicjalizacja trwa już kilkaset ms
+        auto key = hex_to_bytes(RECORDED_SEED);
+        results.push_back(measure("randomx/cache_init", single, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                api.init_cache(cache, key.data(), key.size());
+            }
+        }));
+        api.release_cache(cache);
+    }
+
+    if (!manager->updateSeed(RECORDED_SEED)) {
+        std::cerr << "[Bench] Nie udało się zbudować seeda - pomijam randomx/light_hash.\n";
+        return;
+    }
+    RandomXBinding binding = manager->binding();
+    RandomXHasher hasher;
+    hasher.bind(*binding.algorithm, binding.cache, binding.dataset);
+    uint32_t nonce = 0;
+    results.push_back(measure("randomx/light_hash", options, [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            g_sink = g_sink + hasher.hash(RECORDED_BLOB, nonce++).size();
+        }
+    }));
+}
+
+BenchOptions parse_options(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument(fmt::format("Brak wartości dla {}", arg));
+            }
+            return argv[++i];
+        };
+        auto number = [&](const std::string& text) {
+            double result = 0.0;
+            auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), result);
+            if (ec != std::errc() || ptr != text.data() + text.size() || result < 0.0) {
+                throw std::invalid_argument(fmt::format("Nieprawidłowa wartość dla {}: '{}'", arg, text));
+            }
+            return result;
+        };
+        if (arg == "--baseline") {
+            options.baseline_file = value();
+        } else if (arg == "--json") {
+            options.json_file = value();
+        } else if (arg == "--filter") {
+            options.filter = value();
+        } else if (arg == "--threshold") {
+            options.threshold = number(value()) / 100.0;
+        } else if (arg == "--min-time") {
+            options.min_time = number(value());
+        } else if (arg == "--repetitions") {
+            options.repetitions = std::max(1u, static_cast<unsigned>(number(value())));
+        } else if (arg == "--update-baseline") {
+            options.update_baseline = true;
+        } else if (arg == "--no-randomx") {
+            options.randomx = false;
+        } else {
+            throw std::invalid_argument(fmt::format("Nieznana opcja: '{}'", arg));
+        }
+    }
+    return options;
+}
+
+const char* USAGE =
+        "Użycie: pjurominer_bench [opcje]\n"
+        "  --baseline PLIK      Baza do porównania (domyślnie bench_baseline.json z repozytorium)\n"
+        "  --threshold P        Próg regresji w % (domyślnie 10)\n"
+        "  --json PLIK          Zapisuje wyniki JSON do pliku\n"
+        "  --filter TEKST       Tylko benchmarki, których nazwa zawiera TEKST\n"
+        "  --min-time S         Minimalny czas powtórzenia w sekundach (domyślnie 0.2)\n"
+        "  --repetitions N      Liczba powtórzeń (domyślnie 5, wynik = mediana)\n"
+        "  --no-randomx         Pomija benchmarki RandomX (cache 256 MB)\n"
+        "  --update-baseline    Zapisuje wyniki jako nową bazę (wymaga wszystkich benchmarków,\n"
+        "                       bez --filter i --no-randomx)\n";
+
+nlohmann::json machine_info() {
+    return {{"hardware_concurrency", std::thread::hardware_concurrency()},
+#if defined(__clang__)
+            {"compiler", fmt::format("clang {}.{}", __clang_major__, __clang_minor__)},
+#elif defined(__GNUC__)
+            {"compiler", fmt::format("gcc {}.{}", __GNUC__, __GNUC_MINOR__)},
+#elif defined(_MSC_VER)
+            {"compiler", fmt::format("msvc {}", _MSC_VER)},
+#endif
+    };
+}
+
+/**
+ * @brief Zarejestrowane benchmarki, których brak w wynikach.
+ */
+std::vector<std::string> missing_benchmarks(const std::vector<BenchResult>& results) {
+    std::vector<std::string> missing;
+    for (const char* name : REGISTERED_BENCHMARKS) {
+        if (std::ranges::none_of(results, [&](const BenchResult& r) { return r.name == name; })) {
+            missing.emplace_back(name);
+        }
+    }
+    return missing;
+}
+
+/**
+ * @brief Porównuje wyniki z bazą. Zwraca liczbę błędów: regresji i benchmarków bez wpisu w bazie.
+ */
+int compare_with_baseline(const std::vector<BenchResult>& results, const nlohmann::json& baseline, double threshold) {
+    std::map<std::string, double> base;
+    for (const auto& entry : baseline.value("benchmarks", nlohmann::json::array())) {
+        base[entry.at("name").get<std::string>()] = entry.at("ns_per_op").get<double>();
+    }
+
+    int regressions = 0;
+    int unchecked = 0;
+    std::cout << fmt::format("\nPorównanie z bazą (próg {:.0f}%):\n", threshold * 100.0);
+    for (const auto& result : results) {
+        auto it = base.find(result.name);
+        if (it == base.end() || it->second <= 0.0) {
+            // Bez wpisu benchmark nie byłby sprawdzany wcale - odśwież bazę
+            std::cout << fmt::format("  {:<32} BRAK W BAZIE\n", result.name);
+            ++unchecked;
+            continue;
+        }
+        double change = result.ns_per_op / it->second - 1.0;
+        const char* verdict = "ok";
+        if (change > threshold) {
+            verdict = "REGRESJA";
+            ++regressions;
+        } else if (change < -threshold) {
+            verdict = "szybciej";
+        }
+        std::cout << fmt::format("  {:<32} {:>12.1f} -> {:>12.1f} ns/op  {:>+7.1f}%  {}\n",
+                                 result.name, it->second, result.ns_per_op, change * 100.0, verdict);
+    }
+    if (unchecked > 0) {
+        std::cout << fmt::format("\nBŁĄD: {} benchmarków bez wpisu w bazie - odśwież ją (--update-baseline) "
+                                 "na maszynie referencyjnej.\n", unchecked);
+    }
+    return regressions + unchecked;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    try {
+        options = parse_options(argc, argv);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << fmt::format("BŁĄD: {}\n\n{}", e.what(), USAGE);
+        return 1;
+    }
+
+    // Mierzymy parsowanie i rozdanie pracy, nie zapis na terminal: logi minera
+    // są odfiltrowane (wyniki benchmarku idą bezpośrednio na std::cout)
+    LoggerConfig log_config;
+    log_config.category_mask = 0;
+    g_logger.start(log_config);
+
+    std::vector<BenchResult> results;
+    auto wanted = [&](std::initializer_list<std::string_view> names) {
+        return options.filter.empty() || std::ranges::any_of(names, [&](std::string_view name) {
+            return name.find(options.filter) != std::string_view::npos || options.filter.starts_with(name);
+        });
+    };
+
+    if (wanted({"hex_to_bytes/", "bytes_to_hex/"})) bench_hex(options, results);
+    if (wanted({"check_hash_target_real"})) bench_target(options, results);
+    if (wanted({"stub/"})) bench_stub(options, results);
+    if (wanted({"stratum/"})) bench_stratum(options, results);
+
+    std::shared_ptr<RandomXManager> manager;
+    if (options.randomx && wanted({"worker_pool/", "randomx/"})) {
+        try {
+            manager = std::make_shared<RandomXManager>(RandomXMode::Light);
+        } catch (const std::exception& e) {
+            std::cerr << fmt::format("[Bench] RandomX niedostępny: {}\n", e.what());
+        }
+    }
+    if (manager && wanted({"worker_pool/"})) bench_broadcast(options, results, manager);
+    if (manager && wanted({"randomx/"})) bench_randomx(options, results, manager);
+    manager.reset();
+    g_logger.stop();
+
+    if (!options.filter.empty()) {
+        std::erase_if(results, [&](const BenchResult& r) { return r.name.find(options.filter) == std::string::npos; });
+    }
+
+    std::cout << fmt::format("\n{:<32} {:>14} {:>14} {:>12}\n", "benchmark", "ns/op (med.)", "ns/op (min)", "iteracje");
+    nlohmann::json report = {{"machine", machine_info()}, {"benchmarks", nlohmann::json::array()}};
+    for (const auto& r : results) {
+        std::cout << fmt::format("{:<32} {:>14.1f} {:>14.1f} {:>12}\n", r.name, r.ns_per_op, r.min_ns_per_op, r.iterations);
+        report["benchmarks"].push_back({{"name", r.name},
+                                        {"ns_per_op", r.ns_per_op},
+                                        {"min_ns_per_op", r.min_ns_per_op},
+                                        {"iterations", r.iterations}});
+    }
+
+    if (!options.json_file.empty()) {
+        std::ofstream out(options.json_file);
+        out << report.dump(2) << "\n";
+    }
+
+    if (options.update_baseline) {
+        // Niepełna baza oznaczałaby benchmarki, których nikt nie sprawdza
+        if (auto missing = missing_benchmarks(results); !missing.empty()) {
+            std::cerr << fmt::format("BŁĄD: Nie zapisuję bazy - brak wyników: {} (RandomX niedostępny, --filter "
+                                     "lub --no-randomx?)\n", fmt::join(missing, ", "));
+            return 1;
+        }
+        if (std::thread::hardware_concurrency() < MIN_BASELINE_CPUS) {
+            std::cerr << fmt::format("UWAGA: Baza z maszyny o {} CPU - benchmarki worker_pool/broadcast/* nie będą "
+                                     "reprezentatywne (zalecane co najmniej {}).\n",
+                                     std::thread::hardware_concurrency(), MIN_BASELINE_CPUS);
+        }
+        std::ofstream out(options.baseline_file);
+        out << report.dump(2) << "\n";
+        if (!out) {
+            std::cerr << fmt::format("BŁĄD: Nie udało się zapisać bazy {}\n", options.baseline_file);
+            return 1;
+        }
+        std::cout << fmt::format("\nZapisano bazę: {}\n", options.baseline_file);
+        return 0;
+    }
+
+    std::ifstream in(options.baseline_file);
+    if (!in) {
+        std::cout << fmt::format("\nBrak bazy {} - pomijam porównanie.\n", options.baseline_file);
+        return 0;
+    }
+    nlohmann::json baseline;
+    try {
+        baseline = nlohmann::json::parse(in);
+    } catch (const nlohmann::json::exception& e) {
+        std::cerr << fmt::format("BŁĄD: Nieprawidłowa baza {}: {}\n", options.baseline_file, e.what());
+        return 1;
+    }
+    if (baseline.contains("machine") && baseline["machine"] != machine_info()) {
+        std::cout << fmt::format("\nUwaga: baza pochodzi z innej maszyny/kompilatora: {}\n", baseline["machine"].dump());
+    }
+    unsigned baseline_cpus = baseline.value("machine", nlohmann::json::object()).value("hardware_concurrency", 0u);
+    if (baseline_cpus < MIN_BASELINE_CPUS) {
+        std::cout << fmt::format("\nUWAGA: baza z maszyny o {} CPU - porównanie worker_pool/broadcast/* "
+                                 "nie mówi nic o skalowaniu.\n", baseline_cpus);
+    }
+    if (options.filter.empty() && options.randomx) {
+        if (auto missing = missing_benchmarks(results); !missing.empty()) {
+            std::cout << fmt::format("\nUWAGA: nie uruchomiono: {}\n", fmt::join(missing, ", "));
+        }
+    }
+
+    int failures = compare_with_baseline(results, baseline, options.threshold);
+    if (failures > 0) {
+        std::cout << fmt::format("\n{} błędów porównania (regresje i benchmarki bez bazy).\n", failures);
+        return 2;
+    }
+    std::cout << "\nBrak regresji.\n";
+    return 0;
+}
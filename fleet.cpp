@@ -0,0 +1,329 @@
+/**
+ * @file fleet.cpp
+ * @brief pjurominer_fleet - agregator migawek floty minerów.
+ *
+ * Tryby:
+ *   pjurominer_fleet [--listen ADRES:PORT] [--http ADRES:PORT] ...
+ *       odbiera paczki (UDP i TCP) i udostępnia widoki floty przez HTTP.
+ *   pjurominer_fleet simulate [--collector URL] [--hosts N] ...
+ *       udaje N minerów (także wolnych i milknących) - test agregatora
+ *       i obciążenia na localhost bez uruchamiania minerów.
+ */
+#include "FleetAggregator.h"
+#include "FleetCollector.h"
+#include "FleetReporter.h"
+#include "Logger.h"
+#include <charconv>
+#include <csignal>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <fmt/core.h>
+
+namespace {
+
+std::shared_ptr<asio::io_context> g_io_context;
+
+struct ServeOptions {
+    std::string listen_address = "127.0.0.1";
+    uint16_t listen_port = 9300;
+    std::string http_address = "127.0.0.1";
+    uint16_t http_port = 9301;
+    FleetAggregatorConfig aggregator;
+    LogLevel log_level = LogLevel::Info;
+};
+
+struct SimulateOptions {
+    FleetConfig reporter;
+    unsigned hosts = 10;
+    unsigned threads = 8;
+    double thread_rate = 600.0; // H/s na wątek
+    unsigned slow = 1;          // Hosty z 40% hashrate i jednym wolnym wątkiem
+    unsigned silent = 1;        // Hosty milknące po trzech paczkach
+    std::chrono::seconds duration{0};
+};
+
+unsigned long parse_number(const std::string& option, const std::string& value, unsigned long max) {
+    unsigned long result = 0;
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+    if (ec != std::errc() || ptr != value.data() + value.size() || result > max) {
+        throw std::invalid_argument(fmt::format("Nieprawidłowa wartość dla {}: '{}'", option, value));
+    }
+    return result;
+}
+
+/**
+ * @brief Czas w sekundach, np. "90", "30s", "5m", "2h".
+ */
+std::chrono::seconds parse_duration(const std::string& option, std::string value) {
+    unsigned long multiplier = 1;
+    if (!value.empty()) {
+        switch (value.back()) {
+            case 's': value.pop_back(); break;
+            case 'm': value.pop_back(); multiplier = 60; break;
+            case 'h': value.pop_back(); multiplier = 3600; break;
+            default: break;
+        }
+    }
+    return std::chrono::seconds(parse_number(option, value, 30 * 24 * 3600) * multiplier);
+}
+
+double parse_percent(const std::string& option, const std::string& value) {
+    double result = 0.0;
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+    if (ec != std::errc() || ptr != value.data() + value.size() || result < 0.0 || result > 100.0) {
+        throw std::invalid_argument(fmt::format("Nieprawidłowa wartość dla {}: '{}' (oczekiwano 0-100)", option, value));
+    }
+    return result / 100.0;
+}
+
+void parse_address(const std::string& option, const std::string& value, std::string& address, uint16_t& port) {
+    auto colon = value.rfind(':');
+    if (colon == std::string::npos || colon == 0) {
+        throw std::invalid_argument(fmt::format("Oczekiwano ADRES:PORT dla {}, otrzymano '{}'", option, value));
+    }
+    address = value.substr(0, colon);
+    if (address.size() > 2 && address.front() == '[' && address.back() == ']') {
+        address = address.substr(1, address.size() - 2);
+    }
+    port = static_cast<uint16_t>(parse_number(option, value.substr(colon + 1), 65535));
+}
+
+template <typename Options, typename Handler>
+Options parse_args(const std::vector<std::string>& args, Handler handle) {
+    Options options;
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        auto value = [&]() -> const std::string& {
+            if (i + 1 >= args.size()) {
+                throw std::invalid_argument(fmt::format("Brak wartości dla {}", arg));
+            }
+            return args[++i];
+        };
+        if (!handle(options, arg, value)) {
+            throw std::invalid_argument(fmt::format("Nieznana opcja: '{}'", arg));
+        }
+    }
+    return options;
+}
+
+ServeOptions parse_serve_options(const std::vector<std::string>& args) {
+    return parse_args<ServeOptions>(args, [](ServeOptions& o, const std::string& arg, auto value) {
+        if (arg == "--listen") {
+            parse_address(arg, value(), o.listen_address, o.listen_port);
+        } else if (arg == "--http") {
+            parse_address(arg, value(), o.http_address, o.http_port);
+        } else if (arg == "--stale") {
+            o.aggregator.stale_after = parse_duration(arg, value());
+        } else if (arg == "--forget") {
+            o.aggregator.forget_after = parse_duration(arg, value());
+        } else if (arg == "--outlier") {
+            o.aggregator.outlier_deviation = parse_percent(arg, value());
+        } else if (arg == "--reject-ratio") {
+            o.aggregator.reject_ratio = parse_percent(arg, value());
+        } else if (arg == "--log-level") {
+            o.log_level = parse_log_level(value());
+        } else {
+            return false;
+        }
+        return true;
+    });
+}
+
+SimulateOptions parse_simulate_options(const std::vector<std::string>& args) {
+    auto options = parse_args<SimulateOptions>(args, [](SimulateOptions& o, const std::string& arg, auto value) {
+        if (arg == "--collector") {
+            parse_fleet_collector(value(), o.reporter);
+        } else if (arg == "--hosts") {
+            o.hosts = static_cast<unsigned>(parse_number(arg, value(), 100000));
+        } else if (arg == "--threads") {
+            o.threads = static_cast<unsigned>(parse_number(arg, value(), 4096));
+        } else if (arg == "--rate") {
+            o.thread_rate = static_cast<double>(parse_number(arg, value(), 1000000000));
+        } else if (arg == "--interval") {
+            o.reporter.interval = parse_duration(arg, value());
+        } else if (arg == "--batch") {
+            o.reporter.batch = static_cast<unsigned>(parse_number(arg, value(), 60));
+        } else if (arg == "--slow") {
+            o.slow = static_cast<unsigned>(parse_number(arg, value(), 100000));
+        } else if (arg == "--silent") {
+            o.silent = static_cast<unsigned>(parse_number(arg, value(), 100000));
+        } else if (arg == "--duration") {
+            o.duration = parse_duration(arg, value());
+        } else {
+            return false;
+        }
+        return true;
+    });
+    if (!options.reporter.enabled()) {
+        parse_fleet_collector("udp://127.0.0.1:9300", options.reporter);
+    }
+    if (options.reporter.interval.count() == 0 || options.reporter.batch == 0 || options.hosts == 0) {
+        throw std::invalid_argument("--interval, --batch i --hosts muszą być dodatnie");
+    }
+    return options;
+}
+
+std::string usage() {
+    return "Użycie: pjurominer_fleet [--listen ADRES:PORT] [--http ADRES:PORT] [--stale CZAS] [--forget CZAS]\n"
+           "                        [--outlier P] [--reject-ratio P] [--log-level POZIOM]\n"
+           "       pjurominer_fleet simulate [--collector URL] [--hosts N] [--threads N] [--rate H/s]\n"
+           "                        [--interval CZAS] [--batch N] [--slow N] [--silent N] [--duration CZAS]\n"
+           "  --listen ADRES:PORT     Odbiór migawek UDP i TCP (domyślnie 127.0.0.1:9300)\n"
+           "  --http ADRES:PORT       Widoki /fleet, /fleet/hosts, /fleet/outliers, /fleet/stale, /metrics\n"
+           "                          (domyślnie 127.0.0.1:9301)\n"
+           "  --stale CZAS            Host bez paczki dłużej jest stale (domyślnie 3 odstępy między jego paczkami)\n"
+           "  --forget CZAS           Host stale dłużej znika z widoków (domyślnie 24h)\n"
+           "  --outlier P             Odchylenie H/s na wątek od mediany floty, od którego host jest odstający\n"
+           "                          (domyślnie 30)\n"
+           "  --reject-ratio P        % odrzuconych udziałów, od którego host jest odstający (domyślnie 5)\n"
+           "  simulate                Udaje --hosts minerów wysyłających do --collector\n"
+           "                          (domyślnie udp://127.0.0.1:9300; --slow wolnych, --silent milknących)\n";
+}
+
+/**
+ * @brief Migawka udawanego minera: szum kilku procent, wolne hosty z jednym
+ * wolnym wątkiem i okazjonalnym błędem w logu.
+ */
+FleetSnapshot simulated_snapshot(const SimulateOptions& options, unsigned index, bool slow, std::mt19937& rng,
+                                 std::chrono::steady_clock::time_point start) {
+    std::normal_distribution<double> noise(1.0, 0.03);
+    FleetSnapshot s;
+    s.time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    s.uptime_seconds = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start).count());
+    for (unsigned t = 0; t < options.threads; ++t) {
+        double rate = options.thread_rate * noise(rng) * (slow ? 0.4 : 1.0);
+        if (slow && t == 0) {
+            rate *= 0.2;
+        }
+        s.thread_rates.push_back(static_cast<float>(rate));
+        s.hashrate += static_cast<float>(rate);
+    }
+    s.hashrate_ewma = s.hashrate;
+    double shares = s.hashrate * s.uptime_seconds / 100000.0;
+    s.shares_accepted = static_cast<uint64_t>(shares);
+    s.shares_rejected = slow ? s.shares_accepted / 10 : 0;
+    s.pools_connected = 1;
+    s.pools_total = 1;
+    s.dataset_state = FleetDatasetState::Ready;
+    s.dataset_build_seconds = 20.0f + index % 10;
+    s.seed_epoch = 1;
+    s.seed_hash = std::string(64, 'a');
+    s.algorithm = "rx/0";
+    s.log_errors = slow ? s.uptime_seconds / 30 : 0;
+    return s;
+}
+
+int run_simulate(const std::vector<std::string>& args) {
+    SimulateOptions options;
+    try {
+        options = parse_simulate_options(args);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << fmt::format("BŁĄD: {}\n\n{}", e.what(), usage());
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<FleetReporter>> reporters;
+    auto rng = std::make_shared<std::mt19937>(std::random_device{}());
+    for (unsigned i = 0; i < options.hosts; ++i) {
+        FleetConfig config = options.reporter;
+        config.host = fmt::format("sim-{:04}", i);
+        bool slow = i < options.slow;
+        auto reporter = std::make_shared<FleetReporter>(*g_io_context, config, [options, i, slow, rng, start] {
+            return simulated_snapshot(options, i, slow, *rng, start);
+        });
+        reporter->start();
+        reporters.push_back(reporter);
+    }
+
+    // Milknące hosty: ostatnie --silent, po trzech paczkach
+    auto silence = std::make_shared<asio::steady_timer>(*g_io_context,
+                                                        3 * options.reporter.interval * options.reporter.batch +
+                                                        options.reporter.interval / 2);
+    silence->async_wait([&reporters, &options, silence](const asio::error_code& ec) {
+        if (ec) {
+            return;
+        }
+        for (unsigned i = 0; i < options.silent && i < reporters.size(); ++i) {
+            reporters[reporters.size() - 1 - i]->stop();
+        }
+        LOG_INFO(LogCategory::Metrics, "[Fleet] Symulacja: {} hostów przestało wysyłać.", std::min<std::size_t>(options.silent, reporters.size()));
+    });
+    asio::steady_timer deadline(*g_io_context);
+    if (options.duration.count() > 0) {
+        deadline.expires_after(options.duration);
+        deadline.async_wait([](const asio::error_code& ec) {
+            if (!ec) {
+                g_io_context->stop();
+            }
+        });
+    }
+
+    LOG_INFO(LogCategory::Metrics, "[Fleet] Symulacja {} hostów x {} wątków ({} wolnych, {} milknących).",
+             options.hosts, options.threads, std::min(options.slow, options.hosts), std::min(options.silent, options.hosts));
+    g_io_context->run();
+    for (const auto& reporter : reporters) {
+        reporter->stop();
+    }
+    return 0;
+}
+
+int run_serve(const std::vector<std::string>& args) {
+    ServeOptions options;
+    try {
+        options = parse_serve_options(args);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << fmt::format("BŁĄD: {}\n\n{}", e.what(), usage());
+        return 1;
+    }
+    LoggerConfig logging;
+    logging.min_level = options.log_level;
+    g_logger.start(logging);
+
+    FleetAggregator aggregator(options.aggregator);
+    auto collector = std::make_shared<FleetCollector>(*g_io_context, aggregator, options.listen_address,
+                                                      options.listen_port, options.http_address, options.http_port);
+    try {
+        collector->start();
+    } catch (const std::system_error& e) {
+        LOG_ERROR(LogCategory::Metrics, "[Fleet] Nie udało się otworzyć gniazd: {}", e.what());
+        return 1;
+    }
+    g_io_context->run();
+    collector->stop();
+    const auto& stats = aggregator.stats();
+    LOG_INFO(LogCategory::Metrics, "[Fleet] Koniec: {} hostów, {} paczek, {} zgubionych, {} błędnych.",
+             aggregator.host_count(), stats.batches, stats.lost_batches, stats.malformed);
+    return 0;
+}
+
+void signal_handler(int) {
+    if (g_io_context) {
+        g_io_context->stop();
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (!args.empty() && (args.front() == "--help" || args.front() == "-h")) {
+        std::cout << usage();
+        return 0;
+    }
+
+    g_io_context = std::make_shared<asio::io_context>();
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+    int result = 0;
+    if (!args.empty() && args.front() == "simulate") {
+        result = run_simulate(std::vector<std::string>(args.begin() + 1, args.end()));
+    } else {
+        result = run_serve(args);
+    }
+    g_logger.stop();
+    return result;
+}
@@ -7,12 +7,33 @@
 #include <atomic>
 #include <string>
 #include <cstdio>
-#include <deque>
 #include <sstream>
+#include <algorithm>
 #include "StratumClient.h"
-#include "MinerWorker.h"
+#include "WorkerPool.h"
 #include "MiningCommon.h"
 #include "RandomXManager.h" // <-- DODANO
+#include "MinerConfig.h"
+#include "MetricsServer.h"
+#include "ControlServer.h"
+#include "CgroupLimits.h"
+#include "CotenantMonitor.h"
+#include "EnergyMonitor.h"
+#include "FleetReporter.h"
+#include "LastSeed.h"
+#include "StartupTimeline.h"
+#include "RateLimiter.h"
+#include "MemoryReport.h"
+#include "InitBenchmark.h"
+#include "BatchHash.h"
+#include "Telemetry.h"
+#include "Trace.h"
+#include "Logger.h"
+#include "ShareJournal.h"
+#include "ShareAccounting.h"
+#include "PoolScheduler.h"
+#include "HashBackend.h"
+#include "StubHasher.h"
 
 // --- NAGŁÓWKI KONSOLI (bez zmian) ---
 #ifdef _WIN32
@@ -26,58 +47,404 @@
 // ---
 
 // --- KONFIGURACJA I GLOBALS (zmiany) ---
-const std::string POOL_HOST = "pool.supportxmr.com";
-const std::string POOL_PORT = "3333";
-const std::string YOUR_WALLET_ADDRESS = "44xLKKizoqAioFsVQtm9AbUVYW7TrJGFBcYVQErc18qcVRrW5koAK2Yh3kVvGibh8w15E5gym3n5V8RSV7Q2bSuPT7kHQ72";
+// Adres puli i portfel pochodzą z MinerConfig (domyślne wartości + linia poleceń)
+MinerConfig g_config;
 
-std::shared_ptr<StratumClient> client;
-std::vector<std::shared_ptr<MinerWorker>> workers;
+// Sesje pul (indeks = MiningJob::pool); podmieniane tylko w wątku io_context
+std::vector<std::shared_ptr<StratumClient>> g_clients;
+std::vector<std::shared_ptr<asio::steady_timer>> g_reconnect_timers;
+constexpr auto RECONNECT_DELAY = std::chrono::seconds(5);
+
+// Dziennik udziałów (--share-journal); używany tylko w wątku io_context
+std::shared_ptr<ShareJournal> g_journal;
+std::shared_ptr<WorkerPool> g_workers;
 std::shared_ptr<asio::io_context> io_context;
 std::atomic_bool is_shutting_down{false};
 
-// --- NOWY GLOBALNY MANAGER ---
-std::shared_ptr<RandomXManager> g_rx_manager;
-// ---
+// Podział workerów między pule i managery RandomX (datasety) sesji
+std::shared_ptr<PoolScheduler> g_scheduler;
+std::shared_ptr<asio::steady_timer> g_slice_timer;
+RandomXMode g_rx_mode = RandomXMode::Fast; // Tryb dla nowych managerów (wątek io_context)
+
+// Rdzeń telemetrii - źródło wszystkich statystyk (raport, 's', metryki)
+std::shared_ptr<Telemetry> g_telemetry;
+// Rozliczenie udziałów: efektywny hashrate wobec lokalnego i powody odrzuceń
+std::shared_ptr<ShareAccounting> g_accounting;
+const auto g_start_time = std::chrono::steady_clock::now();
+
+// Oś czasu startu (raport przy pierwszym hashu, "startup" w /status)
+StartupTimeline g_startup{g_start_time};
+// Seed spekulacyjnej budowy (ustawiany przed zleceniem budowy i io_context->run(), potem tylko czytany)
+std::string g_speculative_seed;
+std::string g_saved_seed; // Ostatnio zapisany w --seed-file (wątek io_context)
+// Starszy zapisany seed na pewno nie jest już aktualny (epoka Monero to ok. 2,8 dnia)
+constexpr auto SPECULATION_MAX_AGE = std::chrono::hours(72);
+
+std::shared_ptr<MetricsServer> g_metrics_server;
+std::shared_ptr<ControlServer> g_control_server;
+
+// Limity cgroup (odczytywane ponownie co LIMITS_POLL_INTERVAL w wątku io_context)
+CgroupLimits g_limits;
+std::shared_ptr<asio::steady_timer> g_limits_timer;
+constexpr auto LIMITS_POLL_INTERVAL = std::chrono::seconds(10);
 
-std::mutex g_stats_mutex;
-std::deque<double> g_hashrate_samples;
-const size_t MAX_SAMPLES_1H = 360;
+// Tryb co-tenant (tylko z --cotenant); stan zmieniany wyłącznie w wątku io_context
+std::unique_ptr<CotenantMonitor> g_cotenant;
+std::shared_ptr<asio::steady_timer> g_cotenant_timer;
+
+// Limit hashrate/CPU: regulator wspólny dla workerów, krok pętli co LIMITER_INTERVAL
+std::shared_ptr<RateLimiter> g_limiter;
+std::shared_ptr<asio::steady_timer> g_limiter_timer;
+constexpr auto LIMITER_INTERVAL = std::chrono::seconds(1);
+constexpr auto LIMITER_HASHRATE_WINDOW = std::chrono::seconds(5);
+
+// Nadzór workerów (--watchdog-slow > 0); stan zmieniany wyłącznie w wątku io_context
+std::unique_ptr<WorkerWatchdog> g_watchdog;
+std::shared_ptr<asio::steady_timer> g_watchdog_timer;
+
+// Pomiar energii (tylko z --energy); odczyt RAPL w kroku regulatora, statystyki z dowolnego wątku
+std::unique_ptr<EnergyMonitor> g_energy;
+
+// Migawki dla agregatora floty (tylko z --fleet-collector); wątek io_context
+std::shared_ptr<FleetReporter> g_fleet_reporter;
+uint64_t g_pool_reconnects = 0; // Utracone połączenia z pulami (wątek io_context)
 // ---
 
-// --- FUNKCJE POMOCNICZE (bez zmian) ---
-void print_green_line(const std::string& s) {
-    std::lock_guard<std::mutex> lock(g_cout_mutex);
-#ifdef _WIN32
-    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-    CONSOLE_SCREEN_BUFFER_INFO consoleInfo;
-    WORD saved_attributes;
-    GetConsoleScreenBufferInfo(hConsole, &consoleInfo);
-    saved_attributes = consoleInfo.wAttributes;
-    SetConsoleTextAttribute(hConsole, FOREGROUND_GREEN | FOREGROUND_INTENSITY);
-    std::cout << s;
-    SetConsoleTextAttribute(hConsole, saved_attributes);
-#else
-    if (isatty(STDOUT_FILENO)) {
-        std::cout << "\033[1;32m" << s << "\033[0m";
+// --- FUNKCJE POMOCNICZE ---
+/**
+ * @brief Zwraca liczniki wydajności workera o danym ID (jeśli włączone).
+ */
+std::optional<PerfSample> perf_for_worker(int id) {
+    return g_workers ? g_workers->perf_sample(id) : std::nullopt;
+}
+
+/**
+ * @brief Manager RandomX głównej puli (seed, tryb, postęp budowy w raportach).
+ */
+std::shared_ptr<RandomXManager> rx_manager() {
+    return g_scheduler->primary_manager();
+}
+
+/**
+ * @brief Pamięć wszystkich datasetów i cache'y (przy kilku pulach z różnymi seedami jest ich kilka).
+ */
+RandomXFootprint rx_footprint() {
+    RandomXFootprint total;
+    bool first = true;
+    for (const auto& manager : g_scheduler->managers()) {
+        RandomXFootprint footprint = manager->get_footprint();
+        total.cache_bytes += footprint.cache_bytes;
+        total.dataset_bytes += footprint.dataset_bytes;
+        total.cache_large_pages = (first || total.cache_large_pages) && footprint.cache_large_pages;
+        total.dataset_large_pages = (first || total.dataset_large_pages) && footprint.dataset_large_pages;
+        first = false;
+    }
+    return total;
+}
+
+/**
+ * @brief Suma liczników skanowania datasetów wszystkich pul.
+ */
+DatasetScrubStats dataset_scrub_stats() {
+    DatasetScrubStats total;
+    for (const auto& manager : g_scheduler->managers()) {
+        DatasetScrubStats stats = manager->get_scrub_stats();
+        total.active = total.active || stats.active;
+        total.items_checked += stats.items_checked;
+        total.corrupt_items += stats.corrupt_items;
+        total.corrupt_ranges += stats.corrupt_ranges;
+        total.rebuilds += stats.rebuilds;
+        total.passes += stats.passes;
+        total.pass_progress = std::max(total.pass_progress, stats.pass_progress);
+    }
+    return total;
+}
+
+/**
+ * @brief Formatuje liczniki wydajności jako dopisek do linii wątku.
+ */
+std::string format_perf_suffix(const PerfSample& perf, uint64_t hashes) {
+    auto per_hash = [hashes](const std::optional<uint64_t>& v) {
+        return v && hashes > 0 ? fmt::format("{:.0f}", static_cast<double>(*v) / hashes) : std::string("-");
+    };
+    std::string suffix;
+    if (perf.hardware) {
+        suffix += fmt::format(" | IPC {:.2f} | LLC miss/hash {} | dTLB miss/hash {}",
+                              perf.ipc(), per_hash(perf.llc_misses), per_hash(perf.dtlb_misses));
     } else {
-        std::cout << s;
+        suffix += " | PMU niedostępne";
     }
-#endif
-    std::cout.flush();
+    if (perf.context_switches) {
+        suffix += fmt::format(" | cs {}", *perf.context_switches);
+    }
+    if (perf.cpu_migrations) {
+        suffix += fmt::format(" | migr {}", *perf.cpu_migrations);
+    }
+    return suffix;
 }
 
-double calculate_average(size_t count) {
-    if (g_hashrate_samples.empty() || count == 0) {
-        return 0.0;
+/**
+ * @brief Drukuje raport statystyk (klawisz 's') na podstawie telemetrii.
+ */
+void print_stats_report() {
+    auto view = g_telemetry->view(true);
+
+    std::string stats_report = "\n--- STATYSTYKI ---\n";
+    for (size_t w = 0; w < view.windows.size(); ++w) {
+        stats_report += fmt::format(" Średnia ({:>3}):  {:.2f} H/s\n",
+                                    format_window_label(view.windows[w]), view.total_window_rates[w]);
     }
-    double sum = 0.0;
-    size_t num_samples = std::min(g_hashrate_samples.size(), count);
-    auto it = g_hashrate_samples.rbegin();
-    for (size_t i = 0; i < num_samples; ++i) {
-        sum += *it;
-        ++it;
+    stats_report += fmt::format(" EWMA:           {:.2f} H/s\n", view.total_ewma_rate);
+    if (g_energy) {
+        if (auto energy = g_energy->stats(); energy.available) {
+            stats_report += fmt::format(" Energia:        {:.1f} W (pakiet {:.1f}, DRAM {:.1f}) | {:.2f} H/J | {:.0f} J/udział | łącznie {:.1f} kJ\n",
+                                        energy.watts(), energy.package_watts, energy.dram_watts, energy.hashes_per_joule,
+                                        energy.joules_per_share, energy.joules_total() / 1e3);
+        } else {
+            stats_report += " Energia:        pomiar niedostępny (RAPL)\n";
+        }
+    }
+    stats_report += fmt::format(" Hashe łącznie:  {}\n", view.total_hashes);
+    for (const auto& w : view.workers) {
+        stats_report += fmt::format(" Wątek {:>3}: {:>8.1f} H/s | hash p50 {:.2f} ms, p99 {:.2f} ms",
+                                    w.id, w.ewma_rate,
+                                    w.latency.percentile(0.50) / 1e6,
+                                    w.latency.percentile(0.99) / 1e6);
+        if (auto perf = perf_for_worker(w.id)) {
+            stats_report += format_perf_suffix(*perf, w.hashes);
+        }
+        stats_report += "\n";
+    }
+    auto shares = g_accounting->stats(view.total_window_rates);
+    for (const auto& w : shares.windows) {
+        stats_report += fmt::format(" Efektywny ({:>3}): {:.2f} H/s (95%: {:.2f} - {:.2f}) | udziały {} / odrz. {} / nieakt. {}\n",
+                                    format_window_label(w.window), w.effective_rate, w.effective_low, w.effective_high,
+                                    w.accepted, w.rejected, w.stale);
+    }
+    for (std::size_t r = 1; r < shares.reasons.size(); ++r) {
+        if (shares.reasons[r]) {
+            stats_report += fmt::format(" Odrzucone ({}): {}\n", reject_reason_name(static_cast<RejectReason>(r)),
+                                        shares.reasons[r]);
+        }
+    }
+    if (shares.alert) {
+        stats_report += fmt::format(" UWAGA: {}\n", shares.alert_reason);
+    }
+    if (g_scheduler->size() > 1) {
+        for (const auto& pool : g_scheduler->stats()) {
+            stats_report += fmt::format(" Pula {}: {} | wątki {} | waga {} | dataset #{}\n", pool.pool,
+                                        pool.connected ? "połączona" : "rozłączona", pool.threads, pool.weight,
+                                        pool.dataset);
+        }
+    }
+    stats_report += fmt::format(" {}\n", format_memory_report(read_memory_usage(), rx_footprint()));
+    if (auto scrub = dataset_scrub_stats(); scrub.items_checked > 0) {
+        stats_report += fmt::format(" Skanowanie datasetu: {} elementów, {} uszkodzonych, przebudowy: {}, przebieg {:.0f}%\n",
+                                    scrub.items_checked, scrub.corrupt_items, scrub.rebuilds,
+                                    scrub.pass_progress * 100.0);
+    }
+    stats_report += "------------------";
+
+    LOG_INFO(LogCategory::Stats, "{}", stats_report);
+}
+
+/**
+ * @brief Zbiera migawkę statystyk dla endpointu metryk.
+ * Wywoływana w wątku io_context; odczytuje tylko liczniki atomowe workerów
+ * i stan opublikowany przez managery RandomX (seed, pamięć, postęp budowy),
+ * więc nie bierze blokad wątków haszujących i nie czeka na budowę datasetu.
+ */
+MetricsSnapshot collect_metrics_snapshot() {
+    MetricsSnapshot snapshot;
+
+    auto view = g_telemetry->view(true);
+    for (auto window : view.windows) {
+        snapshot.windows.push_back(format_window_label(window));
+    }
+    snapshot.total_window_rates = view.total_window_rates;
+    snapshot.total_ewma_rate = view.total_ewma_rate;
+
+    for (const auto& w : view.workers) {
+        MetricsSnapshot::ThreadStats t;
+        t.id = w.id;
+        t.hashes = w.hashes;
+        t.ewma_rate = w.ewma_rate;
+        t.window_rates = w.window_rates;
+        t.latency_p50_seconds = w.latency.percentile(0.50) / 1e9;
+        t.latency_p90_seconds = w.latency.percentile(0.90) / 1e9;
+        t.latency_p99_seconds = w.latency.percentile(0.99) / 1e9;
+        t.latency_count = w.latency.total;
+        t.perf = perf_for_worker(w.id);
+        snapshot.threads.push_back(std::move(t));
+    }
+
+    for (const auto& session : g_clients) {
+        if (session) {
+            snapshot.shares_accepted += session->getAcceptedShares();
+            snapshot.shares_rejected += session->getRejectedShares();
+        }
+    }
+    if (!g_clients.empty() && g_clients.front()) {
+        snapshot.pool_rtt_seconds = g_clients.front()->getPoolRttSeconds();
+        snapshot.job_age_seconds = g_clients.front()->getJobAgeSeconds();
+    }
+    const auto pool_stats = g_scheduler->stats();
+    for (std::size_t i = 0; i < pool_stats.size() && i < g_clients.size(); ++i) {
+        const auto& stats = pool_stats;
+        MetricsSnapshot::Pool pool;
+        pool.pool = stats[i].pool;
+        pool.connected = stats[i].connected;
+        pool.active = stats[i].active;
+        pool.threads = stats[i].threads;
+        pool.weight = stats[i].weight;
+        pool.dataset = stats[i].dataset;
+        if (g_clients[i]) {
+            pool.rtt_seconds = g_clients[i]->getPoolRttSeconds();
+            pool.job_age_seconds = g_clients[i]->getJobAgeSeconds();
+        }
+        snapshot.pools.push_back(std::move(pool));
+    }
+    snapshot.datasets = g_scheduler->managers().size();
+    if (g_journal) {
+        snapshot.share_journal = g_journal->stats();
+    }
+    snapshot.share_accounting = g_accounting->stats(view.total_window_rates);
+
+    if (g_scheduler) {
+        auto manager = rx_manager();
+        snapshot.dataset_build_seconds = manager->get_dataset_build_ms() / 1000.0;
+        snapshot.dataset_init = manager->get_init_progress();
+        snapshot.seed_epoch = manager->get_seed_epoch();
+        snapshot.seed_hash = manager->get_current_seed();
+        snapshot.randomx_mode = randomx_mode_name(manager->get_mode());
+        snapshot.algorithm = manager->get_algorithm().name;
+        snapshot.randomx_memory = rx_footprint();
+        snapshot.dataset_scrub = dataset_scrub_stats();
+    }
+
+    snapshot.uptime_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - g_start_time).count();
+    snapshot.log_dropped = g_logger.dropped();
+    snapshot.memory = read_memory_usage();
+
+    // Limity cgroup: węższy z cpuset i quota
+    double cpu_limit = g_limits.cpuset.empty() ? -1.0 : static_cast<double>(g_limits.cpuset.size());
+    if (g_limits.cpu_quota) {
+        cpu_limit = cpu_limit < 0 ? *g_limits.cpu_quota : std::min(cpu_limit, *g_limits.cpu_quota);
+    }
+    snapshot.cpu_limit = cpu_limit;
+    if (g_limits.memory_limit) {
+        snapshot.memory_limit_bytes = static_cast<double>(*g_limits.memory_limit);
+    }
+
+    if (g_energy) {
+        snapshot.energy = g_energy->stats();
+    }
+    if (g_watchdog) {
+        snapshot.watchdog = g_watchdog->stats();
+    }
+    if (g_fleet_reporter) {
+        snapshot.fleet = g_fleet_reporter->stats();
+    }
+
+    if (auto limit = g_limiter->stats(); limit.limit.kind != RateLimit::Kind::None) {
+        MetricsSnapshot::Limit l;
+        l.kind = limit.limit.kind == RateLimit::Kind::Hashrate ? "hashrate"
+                 : limit.limit.kind == RateLimit::Kind::Watts  ? "power"
+                                                                : "cpu";
+        l.target = limit.target;
+        l.measured = limit.measured;
+        l.deviation = limit.deviation;
+        l.correction = limit.correction;
+        l.throttle_seconds = limit.throttle_seconds;
+        snapshot.limit = l;
+    }
+
+    if (g_cotenant) {
+        const auto& stats = g_cotenant->stats();
+        MetricsSnapshot::Cotenant c;
+        c.active_workers = stats.active_workers;
+        c.parked_workers = stats.parked_workers;
+        c.park_events = stats.park_events;
+        c.hashrate_forgone = stats.hashrate_forgone;
+        c.hashes_forgone_total = stats.hashes_forgone_total;
+        c.cpu_seconds_yielded = stats.cpu_seconds_yielded;
+        if (stats.cpu) {
+            c.cpu_pressure_avg10 = stats.cpu->some_avg10;
+            c.cpu_stall_seconds = stats.cpu->some_total_us / 1e6;
+        }
+        if (stats.memory) {
+            c.memory_pressure_avg10 = stats.memory->some_avg10;
+            c.memory_stall_seconds = stats.memory->some_total_us / 1e6;
+        }
+        snapshot.cotenant = c;
+    }
+    return snapshot;
+}
+
+/**
+ * @brief Migawka dla agregatora floty (wątek io_context): podzbiór metryk
+ * z hashrate w najkrótszym oknie telemetrii i licznikami błędów.
+ */
+FleetSnapshot collect_fleet_snapshot() {
+    MetricsSnapshot metrics = collect_metrics_snapshot();
+    FleetSnapshot s;
+    s.time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    s.uptime_seconds = static_cast<uint64_t>(metrics.uptime_seconds);
+    s.hashrate = metrics.total_window_rates.empty() ? 0.0f : static_cast<float>(metrics.total_window_rates.front());
+    s.hashrate_ewma = static_cast<float>(metrics.total_ewma_rate);
+    for (const auto& t : metrics.threads) {
+        s.thread_rates.push_back(t.window_rates.empty() ? 0.0f : static_cast<float>(t.window_rates.front()));
+    }
+
+    s.shares_accepted = metrics.shares_accepted;
+    s.shares_rejected = metrics.shares_rejected;
+    if (metrics.share_accounting) {
+        for (const auto& pool : metrics.share_accounting->pools) {
+            s.shares_stale += pool.stale;
+        }
+    }
+    for (const auto& pool : metrics.pools) {
+        s.pools_connected += pool.connected ? 1 : 0;
+    }
+    s.pools_total = static_cast<uint32_t>(metrics.pools.size());
+
+    if (metrics.dataset_init.active) {
+        s.dataset_state = FleetDatasetState::Building;
+        s.dataset_progress = static_cast<float>(metrics.dataset_init.fraction());
+    } else if (metrics.seed_hash.empty()) {
+        s.dataset_state = FleetDatasetState::None;
+    } else {
+        s.dataset_state = metrics.randomx_mode == "light" ? FleetDatasetState::Light : FleetDatasetState::Ready;
+    }
+    s.dataset_build_seconds = static_cast<float>(metrics.dataset_build_seconds);
+    s.seed_epoch = metrics.seed_epoch;
+    s.seed_hash = metrics.seed_hash;
+    s.algorithm = metrics.algorithm;
+
+    s.log_warnings = g_logger.warnings();
+    s.log_errors = g_logger.errors();
+    s.pool_reconnects = g_pool_reconnects;
+    if (metrics.watchdog) {
+        s.watchdog_repairs = metrics.watchdog->repins + metrics.watchdog->vm_resets + metrics.watchdog->restarts;
+    }
+    s.dataset_corrupt_items = metrics.dataset_scrub.corrupt_items;
+    return s;
+}
+
+/**
+ * @brief Zapisuje zebrany ślad do pliku (klawisz 't').
+ */
+void export_trace() {
+    if (!trace_enabled()) {
+        LOG_INFO(LogCategory::Trace, "[Trace] Śledzenie jest wyłączone (uruchom z --trace).");
+        return;
+    }
+    if (trace_write_chrome_json(g_config.trace_file)) {
+        LOG_INFO(LogCategory::Trace, "[Trace] Zapisano ślad do {}", g_config.trace_file);
+    } else {
+        LOG_ERROR(LogCategory::Trace, "[Trace] Nie udało się zapisać {}", g_config.trace_file);
     }
-    return sum / num_samples;
 }
 
 void shutdown_miner() {
@@ -85,13 +452,9 @@ void shutdown_miner() {
     if (already_shutting_down) {
         return;
     }
-    {
-        std::lock_guard<std::mutex> lock(g_cout_mutex);
-        std::cout << "\nZatrzymywanie minera...\n";
-        std::cout.flush();
-    }
-    for (auto& worker : workers) {
-        worker->stop();
+    LOG_INFO(LogCategory::General, "\nZatrzymywanie minera...");
+    if (g_workers) {
+        g_workers->request_stop();
     }
     if (io_context) {
         io_context->stop();
@@ -104,62 +467,642 @@ void shutdown_miner() {
 }
 
 void signal_handler(int signum) {
-    {
-        std::lock_guard<std::mutex> lock(g_cout_mutex);
-        std::cout << fmt::format("\nOtrzymano sygnał {}...", signum);
-    }
+    LOG_INFO(LogCategory::General, "\nOtrzymano sygnał {}...", signum);
     shutdown_miner();
 }
+
+/**
+ * @brief Pamięć hosta dla planisty: MemAvailable, wolne huge pages i to, co już zajmuje RandomX.
+ * Zajętość RandomX pochodzi z opublikowanego stanu managerów - bez czekania na trwającą budowę.
+ */
+MemoryBudget current_memory_budget() {
+    MemoryUsage usage = read_memory_usage(g_config.cgroup_root);
+    MemoryBudget budget;
+    budget.available_bytes = usage.available_bytes;
+    if (usage.hugepages_free && usage.hugepage_size_bytes) {
+        budget.hugepages_free_bytes = *usage.hugepages_free * *usage.hugepage_size_bytes;
+    }
+    if (g_scheduler) {
+        RandomXFootprint footprint = rx_footprint();
+        budget.resident_bytes = footprint.cache_bytes + footprint.dataset_bytes;
+        budget.current_mode = g_rx_mode;
+    }
+    return budget;
+}
+
+/**
+ * @brief Liczba wątków i tryb RandomX dla konfiguracji, limitów cgroup i wolnej pamięci.
+ */
+WorkerPlan current_plan(const MinerConfig& config) {
+    return plan_workers(g_limits, std::thread::hardware_concurrency(), config.threads, config.randomx_mode,
+                        current_memory_budget());
+}
+
+/**
+ * @brief Dostosowuje pulę wątków i tryb RandomX do planu (wątek io_context).
+ * Zmianę trybu tylko zlecamy: zwolnienie lub budowę datasetu wykonuje wątek
+ * managera (haszowanie czeka), a workery odtwarzają potem VM z nowymi flagami.
+ */
+void apply_plan(const WorkerPlan& plan) {
+    // Mniej wątków najpierw: scratchpady zwalniamy przed alokacją datasetu
+    if (plan.threads < g_workers->size()) {
+        g_workers->resize(plan.threads);
+    }
+    if (plan.mode != g_rx_mode) {
+        LOG_INFO(LogCategory::Manager, "[MANAGER] Zmiana trybu RandomX: {}", plan.reason);
+    }
+    g_rx_mode = plan.mode;
+    for (const auto& manager : g_scheduler->managers()) {
+        // Zmianę (zwolnienie lub budowę datasetu) wykonuje wątek managera
+        if (manager->get_mode() != plan.mode) {
+            manager->request_mode(plan.mode);
+        }
+    }
+    g_workers->resize(plan.threads);
+}
+
+/**
+ * @brief Okresowo sprawdza limity cgroup i reaguje na ich zmianę (wątek io_context).
+ */
+void schedule_limits_check() {
+    g_limits_timer->expires_after(LIMITS_POLL_INTERVAL);
+    g_limits_timer->async_wait([](const asio::error_code& ec) {
+        if (ec || is_shutting_down) {
+            return;
+        }
+        // Planujemy dopiero po zakończeniu zleconych zmian trybu (pamięć RandomX się jeszcze zmienia)
+        const auto managers = g_scheduler->managers();
+        if (std::any_of(managers.begin(), managers.end(), [](const auto& m) { return m->mode_change_pending(); })) {
+            schedule_limits_check();
+            return;
+        }
+        // Manager, któremu nie starczyło pamięci na dataset, sam został przy light
+        if (g_rx_mode == RandomXMode::Fast &&
+            std::any_of(managers.begin(), managers.end(), [](const auto& m) { return m->get_mode() == RandomXMode::Light; })) {
+            LOG_WARN(LogCategory::Manager, "[MANAGER] Dataset nie zmieścił się w pamięci - zostaję w trybie light");
+            g_rx_mode = RandomXMode::Light;
+        }
+
+        CgroupLimits limits = read_cgroup_limits(g_config.cgroup_root);
+        bool limits_changed = limits != g_limits;
+        g_limits = limits;
+        WorkerPlan plan = current_plan(g_config);
+        if (limits_changed) {
+            LOG_INFO(LogCategory::Manager, "[MANAGER] Zmiana limitów cgroup: {}", plan.reason);
+            apply_plan(plan);
+        } else if (!g_config.randomx_mode && (plan.mode != g_rx_mode || plan.threads != g_workers->size())) {
+            // Presja pamięci (lub jej ustąpienie) na hoście - nowy tryb albo liczba wątków
+            LOG_WARN(LogCategory::Manager, "[MANAGER] Zmiana dostępnej pamięci: {}", plan.reason);
+            apply_plan(plan);
+        }
+        schedule_limits_check();
+    });
+}
+
+/**
+ * @brief Okresowo dopasowuje liczbę haszujących workerów do obciążenia hosta (wątek io_context).
+ * Zaparkowane workery śpią jak przy pauzie, więc oddają CPU natychmiast.
+ */
+void schedule_cotenant_check() {
+    g_cotenant_timer->expires_after(g_cotenant->config().poll_interval);
+    g_cotenant_timer->async_wait([](const asio::error_code& ec) {
+        if (ec || is_shutting_down) {
+            return;
+        }
+        // Średni hashrate aktywnego workera - do szacunku, ile oddajemy
+        double rate_sum = 0.0;
+        unsigned rate_count = 0;
+        for (double rate : g_telemetry->worker_rates(std::chrono::seconds(10))) {
+            if (rate > 0.0) {
+                rate_sum += rate;
+                rate_count += 1;
+            }
+        }
+        double per_worker_rate = rate_count > 0 ? rate_sum / rate_count : 0.0;
+
+        unsigned total = g_workers->size();
+        unsigned usable = g_limits.usable_cpus(std::thread::hardware_concurrency());
+        g_workers->set_active_limit(g_cotenant->update(total, usable, per_worker_rate));
+        schedule_cotenant_check();
+    });
+}
+
+/**
+ * @brief Okresowo ocenia postęp workerów i wykonuje naprawy watchdoga (wątek io_context).
+ */
+void schedule_watchdog_check() {
+    g_watchdog_timer->expires_after(g_watchdog->config().interval);
+    g_watchdog_timer->async_wait([](const asio::error_code& ec) {
+        if (ec || is_shutting_down) {
+            return;
+        }
+        // Przepinamy w obrębie --affinity, a bez niej - CPU dozwolonych przez cgroup
+        std::vector<unsigned> cpus = g_config.affinity.empty() ? g_limits.cpuset : g_config.affinity;
+        if (cpus.empty()) {
+            for (unsigned cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu) {
+                cpus.push_back(cpu);
+            }
+        }
+        for (const auto& intervention : g_watchdog->update(g_workers->health(), cpus)) {
+            switch (intervention.action) {
+                case WorkerWatchdog::Action::Repin:
+                    g_workers->repin_worker(intervention.worker, static_cast<unsigned>(intervention.cpu));
+                    break;
+                case WorkerWatchdog::Action::ResetVm:
+                    g_workers->reset_worker_vm(intervention.worker);
+                    break;
+                case WorkerWatchdog::Action::Restart:
+                    g_workers->restart_worker(intervention.worker);
+                    break;
+            }
+        }
+        schedule_watchdog_check();
+    });
+}
+
+/**
+ * @brief Krok pętli regulatora limitu (wątek io_context).
+ * Hashrate z krótkiego okna telemetrii, CPU - przyrost czasu CPU procesu.
+ */
+void schedule_limiter_step() {
+    static double last_cpu_seconds = process_cpu_seconds();
+    static auto last_step = std::chrono::steady_clock::now();
+
+    g_limiter_timer->expires_after(LIMITER_INTERVAL);
+    g_limiter_timer->async_wait([](const asio::error_code& ec) {
+        if (ec || is_shutting_down) {
+            return;
+        }
+        auto now = std::chrono::steady_clock::now();
+        double cpu_seconds = process_cpu_seconds();
+        double wall = std::chrono::duration<double>(now - last_step).count();
+        double cpu_cores = wall > 0.0 ? (cpu_seconds - last_cpu_seconds) / wall : 0.0;
+        last_cpu_seconds = cpu_seconds;
+        last_step = now;
+
+        std::optional<double> watts;
+        if (g_energy) {
+            uint64_t accepted = 0;
+            for (const auto& session : g_clients) {
+                accepted += session ? session->getAcceptedShares() : 0;
+            }
+            g_energy->update(g_telemetry->view().total_hashes, accepted);
+            watts = g_energy->watts();
+        }
+
+        g_limiter->update(g_telemetry->total_rate(LIMITER_HASHRATE_WINDOW), cpu_cores,
+                          g_workers->active_count(), g_limits.usable_cpus(std::thread::hardware_concurrency()), watts);
+        schedule_limiter_step();
+    });
+}
+
+/**
+ * @brief Nowa praca z puli o danym indeksie sesji (wątek io_context).
+ * Dataset jest przebudowywany tylko przy zmianie seeda - zmiana puli
+ * lub liczby wątków go nie dotyka; pule o tym samym seedzie dzielą dataset.
+ */
+void on_job(unsigned session, const MiningJob& pool_job) {
+    // StratumClient przepuszcza tylko prace z obsługiwanym algo
+    const RandomXAlgorithm* algorithm = find_randomx_algorithm(pool_job.algo);
+    if (!algorithm) {
+        return;
+    }
+    MiningJob job = pool_job;
+    job.pool = session;
+
+    const std::string pool = g_scheduler->stats()[session].pool;
+    g_accounting->record_job(pool, job.job_id, target_to_difficulty(job.target));
+
+    if (g_startup.first_job(job.seed_hash) && !g_speculative_seed.empty()) {
+        if (job.seed_hash == g_speculative_seed) {
+            LOG_INFO(LogCategory::Manager, "[MANAGER] Seed pierwszej pracy zgodny z zapisanym - dataset budowany od startu");
+        } else {
+            LOG_INFO(LogCategory::Manager, "[MANAGER] Seed pierwszej pracy inny niż zapisany - porzucam spekulacyjną budowę");
+        }
+    }
+    if (session == 0 && !g_config.seed_file.empty() && job.seed_hash != g_saved_seed) {
+        g_saved_seed = job.seed_hash;
+        if (!save_last_seed(g_config.seed_file,
+                            {job.seed_hash, algorithm->name, pool, std::chrono::system_clock::now()})) {
+            LOG_WARN(LogCategory::Manager, "[MANAGER] Nie udało się zapisać seeda do {}", g_config.seed_file);
+        }
+    }
+
+    LOG_INFO(LogCategory::Manager, "\n[MANAGER] Rozdzielam nową pracę: {} (Seed: ...{})",
+             job.job_id,
+             job.seed_hash.substr(job.seed_hash.length() - 6));
+
+    // Budowa w tle (wątek managera): io_context dalej obsługuje pulę,
+    // a workery zachowują pracę i pomagają w inicjalizacji datasetu
+    if (g_scheduler->set_job(session, job, *algorithm)) {
+        LOG_INFO(LogCategory::Manager, "\n[MANAGER] Nowy seed ...{} ({}) - buduję dataset w tle",
+                 job.seed_hash.substr(job.seed_hash.length() - 6), algorithm->name);
+    }
+}
+
+/**
+ * @brief Parametry inicjalizacji datasetu: domyślnie wszystkie CPU dozwolone
+ * przez cgroup, a przy --affinity tylko przypięte.
+ */
+DatasetInitConfig dataset_init_config(const MinerConfig& config) {
+    DatasetInitConfig init;
+    init.threads = config.init_threads ? config.init_threads
+                                       : g_limits.usable_cpus(std::thread::hardware_concurrency());
+    init.cpus = !config.affinity.empty() ? config.affinity : g_limits.cpuset;
+    init.kernel = config.dataset_kernel;
+    return init;
+}
+
+DatasetScrubConfig dataset_scrub_config(const MinerConfig& config) {
+    DatasetScrubConfig scrub;
+    scrub.rate = config.release_cache ? 0 : config.scrub_rate;
+    scrub.rebuild_after = config.scrub_rebuild;
+    return scrub;
+}
+
+/**
+ * @brief Koniec budowy seeda (wątek budujący managera).
+ */
+void on_seed_built(const std::string& seed_hash, bool ok) {
+    if (!ok && seed_hash == g_speculative_seed) {
+        LOG_INFO(LogCategory::Manager, "[MANAGER] Spekulacyjna budowa dla seeda ...{} przerwana",
+                 seed_hash.substr(seed_hash.length() - 6));
+        return;
+    }
+    if (!ok) {
+        LOG_WARN(LogCategory::Manager, "[MANAGER] Dataset dla seeda ...{} nie został zbudowany",
+                 seed_hash.substr(seed_hash.length() - 6));
+        return;
+    }
+    g_startup.seed_built(seed_hash);
+    LOG_INFO(LogCategory::Manager, "\n[MANAGER] Globalny Dataset zaktualizowany do seeda: ...{}",
+             seed_hash.substr(seed_hash.length() - 6));
+    LOG_INFO(LogCategory::Manager, "{}", format_memory_report(read_memory_usage(), rx_footprint()));
+}
+
+/**
+ * @brief Nowy manager RandomX (dataset dla puli z innym seedem), ustawiony jak główny.
+ * @throws std::runtime_error przy błędzie alokacji.
+ */
+std::shared_ptr<RandomXManager> make_rx_manager(RandomXMode mode, const RandomXAlgorithm& algorithm) {
+    auto manager = std::make_shared<RandomXManager>(mode, algorithm);
+    manager->set_release_cache(g_config.release_cache);
+    manager->set_init_config(dataset_init_config(g_config));
+    manager->set_scrub_config(dataset_scrub_config(g_config));
+    manager->set_seed_callback(on_seed_built);
+    return manager;
+}
+
+/**
+ * @brief Rozwiązanie znalezione przez worker (wątek roboczy).
+ * Klienci sesji są podmieniani w wątku io_context, więc odczytujemy ich tam.
+ */
+void on_solution(const Solution& solution) {
+    asio::post(*io_context, [solution]() {
+        if (solution.pool < g_clients.size() && g_clients[solution.pool]) {
+            g_clients[solution.pool]->submit(solution);
+        }
+    });
+}
+
+/**
+ * @brief Wynik udziału od puli (wątek io_context).
+ */
+void on_share_result(const ShareResult& result) {
+    g_accounting->record(result);
+    if (result.outcome == ShareOutcome::Accepted) {
+        LOG_NOTICE(LogCategory::Stratum, "[Stratum] Share zaakceptowany! :-) (trudność {})", result.difficulty);
+    }
+}
+
+void schedule_reconnect(unsigned session);
+
+/**
+ * @brief Łączy sesję z pulą z g_config, zamykając poprzednie połączenie (wątek io_context).
+ * @param session 0 = --pool, kolejne = --extra-pool.
+ */
+void connect_to_pool(unsigned session = 0) {
+    const PoolEndpoint endpoint = pool_endpoints(g_config).at(session);
+    if (g_clients[session]) {
+        g_clients[session]->close();
+    }
+    g_reconnect_timers[session]->cancel();
+    auto& session_client = g_clients[session];
+    session_client = std::make_shared<StratumClient>(
+            *io_context, endpoint.host, endpoint.port, endpoint.wallet,
+            [session](const MiningJob& job) { on_job(session, job); }, on_share_result);
+    session_client->set_algorithms(g_config.algorithms);
+    session_client->set_journal(g_journal);
+    session_client->set_disconnect_callback([session] { schedule_reconnect(session); });
+    session_client->set_connect_callback([] { g_startup.pool_connected(); });
+    session_client->connect();
+}
+
+/**
+ * @brief Łączy ponownie po utracie połączenia z pulą (wątek io_context).
+ * Do tego czasu wątki sesji przejmują pozostałe pule; niepotwierdzone
+ * udziały nowe połączenie zamyka jako Stale (zobacz ShareJournal.h).
+ */
+void schedule_reconnect(unsigned session) {
+    if (is_shutting_down) {
+        return;
+    }
+    g_scheduler->set_connected(session, false);
+    ++g_pool_reconnects;
+    LOG_WARN(LogCategory::Stratum, "[Stratum] Utracono połączenie z pulą {} - ponowna próba za {} s.",
+             g_scheduler->stats()[session].pool, RECONNECT_DELAY.count());
+    g_reconnect_timers[session]->expires_after(RECONNECT_DELAY);
+    g_reconnect_timers[session]->async_wait([session](const asio::error_code& ec) {
+        if (!ec && !is_shutting_down) {
+            connect_to_pool(session);
+        }
+    });
+}
+
+/**
+ * @brief Spekulacyjny start: zleca budowę cache'a i datasetu dla seeda z --seed-file,
+ * zanim pula odpowie na login. Workery bez pracy pomagają w budowie i przygotowują
+ * VM; pierwsza praca potwierdza budowę (ten sam seed) albo ją przerywa.
+ */
+void start_speculative_seed() {
+    auto last = load_last_seed(g_config.seed_file);
+    if (!last) {
+        return;
+    }
+    g_saved_seed = last->seed_hash;
+    const RandomXAlgorithm* algorithm = find_randomx_algorithm(last->algo);
+    if (!algorithm || (!g_config.algorithms.empty() &&
+                       std::find(g_config.algorithms.begin(), g_config.algorithms.end(), last->algo) ==
+                               g_config.algorithms.end())) {
+        LOG_INFO(LogCategory::Manager, "[MANAGER] Zapisany seed dotyczy wariantu {} spoza --algo - start bez spekulacji",
+                 last->algo);
+        return;
+    }
+    auto age = std::chrono::system_clock::now() - last->saved_at;
+    if (age > SPECULATION_MAX_AGE) {
+        LOG_INFO(LogCategory::Manager, "[MANAGER] Zapisany seed ma {} h - zapewne nieaktualny, start bez spekulacji",
+                 std::chrono::duration_cast<std::chrono::hours>(age).count());
+        return;
+    }
+    // Przed zleceniem: on_seed_built() czyta g_speculative_seed w wątku budującym,
+    // który speculate() może obudzić od razu
+    g_speculative_seed = last->seed_hash;
+    g_startup.speculate(last->seed_hash);
+    if (!g_scheduler->speculate(last->seed_hash, *algorithm)) {
+        // Budowa nie została zlecona, więc wątek budujący nie czyta jeszcze tej zmiennej
+        g_speculative_seed.clear();
+        g_startup.cancel_speculation();
+        return;
+    }
+    LOG_INFO(LogCategory::Manager, "[MANAGER] Buduję dataset dla ostatniego seeda ...{} ({}, pula {}) równolegle z łączeniem",
+             last->seed_hash.substr(last->seed_hash.length() - 6), algorithm->name, last->pool);
+}
+
+/**
+ * @brief Przełącza wątki na kolejną pulę (--pool-split time, wątek io_context).
+ */
+void schedule_pool_slice(std::chrono::milliseconds slice) {
+    g_slice_timer->expires_after(slice);
+    g_slice_timer->async_wait([](const asio::error_code& ec) {
+        if (!ec && !is_shutting_down) {
+            schedule_pool_slice(g_scheduler->advance_slice());
+        }
+    });
+}
+
+/**
+ * @brief Stan minera dla interfejsu sterowania.
+ */
+json control_status() {
+    json status = {
+            {"paused", g_workers->paused()},
+            {"threads", g_workers->size()},
+            {"affinity", g_workers->affinity()},
+            {"pool", fmt::format("{}:{}", g_config.pool_host, g_config.pool_port)},
+            {"user", g_config.wallet},
+            {"seed_hash", rx_manager()->get_current_seed()},
+            {"seed_epoch", rx_manager()->get_seed_epoch()},
+            {"mode", randomx_mode_name(rx_manager()->get_mode())},
+            {"algo", rx_manager()->get_algorithm().name},
+            {"config_file", g_config.config_file},
+            {"hash_backend", MinerHashBackend::BACKEND_NAME},
+            {"startup", g_startup.to_json()}
+    };
+    if (g_scheduler->size() > 1) {
+        json pools = json::array();
+        for (const auto& pool : g_scheduler->stats()) {
+            pools.push_back({{"pool", pool.pool},
+                             {"connected", pool.connected},
+                             {"active", pool.active},
+                             {"threads", pool.threads},
+                             {"weight", pool.weight},
+                             {"dataset", pool.dataset},
+                             {"seed_hash", pool.seed_hash},
+                             {"algo", pool.algo}});
+        }
+        status["pools"] = pools;
+        status["pool_split"] = pool_split_name(g_scheduler->split());
+    }
+    if (auto init = rx_manager()->get_init_progress(); init.active) {
+        status["dataset_init"] = {{"progress", init.fraction()},
+                                  {"elapsed_seconds", init.elapsed_seconds},
+                                  {"eta_seconds", init.eta_seconds},
+                                  {"threads", init.participants},
+                                  {"kernel", dataset_kernel_name(init.kernel)}};
+    }
+    if (auto limit = g_limiter->stats(); limit.limit.kind != RateLimit::Kind::None) {
+        status["limit"] = {{"limit", format_rate_limit(limit.limit)},
+                           {"target", limit.target},
+                           {"measured", limit.measured},
+                           {"deviation", limit.deviation}};
+    }
+    if (g_energy) {
+        auto energy = g_energy->stats();
+        status["energy"] = {{"available", energy.available},
+                            {"watts", energy.watts()},
+                            {"hashes_per_joule", energy.hashes_per_joule},
+                            {"joules_per_share", energy.joules_per_share}};
+    }
+    auto shares = g_accounting->stats(g_telemetry->view().total_window_rates);
+    json effective = json::object();
+    for (const auto& w : shares.windows) {
+        effective[format_window_label(w.window)] = {{"rate", w.effective_rate},
+                                                    {"low", w.effective_low},
+                                                    {"high", w.effective_high},
+                                                    {"local", w.local_rate}};
+    }
+    status["shares"] = {{"effective_hashrate", effective},
+                        {"alert", shares.alert},
+                        {"alert_reason", shares.alert_reason}};
+    if (g_cotenant) {
+        const auto& stats = g_cotenant->stats();
+        status["cotenant"] = {{"active_workers", stats.active_workers},
+                              {"parked_workers", stats.parked_workers},
+                              {"priority", thread_priority_name(g_config.cotenant.priority.cls)},
+                              {"hashrate_forgone", stats.hashrate_forgone},
+                              {"cpu_seconds_yielded", stats.cpu_seconds_yielded}};
+    }
+    return status;
+}
+
+/**
+ * @brief Nakłada nową konfigurację na działającego minera (wątek io_context).
+ * Pula, wątki, powinowactwo, limit i poziom logowania zmieniają się na żywo;
+ * pozostałe opcje wymagają restartu.
+ */
+void apply_config(const MinerConfig& updated) {
+    bool pool_changed = updated.pool_host != g_config.pool_host || updated.pool_port != g_config.pool_port ||
+                        updated.wallet != g_config.wallet || updated.algorithms != g_config.algorithms;
+    bool needs_restart = updated.metrics_port != g_config.metrics_port ||
+                         updated.metrics_bind != g_config.metrics_bind ||
+                         updated.control_port != g_config.control_port ||
+                         updated.control_bind != g_config.control_bind ||
+                         updated.stats_windows != g_config.stats_windows ||
+                         updated.perf_counters != g_config.perf_counters ||
+                         updated.trace != g_config.trace ||
+                         updated.share_journal != g_config.share_journal ||
+                         updated.cotenant.enabled != g_config.cotenant.enabled ||
+                         updated.cotenant.priority != g_config.cotenant.priority ||
+                         updated.energy != g_config.energy ||
+                         updated.fleet != g_config.fleet ||
+                         updated.watchdog.slow_ratio != g_config.watchdog.slow_ratio ||
+                         updated.extra_pools != g_config.extra_pools ||
+                         updated.pool_weights != g_config.pool_weights ||
+                         updated.pool_split != g_config.pool_split ||
+                         updated.pool_slice != g_config.pool_slice;
+
+    bool release_cache_changed = updated.release_cache != g_config.release_cache;
+    // Sesje dodatkowych pul powstają przy starcie - do restartu zostają dotychczasowe
+    MinerConfig running = g_config;
+    g_config = updated;
+    g_config.extra_pools = running.extra_pools;
+    g_config.pool_weights = running.pool_weights;
+    g_config.pool_split = running.pool_split;
+    g_config.pool_slice = running.pool_slice;
+    g_logger.set_min_level(g_config.logging.min_level);
+    for (const auto& manager : g_scheduler->managers()) {
+        if (release_cache_changed) {
+            manager->set_release_cache(g_config.release_cache);
+        }
+        manager->set_init_config(dataset_init_config(g_config)); // Od następnej budowy
+        manager->set_scrub_config(dataset_scrub_config(g_config));
+    }
+    g_workers->set_affinity(g_config.affinity);
+    g_limiter->set_limit(g_config.limit);
+    StubHasher::set_share_probability(g_config.stub_share_percent / 100.0);
+    apply_plan(current_plan(g_config));
+    if (pool_changed) {
+        LOG_INFO(LogCategory::Control, "[Control] Zmiana puli na {}:{}", g_config.pool_host, g_config.pool_port);
+        connect_to_pool();
+    }
+    if (needs_restart) {
+        LOG_WARN(LogCategory::Control, "[Control] Część zmienionych opcji (metryki, sterowanie, okna, perf, trace, dziennik udziałów, co-tenant, watchdog, energia, flota, pule dodatkowe) zadziała po restarcie.");
+    }
+}
+
+/**
+ * @brief Operacje interfejsu sterowania (wywoływane w wątku io_context).
+ */
+ControlHandlers make_control_handlers() {
+    ControlHandlers handlers;
+    handlers.status = control_status;
+    handlers.pause = [] { g_workers->pause(); };
+    handlers.resume = [] { g_workers->resume(); };
+    handlers.set_threads = [](unsigned count) {
+        g_config.threads = count;
+        g_workers->resize(count);
+    };
+    handlers.set_affinity = [](std::vector<unsigned> cpus) {
+        g_config.affinity = cpus;
+        g_workers->set_affinity(std::move(cpus));
+    };
+    handlers.switch_pool = [](const std::string& host, const std::string& port, const std::optional<std::string>& user) {
+        MinerConfig updated = g_config;
+        updated.pool_host = host;
+        updated.pool_port = port;
+        if (user) {
+            updated.wallet = *user;
+        }
+        apply_config(updated);
+    };
+    handlers.reload_config = [](const std::string& path) {
+        std::string file = path.empty() ? g_config.config_file : path;
+        if (file.empty()) {
+            throw std::invalid_argument("no config file (start with --config or pass \"path\")");
+        }
+        apply_config(load_config_file(file, g_config));
+    };
+    handlers.set_limit = [](const std::string& spec) {
+        RateLimit limit = parse_rate_limit(spec);
+        if (limit.kind == RateLimit::Kind::Watts && !g_energy) {
+            throw std::invalid_argument("Limit mocy wymaga pomiaru energii (uruchom z --energy)");
+        }
+        g_config.limit = limit;
+        g_limiter->set_limit(g_config.limit);
+    };
+    return handlers;
+}
 // --- KONIEC FUNKCJI POMOCNICZYCH ---
 
 
 /**
- * @brief Pętla raportowania Hashrate (bez zmian)
+ * @brief Pętla samplera telemetrii i raportowania Hashrate.
+ * Co sample_interval pobiera próbkę liczników, co 60 s drukuje linię [HASHRATE].
  */
-void report_hashrate_loop(int num_threads) {
-    std::vector<uint64_t> last_hash_counts(num_threads, 0);
-    auto last_stats_time = std::chrono::steady_clock::now();
+void report_hashrate_loop() {
+    const auto report_interval = std::chrono::seconds(60);
+    const auto sample_interval = g_telemetry->config().sample_interval;
+    auto next_sample = std::chrono::steady_clock::now();
+    auto last_report_time = std::chrono::steady_clock::now();
 
     while (!is_shutting_down) {
         auto now = std::chrono::steady_clock::now();
-        double elapsed_stats = std::chrono::duration<double>(now - last_stats_time).count();
-
-        if (elapsed_stats >= 60.0) {
-            std::vector<double> thread_hashrates;
-            double total_hashrate = 0;
-
-            if (workers.size() == num_threads) {
-                for (int i = 0; i < num_threads; ++i) {
-                    uint64_t current_count = workers[i]->getHashCount();
-                    uint64_t count_delta = current_count - last_hash_counts[i];
-                    double hashrate = count_delta / elapsed_stats;
-                    thread_hashrates.push_back(hashrate);
-                    total_hashrate += hashrate;
-                    last_hash_counts[i] = current_count;
-                }
-            }
-            {
-                std::lock_guard<std::mutex> lock(g_stats_mutex);
-                g_hashrate_samples.push_back(total_hashrate);
-                if (g_hashrate_samples.size() > MAX_SAMPLES_1H) {
-                    g_hashrate_samples.pop_front();
-                }
+
+        // Pierwszy hash (z dokładnością do obiegu pętli) zamyka oś czasu startu
+        if (!g_startup.finished() && g_telemetry->view().total_hashes > 0) {
+            g_startup.first_hash();
+            LOG_INFO(LogCategory::Stats, "{}", g_startup.report());
+        }
+
+        if (now >= next_sample) {
+            g_telemetry->sample();
+            next_sample += sample_interval;
+            if (next_sample < now) {
+                next_sample = now + sample_interval; // Nadrabiamy po uśpieniu systemu
             }
+        }
+
+        if (now - last_report_time >= report_interval) {
+            std::vector<double> thread_hashrates = g_telemetry->worker_rates(report_interval);
+            double total_hashrate = g_telemetry->total_rate(report_interval);
 
             std::stringstream ss;
             ss << fmt::format("[HASHRATE] Total: {:.2f} H/s | Wątki: [", total_hashrate);
             for (size_t i = 0; i < thread_hashrates.size(); ++i) {
                 ss << fmt::format("{:.1f}{}", thread_hashrates[i], (i == thread_hashrates.size() - 1) ? "" : ", ");
             }
-            ss << "]\n";
-
-            {
-                std::lock_guard<std::mutex> lock(g_cout_mutex);
-                std::cout << ss.str();
-                std::cout.flush();
+            ss << "]";
+            if (auto limit = g_limiter->stats(); limit.limit.kind != RateLimit::Kind::None) {
+                ss << fmt::format(" | Limit {}: {:.2f} / {:.2f} ({:+.1f}%)", format_rate_limit(limit.limit),
+                                  limit.measured, limit.target, limit.deviation * 100.0);
+            }
+            if (g_energy) {
+                if (auto energy = g_energy->stats(); energy.available) {
+                    ss << fmt::format(" | {:.1f} W, {:.2f} H/J", energy.watts(), energy.hashes_per_joule);
+                }
             }
+            // Ocena rozbieżności co raport; w linii najdłuższe okno (najwęższy przedział)
+            auto shares = g_accounting->check(g_telemetry->view().total_window_rates);
+            auto longest = std::max_element(shares.windows.begin(), shares.windows.end(),
+                                            [](const auto& a, const auto& b) { return a.window < b.window; });
+            if (longest != shares.windows.end() && longest->accepted) {
+                ss << fmt::format(" | Efektywny ({}): {:.2f} H/s ({:.2f} - {:.2f})", format_window_label(longest->window),
+                                  longest->effective_rate, longest->effective_low, longest->effective_high);
+            }
+
+            LOG_INFO(LogCategory::Stats, "{}", ss.str());
 
-            last_stats_time = now;
+            last_report_time = now;
         }
 
         if (is_shutting_down.load()) break;
@@ -182,23 +1125,10 @@ void watch_stdin() {
                 break;
             }
             if (ch == 's' || ch == 'S') {
-                double avg_1m, avg_15m, avg_1h;
-                {
-                    std::lock_guard<std::mutex> lock(g_stats_mutex);
-                    avg_1m = calculate_average(6);
-                    avg_15m = calculate_average(90);
-                    avg_1h = calculate_average(360);
-                }
-                std::string stats_report = "\n--- STATYSTYKI ---\n";
-                stats_report += fmt::format(" Średnia (1m):   {:.2f} H/s\n", avg_1m);
-                stats_report += fmt::format(" Średnia (15m):  {:.2f} H/s\n", avg_15m);
-                stats_report += fmt::format(" Średnia (1h):   {:.2f} H/s\n", avg_1h);
-                stats_report += "------------------\n";
-                {
-                    std::lock_guard<std::mutex> cout_lock(g_cout_mutex);
-                    std::cout << stats_report;
-                    std::cout.flush();
-                }
+                print_stats_report();
+            }
+            if (ch == 't' || ch == 'T') {
+                export_trace();
             }
         }
         if (is_shutting_down.load()) break;
@@ -223,23 +1153,10 @@ void watch_stdin() {
                 break;
             }
             if (c == 's' || c == 'S') {
-                double avg_1m, avg_15m, avg_1h;
-                {
-                    std::lock_guard<std::mutex> lock(g_stats_mutex);
-                    avg_1m = calculate_average(6);
-                    avg_15m = calculate_average(90);
-                    avg_1h = calculate_average(360);
-                }
-                std::string stats_report = "\n--- STATYSTYKI ---\n";
-                stats_report += fmt::format(" Średnia (1m):   {:.2f} H/s\n", avg_1m);
-                stats_report += fmt::format(" Średnia (15m):  {:.2f} H/s\n", avg_15m);
-                stats_report += fmt::format(" Średnia (1h):   {:.2f} H/s\n", avg_1h);
-                stats_report += "------------------\n";
-                {
-                    std::lock_guard<std::mutex> cout_lock(g_cout_mutex);
-                    std::cout << stats_report;
-                    std::cout.flush();
-                }
+                print_stats_report();
+            }
+            if (c == 't' || c == 'T') {
+                export_trace();
             }
         } else if (n == 0) {
              break;
@@ -256,96 +1173,197 @@ void watch_stdin() {
 /**
  * @brief Główna funkcja programu
  */
-int main() {
+int main(int argc, char* argv[]) {
 #ifdef _WIN32
     SetConsoleOutputCP(CP_UTF8);
 #endif
 
-    if (YOUR_WALLET_ADDRESS == "TUTAJ_WKLEJ_SWOJ_ADRES_MONERO") {
+    if (argc > 1 && std::string(argv[1]) == "bench-init") {
+        return run_init_benchmark(std::vector<std::string>(argv + 2, argv + argc));
+    }
+    if (argc > 1 && std::string(argv[1]) == "hash") {
+        return run_batch_hash(std::vector<std::string>(argv + 2, argv + argc));
+    }
+
+    try {
+        g_config = parse_command_line(argc, argv);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << fmt::format("BŁĄD: {}\n\n{}", e.what(), command_line_usage());
+        return 1;
+    }
+
+    if (g_config.wallet == "TUTAJ_WKLEJ_SWOJ_ADRES_MONERO") {
         std::cerr << "BŁĄD: Musisz edytować main.cpp i podać swój adres portfela Monero.\n";
         return 1;
     }
+    g_logger.start(g_config.logging);
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
 
-    int num_threads = std::max(1u, std::thread::hardware_concurrency());
+    g_limits = read_cgroup_limits(g_config.cgroup_root);
+    WorkerPlan plan = current_plan(g_config);
+    unsigned num_threads = plan.threads;
 
     std::cout << "--- Mój CPU Miner (Szkielet C++23) ---\n";
-    std::cout << fmt::format(" Adres puli: {}:{}\n", POOL_HOST, POOL_PORT);
-    std::cout << fmt::format(" Portfel: {}\n", YOUR_WALLET_ADDRESS);
+    std::cout << fmt::format(" Adres puli: {}:{}\n", g_config.pool_host, g_config.pool_port);
+    std::cout << fmt::format(" Portfel: {}\n", g_config.wallet);
+    for (const auto& extra : g_config.extra_pools) {
+        std::cout << fmt::format(" Pula dodatkowa: {}:{} ({})\n", extra.host, extra.port,
+                                 extra.wallet.empty() ? g_config.wallet : extra.wallet);
+    }
+    if (!g_config.extra_pools.empty()) {
+        std::cout << fmt::format(" Podział między pule: {}\n", pool_split_name(g_config.pool_split));
+    }
     std::cout << fmt::format(" Uruchamiam {} wątków roboczych (1 na fizyczny rdzeń).\n", num_threads);
+    std::cout << fmt::format(" Plan: {}\n", plan.reason);
+    if (std::string_view(MinerHashBackend::BACKEND_NAME) != "randomx") {
+        std::cout << fmt::format(" UWAGA: backend haszowania '{}' - wyniki nie są prawdziwymi hashami RandomX!\n",
+                                 MinerHashBackend::BACKEND_NAME);
+    } else if (g_config.stub_share_percent > 0.0) {
+        std::cout << " --stub-share-percent działa tylko w kompilacji z PJUROMINER_STUB_BACKEND.\n";
+    }
+    StubHasher::set_share_probability(g_config.stub_share_percent / 100.0);
     std::cout << "\nWAŻNE: Upewnij się, że masz ustawione 'Large Pages' (Blokuj strony w pamięci)!\n";
     std::cout << "Windows: 'secpol.msc' -> Zasady Lokalne -> Przypisywanie praw -> 'Blokuj strony w pamięci' (i restart).\n";
     std::cout << "Linux: 'sudo sysctl -w vm.nr_hugepages=...' (wymagane > 1100 stron 2MB).\n";
-    std::cout << "\nNaciśnij 'q', aby zakończyć, 's' aby zobaczyć statystyki.\n\n";
+    std::cout << "\nNaciśnij 'q', aby zakończyć, 's' aby zobaczyć statystyki, 't' aby zapisać ślad.\n\n";
 
+    if (g_config.trace) {
+        trace_set_enabled(true);
+        trace_set_thread_name("io_context");
+    }
+
+    std::shared_ptr<RandomXManager> primary_manager;
     try {
-        g_rx_manager = std::make_shared<RandomXManager>();
+        const RandomXAlgorithm* algorithm = g_config.algorithms.empty()
+                                            ? &default_randomx_algorithm()
+                                            : find_randomx_algorithm(g_config.algorithms.front());
+        g_rx_mode = plan.mode;
+        primary_manager = make_rx_manager(plan.mode, *algorithm);
     } catch (const std::exception& e) {
-        std::cerr << fmt::format("Krytyczny błąd inicjalizacji RandomX: {}\n", e.what());
+        LOG_ERROR(LogCategory::RandomX, "Krytyczny błąd inicjalizacji RandomX: {}", e.what());
+        g_logger.stop();
         return 1;
     }
 
+    TelemetryConfig telemetry_config;
+    telemetry_config.windows = g_config.stats_windows;
+    g_telemetry = std::make_shared<Telemetry>(telemetry_config);
+    g_accounting = std::make_shared<ShareAccounting>(g_config.stats_windows);
+
     io_context = std::make_shared<asio::io_context>();
-    workers.reserve(num_threads);
 
-    auto job_callback = [&](const MiningJob& job) {
-        bool seed_changed = g_rx_manager->updateSeed(job.seed_hash);
+    g_limiter = std::make_shared<RateLimiter>();
+    g_limiter->set_limit(g_config.limit);
+    if (g_config.energy.enabled) {
+        g_energy = std::make_unique<EnergyMonitor>(g_config.energy);
+    }
 
-        if (seed_changed) {
-            {
-                std::lock_guard<std::mutex> lock(g_cout_mutex);
-                std::cout << fmt::format("\n[MANAGER] Globalny Dataset zaktualizowany do seeda: ...{}\n",
-                                         job.seed_hash.substr(job.seed_hash.length() - 6));
-            }
-        }
+    g_workers = std::make_shared<WorkerPool>(on_solution, primary_manager, g_telemetry);
+    g_workers->set_rate_limiter(g_limiter);
+    g_workers->set_perf_counters_enabled(g_config.perf_counters);
+    g_workers->set_affinity(g_config.affinity);
+    if (g_config.cotenant.enabled) {
+        g_workers->set_priority(g_config.cotenant.priority);
+    }
+    g_workers->resize(num_threads);
 
-        {
-            std::lock_guard<std::mutex> lock(g_cout_mutex);
-            std::cout << fmt::format("\n[MANAGER] Rozdzielam nową pracę: {} (Seed: ...{})\n",
-                                     job.job_id,
-                                     job.seed_hash.substr(job.seed_hash.length() - 6));
-        }
-        for (auto& worker : workers) {
-            worker->setNewJob(job);
+    // Sesja 0 to --pool, kolejne to --extra-pool; wątki dzieli PoolScheduler
+    std::vector<PoolScheduler::Session> sessions;
+    const auto endpoints = pool_endpoints(g_config);
+    for (std::size_t i = 0; i < endpoints.size(); ++i) {
+        sessions.push_back({fmt::format("{}:{}", endpoints[i].host, endpoints[i].port), pool_weight(g_config, i)});
+    }
+    // Fabryka działa pod blokadą schedulera - nie może go wywoływać
+    g_scheduler = std::make_shared<PoolScheduler>(
+            std::move(sessions), g_config.pool_split, g_config.pool_slice, g_workers, primary_manager,
+            [](const RandomXAlgorithm& algorithm) { return make_rx_manager(g_rx_mode, algorithm); });
+    if (!g_config.seed_file.empty()) {
+        start_speculative_seed(); // Przed łączeniem z pulami - budowa idzie równolegle z DNS i loginem
+    }
+
+    // --- POCZĄTEK POPRAWKI 2 ---
+    // Uruchamiamy wątki, ale ich NIE odłączamy (bez .detach())
+    std::thread input_thread(watch_stdin);
+    std::thread hashrate_thread(report_hashrate_loop);
+
+    if (g_config.metrics_port != 0) {
+        g_metrics_server = std::make_shared<MetricsServer>(
+                *io_context, g_config.metrics_bind, g_config.metrics_port, collect_metrics_snapshot);
+        try {
+            g_metrics_server->start();
+        } catch (const std::system_error& e) {
+            // Metryki są opcjonalne - brak portu nie zatrzymuje kopania
+            LOG_WARN(LogCategory::Metrics, "[Metrics] Nie udało się uruchomić serwera metryk: {}", e.what());
+            g_metrics_server.reset();
         }
-    };
+    }
 
-    auto solution_callback = [&](const Solution& solution) {
-        if (client) {
-            client->submit(solution);
+    if (g_config.fleet.enabled()) {
+        // Pierwsza paczka po fleet.interval * fleet.batch; błędy wysyłki nie zatrzymują kopania
+        g_fleet_reporter = std::make_shared<FleetReporter>(*io_context, g_config.fleet, collect_fleet_snapshot);
+        g_fleet_reporter->start();
+    }
+
+    if (g_config.control_port != 0) {
+        g_control_server = std::make_shared<ControlServer>(
+                *io_context, g_config.control_bind, g_config.control_port, make_control_handlers());
+        try {
+            g_control_server->start();
+        } catch (const std::system_error& e) {
+            LOG_WARN(LogCategory::Control, "[Control] Nie udało się uruchomić interfejsu sterowania: {}", e.what());
+            g_control_server.reset();
         }
-    };
+    }
 
-    auto accepted_share_callback = []() {
-        print_green_line(fmt::format("[Stratum] Share zaakceptowany! :-)\n"));
-    };
+    g_limits_timer = std::make_shared<asio::steady_timer>(*io_context);
+    schedule_limits_check();
 
-    client = std::make_shared<StratumClient>(
-            *io_context, POOL_HOST, POOL_PORT, YOUR_WALLET_ADDRESS, job_callback,
-            accepted_share_callback
-    );
+    g_limiter_timer = std::make_shared<asio::steady_timer>(*io_context);
+    schedule_limiter_step();
 
-    for (int i = 0; i < num_threads; ++i) {
-        auto worker = std::make_shared<MinerWorker>(i, solution_callback, g_rx_manager);
-        workers.push_back(worker);
-        worker->start();
+    if (g_config.watchdog.slow_ratio > 0.0) {
+        g_watchdog = std::make_unique<WorkerWatchdog>(g_config.watchdog);
+        g_watchdog_timer = std::make_shared<asio::steady_timer>(*io_context);
+        schedule_watchdog_check();
     }
 
-    // --- POCZĄTEK POPRAWKI 2 ---
-    // Uruchamiamy wątki, ale ich NIE odłączamy (bez .detach())
-    std::thread input_thread(watch_stdin);
-    std::thread hashrate_thread(report_hashrate_loop, num_threads);
+    if (g_config.cotenant.enabled) {
+        CotenantConfig cotenant_config = g_config.cotenant;
+        cotenant_config.proc_root = g_config.cgroup_root;
+        g_cotenant = std::make_unique<CotenantMonitor>(cotenant_config);
+        g_cotenant_timer = std::make_shared<asio::steady_timer>(*io_context);
+        LOG_INFO(LogCategory::Manager, "[Co-tenant] Priorytet wątków: {}; parkowanie przy PSI CPU > {:.1f}%, wznawianie < {:.1f}%",
+                 thread_priority_name(cotenant_config.priority.cls),
+                 cotenant_config.cpu_pressure_high, cotenant_config.cpu_pressure_low);
+        schedule_cotenant_check();
+    }
 
-    client->connect();
+    if (!g_config.share_journal.empty()) {
+        g_journal = std::make_shared<ShareJournal>(g_config.share_journal);
+        if (g_journal->open()) {
+            LOG_INFO(LogCategory::Stratum, "[Journal] Dziennik udziałów: {}", g_journal->path());
+        } else {
+            g_journal.reset();
+        }
+    }
+    for (std::size_t i = 0; i < g_scheduler->size(); ++i) {
+        g_clients.push_back(nullptr);
+        g_reconnect_timers.push_back(std::make_shared<asio::steady_timer>(*io_context));
+    }
+    for (unsigned i = 0; i < g_scheduler->size(); ++i) {
+        connect_to_pool(i);
+    }
+    if (g_scheduler->split() == PoolSplit::Time && g_scheduler->size() > 1) {
+        g_slice_timer = std::make_shared<asio::steady_timer>(*io_context);
+        schedule_pool_slice(std::chrono::duration_cast<std::chrono::milliseconds>(g_config.pool_slice) /
+                            g_scheduler->size());
+    }
     io_context->run(); // Ta linia blokuje, dopóki shutdown_miner() nie wywoła io_context->stop()
 
     // --- Kod wykonywany po zatrzymaniu io_context ---
 
-    {
-        std::lock_guard<std::mutex> lock(g_cout_mutex);
-        std::cout << "Pętla sieciowa zatrzymana. Czekanie na wątki pomocnicze...\n";
-    }
+    LOG_INFO(LogCategory::General, "Pętla sieciowa zatrzymana. Czekanie na wątki pomocnicze...");
 
     // shutdown_miner() ustawił is_shutting_down na true.
     // Czekamy (join) na wątki pomocnicze, aż same się zakończą.
@@ -356,27 +1374,23 @@ int main() {
         input_thread.join();
     }
 
-    {
-        std::lock_guard<std::mutex> lock(g_cout_mutex);
-        std::cout << "Wątki pomocnicze zatrzymane. Czekanie na wątki robocze...\n";
-    }
+    LOG_INFO(LogCategory::General, "Wątki pomocnicze zatrzymane. Czekanie na wątki robocze...");
 
     // Teraz, gdy wątki pomocnicze są zatrzymane, możemy bezpiecznie
-    // zniszczyć wątki robocze.
-    // Wyczyszczenie wektora wywoła destruktory shared_ptr,
-    // co wywoła destruktory MinerWorker, co wywoła destruktory jthread,
-    // które z kolei wykonają 'join' na każdym wątku roboczym.
+    // zniszczyć wątki robocze. WorkerPool::clear() wywoła destruktory
+    // MinerWorker, które wykonają 'join' na każdym wątku roboczym.
     // Komunikaty "[Worker X] Zatrzymany." pojawią się tutaj.
-    workers.clear();
+    g_workers->clear();
+    g_journal.reset(); // msync i zamknięcie dziennika
 
     // --- KONIEC POPRAWKI 2 ---
 
-    {
-        std::lock_guard<std::mutex> lock(g_cout_mutex);
-        std::cout << "Wszystkie wątki zatrzymane. Zamykanie.\n";
-    }
+    LOG_INFO(LogCategory::General, "Wszystkie wątki zatrzymane. Zamykanie.");
+
+    // Opróżnia bufory loggera; dalsze komunikaty są wypisywane synchronicznie
+    g_logger.stop();
     return 0;
     // Teraz funkcja main() może bezpiecznie zwrócić. Wszystkie wątki
     // są zakończone, więc nie będzie wyścigu przy niszczeniu
-    // globalnych zmiennych (jak g_cout_mutex).
+    // globalnych zmiennych (jak g_logger).
 }
\ No newline at end of file
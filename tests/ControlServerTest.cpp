@@ -0,0 +1,84 @@
+#include "ControlServer.h"
+#include "TestCheck.h"
+#include <chrono>
+#include <string>
+#include <thread>
+
+using asio::ip::tcp;
+using namespace std::chrono_literals;
+
+namespace {
+
+ControlHandlers status_only() {
+    ControlHandlers handlers;
+    handlers.status = [] { return nlohmann::json{{"ok", true}}; };
+    return handlers;
+}
+
+/**
+ * @brief Czyta do zamknięcia połączenia przez serwer; zwraca odebrane dane.
+ */
+std::string read_until_closed(tcp::socket& socket, asio::error_code& ec) {
+    std::string data;
+    char chunk[512];
+    for (;;) {
+        std::size_t n = socket.read_some(asio::buffer(chunk), ec);
+        data.append(chunk, n);
+        if (ec) {
+            return data;
+        }
+    }
+}
+
+/**
+ * @brief Klient, który łączy się i nic nie wysyła, zostaje rozłączony po czasie na żądanie.
+ */
+void silent_client_is_disconnected(asio::io_context& io, ControlServer& server) {
+    tcp::socket client(io);
+    client.connect({asio::ip::make_address("127.0.0.1"), server.port()});
+    auto start = std::chrono::steady_clock::now();
+    asio::error_code ec;
+    std::string data = read_until_closed(client, ec);
+    auto waited = std::chrono::steady_clock::now() - start;
+    CHECK(ec == asio::error::eof || ec == asio::error::connection_reset);
+    CHECK(data.empty());
+    CHECK(waited >= 150ms);
+    CHECK(waited < 5s);
+}
+
+/**
+ * @brief Zwykłe żądanie nadal dostaje odpowiedź.
+ */
+void status_request_is_answered(asio::io_context& io, ControlServer& server) {
+    tcp::socket client(io);
+    client.connect({asio::ip::make_address("127.0.0.1"), server.port()});
+    std::string request = "GET /status HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    asio::write(client, asio::buffer(request));
+    asio::error_code ec;
+    std::string data = read_until_closed(client, ec);
+    CHECK(data.starts_with("HTTP/1.1 200 OK"));
+    CHECK(data.find("\"ok\":true") != std::string::npos);
+}
+
+} // namespace
+
+int main() {
+    asio::io_context io;
+    auto server = std::make_shared<ControlServer>(io, "127.0.0.1", 0, status_only());
+    server->set_request_timeout(200ms);
+    server->start();
+    auto guard = asio::make_work_guard(io);
+    std::thread runner([&io] { io.run(); });
+
+    // Klienci w tym wątku (blokująco), serwer w wątku io_context
+    asio::io_context client_io;
+    silent_client_is_disconnected(client_io, *server);
+    status_request_is_answered(client_io, *server);
+
+    asio::post(io, [&] {
+        server->stop();
+        guard.reset();
+    });
+    runner.join();
+    return test_result();
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdio>
+
+/**
+ * @file TestCheck.h
+ * @brief Minimalne asercje testów (bez zewnętrznego frameworka). Test kończy się
+ * kodem test_result(): 0 = wszystkie sprawdzenia przeszły.
+ */
+
+inline int g_test_failures = 0;
+
+#define CHECK(condition)                                                                   \
+    do {                                                                                   \
+        if (!(condition)) {                                                                \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) nie przeszło\n", __FILE__, __LINE__, #condition); \
+            ++g_test_failures;                                                             \
+        }                                                                                  \
+    } while (0)
+
+inline int test_result() {
+    if (g_test_failures > 0) {
+        std::fprintf(stderr, "Nieudane sprawdzenia: %d\n", g_test_failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include "Logger.h"
+#include "StubHasher.h"
+#include "TestCheck.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr auto WAIT_LIMIT = 10s;
+constexpr unsigned WORKERS = 2;   // Podział nonce na 2 zakresy: ID workera = najwyższy bit nonce
+constexpr unsigned SESSIONS = 2;
+constexpr unsigned SLICES = 5;    // Każda sesja wraca co najmniej raz
+
+const std::string SEED(64, 'a');
+
+/**
+ * @brief Rozwiązania zgłoszone przez workery (wątki workerów dopisują, test czeka).
+ */
+class Solutions {
+public:
+    void add(const Solution& solution) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_solutions.push_back(solution);
+        m_cv.notify_all();
+    }
+
+    std::size_t size() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_solutions.size();
+    }
+
+    /**
+     * @brief Czeka, aż każdy worker zgłosi od indeksu from rozwiązanie dla sesji pool.
+     */
+    bool wait_for_all_workers(std::size_t from, unsigned pool) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_cv.wait_for(lock, WAIT_LIMIT, [&] {
+            std::vector<bool> seen(WORKERS, false);
+            for (std::size_t i = from; i < m_solutions.size(); ++i) {
+                if (m_solutions[i].pool == pool) {
+                    seen[m_solutions[i].nonce >> 31] = true;
+                }
+            }
+            return std::find(seen.begin(), seen.end(), false) == seen.end();
+        });
+    }
+
+    std::vector<Solution> snapshot() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_solutions;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<Solution> m_solutions;
+};
+
+MiningJob make_job(unsigned pool) {
+    MiningJob job;
+    job.job_id = fmt::format("job-{}", pool);
+    job.blob = std::string(152, '0');
+    job.target = "ffffffff";
+    job.seed_hash = SEED;
+    job.algo = default_randomx_algorithm().name;
+    job.pool = pool;
+    return job;
+}
+
+/**
+ * @brief Przedziały czasu (--pool-split time) krążą między dwiema sesjami ze stałą
+ * pracą każdej z nich. Po powrocie przedziału workery znów haszują dla swojej
+ * sesji i wznawiają jej zakres nonce, zamiast go powtarzać.
+ */
+void time_slices_resume_each_session() {
+    auto manager = std::make_shared<RandomXManager>(RandomXMode::Light);
+    manager->request_seed(SEED);
+    auto telemetry = std::make_shared<Telemetry>();
+    Solutions solutions;
+    WorkerPool pool([&](const Solution& solution) { solutions.add(solution); }, manager, telemetry);
+
+    pool.set_pool_weights({1, 0});
+    pool.resize(WORKERS);
+    for (unsigned session = 0; session < SESSIONS; ++session) {
+        pool.set_job(make_job(session), manager);
+    }
+
+    for (unsigned slice = 0; slice < SLICES; ++slice) {
+        unsigned active = slice % SESSIONS;
+        std::vector<unsigned> weights(SESSIONS, 0);
+        weights[active] = 1;
+        std::size_t from = solutions.size();
+        pool.set_pool_weights(weights);
+        CHECK(pool.pool_threads()[active] == WORKERS);
+        bool mined = solutions.wait_for_all_workers(from, active);
+        CHECK(mined);
+        if (!mined) {
+            break; // Kolejne przedziały czekałyby tak samo
+        }
+    }
+    pool.clear();
+
+    // Nonce każdej pary (sesja, worker) rosną przez wszystkie przedziały - bez powtórzeń
+    std::map<std::pair<unsigned, uint32_t>, uint32_t> last_nonce;
+    for (const Solution& solution : solutions.snapshot()) {
+        CHECK(solution.job_id == fmt::format("job-{}", solution.pool));
+        auto key = std::make_pair(solution.pool, solution.nonce >> 31);
+        if (auto it = last_nonce.find(key); it != last_nonce.end()) {
+            CHECK(solution.nonce > it->second);
+        }
+        last_nonce[key] = solution.nonce;
+    }
+}
+
+} // namespace
+
+int main() {
+    g_logger.set_min_level(LogLevel::Warn); // Bez logu każdego rozwiązania
+    StubHasher::set_share_probability(0.001);
+    time_slices_resume_each_session();
+    return test_result();
+}